@@ -10,7 +10,9 @@
 using namespace GeneTrail;
 namespace bpo = boost::program_options;
 
-std::string samples = "", output = "";
+std::string samples = "", output = "", input = "text";
+bool binary = false;
+size_t threads = 0;
 
 bool parseArguments(int argc, char* argv[]){
 	bpo::variables_map vm;
@@ -18,7 +20,10 @@ bool parseArguments(int argc, char* argv[]){
 
 	desc.add_options()("help,h", "Display this message")
 		("samples,s", bpo::value<std::string>(&samples)->required(), "Path to a file listing the samples along with their output directories of the enrichment analyses that should be combined")
-		("out_files,o", bpo::value<std::string>(&output)->required(), "Path to a file containing the measured category databases along with a path to an file for the created matrix (for each category)");
+		("out_files,o", bpo::value<std::string>(&output)->required(), "Path to a file containing the measured category databases along with a path to an file for the created matrix (for each category)")
+		("input,i", bpo::value<std::string>(&input)->default_value("text"), "Format of the sample results: text (<database>.txt), binary-scores or binary-pvalues (<database>.bin, written with --binary_output)")
+		("binary,b", bpo::bool_switch(&binary)->default_value(false), "Write the matrices in the binary matrix format")
+		("threads,j", bpo::value<size_t>(&threads)->default_value(0), "Number of threads used for reading the sample files. 0 uses all cores.");
 
 	try{
 		bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(), vm);
@@ -28,6 +33,11 @@ bool parseArguments(int argc, char* argv[]){
 		desc.print(std::cerr);
 		return false;
 	}
+
+	if(input != "text" && input != "binary-scores" && input != "binary-pvalues") {
+		std::cerr << "ERROR: Unknown input format: " << input << std::endl;
+		return false;
+	}
 	return true;
 }
 
@@ -36,6 +46,13 @@ int main(int argc, char* argv[]){
 
 	try{
 		CombineReducedEnrichments c;
+		c.setBinaryOutput(binary);
+		if(input == "binary-scores") {
+			c.setInputFormat(CombineReducedEnrichments::InputFormat::BinaryScores);
+		} else if(input == "binary-pvalues") {
+			c.setInputFormat(CombineReducedEnrichments::InputFormat::BinaryPValues);
+		}
+		c.setNumberOfThreads(threads);
 		c.writeFiles(samples, output);
 	} catch(const IOError& e) {
 		std::cerr << "ERROR: " << e.what() << std::endl;
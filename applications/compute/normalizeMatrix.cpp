@@ -20,6 +20,7 @@ namespace bpo = boost::program_options;
 std::string matrix = "", output = "", normalization = "", samples = "";
 DenseMatrix valueMatrix(0,0);
 MatrixReaderOptions matrixOptions;
+size_t threads = 0;
 
 bool parseArguments(int argc, char* argv[])
 {
@@ -33,7 +34,8 @@ bool parseArguments(int argc, char* argv[])
 		("no-row-names,r", bpo::value<bool>(&matrixOptions.no_rownames)->default_value(false)->zero_tokens(), "Does the file contain row names.")
 		("no-col-names,c", bpo::value<bool>(&matrixOptions.no_colnames)->default_value(false)->zero_tokens(), "Does the file contain column names.")
 		("add-col-name,a", bpo::value<bool>(&matrixOptions.additional_colname)->default_value(false)->zero_tokens(), "Additional column names")
-		("samples,s", bpo::value<std::string>(&samples)->required(), "File containing one line specifying which rownames should be used in the analysis.");
+		("samples,s", bpo::value<std::string>(&samples)->required(), "File containing one line specifying which rownames should be used in the analysis.")
+		("threads,j", bpo::value<size_t>(&threads)->default_value(0), "Number of rows that are normalized in parallel. 0 uses all cores.");
 
 
 	try
@@ -74,13 +76,13 @@ bool writeNormalizedMatrix(DenseColumnSubset subset)
 	
 	else if(normalization.compare("gauss")== 0) {
 	  GaussEstimator gauss;
-	  writer.writeText(os,norm.normalizeMatrix(subset,gauss));
+	  writer.writeText(os,norm.normalizeMatrix(subset,gauss,threads));
 	  fb2.close();
 	  return true;
 	}
 	else if(normalization.compare("poisson") == 0) {
 	  PoissonEstimator poisson;
-	  writer.writeText(os,norm.normalizeMatrix(subset,poisson));
+	  writer.writeText(os,norm.normalizeMatrix(subset,poisson,threads));
 	  fb2.close();
 	  return true;
 	}
@@ -91,7 +93,7 @@ bool writeNormalizedMatrix(DenseColumnSubset subset)
 	  }
 
 	  ExclusiveZScore zscore;
-	  writer.writeText(os,norm.normalizeMatrix(subset,zscore));
+	  writer.writeText(os,norm.normalizeMatrix(subset,zscore,threads));
 	  fb2.close();
 	  return true;
 	}
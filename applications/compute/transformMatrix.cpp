@@ -20,6 +20,7 @@ namespace bpo = boost::program_options;
 std::string matrix = "", output = "", transformation = "";
 
 bool use_ranks = false;
+size_t threads = 0;
 DenseMatrix valueMatrix(0,0);
 MatrixReaderOptions matrixOptions;
 
@@ -35,7 +36,8 @@ bool parseArguments(int argc, char* argv[])
 		("transformation,t", bpo::value<std::string>(&transformation)->default_value("default"), "Method to transform the values.")
 		("no-row-names,r", bpo::value<bool>(&matrixOptions.no_rownames)->default_value(false)->zero_tokens(), "Does the file contain row names.")
 		("no-col-names,c", bpo::value<bool>(&matrixOptions.no_colnames)->default_value(false)->zero_tokens(), "Does the file contain column names.")
-		("add-col-name,a", bpo::value<bool>(&matrixOptions.additional_colname)->default_value(false)->zero_tokens(), "File containing two lines specifying which rownames belong to which group.");
+		("add-col-name,a", bpo::value<bool>(&matrixOptions.additional_colname)->default_value(false)->zero_tokens(), "File containing two lines specifying which rownames belong to which group.")
+		("threads,j", bpo::value<size_t>(&threads)->default_value(0), "Number of columns that are ranked in parallel. 0 uses all cores.");
 
 	try
 	{
@@ -56,7 +58,7 @@ bool applyTransformation()
 {
   
   	if(use_ranks) 
-	  valuesToRanks(valueMatrix);
+	  valuesToRanks(valueMatrix, threads);
 	
 	//no transformation
 	if(transformation.compare("default")== 0)
@@ -19,6 +19,7 @@ using namespace GeneTrail;
 namespace bpo = boost::program_options;
 
 std::string input_file = "", output_file, adjustment_method_ = "";
+size_t num_threads = 0;
 
 bool parseArguments(int argc, char* argv[])
 {
@@ -28,7 +29,8 @@ bool parseArguments(int argc, char* argv[])
 	desc.add_options()("help,h", "Display this message")
 	    ("adjust,a", bpo::value(&adjustment_method_)->required()->default_value("benjamini-yekutieli"), "Method for multiple testing correction. (default: benjamini-yekutieli)")
 		("input,i", bpo::value<std::string>(&input_file)->required(), "Input file (AB, notAB, AnotB, notAnotB).")
-		("output,o", bpo::value<std::string>(&output_file)->required(), "Name of the output file.");
+		("output,o", bpo::value<std::string>(&output_file)->required(), "Name of the output file.")
+		("threads,t", bpo::value<size_t>(&num_threads)->default_value(0), "Number of threads (0 = number of hardware threads).");
 
 	try
 	{
@@ -95,11 +97,11 @@ int main(int argc, char* argv[])
 
 	std::cout << "INFO: Parsing contingency matrix ..." << std::endl;
 	ContingencyMatrixParser<uint64_t> parser(input_file);
-	auto ctables = parser.getContingencyTables();
+	const auto& ctables = parser.getContingencyTables();
 
 	std::cout << "INFO: Setting up ORA ..." << std::endl;
-	ContingencyORA<uint64_t, long double> ora (ctables);
-	auto results = ora.run(true);
+	ContingencyORA<uint64_t> ora (ctables);
+	auto results = ora.run(true, num_threads);
 
 	std::cout << "INFO: Adjusting p-values ..." << std::endl;
 	results = pvalue::adjustPValues(results, get_pvalue(), pvalue::getCorrectionMethod(adjustment_method_).get());
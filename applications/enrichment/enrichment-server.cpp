@@ -0,0 +1,456 @@
+#include <genetrail2/core/Exception.h>
+#include <genetrail2/core/Parallel.h>
+
+#include <genetrail2/enrichment/EnrichmentService.h>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/program_options.hpp>
+
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace GeneTrail;
+namespace bpo = boost::program_options;
+
+std::string socket_path, preload;
+size_t num_threads = 0, max_request_size = 0;
+
+bool parseArguments(int argc, char* argv[])
+{
+	bpo::variables_map vm;
+	bpo::options_description desc;
+
+	desc.add_options()
+		("help,h", "Display this message")
+		("socket,s", bpo::value(&socket_path)->required(), "Path of the Unix domain socket the server listens on.")
+		("categories,c", bpo::value(&preload)->required(), "A list of category files (name and path per line). Requests can only use these databases.")
+		("threads,t", bpo::value(&num_threads)->default_value(0), "Number of requests processed concurrently. 0 uses all cores.")
+		("max-request-size,m", bpo::value(&max_request_size)->default_value(64 << 20), "Maximum length of a request in bytes. The connection of a client sending a longer request is closed.");
+
+	try {
+		bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(), vm);
+		bpo::notify(vm);
+	} catch(bpo::error& e) {
+		std::cerr << "ERROR: " << e.what() << "\n";
+		desc.print(std::cerr);
+		return false;
+	}
+
+	return true;
+}
+
+void preloadCategories(EnrichmentService& service, const std::string& list)
+{
+	std::ifstream input(list);
+	if(!input) {
+		throw IOError("File (" + list + ") is not open for reading");
+	}
+
+	std::vector<std::string> sline;
+	for(std::string line; getline(input, line);) {
+		boost::trim(line);
+		if(line.empty()) {
+			continue;
+		}
+		boost::split(sline, line, boost::is_any_of(" \t"), boost::token_compress_on);
+		if(sline.size() != 2) {
+			throw IOError("Wrong file format.");
+		}
+		service.preload(sline[0], sline[1]);
+	}
+}
+
+/**
+ * Sends all data. With MSG_DONTWAIT in flags this fails instead of blocking
+ * if the client does not read.
+ */
+bool writeAll(int fd, const std::string& data, int flags = 0)
+{
+	size_t written = 0;
+	while(written < data.size()) {
+		ssize_t n = ::send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL | flags);
+		if(n < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		written += n;
+	}
+	return true;
+}
+
+/**
+ * Whether a failed accept() only affects the pending connection or is due
+ * to temporarily exhausted resources. The server keeps running in this case.
+ */
+bool isTransientAcceptError(int error)
+{
+	switch(error) {
+		case EINTR:
+		case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+		case EWOULDBLOCK:
+#endif
+		case ECONNABORTED:
+		case EPROTO:
+		case EPERM:
+		case EMFILE:
+		case ENFILE:
+		case ENOBUFS:
+		case ENOMEM:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/**
+ * A client connection. At most one request of a connection is processed at
+ * a time. This keeps the responses in order and bounds the memory used per
+ * connection, as no data is read while requests are pending.
+ */
+struct Connection
+{
+	explicit Connection(int fd) : fd(fd) {}
+
+	int fd;
+	// Received data that does not form a complete request yet
+	std::string buffer;
+	// Complete requests that were not yet handed to a worker
+	std::deque<std::string> requests;
+	// A worker processes a request of this connection
+	bool busy = false;
+	// The client sent a request longer than max_request_size
+	bool overflow = false;
+	// No more data can be received
+	bool closed = false;
+};
+
+struct Task
+{
+	Connection* connection;
+	std::string request;
+};
+
+/**
+ * Splits the received data into requests. Returns false if a request
+ * exceeds max_request_size.
+ */
+bool splitRequests(Connection& c)
+{
+	size_t begin = 0;
+	for(size_t end = c.buffer.find('\n'); end != std::string::npos;
+	    end = c.buffer.find('\n', begin)) {
+		if(end - begin > max_request_size) {
+			return false;
+		}
+		std::string request = c.buffer.substr(begin, end - begin);
+		begin = end + 1;
+		if(request.find_first_not_of(" \t\r") != std::string::npos) {
+			c.requests.emplace_back(std::move(request));
+		}
+	}
+	c.buffer.erase(0, begin);
+
+	return c.buffer.size() <= max_request_size;
+}
+
+/**
+ * Reads the available data of a connection.
+ */
+void receive(Connection& c)
+{
+	char chunk[1 << 16];
+	ssize_t n = ::recv(c.fd, chunk, sizeof(chunk), 0);
+	if(n < 0 && (errno == EINTR || errno == EAGAIN)) {
+		return;
+	}
+	if(n <= 0) {
+		c.closed = true;
+		return;
+	}
+
+	c.buffer.append(chunk, n);
+	if(!splitRequests(c)) {
+		c.buffer.clear();
+		c.overflow = true;
+		c.closed = true;
+	}
+}
+
+/**
+ * A fixed pool of workers that process one request at a time. Finished
+ * connections are reported back to the event loop via a pipe.
+ */
+class Workers
+{
+  public:
+	Workers(EnrichmentService& service, size_t num_threads, int wake_fd)
+	    : service_(service), wake_fd_(wake_fd)
+	{
+		for(size_t i = 0; i < num_threads; ++i) {
+			std::thread([this]() { run_(); }).detach();
+		}
+	}
+
+	void push(Connection* connection, std::string request)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			tasks_.push(Task{connection, std::move(request)});
+		}
+		available_.notify_one();
+	}
+
+	/**
+	 * The connections whose request was answered since the last call,
+	 * together with whether the response could be sent.
+	 */
+	std::vector<std::pair<Connection*, bool>> finished()
+	{
+		std::vector<std::pair<Connection*, bool>> result;
+		std::lock_guard<std::mutex> lock(mutex_);
+		result.swap(finished_);
+		return result;
+	}
+
+  private:
+	void run_()
+	{
+		for(;;) {
+			Task task;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				available_.wait(lock, [this] { return !tasks_.empty(); });
+				task = std::move(tasks_.front());
+				tasks_.pop();
+			}
+
+			const bool sent = writeAll(task.connection->fd,
+			                           service_.handle(task.request) + '\n');
+
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				finished_.emplace_back(task.connection, sent);
+			}
+
+			const char wake = 0;
+			while(::write(wake_fd_, &wake, 1) < 0 && errno == EINTR) {
+			}
+		}
+	}
+
+	EnrichmentService& service_;
+	int wake_fd_;
+
+	std::mutex mutex_;
+	std::condition_variable available_;
+	std::queue<Task> tasks_;
+	std::vector<std::pair<Connection*, bool>> finished_;
+};
+
+/**
+ * Hands the next request of an idle connection to the workers. Returns
+ * false if the connection is done and can be closed.
+ */
+bool advance(Connection& c, Workers& workers)
+{
+	if(c.busy) {
+		return true;
+	}
+
+	if(!c.requests.empty()) {
+		c.busy = true;
+		workers.push(&c, std::move(c.requests.front()));
+		c.requests.pop_front();
+		return true;
+	}
+
+	// This runs in the event loop, which must not wait for a client that
+	// does not read. The connection is closed afterwards in any case.
+	if(c.overflow) {
+		writeAll(c.fd, "{\"status\":\"error\",\"message\":\"The request exceeds "
+		               "the maximum length of " +
+		                   std::to_string(max_request_size) + " bytes.\"}\n",
+		         MSG_DONTWAIT);
+	}
+
+	return !c.closed;
+}
+
+int main(int argc, char* argv[])
+{
+	if(!parseArguments(argc, argv)) {
+		return -1;
+	}
+
+	EnrichmentService service;
+
+	try {
+		preloadCategories(service, preload);
+	} catch(const std::exception& e) {
+		std::cerr << "ERROR: Failed to load categories. Reason: " << e.what() << std::endl;
+		return -1;
+	}
+
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if(socket_path.size() >= sizeof(address.sun_path)) {
+		std::cerr << "ERROR: The socket path is too long." << std::endl;
+		return -1;
+	}
+	std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+	int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	::unlink(socket_path.c_str());
+
+	// Only the owner may connect. The socket file is created with mode 0600
+	// right away, so there is no window in which others can connect.
+	const mode_t mask = ::umask(0177);
+	const bool bound = server >= 0 &&
+	    ::bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+	::umask(mask);
+
+	if(!bound || ::listen(server, SOMAXCONN) < 0) {
+		std::cerr << "ERROR: Could not listen on " << socket_path << ": "
+		          << std::strerror(errno) << std::endl;
+		return -1;
+	}
+
+	// accept() must not block if a pending client disconnects before it is
+	// accepted
+	if(::fcntl(server, F_SETFL, O_NONBLOCK) < 0) {
+		std::cerr << "ERROR: Could not configure the socket: " << std::strerror(errno) << std::endl;
+		return -1;
+	}
+
+	int wake[2];
+	if(::pipe(wake) < 0 || ::fcntl(wake[0], F_SETFL, O_NONBLOCK) < 0) {
+		std::cerr << "ERROR: Could not create a pipe: " << std::strerror(errno) << std::endl;
+		return -1;
+	}
+
+	std::cerr << "INFO: Listening on " << socket_path << " ("
+	          << service.numberOfDatabases() << " category databases loaded)"
+	          << std::endl;
+
+	if(num_threads == 0) {
+		num_threads = defaultNumberOfThreads();
+	}
+
+	// Idle connections do not occupy a worker. The event loop reads the
+	// requests of all connections and only complete requests are handed
+	// to the workers.
+	Workers workers(service, num_threads, wake[1]);
+	std::map<int, std::unique_ptr<Connection>> connections;
+
+	auto drop = [&connections](Connection& c) {
+		::close(c.fd);
+		connections.erase(c.fd);
+	};
+
+	std::vector<pollfd> fds;
+	for(;;) {
+		fds.clear();
+		fds.push_back(pollfd{wake[0], POLLIN, 0});
+		fds.push_back(pollfd{server, POLLIN, 0});
+		for(const auto& c : connections) {
+			if(!c.second->busy && c.second->requests.empty() && !c.second->closed) {
+				fds.push_back(pollfd{c.first, POLLIN, 0});
+			}
+		}
+
+		if(::poll(fds.data(), fds.size(), -1) < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			std::cerr << "ERROR: poll failed: " << std::strerror(errno) << std::endl;
+			break;
+		}
+
+		if(fds[0].revents != 0) {
+			char drain[256];
+			while(::read(wake[0], drain, sizeof(drain)) > 0) {
+			}
+
+			for(const auto& f : workers.finished()) {
+				Connection& c = *f.first;
+				c.busy = false;
+				c.closed = c.closed || !f.second;
+				if(!f.second) {
+					c.requests.clear();
+				}
+				if(!advance(c, workers)) {
+					drop(c);
+				}
+			}
+		}
+
+		for(size_t i = 2; i < fds.size(); ++i) {
+			if(fds[i].revents == 0) {
+				continue;
+			}
+
+			Connection& c = *connections.at(fds[i].fd);
+			receive(c);
+			if(!advance(c, workers)) {
+				drop(c);
+			}
+		}
+
+		if(fds[1].revents != 0) {
+			int fd = ::accept(server, nullptr, nullptr);
+			if(fd < 0) {
+				const int error = errno;
+				if(!isTransientAcceptError(error)) {
+					std::cerr << "ERROR: accept failed: " << std::strerror(error) << std::endl;
+					break;
+				}
+
+				// The pending connection stays in the queue if we run out of
+				// file descriptors or memory. Back off until requests finish
+				// and free resources instead of polling it in a busy loop.
+				if(error == EMFILE || error == ENFILE || error == ENOBUFS ||
+				   error == ENOMEM) {
+					std::cerr << "WARNING: accept failed: " << std::strerror(error) << std::endl;
+					std::this_thread::sleep_for(std::chrono::milliseconds(100));
+				}
+				continue;
+			}
+
+			// A client that does not read its responses must not block a
+			// worker forever
+			const timeval timeout{60, 0};
+			::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+			connections.emplace(fd, std::make_unique<Connection>(fd));
+		}
+	}
+
+	::close(server);
+	::unlink(socket_path.c_str());
+
+	return -1;
+}
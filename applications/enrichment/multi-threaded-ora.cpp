@@ -1,7 +1,7 @@
+#include <genetrail2/core/BinaryCategoryDatabase.h>
 #include <genetrail2/core/DenseMatrix.h>
 #include <genetrail2/core/DenseMatrixReader.h>
 #include <genetrail2/core/EntityDatabase.h>
-#include <genetrail2/core/GMTFile.h>
 #include <genetrail2/core/Exception.h>
 #include <genetrail2/core/GeneSet.h>
 #include <genetrail2/core/GeneSetReader.h>
@@ -77,7 +77,8 @@ void prepareScores(Scores& scores) {
 	scores.sortByScore(increasing ? Order::Increasing : Order::Decreasing);
 }
 
-void thread_job(const DenseMatrix& p_values, const CategoryDBList& cat_list,
+void thread_job(const OraPValueCache& p_values, const CategoryDBList& cat_list,
+				const IndexedCategoryDBList& indexed_cat_list,
 				const Category& reference_set, std::shared_ptr<EntityDatabase> db,
 				Params p, NullHypothesis& hypothesis_)
 {
@@ -119,17 +120,9 @@ void thread_job(const DenseMatrix& p_values, const CategoryDBList& cat_list,
 		try{
 			Scores scores(test_set, db);
 			if(method == "ora"){
-				auto enrichmentAlgorithm = createEnrichmentAlgorithm<Ora>(
-					p.pValueMode, reference_set, test_set.toCategory(db, "test"),
-					hypothesis_
-				);
-				run(scores, cat_list, enrichmentAlgorithm, p, true);
+				runOra(test_set.toCategory(db, "test"), indexed_cat_list, hypothesis_, p);
 			} else if(method == "parallel_ora"){
-				auto enrichmentAlgorithm = createEnrichmentAlgorithm<PreprocessedORA>(
-					p.pValueMode, reference_set, test_set.toCategory(db, "test"),
-					hypothesis_, p_values, p.justScores, p.justPvalues
-				);
-				run(scores, cat_list, enrichmentAlgorithm, p, true);
+				runOra(test_set.toCategory(db, "test"), indexed_cat_list, hypothesis_, p, &p_values);
 			} else if(method == "percentage"){
 				auto enrichmentAlgorithm = createEnrichmentAlgorithm<IntersectionPercentage>(
 					p.pValueMode, reference_set, test_set.toCategory(db, "test"),
@@ -207,7 +200,9 @@ int main(int argc, char* argv[]){
 	auto db = std::make_shared<EntityDatabase>();
 	NullHypothesis hypothesis_ = getHypothesis(hypothesis);
 	
-	DenseMatrix p_values(1,1);
+	// Shared by all threads, p-values for the same (reference hits,
+	// test hits) pair are only computed once.
+	std::unique_ptr<OraPValueCache> p_values(new OraPValueCache());
 	if(preComputedPValues != ""){
 		DenseMatrixReader dm_reader;
 		std::ifstream file(preComputedPValues);
@@ -217,32 +212,39 @@ int main(int argc, char* argv[]){
 		}
 		//This is needed since our matrix does not contain any row/col names
 		unsigned int opts = DenseMatrixReader::NO_OPTIONS;
-		p_values = dm_reader.read(file, opts);
+		p_values.reset(new OraPValueCache(dm_reader.read(file, opts)));
 		file.close();
 	}
 	
 	Category ref = reference_set.toCategory(db, "reference");
 	
+	// For ORAs the categories are indexed once and shared by all threads,
+	// as every test set uses the same reference set. Binary databases are
+	// indexed directly from the mapped file.
+	const bool indexed = method == "ora" || method == "parallel_ora";
 	CategoryDBList category_dbs;
+	IndexedCategoryDBList indexed_dbs;
 	for(const auto& cat: cat_list){
 		try {
-			GMTFile gmt(db, cat.second);
-			if(!gmt) {
-				std::cerr << "WARNING: Could not open database " + cat.first +
-									" for reading! Skipping database."
-							<< std::endl;
+			if(indexed && BinaryCategoryDatabase::isBinaryCategoryDatabase(cat.second)) {
+				indexed_dbs.emplace_back(
+					cat.first, std::make_shared<const BinaryCategoryDatabase>(cat.second),
+					db, ref);
 				continue;
 			}
-
-			CategoryDatabase b = gmt.read();
+			CategoryDatabase b = readCategoryDatabase(db, cat.second);
 			b.setName(cat.first);
-			category_dbs.push_back(b);
+			if(indexed) {
+				indexed_dbs.emplace_back(cat.first, std::move(b), ref);
+			} else {
+				category_dbs.push_back(b);
+			}
 		} catch(IOError& exn) {
 			std::cerr << "WARNING: Could not process category file "
 				<< cat.first << "! " << std::endl;
 		}
 	}
-	
+
 	std::ifstream input_strm(input);
 	if(!input_strm){
 		std::cerr << "Could not open " << input << " for reading." << std::endl;
@@ -253,7 +255,8 @@ int main(int argc, char* argv[]){
 	for(int i=0; i < threads; i++){
 		thread_jobs.emplace_back(
 			threadNamespace2::thread_job,
-			boost::cref(p_values), boost::cref(category_dbs),
+			boost::cref(*p_values), boost::cref(category_dbs),
+			boost::cref(indexed_dbs),
 			boost::cref(ref), db, p, boost::ref(hypothesis_)
 		);
 	}
@@ -101,7 +101,7 @@ int main(int argc, char* argv[])
 		}
 		//This is needed since our matrix does not contain any row/col names
 		unsigned int opts = DenseMatrixReader::NO_OPTIONS;
-		DenseMatrix p_values = reader.read(file, opts);
+		OraPValueCache p_values(reader.read(file, opts));
 		file.close();
 		//auto finish = std::chrono::high_resolution_clock::now();
 		//std::chrono::duration<double> elapsed = finish - start;
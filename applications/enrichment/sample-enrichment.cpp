@@ -0,0 +1,168 @@
+#include <genetrail2/core/BinaryCategoryDatabase.h>
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/DenseMatrixReader.h>
+#include <genetrail2/core/DenseMatrixWriter.h>
+#include <genetrail2/core/EntityDatabase.h>
+#include <genetrail2/core/Exception.h>
+
+#include <genetrail2/enrichment/common.h>
+#include <genetrail2/enrichment/CommandLineInterface.h>
+#include <genetrail2/enrichment/EnrichmentAlgorithm.h>
+#include <genetrail2/enrichment/Parameters.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace GeneTrail;
+namespace bpo = boost::program_options;
+
+std::string matrix, method;
+bool increasing = false, absolute = false;
+size_t threads = 0;
+
+bool parseArguments(int argc, char* argv[], Params& p)
+{
+	bpo::variables_map vm;
+	bpo::options_description desc;
+
+	addCommonCLIArgs(desc, p);
+	desc.add_options()
+		("matrix", bpo::value<std::string>(&matrix)->required(), "A gene x sample matrix of scores. Every column is tested separately.")
+		("method", bpo::value<std::string>(&method)->default_value("gsea"), "Method for gene set testing: gsea, weighted-gsea, wilcoxon, mean, median, sum or max-mean.")
+		("increasing", bpo::value(&increasing)->zero_tokens(), "Use increasingly sorted scores. (Decreasing is default)")
+		("absolute", bpo::value(&absolute)->zero_tokens(), "Use decreasingly sorted absolute scores.")
+		("threads", bpo::value<size_t>(&threads)->default_value(0), "Number of samples processed in parallel (0 = number of hardware threads).");
+
+	try {
+		bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(),
+		           vm);
+		bpo::notify(vm);
+	} catch(bpo::error& e) {
+		std::cerr << "ERROR: " << e.what() << "\n";
+		desc.print(std::cerr);
+		return false;
+	}
+
+	if(absolute && increasing) {
+		std::cerr << "ERROR: Please specify only one option to sort the scores." << std::endl;
+		return false;
+	}
+
+	return checkCLIArgs(p);
+}
+
+EnrichmentAlgorithmPtr getAlgorithm(Scores& scores, PValueMode mode)
+{
+	const Order order = increasing ? Order::Increasing : Order::Decreasing;
+
+	if(method == "gsea" || method == "weighted-gsea" || method == "wilcoxon") {
+		if(absolute) {
+			std::transform(scores.scores().begin(), scores.scores().end(),
+			               scores.scores().begin(),
+			               static_cast<double (*)(double)>(std::abs));
+		}
+		scores.sortByScore(order);
+	}
+
+	if(method == "gsea") {
+		return createEnrichmentAlgorithm<KolmogorovSmirnov>(
+		    mode, scores.indices().begin(), scores.indices().end(), order);
+	} else if(method == "weighted-gsea") {
+		return createEnrichmentAlgorithm<WeightedKolmogorovSmirnov>(
+		    mode, scores, order, true);
+	} else if(method == "wilcoxon") {
+		return createEnrichmentAlgorithm<WilcoxonRSTest>(
+		    mode, scores.indices().begin(), scores.indices().end(), order);
+	} else if(method == "mean") {
+		return createEnrichmentAlgorithm<MeanEnrichment>(mode, scores);
+	} else if(method == "median") {
+		return createEnrichmentAlgorithm<MedianEnrichment>(mode, scores);
+	} else if(method == "sum") {
+		return createEnrichmentAlgorithm<SumEnrichment>(mode, scores);
+	} else if(method == "max-mean") {
+		return createEnrichmentAlgorithm<MaxMeanEnrichment>(mode, scores);
+	}
+
+	throw std::invalid_argument("Unknown method: " + method);
+}
+
+bool writeMatrix(const DenseMatrix& m, const std::string& path)
+{
+	std::ofstream out(path);
+	if(!out) {
+		std::cerr << "ERROR: Could not open " << path << " for writing." << std::endl;
+		return false;
+	}
+
+	DenseMatrixWriter writer;
+	writer.writeText(out, m);
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	Params p;
+	if(!parseArguments(argc, argv, p)) {
+		return -1;
+	}
+	p.verbose = false;
+
+	if(method != "gsea" && method != "weighted-gsea" && method != "wilcoxon" &&
+	   method != "mean" && method != "median" && method != "sum" &&
+	   method != "max-mean") {
+		std::cerr << "ERROR: Unknown method: " << method << std::endl;
+		return -1;
+	}
+
+	CategoryList cat_list;
+	if(initCategories(cat_list, p) != 0) {
+		return -1;
+	}
+
+	std::ifstream file(matrix);
+	if(!file) {
+		std::cerr << "ERROR: Could not open " << matrix << " for reading." << std::endl;
+		return -1;
+	}
+
+	DenseMatrixReader reader;
+	DenseMatrix samples = reader.read(file);
+	file.close();
+
+	auto db = std::make_shared<EntityDatabase>();
+
+	// All databases are read once and shared by all samples
+	CategoryDBPtrList databases;
+	for(const auto& cat : cat_list) {
+		try {
+			auto database = std::make_shared<CategoryDatabase>(
+			    readCategoryDatabase(db, cat.second));
+			database->setName(cat.first);
+			databases.emplace_back(cat.first, std::move(database));
+		} catch(IOError& exn) {
+			std::cerr << "WARNING: Could not process category file "
+			          << cat.first << "! " << exn.what() << std::endl;
+		}
+	}
+
+	const auto results = computeSampleEnrichments(
+	    samples, databases, db,
+	    [&p](Scores& scores) { return getAlgorithm(scores, p.pValueMode); },
+	    p, threads);
+
+	for(const auto& result : results) {
+		const std::string prefix = p.out() + "/" + result.first;
+		if(!writeMatrix(result.second.scores, prefix + ".scores.txt") ||
+		   !writeMatrix(result.second.pvalues, prefix + ".pvalues.txt")) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
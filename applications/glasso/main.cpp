@@ -2,16 +2,202 @@
 
 #include <genetrail2/core/DenseMatrix.h>
 #include <genetrail2/core/DenseMatrixReader.h>
-#include <genetrail2/core/DenseMatrixWriter.h>
+#include <genetrail2/core/Parallel.h>
+#include <genetrail2/core/SparseMatrix.h>
+#include <genetrail2/core/SparseMatrixWriter.h>
 
+#include <Eigen/Core>
+
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <fstream>
+#include <mutex>
+#include <numeric>
+#include <vector>
 
 #include <boost/program_options.hpp>
 
 using namespace GeneTrail;
 namespace bpo = boost::program_options;
 
+typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> Data;
+typedef Eigen::Triplet<SparseMatrix::value_type> Triplet;
+
+// The number of covariance matrix rows that are computed at once
+// during screening.
+static const size_t BLOCK_SIZE = 256;
+
+class UnionFind
+{
+	public:
+		explicit UnionFind(size_t n) : parent_(n) { reset(); }
+
+		void reset() { std::iota(parent_.begin(), parent_.end(), 0u); }
+
+		unsigned int find(unsigned int i)
+		{
+			while(parent_[i] != i) {
+				parent_[i] = parent_[parent_[i]];
+				i = parent_[i];
+			}
+
+			return i;
+		}
+
+		void unite(unsigned int i, unsigned int j)
+		{
+			i = find(i);
+			j = find(j);
+
+			if(i < j) {
+				parent_[j] = i;
+			} else if(j < i) {
+				parent_[i] = j;
+			}
+		}
+
+	private:
+		std::vector<unsigned int> parent_;
+};
+
+/**
+ * Centers the variables (rows) and scales them by 1/sqrt(n - 1), so that
+ * the covariance of two variables is the dot product of the respective rows.
+ */
+static Data prepareData(const DenseMatrix& mat)
+{
+	Data data = mat.matrix().cast<float>();
+
+	const float scale = 1.0f / std::sqrt(static_cast<float>(std::max(1u, mat.cols() - 1)));
+
+	for(Data::Index i = 0; i < data.rows(); ++i) {
+		data.row(i).array() -= data.row(i).mean();
+		data.row(i) *= scale;
+	}
+
+	return data;
+}
+
+/**
+ * Exact block-diagonal screening: two variables end up in the same
+ * component iff they are connected by a path of covariances exceeding
+ * rho in absolute value. The covariance matrix is computed block-wise
+ * and never stored as a whole. Blocks are processed by num_threads
+ * threads (0 uses all cores).
+ */
+static std::vector<std::vector<unsigned int>> screen(const Data& data, float rho,
+                                                     unsigned int num_threads)
+{
+	const size_t n = data.rows();
+	const size_t num_blocks = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+	UnionFind components(n);
+	std::mutex mutex;
+
+	parallel_for(0, num_blocks, [&](size_t b) {
+		const size_t begin = b * BLOCK_SIZE;
+		const size_t size = std::min(BLOCK_SIZE, n - begin);
+
+		// We only need the upper triangle of the covariance matrix
+		Eigen::MatrixXf cov = data.middleRows(begin, size) * data.bottomRows(n - begin).transpose();
+
+		// Merge the block locally first to keep the critical section short.
+		UnionFind local(n);
+		bool has_edges = false;
+		for(size_t j = 0; j < (size_t)cov.cols(); ++j) {
+			for(size_t i = 0; i < size; ++i) {
+				if(i < j && std::fabs(cov(i, j)) > rho) {
+					local.unite(begin + i, begin + j);
+					has_edges = true;
+				}
+			}
+		}
+
+		if(!has_edges) {
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		for(unsigned int i = begin; i < n; ++i) {
+			components.unite(i, local.find(i));
+		}
+	}, num_threads);
+
+	std::vector<std::vector<unsigned int>> result(n);
+	for(unsigned int i = 0; i < n; ++i) {
+		result[components.find(i)].push_back(i);
+	}
+
+	result.erase(std::remove_if(result.begin(), result.end(),
+	                            [](const std::vector<unsigned int>& c) { return c.empty(); }),
+	             result.end());
+
+	// Process the large components first for a better load balancing.
+	std::sort(result.begin(), result.end(),
+	          [](const std::vector<unsigned int>& a, const std::vector<unsigned int>& b) {
+		          return a.size() > b.size();
+	          });
+
+	return result;
+}
+
+/**
+ * Runs glasso on a single connected component and appends the non-zero
+ * entries of the precision matrix to result.
+ */
+static bool solveComponent(const Data& data, const std::vector<unsigned int>& component, float rho,
+                           float thr, int maxit, std::vector<Triplet>& result)
+{
+	int nn = component.size();
+
+	Data sub(nn, data.cols());
+	for(int i = 0; i < nn; ++i) {
+		sub.row(i) = data.row(component[i]);
+	}
+
+	Eigen::MatrixXf cov = sub * sub.transpose();
+
+	if(nn == 1) {
+		// With a penalized diagonal the solution is (s_ii + rho)^-1
+		result.emplace_back(component[0], component[0], 1.0 / (cov(0, 0) + rho));
+		return true;
+	}
+
+	// The Fortran code expects an element-wise penalty and has no scalar
+	// path. We only need it for the component at hand, but a single giant
+	// component still requires the full n x n penalty.
+	Eigen::MatrixXf rho_mem = Eigen::MatrixXf::Constant(nn, nn, rho);
+	Eigen::MatrixXf www(nn, nn);
+	Eigen::MatrixXf wwwi(nn, nn);
+
+	int ia = 0;
+	int is = 0;
+	int itr = 0;
+	int ipen = 1;
+
+	int nniter;
+	float ddel;
+	int jerr;
+
+	glasso_(&nn, cov.data(), rho_mem.data(), &ia, &is, &itr, &ipen, &thr, &maxit,
+	        www.data(), wwwi.data(), &nniter, &ddel, &jerr);
+
+	if(jerr != 0) {
+		return false;
+	}
+
+	for(int j = 0; j < nn; ++j) {
+		for(int i = 0; i < nn; ++i) {
+			if(wwwi(i, j) != 0.0f) {
+				result.emplace_back(component[i], component[j], wwwi(i, j));
+			}
+		}
+	}
+
+	return true;
+}
+
 int main(int argc, char* argv[])
 {
 	bpo::variables_map vm;
@@ -20,6 +206,7 @@ int main(int argc, char* argv[])
 	std::string infile, outfile;
 	float rho, thr;
 	int maxit;
+	unsigned int threads;
 	bool transpose, text_out;
 
 	desc.add_options()
@@ -29,6 +216,7 @@ int main(int argc, char* argv[])
 		("rho,r",   bpo::value<float>(&rho)->required(), "The regularization parameter")
 		("thr,t",   bpo::value<float>(&thr)->default_value(1.0e-6), "Convergence threshold")
 		("maxit,m", bpo::value<int>(&maxit)->default_value(10000), "Maximum number of iterations")
+		("threads,j", bpo::value<unsigned int>(&threads)->default_value(0), "Number of threads used for screening and for solving components. 0 uses all cores.")
 		("transpose,t", bpo::bool_switch(&transpose)->default_value(false), "Should the input matrix be transposed.")
 		("text,a", bpo::bool_switch(&text_out)->default_value(false), "Write the output as a text file.");
 
@@ -64,61 +252,67 @@ int main(int argc, char* argv[])
 
 	std::cout << "Reading data ..." << std::endl;
 
-	//TODO: See if we can make this casting business less wasteful
-	DenseMatrix mat = reader.read(input, opt);
+	std::vector<std::string> names;
+	Data data;
+	{
+		DenseMatrix mat = reader.read(input, opt);
+		names = mat.rowNames();
+		// Only the single precision copy is kept from here on.
+		data = prepareData(mat);
+	}
 
-	auto mu = mat.matrix().rowwise().mean();
-	mat.matrix().colwise() -= mu;
+	if(data.rows() == 0) {
+		std::cerr << "The input matrix is empty." << std::endl;
+		return -1;
+	}
 
-	std::cout << "Computing covariance matrix ..." << std::endl;
-	// Compute the covariance matrix
-	Eigen::MatrixXf cov = (mat.matrix() * mat.matrix().transpose() / (mat.cols() - 1)).cast<float>();
+	std::cout << "Screening covariance matrix ..." << std::endl;
 
-	// The glasso driver part. Mainly the creation of lots and lots of variables
-	// in order to interface with Fortran...
-	Eigen::MatrixXf www(mat.rows(), mat.rows());
-	Eigen::MatrixXf wwwi(mat.rows(), mat.rows());
+	auto components = screen(data, rho, threads);
 
-	// Wow! This is really a waste!
-	// This code requires four times the memory of the input matrix...
-	std::vector<float> rho_mem(mat.rows() * mat.rows(), 0.001);
+	std::cout << "Approximating precision matrix (" << components.size()
+	          << " components, largest has " << components.front().size()
+	          << " variables) ..." << std::endl;
 
-	int nn = cov.rows();
+	std::vector<std::vector<Triplet>> entries(components.size());
+	std::atomic<bool> failed(false);
 
-	int ia = 0;
-	int is = 0;
-	int itr = 0;
-	int ipen = 1;
+	parallel_for(0, components.size(), [&](size_t c) {
+		if(!solveComponent(data, components[c], rho, thr, maxit, entries[c])) {
+			failed = true;
+		}
+	}, threads);
 
-	int nniter;
-	float ddel;
-	int jerr;
+	if(failed) {
+		std::cerr << "Glasso failed to allocate memory." << std::endl;
+		return -1;
+	}
 
-	std::cout << "Approximating precision matrix ..." << std::endl;
+	data.resize(0, 0);
 
-	glasso_(&nn, cov.data(), &rho_mem[0], &ia, &is, &itr, &ipen, &thr, &maxit,
-	        www.data(), wwwi.data(), &nniter, &ddel, &jerr);
+	SparseMatrix result(names, names);
+	{
+		std::vector<Triplet> triplets;
+		for(auto& e : entries) {
+			triplets.insert(triplets.end(), e.begin(), e.end());
+			std::vector<Triplet>().swap(e);
+		}
+
+		result.matrix().setFromTriplets(triplets.begin(), triplets.end());
+		result.matrix().makeCompressed();
+	}
 
 	std::ofstream out(outfile);
 	if(!out) {
-		std::cerr << "Could not open " << outfile << " for reading." << std::endl;
+		std::cerr << "Could not open " << outfile << " for writing." << std::endl;
 		return -1;
 	}
 
-	// We no longer need this stuff...
-	cov.resize(0,0);
-	www.resize(0,0);
-
-	//TODO: Think about specializations for the matrix writer...
-	//      OR make glasso double precision...
-	DenseMatrix tmp(mat.rowNames(), mat.rowNames());
-	tmp.matrix() = wwwi.cast<double>();
-
-	DenseMatrixWriter writer;
+	SparseMatrixWriter writer;
 	if(text_out) {
-		writer.writeText(out, tmp);
+		writer.writeText(out, result);
 	} else {
-		writer.writeBinary(out, tmp);
+		writer.writeBinary(out, result);
 	}
 
 	return 0;
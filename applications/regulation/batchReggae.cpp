@@ -0,0 +1,236 @@
+#include <boost/program_options.hpp>
+
+#include <genetrail2/core/Exception.h>
+#include <genetrail2/core/GeneSet.h>
+#include <genetrail2/core/GeneSetReader.h>
+#include <genetrail2/core/DenseMatrixReader.h>
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/NameDatabases.h>
+#include <genetrail2/core/Parallel.h>
+
+#include <genetrail2/regulation/RegulatorGeneAssociationEnrichmentAnalysis.h>
+#include <genetrail2/regulation/RegulatorGeneAssociationEnrichmentAlgorithms.h>
+#include <genetrail2/regulation/RegulationFileParser.h>
+#include <genetrail2/regulation/RegulationBootstrapper.h>
+#include <genetrail2/regulation/RegulatorAssociationScore.h>
+
+#include <atomic>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+#include "common.h"
+#include "../matrixTools.h"
+
+using namespace GeneTrail;
+
+namespace bpo = boost::program_options;
+
+/**
+ * Runs REGGAE for many test sets that share the expression matrix and the
+ * regulatory network. The matrix and the network are only parsed once and
+ * the test sets are processed concurrently.
+ */
+
+std::string contrasts_, matrix_, regulations_, method_, adjustment_method_, impact_score_, confidence_interval_;
+bool normalize_scores_, useAbsoluteValues_, decreasingly_, json_, fill_blanks_, sort_correlations_decreasingly_;
+size_t seed_, bootstrapping_runs_, max_regulators_per_target_ = 0, threads_;
+double alpha_;
+
+MatrixReaderOptions matrixOptions;
+
+struct Contrast
+{
+	std::string scores;
+	std::string output;
+};
+
+bool parseArguments(int argc, char* argv[])
+{
+	bpo::variables_map vm;
+	bpo::options_description desc;
+
+	desc.add_options()("help,h", "Display this message")
+					  ("contrasts,s", bpo::value(&contrasts_)->required(), "A whitespace separated file. Each line contains a score file (test set) and the output file for its results.")
+					  ("matrix,x", bpo::value(&matrix_)->required(), "A whitespace separated file containing expression values for all genes.")
+					  ("no-row-names,w", bpo::value<bool>(&matrixOptions.no_rownames)->default_value(false)->zero_tokens(), "Does the matrix file contain row names?")
+					  ("no-col-names,c", bpo::value<bool>(&matrixOptions.no_colnames)->default_value(false)->zero_tokens(), "Does the matrix file contain column names?")
+					  ("add-col-name,n", bpo::value<bool>(&matrixOptions.additional_colname)->default_value(false)->zero_tokens(), "Does the matrix file contain two rows for column names?")
+					  ("decreasingly,d", bpo::value(&decreasingly_)->default_value(false)->zero_tokens(), "Should the testsets be sorted decreasingly? (default: increasingly)")
+					  ("regulations,r", bpo::value(&regulations_)->required(), "A whitespace separated file containing regulator and target. (RTI database)")
+					  ("abs,a", bpo::value(&useAbsoluteValues_)->default_value(false)->zero_tokens(), "Should absolute values be used for association scores?")
+					  ("sort-rtis-decreasingly,e", bpo::value(&sort_correlations_decreasingly_)->default_value(false)->zero_tokens(), "Should the association scores for each target be sorted decreasingly? (default: increasingly)")
+					  ("method,m", bpo::value(&method_)->required(), "The method that should be applied (ks-test, wrs-test).")
+					  ("seed", bpo::value(&seed_)->required(), "Random seed used for bootstrapping.")
+					  ("bootstrap,b", bpo::value(&bootstrapping_runs_)->default_value(0), "Number of bootstrapping runs.")
+					  ("alpha,l", bpo::value(&alpha_)->default_value(0.1), "Alpha level of confidence interval.")
+					  ("confidence-intervals,v", bpo::value(&confidence_interval_)->default_value("percentile"), "Method that should be used to compute confidence intervals. (percentile, bca)")
+					  ("adjust,u", bpo::value(&adjustment_method_)->default_value("benjamini-yekutieli"), "Method for multiple testing correction. (default: benjamini-yekutieli)")
+					  ("json,j", bpo::value(&json_)->default_value(false)->zero_tokens(), "Output file in .json format (default: .tsv).")
+					  ("impact,p", bpo::value(&impact_score_)->default_value("pearson_correlation"), "Method that should be used to compute the impact of regulators. (pearson-correlation, spearman-correlation, kendall-correlation)")
+					  ("normalize-association-scores,k", bpo::value(&normalize_scores_)->default_value(false)->zero_tokens(), "Should the association scores be normalized? (default: false)")
+					  ("max-regulator-per-target,y", bpo::value(&max_regulators_per_target_), "The maximum number of regulators that are allowed to influence a regulator. (optional)")
+					  ("fill-blanks,f", bpo::value(&fill_blanks_)->default_value(false)->zero_tokens(), "Should blanks be introduced if a target has a fewer regulators than all other targets. (optional)")
+					  ("threads", bpo::value(&threads_)->default_value(0), "Number of test sets that are processed concurrently. (default: number of cores)");
+	try {
+		bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(), vm);
+		bpo::notify(vm);
+	} catch(bpo::error& e) {
+		std::cerr << "ERROR: " << e.what() << "\n";
+		desc.print(std::cerr);
+		return false;
+	}
+
+	return checkIfFileExists(desc, contrasts_) &&
+	       checkIfFileExists(desc, matrix_) &&
+	       checkIfFileExists(desc, regulations_);
+}
+
+std::vector<Contrast> readContrasts(const std::string& file)
+{
+	std::ifstream input(file);
+	if(!input) {
+		throw IOError("File (" + file + ") is not open for reading");
+	}
+
+	std::vector<Contrast> contrasts;
+	Contrast contrast;
+	while(input >> contrast.scores >> contrast.output) {
+		contrasts.push_back(contrast);
+	}
+
+	if(!input.eof()) {
+		throw IOError("Wrong file format.");
+	}
+
+	return contrasts;
+}
+
+template <typename REGGAEAnalysis, typename RegulatorImpactScore>
+std::vector<RegulatorEffectResult> run(REGGAEAnalysis& analysis,
+                                       RegulatorImpactScore impactScore)
+{
+	std::vector<RegulatorEffectResult> results;
+	if(method_ == "ks-test") {
+		results = analysis.run(KSTest(), impactScore);
+	} else if(method_ == "wrs-test") {
+		results = analysis.run(WRSTest(), impactScore);
+	} else if(method_ == "em-test") {
+		results = analysis.run(EMTest(), impactScore);
+	} else {
+		std::cerr << "ERROR: Method '" << method_ << "' not known!"
+		          << std::endl;
+	}
+	return results;
+}
+
+template <typename REGGAEAnalysis>
+std::vector<RegulatorEffectResult> run(REGGAEAnalysis& analysis)
+{
+	std::vector<RegulatorEffectResult> results;
+	if(impact_score_ == "pearson_correlation") {
+		results = run(analysis, PearsonCorrelation());
+	} else if(impact_score_ == "spearman_correlation") {
+		results = run(analysis, SpearmanCorrelation());
+	} else if(impact_score_ == "kendall_correlation") {
+		results = run(analysis, KendallCorrelation());
+	} else {
+		std::cerr << "ERROR: Impact score '" << impact_score_ << "' not known!"
+		          << std::endl;
+	}
+	return results;
+}
+
+/**
+ * Performs REGGAE for a single test set. The matrix and the name database
+ * are only read, the analysis modifies its own copy of the network.
+ */
+void runContrast(DenseMatrix& matrix, MatrixNameDatabase& name_database,
+                 const RegulationFile<double>& network,
+                 const Contrast& contrast)
+{
+	GeneSetReader reader;
+	GeneSet test_set = reader.readScoringFile(contrast.scores);
+	std::vector<std::string> sorted_target_names = test_set.getSortedIdentifier(decreasingly_);
+	std::vector<size_t> sorted_targets = translate_test_set(&matrix, sorted_target_names);
+	std::unordered_set<size_t> tset(sorted_targets.begin(), sorted_targets.end());
+
+	RegulationFile<double> regulationFile = network.restrictToTargets(tset);
+	size_t max_regulators_per_target = max_regulators_per_target_;
+	if(max_regulators_per_target == 0){
+		max_regulators_per_target = regulationFile.maxNumberOfRegulators();
+	}
+
+	RegulationBootstrapper<double> bootstrapper(&matrix, seed_);
+	RegulatorGeneAssociationEnrichmentAnalysis<RegulationBootstrapper<double>,
+	                                           MatrixNameDatabase, double>
+	    analysis(sorted_targets, regulationFile, bootstrapper, name_database, normalize_scores_,
+	             useAbsoluteValues_, sort_correlations_decreasingly_, fill_blanks_, bootstrapping_runs_, max_regulators_per_target);
+	std::vector<RegulatorEffectResult> results = run(analysis);
+
+	adjustPValues(results, adjustment_method_);
+	for(auto& res : results) {
+		if(res.name != ""){
+			res.calculate_bootstrap_parameters(alpha_, confidence_interval_);
+		}
+	}
+	write(results, contrast.output, json_);
+}
+
+int main(int argc, char* argv[])
+{
+	if(!parseArguments(argc, argv)) {
+		return -1;
+	}
+
+	if(matrixOptions.additional_colname && matrixOptions.no_rownames) {
+		std::cerr << "Conflicting arguments. Additional colnames can only be "
+		             "specified if row names are present!" << std::endl;
+		return -2;
+	}
+
+	std::vector<Contrast> contrasts;
+	try {
+		contrasts = readContrasts(contrasts_);
+	} catch(const IOError& e) {
+		std::cerr << "ERROR: Could not read contrasts: " << e.what() << std::endl;
+		return -3;
+	}
+
+	std::cout << "INFO: Parsing data matrix" << std::endl;
+	DenseMatrix matrix(0, 0);
+	try {
+		matrix = readDenseMatrix(matrix_, matrixOptions);
+	} catch(const IOError& e) {
+		std::cerr << "ERROR: Could not open input data matrix for reading."
+		          << std::endl;
+		return -4;
+	}
+	MatrixNameDatabase name_database(&matrix);
+
+	// The network is parsed for all genes of the matrix and restricted to
+	// the test set of every contrast afterwards.
+	std::cout << "INFO: Parsing regulations" << std::endl;
+	std::unordered_set<size_t> all_genes;
+	for(size_t i = 0; i < matrix.rows(); ++i) {
+		all_genes.emplace(i);
+	}
+	RegulationFileParser<MatrixNameDatabase, double> parser(name_database, all_genes, regulations_, 0.0);
+	const RegulationFile<double>& network = parser.getRegulationFile();
+
+	std::atomic<size_t> failed(0);
+	parallel_for(0, contrasts.size(), [&](size_t i) {
+		try {
+			runContrast(matrix, name_database, network, contrasts[i]);
+			std::cout << "INFO: Finished '" + contrasts[i].scores + "'\n";
+		} catch(const std::exception& e) {
+			std::cerr << "ERROR: Could not process '" + contrasts[i].scores +
+			                 "': " + e.what() + "\n";
+			++failed;
+		}
+	}, threads_);
+
+	return failed == 0 ? 0 : -5;
+}
@@ -31,7 +31,7 @@ using namespace GeneTrail;
 namespace bpo = boost::program_options;
 
 std::string scores_ = "", matrix_ = "", regulations_ = "", out_ = "", method_ = "", adjustment_method_ = "";
-size_t seed_, permutations_;
+size_t seed_, permutations_, threads_;
 bool upper_tailed_, abs_;
 
 MatrixReaderOptions matrixOptions;
@@ -54,7 +54,8 @@ bool parseArguments(int argc, char* argv[])
 					  ("adjust,a", bpo::value(&adjustment_method_)->required(), "Method to adjust p-values.")
 					  ("output,o", bpo::value(&out_)->required(), "Output prefix for text files.")
 					  ("upper-tailed,u", bpo::value(&upper_tailed_)->default_value(false)->zero_tokens(), "Calculate an upper-tailed p-value.")
-					  ("abs,b", bpo::value(&upper_tailed_)->default_value(false)->zero_tokens(), "Use absolute value.");
+					  ("abs,b", bpo::value(&abs_)->default_value(false)->zero_tokens(), "Use absolute value.")
+					  ("threads,j", bpo::value(&threads_)->default_value(0), "Number of threads. 0 uses all cores.");
 	try {
 		bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(), vm);
 		bpo::notify(vm);
@@ -103,6 +104,7 @@ int main(int argc, char* argv[])
 	
 	std::cout << "INFO: Performing correlation set analysis" << std::endl;
 	CorrelationSetAnalysis<double> csa(&matrix, name_database, sorted_targets, regulationFile);
+	csa.setNumberOfThreads(threads_);
 	std::vector<RegulatorEffectResult> results;
 	if(method_ == "pearson_correlation") {
 		results = csa.run(PearsonCorrelation(), seed_, permutations_, upper_tailed_, abs_);
@@ -0,0 +1,59 @@
+#include <boost/program_options.hpp>
+
+#include <genetrail2/core/Exception.h>
+#include <genetrail2/regulation/BinaryRegulationNetwork.h>
+
+#include <iostream>
+#include <string>
+
+using namespace GeneTrail;
+
+namespace bpo = boost::program_options;
+
+std::string in_, out_;
+
+bool parseArguments(int argc, char* argv[])
+{
+	bpo::variables_map vm;
+	bpo::options_description desc;
+
+	desc.add_options()("help,h", "Display this message")
+	("input,i", bpo::value(&in_)->required(), "A whitespace separated file containing regulator, target and an optional value per line.")
+	("output,o", bpo::value(&out_)->required(), "Path of the binary network. It can be used wherever a regulation file is expected.")
+	;
+
+	try {
+		bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(),
+		           vm);
+		bpo::notify(vm);
+	} catch(bpo::error& e) {
+		std::cerr << "Error: " << e.what() << "\n";
+		desc.print(std::cerr);
+		return false;
+	}
+
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	if(!parseArguments(argc, argv)) {
+		return -1;
+	}
+
+	try {
+		BinaryRegulationNetwork::convert(in_, out_);
+		BinaryRegulationNetwork network(out_);
+		std::cout << "INFO: Converted " << network.numberOfEdges()
+		          << " regulations between " << network.numberOfNames()
+		          << " genes" << std::endl;
+	} catch(const IOError& e) {
+		std::cerr << "ERROR: " << e.what() << std::endl;
+		return -2;
+	} catch(const std::exception& e) {
+		std::cerr << "ERROR: Could not convert '" << in_ << "': " << e.what() << std::endl;
+		return -3;
+	}
+
+	return 0;
+}
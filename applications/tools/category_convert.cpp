@@ -1,4 +1,6 @@
+#include <genetrail2/core/BinaryCategoryDatabase.h>
 #include <genetrail2/core/EntityDatabase.h>
+#include <genetrail2/core/Exception.h>
 #include <genetrail2/core/File.h>
 #include <genetrail2/core/GMTFile.h>
 #include <genetrail2/core/JsonCategoryFile.h>
@@ -37,17 +39,42 @@ void setParameters(const bpo::variables_map& vm, CategoryDatabase& db)
 	}
 }
 
-template <typename CatDBFileA, typename CatDBFileB>
-void readWriteCategoryDatabase(const std::string& input,
-                               const std::string& output,
-                               const bpo::variables_map& vm)
+bool endsWith(const std::string& s, const std::string& suffix)
+{
+	return s.size() >= suffix.size() &&
+	       s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+template <typename CatDBFile>
+void writeCategoryDatabase(const CategoryDatabase& categories,
+                           const std::string& output)
+{
+	CatDBFile out(categories.entityDatabase(), output, FileOpenMode::WRITE);
+	out.write(categories);
+}
+
+/**
+ * The output format is chosen by the extension of the output file:
+ * ".gtcat" for the binary format, ".json" and ".gmt". For other extensions
+ * JSON files are converted to GMT and all other files to JSON.
+ */
+void convertCategoryDatabase(const std::string& input,
+                             const std::string& output,
+                             const bpo::variables_map& vm)
 {
 	auto db = std::make_shared<EntityDatabase>();
-	CatDBFileA in(db, input);
-	CatDBFileB out(db, output, FileOpenMode::WRITE);
-	auto categories = in.read();
+	auto categories = readCategoryDatabase(db, input);
 	setParameters(vm, categories);
-	out.write(categories);
+
+	if(endsWith(output, ".gtcat")) {
+		BinaryCategoryDatabase::write(categories, output);
+	} else if(endsWith(output, ".json")) {
+		writeCategoryDatabase<JsonCategoryFile>(categories, output);
+	} else if(endsWith(output, ".gmt") || endsWith(input, ".json")) {
+		writeCategoryDatabase<GMTFile>(categories, output);
+	} else {
+		writeCategoryDatabase<JsonCategoryFile>(categories, output);
+	}
 }
 
 int main(int argc, char* argv[])
@@ -77,10 +104,11 @@ int main(int argc, char* argv[])
 		return -1;
 	}
 
-	if(input.substr(input.length() - 5) == ".json") {
-		readWriteCategoryDatabase<JsonCategoryFile, GMTFile>(input, output, vm);
-	} else {
-		readWriteCategoryDatabase<GMTFile, JsonCategoryFile>(input, output, vm);
+	try {
+		convertCategoryDatabase(input, output, vm);
+	} catch(const IOError& e) {
+		std::cerr << "ERROR: " << e.what() << std::endl;
+		return -2;
 	}
 
 	return 0;
@@ -6,6 +6,7 @@
 #include <genetrail2/core/SparseMatrixReader.h>
 #include <genetrail2/core/SparseMatrixWriter.h>
 
+#include <genetrail2/cluster/ApproximateNeighborhoodBuilder.h>
 #include <genetrail2/cluster/METISClusterer.h>
 #include <genetrail2/cluster/NeighborhoodBuilder.h>
 
@@ -16,6 +17,7 @@
 #include <sstream>
 #include <iomanip>
 #include <fstream>
+#include <vector>
 
 using namespace GeneTrail;
 namespace bpo = boost::program_options;
@@ -110,7 +112,7 @@ int main(int argc, char* argv[])
 	bpo::options_description desc;
 
 	std::string infile, outfile, similarity, fixedpoint, graphviz, partfile, save_graph, load_graph;
-	unsigned int num_cluster, num_neighbors;
+	unsigned int num_cluster, num_neighbors, num_trees, leaf_size, num_refinements, recall_samples;
 
 	desc.add_options()
 		("help,h", "Display this message")
@@ -119,7 +121,11 @@ int main(int argc, char* argv[])
 		("partition,p",  bpo::value<std::string>(&partfile), "Write the partitioned data into files. The supplied file name should contain a % wildcard which will be replaced with the partition number.")
 		("clusters,c",   bpo::value<unsigned int>(&num_cluster)->required(), "The number of clusters that should be computed")
 		("neighbors,n",  bpo::value<unsigned int>(&num_neighbors)->required(), "The number of neighbors in the neighborhood graph")
-		("similarity,s", bpo::value<std::string>(&similarity)->default_value("pearson"), "The similarity measure that should be used for building the neighborhood. (Not implemented yet)")
+		("similarity,s", bpo::value<std::string>(&similarity)->default_value("pearson"), "The similarity measure that should be used for building the neighborhood. Either 'pearson' (exact) or 'approximate-pearson' (random projection trees).")
+		("trees",        bpo::value<unsigned int>(&num_trees)->default_value(8), "The number of random projection trees used by 'approximate-pearson'.")
+		("leaf-size",    bpo::value<unsigned int>(&leaf_size)->default_value(64), "The maximal number of points in a random projection tree leaf.")
+		("refinements",  bpo::value<unsigned int>(&num_refinements)->default_value(1), "The number of neighbor-of-neighbor refinement passes used by 'approximate-pearson'.")
+		("recall-samples", bpo::value<unsigned int>(&recall_samples)->default_value(0), "Compare the approximate neighborhood of this many random features to the exact neighborhood and report the recall.")
 		("fixedpoint,f", bpo::value<std::string>(&fixedpoint)->default_value("linear"), "The encoding that should be used for the conversion to fixed point edge weights. (Not implemented yet)")
 		("graphviz,g",   bpo::value<std::string>(&graphviz), "Dump the computed neighborhood graph and partition to the specified file.")
 		("print-scores,x", "Print the achieved cluster scores.")
@@ -141,6 +147,11 @@ int main(int argc, char* argv[])
 		return -1;
 	}
 
+	if(similarity != "pearson" && similarity != "approximate-pearson") {
+		std::cerr << "Unknown similarity measure '" << similarity << "'." << std::endl;
+		return -1;
+	}
+
 	DenseMatrixReader reader;
 
 	std::ifstream input(infile);
@@ -175,10 +186,29 @@ int main(int argc, char* argv[])
 
 		std::cout << "Building neighborhood graph ..." << std::endl;
 
-		NeighborhoodBuilder nbuilder;
-		nbuilder.setNumNeighbors(num_neighbors);
+		if(similarity == "approximate-pearson") {
+			ApproximateNeighborhoodBuilder nbuilder;
+			nbuilder.setNumNeighbors(num_neighbors);
+			nbuilder.setNumTrees(num_trees);
+			nbuilder.setLeafSize(leaf_size);
+			nbuilder.setNumRefinements(num_refinements);
+
+			if(recall_samples > 0) {
+				std::vector<std::vector<unsigned int>> neighbor_lists;
+				graph = nbuilder.build(mat, neighbor_lists);
+
+				std::cout << "Recall of the approximate neighborhood (" << recall_samples
+				          << " samples): " << nbuilder.estimateRecall(mat, neighbor_lists, recall_samples)
+				          << std::endl;
+			} else {
+				graph = nbuilder.build(mat);
+			}
+		} else {
+			NeighborhoodBuilder nbuilder;
+			nbuilder.setNumNeighbors(num_neighbors);
 
-		graph = nbuilder.build(std::move(mat));
+			graph = nbuilder.build(mat);
+		}
 	} else {
 		std::cout << "Loading neighborhood graph ..." << std::endl;
 
@@ -0,0 +1,82 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SyntheticData.h"
+
+#include <genetrail2/core/DenseMatrixReader.h>
+#include <genetrail2/core/DenseMatrixWriter.h>
+
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+
+using namespace GeneTrail;
+
+static std::string serialize(size_t rows, bool binary)
+{
+	DenseMatrix matrix = synthetic::expressionMatrix(rows, 100, 42);
+
+	std::ostringstream strm;
+	DenseMatrixWriter writer;
+	if(binary) {
+		writer.writeBinary(strm, matrix);
+	} else {
+		writer.writeText(strm, matrix);
+	}
+
+	return strm.str();
+}
+
+static void readMatrix(benchmark::State& state, bool binary)
+{
+	const std::string data = serialize(state.range(0), binary);
+	DenseMatrixReader reader;
+
+	for(auto _ : state) {
+		std::istringstream strm(data);
+		DenseMatrix matrix = reader.read(strm);
+		benchmark::DoNotOptimize(matrix.matrix().data());
+	}
+
+	state.SetBytesProcessed(state.iterations() * data.size());
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_DenseMatrixReader_Text(benchmark::State& state)
+{
+	readMatrix(state, false);
+}
+
+static void BM_DenseMatrixReader_Binary(benchmark::State& state)
+{
+	readMatrix(state, true);
+}
+
+BENCHMARK(BM_DenseMatrixReader_Text)
+    ->RangeMultiplier(4)
+    ->Range(1 << 10, 1 << 14)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_DenseMatrixReader_Binary)
+    ->RangeMultiplier(4)
+    ->Range(1 << 10, 1 << 14)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
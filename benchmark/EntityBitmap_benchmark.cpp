@@ -0,0 +1,126 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SyntheticData.h"
+
+#include <genetrail2/core/Category.h>
+#include <genetrail2/core/EntityBitmap.h>
+#include <genetrail2/core/EntityDatabase.h>
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+using namespace GeneTrail;
+
+static const size_t NUM_GENES = 20000;
+static const size_t NUM_CATEGORIES = 5000;
+
+/**
+ * Sets up a reference set containing all genes, a test set of the given
+ * size and the synthetic categories, i.e. the inputs of an ORA.
+ */
+struct IntersectionData
+{
+	explicit IntersectionData(size_t test_set_size)
+	    : reference(&db), test(&db)
+	{
+		for(size_t i = 0; i < NUM_GENES; ++i) {
+			reference.insert(synthetic::geneName(i));
+		}
+
+		for(size_t i = 0; i < test_set_size; ++i) {
+			test.insert(synthetic::geneName((i * 7919) % NUM_GENES));
+		}
+
+		categories =
+		    synthetic::categories(&db, NUM_CATEGORIES, NUM_GENES, 42);
+	}
+
+	EntityDatabase db;
+	Category reference;
+	Category test;
+	std::vector<std::shared_ptr<Category>> categories;
+};
+
+static void BM_Category_Intersect(benchmark::State& state)
+{
+	IntersectionData data(state.range(0));
+
+	for(auto _ : state) {
+		for(const auto& c : data.categories) {
+			auto k = Category::intersect("null", *c, data.test).size();
+			auto l = Category::intersect("null", *c, data.reference).size();
+			benchmark::DoNotOptimize(k);
+			benchmark::DoNotOptimize(l);
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * data.categories.size());
+}
+
+static void BM_EntityBitmap_IntersectionSize(benchmark::State& state)
+{
+	IntersectionData data(state.range(0));
+
+	EntityBitmap test(data.test);
+	EntityBitmap reference(data.reference);
+
+	for(auto _ : state) {
+		for(const auto& c : data.categories) {
+			auto k = test.intersectionSize(*c);
+			auto l = reference.intersectionSize(*c);
+			benchmark::DoNotOptimize(k);
+			benchmark::DoNotOptimize(l);
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * data.categories.size());
+}
+
+static void BM_EntityBitmap_BitmapIntersectionSize(benchmark::State& state)
+{
+	IntersectionData data(state.range(0));
+
+	EntityBitmap test(data.test);
+	std::vector<EntityBitmap> categories;
+	for(const auto& c : data.categories) {
+		categories.emplace_back(*c);
+	}
+
+	for(auto _ : state) {
+		for(const auto& c : categories) {
+			auto k = test.intersectionSize(c);
+			benchmark::DoNotOptimize(k);
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * categories.size());
+}
+
+BENCHMARK(BM_Category_Intersect)
+    ->Arg(100)->Arg(1000)->Arg(5000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EntityBitmap_IntersectionSize)
+    ->Arg(100)->Arg(1000)->Arg(5000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EntityBitmap_BitmapIntersectionSize)
+    ->Arg(100)->Arg(1000)->Arg(5000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,122 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <genetrail2/core/GeneSetEnrichmentAnalysis.h>
+#include <genetrail2/core/multiprecision.h>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace GeneTrail;
+
+/**
+ * Draws the sorted positions of l category members in a list of n genes.
+ */
+static std::vector<size_t> positions(size_t n, size_t l)
+{
+	std::mt19937_64 twister(42);
+	std::vector<size_t> result(n);
+	std::iota(result.begin(), result.end(), size_t(0));
+	std::shuffle(result.begin(), result.end(), twister);
+	result.resize(l);
+	std::sort(result.begin(), result.end());
+
+	return result;
+}
+
+template <typename GSEA> static int64_t runningSum(GSEA& gsea, size_t n, size_t l)
+{
+	const auto pos = positions(n, l);
+	return gsea.computeRunningSum(n, pos.begin(), pos.end());
+}
+
+// The benchmarks below measure the dynamic programming recursion
+// (computePValue_) via its public entry points.
+
+template <typename float_type>
+static void BM_GSEA_TwoSidedPValue(benchmark::State& state)
+{
+	const size_t n = state.range(0);
+	const size_t l = state.range(1);
+
+	GeneSetEnrichmentAnalysis<float_type, int64_t> gsea;
+	const int64_t RSc = runningSum(gsea, n, l);
+
+	for(auto _ : state) {
+		auto p = gsea.computeTwoSidedPValue(n, l, RSc);
+		benchmark::DoNotOptimize(p);
+	}
+}
+
+template <typename float_type>
+static void BM_GSEA_OneSidedPValue(benchmark::State& state)
+{
+	const size_t n = state.range(0);
+	const size_t l = state.range(1);
+
+	GeneSetEnrichmentAnalysis<float_type, int64_t> gsea;
+	const int64_t RSc = runningSum(gsea, n, l);
+
+	for(auto _ : state) {
+		auto p = RSc < 0 ? gsea.computeLeftPValue(n, l, RSc)
+		                 : gsea.computeRightPValue(n, l, RSc);
+		benchmark::DoNotOptimize(p);
+	}
+}
+
+static void BM_GSEA_RunningSum(benchmark::State& state)
+{
+	const size_t n = state.range(0);
+	const size_t l = state.range(1);
+
+	const auto pos = positions(n, l);
+
+	GeneSetEnrichmentAnalysis<double, int64_t> gsea;
+	for(auto _ : state) {
+		auto RSc = gsea.computeRunningSum(n, pos.begin(), pos.end());
+		benchmark::DoNotOptimize(RSc);
+	}
+}
+
+static void sizes(benchmark::internal::Benchmark* b)
+{
+	for(int n : {1000, 5000, 20000}) {
+		for(int l : {10, 100, 500}) {
+			b->Args({n, l});
+		}
+	}
+}
+
+BENCHMARK_TEMPLATE(BM_GSEA_TwoSidedPValue, double)
+    ->Apply(sizes)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_GSEA_TwoSidedPValue, big_float)
+    ->Apply(sizes)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_GSEA_OneSidedPValue, double)
+    ->Apply(sizes)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_GSEA_OneSidedPValue, big_float)
+    ->Apply(sizes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GSEA_RunningSum)->Apply(sizes);
+
+BENCHMARK_MAIN();
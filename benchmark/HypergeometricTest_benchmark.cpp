@@ -0,0 +1,94 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SyntheticData.h"
+
+#include <genetrail2/core/HypergeometricTest.h>
+#include <genetrail2/core/multiprecision.h>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+using namespace GeneTrail;
+
+static const uint64_t NUM_GENES = 20000;
+static const size_t NUM_CATEGORIES = 200;
+
+/**
+ * Creates (l, k) pairs, i.e. category sizes and the number of hits, for a
+ * test set of size n. The number of hits is slightly above the expected
+ * number of hits, as it is the case for interesting categories.
+ */
+static std::vector<std::tuple<uint64_t, uint64_t>> contingencies(uint64_t n)
+{
+	std::vector<std::tuple<uint64_t, uint64_t>> result;
+	for(uint64_t l : synthetic::categorySizes(NUM_CATEGORIES, 5, 500, 42)) {
+		uint64_t k = std::min(std::min(l, n), 2 * (l * n) / NUM_GENES + 1);
+		result.emplace_back(l, k);
+	}
+	return result;
+}
+
+static void BM_HypergeometricTest_UpperTailed(benchmark::State& state)
+{
+	const uint64_t n = state.range(0);
+	const auto tables = contingencies(n);
+
+	HypergeometricTest<uint64_t, big_float> test;
+	for(auto _ : state) {
+		for(const auto& t : tables) {
+			auto p = test.upperTailedPValue(NUM_GENES, std::get<0>(t), n,
+			                                std::get<1>(t));
+			benchmark::DoNotOptimize(p);
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * tables.size());
+}
+
+static void BM_HypergeometricTest_LowerTailed(benchmark::State& state)
+{
+	const uint64_t n = state.range(0);
+	const auto tables = contingencies(n);
+
+	HypergeometricTest<uint64_t, big_float> test;
+	for(auto _ : state) {
+		for(const auto& t : tables) {
+			auto p = test.lowerTailedPValue(NUM_GENES, std::get<0>(t), n,
+			                                std::get<1>(t));
+			benchmark::DoNotOptimize(p);
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * tables.size());
+}
+
+// Same instantiation as used by the OverRepresentationAnalysis. Plain
+// doubles overflow in the binomial coefficients for realistic sizes.
+BENCHMARK(BM_HypergeometricTest_UpperTailed)
+    ->Arg(100)->Arg(1000)->Arg(5000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_HypergeometricTest_LowerTailed)
+    ->Arg(100)->Arg(1000)->Arg(5000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,68 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SyntheticData.h"
+
+#include <genetrail2/core/DenseColumnSubset.h>
+#include <genetrail2/core/MatrixHTest.h>
+
+#include <benchmark/benchmark.h>
+
+#include <numeric>
+#include <vector>
+
+using namespace GeneTrail;
+
+static void testMatrix(benchmark::State& state, MatrixHTests method)
+{
+	const size_t cols = 40;
+	DenseMatrix matrix = synthetic::expressionMatrix(state.range(0), cols, 42);
+
+	// The first half of the columns is the reference group
+	std::vector<size_t> ref(cols / 2), sam(cols - cols / 2);
+	std::iota(ref.begin(), ref.end(), size_t(0));
+	std::iota(sam.begin(), sam.end(), cols / 2);
+
+	DenseColumnSubset reference(&matrix, ref.begin(), ref.end());
+	DenseColumnSubset sample(&matrix, sam.begin(), sam.end());
+
+	MatrixHTest htest;
+	for(auto _ : state) {
+		Scores scores = htest.test(method, sample, reference);
+		benchmark::DoNotOptimize(scores.size());
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_CAPTURE(testMatrix, IndependentTTest, MatrixHTests::IndependentTTest)
+    ->RangeMultiplier(4)->Range(1 << 10, 1 << 14)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(testMatrix, DependentTTest, MatrixHTests::DependentTTest)
+    ->RangeMultiplier(4)->Range(1 << 10, 1 << 14)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(testMatrix, IndependentShrinkageTTest, MatrixHTests::IndependentShrinkageTTest)
+    ->RangeMultiplier(4)->Range(1 << 10, 1 << 14)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(testMatrix, IndependentWilcoxonTest, MatrixHTests::IndependentWilcoxonTest)
+    ->RangeMultiplier(4)->Range(1 << 10, 1 << 14)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(testMatrix, ZScore, MatrixHTests::ZScore)
+    ->RangeMultiplier(4)->Range(1 << 10, 1 << 14)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(testMatrix, MedianFoldQuotient, MatrixHTests::MedianFoldQuotient)
+    ->RangeMultiplier(4)->Range(1 << 10, 1 << 14)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,129 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SyntheticData.h"
+
+#include <genetrail2/core/MatrixNormalization.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace GeneTrail;
+
+static const size_t NUM_GENES = 200;
+
+/**
+ * Reference implementation: calls normalizeValue for every entry.
+ */
+template <typename Normalization>
+static void normalizeByValue(const DenseMatrix& matrix, Normalization& norm,
+                             DenseMatrix& result)
+{
+	std::vector<double> row(matrix.cols());
+	for(size_t i = 0; i < matrix.rows(); ++i) {
+		for(size_t j = 0; j < row.size(); ++j) {
+			row[j] = matrix(i, j);
+		}
+		for(size_t j = 0; j < row.size(); ++j) {
+			result(i, j) =
+			    norm.normalizeValue(row.begin() + j, row.begin(), row.end());
+		}
+	}
+}
+
+static DenseMatrix counts(size_t cols)
+{
+	auto matrix = synthetic::expressionMatrix(NUM_GENES, cols, 42);
+	for(size_t i = 0; i < matrix.rows(); ++i) {
+		for(size_t j = 0; j < matrix.cols(); ++j) {
+			matrix(i, j) = std::floor(std::exp2(matrix(i, j) - 2.0));
+		}
+	}
+	return matrix;
+}
+
+static void BM_GaussEstimator_NormalizeValue(benchmark::State& state)
+{
+	const auto matrix = synthetic::expressionMatrix(NUM_GENES, state.range(0), 42);
+	DenseMatrix result(matrix.rows(), matrix.cols());
+	GaussEstimator gauss;
+
+	for(auto _ : state) {
+		normalizeByValue(matrix, gauss, result);
+	}
+
+	state.SetItemsProcessed(state.iterations() * matrix.rows());
+}
+
+static void BM_GaussEstimator_NormalizeMatrix(benchmark::State& state)
+{
+	const auto matrix = synthetic::expressionMatrix(NUM_GENES, state.range(0), 42);
+	MatrixNormalization norm;
+	GaussEstimator gauss;
+
+	for(auto _ : state) {
+		auto result = norm.normalizeMatrix(matrix, gauss, 1);
+		benchmark::DoNotOptimize(result);
+	}
+
+	state.SetItemsProcessed(state.iterations() * matrix.rows());
+}
+
+static void BM_PoissonEstimator_NormalizeValue(benchmark::State& state)
+{
+	const auto matrix = counts(state.range(0));
+	DenseMatrix result(matrix.rows(), matrix.cols());
+	PoissonEstimator poisson;
+
+	for(auto _ : state) {
+		normalizeByValue(matrix, poisson, result);
+	}
+
+	state.SetItemsProcessed(state.iterations() * matrix.rows());
+}
+
+static void BM_PoissonEstimator_NormalizeMatrix(benchmark::State& state)
+{
+	const auto matrix = counts(state.range(0));
+	MatrixNormalization norm;
+	PoissonEstimator poisson;
+
+	for(auto _ : state) {
+		auto result = norm.normalizeMatrix(matrix, poisson, 1);
+		benchmark::DoNotOptimize(result);
+	}
+
+	state.SetItemsProcessed(state.iterations() * matrix.rows());
+}
+
+// The per-value implementations are quadratic in the number of samples
+// and only run for small matrices.
+BENCHMARK(BM_GaussEstimator_NormalizeValue)
+    ->Arg(50)->Arg(200)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GaussEstimator_NormalizeMatrix)
+    ->Arg(50)->Arg(200)->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PoissonEstimator_NormalizeValue)
+    ->Arg(50)->Arg(200)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PoissonEstimator_NormalizeMatrix)
+    ->Arg(50)->Arg(200)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
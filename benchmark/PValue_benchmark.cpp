@@ -0,0 +1,53 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SyntheticData.h"
+
+#include <genetrail2/core/PValue.h>
+
+#include <benchmark/benchmark.h>
+
+using namespace GeneTrail;
+
+static void adjust(benchmark::State& state, MultipleTestingCorrection method)
+{
+	const auto pvalues = synthetic::pvalues(state.range(0), 42);
+
+	for(auto _ : state) {
+		auto adjusted = pvalue::adjustPValues(pvalues, pvalue::get_second(), method);
+		benchmark::DoNotOptimize(adjusted.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+#define GT2_PVALUE_BENCHMARK(method)                                           \
+	BENCHMARK_CAPTURE(adjust, method, MultipleTestingCorrection::method)       \
+	    ->RangeMultiplier(10)                                                  \
+	    ->Range(1000, 1000000)                                                 \
+	    ->Unit(benchmark::kMillisecond)
+
+GT2_PVALUE_BENCHMARK(Bonferroni);
+GT2_PVALUE_BENCHMARK(Holm);
+GT2_PVALUE_BENCHMARK(Hochberg);
+GT2_PVALUE_BENCHMARK(BenjaminiHochberg);
+GT2_PVALUE_BENCHMARK(BenjaminiYekutieli);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,72 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SyntheticData.h"
+
+#include <genetrail2/regulation/RegulationBootstrapper.h>
+#include <genetrail2/regulation/RegulatorAssociationScore.h>
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+using namespace GeneTrail;
+
+static const size_t NUM_GENES = 2000;
+static const size_t NUM_REGULATORS = 200;
+static const size_t REGULATORS_PER_TARGET = 10;
+
+/**
+ * Performs one bootstrapping run for every target of a synthetic network,
+ * which is the work done per run by REGGAE.
+ */
+template <typename Score>
+static void BM_RegulationBootstrapper(benchmark::State& state)
+{
+	DenseMatrix matrix =
+	    synthetic::expressionMatrix(NUM_GENES, state.range(0), 42);
+	auto network = synthetic::regulationNetwork(
+	    NUM_GENES, NUM_REGULATORS, REGULATORS_PER_TARGET, 42);
+
+	std::vector<std::vector<RegulationBootstrapper<double>::Regulation>> targets;
+	for(size_t t = 0; t < NUM_GENES; ++t) {
+		if(network.checkTarget(t)) {
+			targets.push_back(network.target2regulations(t));
+		}
+	}
+
+	RegulationBootstrapper<double> bootstrapper(&matrix, 42);
+	for(auto _ : state) {
+		bootstrapper.create_bootstrap_sample();
+		for(auto& regulations : targets) {
+			bootstrapper.perform_bootstrapping_run(
+			    network, regulations, false, true, true, Score());
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * targets.size());
+}
+
+BENCHMARK_TEMPLATE(BM_RegulationBootstrapper, PearsonCorrelation)
+    ->Arg(20)->Arg(100)->Arg(500)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_RegulationBootstrapper, SpearmanCorrelation)
+    ->Arg(20)->Arg(100)->Arg(500)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,103 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SyntheticData.h"
+
+#include <genetrail2/enrichment/EnrichmentAlgorithm.h>
+#include <genetrail2/enrichment/PermutationTest.h>
+#include <genetrail2/enrichment/SetLevelStatistics.h>
+
+#include <benchmark/benchmark.h>
+
+#include <iostream>
+#include <sstream>
+
+using namespace GeneTrail;
+
+static const size_t NUM_GENES = 20000;
+static const size_t NUM_CATEGORIES = 500;
+
+static EnrichmentResults results(EnrichmentAlgorithmPtr& algorithm,
+                                 EntityDatabase* db)
+{
+	EnrichmentResults result;
+	for(const auto& c : synthetic::categories(db, NUM_CATEGORIES, NUM_GENES, 42)) {
+		result.emplace_back(algorithm->computeEnrichment(c));
+		result.back()->hits = c->size();
+	}
+
+	return result;
+}
+
+static void permute(benchmark::State& state, EnrichmentAlgorithmPtr algorithm,
+                    const Scores& scores, const std::shared_ptr<EntityDatabase>& db)
+{
+	using Test = RowPermutationTest<double>;
+
+	algorithm->setScores(scores);
+	auto tests = results(algorithm, db.get());
+
+	// The permutation test reports its progress for every permutation
+	std::ostringstream status;
+	auto* buffer = std::cout.rdbuf(status.rdbuf());
+
+	for(auto _ : state) {
+		auto test =
+		    algorithm->supportsIndices()
+		        ? Test::IndexBased(scores, state.range(0), 42)
+		        : Test::CategoryBased(scores, state.range(0), 42);
+		test->computePValue(algorithm, tests);
+
+		status.str("");
+	}
+
+	std::cout.rdbuf(buffer);
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_RowPermutationTest_WeightedKS(benchmark::State& state)
+{
+	auto db = std::make_shared<EntityDatabase>();
+	Scores scores = synthetic::scores(db, NUM_GENES, 42);
+	scores.sortByScore(Order::Decreasing);
+
+	permute(state,
+	        createEnrichmentAlgorithm<WeightedKolmogorovSmirnov>(
+	            PValueMode::RowWise, scores, Order::Decreasing, false),
+	        scores, db);
+}
+
+static void BM_RowPermutationTest_Mean(benchmark::State& state)
+{
+	auto db = std::make_shared<EntityDatabase>();
+	Scores scores = synthetic::scores(db, NUM_GENES, 42);
+
+	permute(state, createEnrichmentAlgorithm<MeanEnrichment>(
+	                   PValueMode::RowWise, scores),
+	        scores, db);
+}
+
+BENCHMARK(BM_RowPermutationTest_WeightedKS)
+    ->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RowPermutationTest_Mean)
+    ->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,265 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SyntheticData.h"
+
+#include <genetrail2/core/Matrix.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <tuple>
+
+namespace GeneTrail
+{
+	namespace synthetic
+	{
+		using Edges = std::vector<std::pair<size_t, size_t>>;
+
+		namespace
+		{
+			std::vector<std::vector<size_t>>
+			categoryMembers(size_t num_categories, size_t num_genes,
+			                uint64_t seed, size_t min_size, size_t max_size)
+			{
+				auto sizes = categorySizes(num_categories, min_size,
+				                           std::min(max_size, num_genes), seed);
+
+				std::mt19937_64 twister(seed + 1);
+				std::vector<size_t> genes(num_genes);
+				std::iota(genes.begin(), genes.end(), size_t(0));
+
+				std::vector<std::vector<size_t>> result;
+				result.reserve(num_categories);
+				for(size_t size : sizes) {
+					// Partial Fisher-Yates shuffle: the first size genes form
+					// a uniformly drawn subset.
+					for(size_t i = 0; i < size; ++i) {
+						std::uniform_int_distribution<size_t> dist(i, num_genes - 1);
+						std::swap(genes[i], genes[dist(twister)]);
+					}
+					result.emplace_back(genes.begin(), genes.begin() + size);
+				}
+
+				return result;
+			}
+
+			Edges regulations(size_t num_genes, size_t num_regulators,
+			                  size_t regulators_per_target, uint64_t seed)
+			{
+				std::mt19937_64 twister(seed);
+				std::uniform_real_distribution<double> uniform;
+				std::poisson_distribution<size_t> degree(regulators_per_target);
+
+				Edges result;
+				std::vector<size_t> regulators;
+				for(size_t target = 0; target < num_genes; ++target) {
+					// Regulators do not regulate themselves
+					const size_t available =
+					    num_regulators - (target < num_regulators ? 1 : 0);
+					const size_t d = std::min(
+					    std::max(degree(twister), size_t(1)), available);
+
+					regulators.clear();
+					while(regulators.size() < d) {
+						// Squaring a uniform number favours small indices
+						// and thus creates a few hub regulators.
+						double u = uniform(twister);
+						size_t r = std::min(
+						    static_cast<size_t>(u * u * num_regulators),
+						    num_regulators - 1);
+
+						if(r != target && std::find(regulators.begin(),
+						                            regulators.end(),
+						                            r) == regulators.end()) {
+							regulators.push_back(r);
+						}
+					}
+
+					for(size_t r : regulators) {
+						result.emplace_back(r, target);
+					}
+				}
+
+				return result;
+			}
+		}
+
+		std::string geneName(size_t i) { return "GENE_" + std::to_string(i); }
+
+		DenseMatrix expressionMatrix(size_t rows, size_t cols, uint64_t seed,
+		                             double differential)
+		{
+			std::vector<std::string> row_names(rows);
+			std::vector<std::string> col_names(cols);
+
+			for(size_t i = 0; i < rows; ++i) {
+				row_names[i] = geneName(i);
+			}
+
+			for(size_t j = 0; j < cols; ++j) {
+				col_names[j] = "SAMPLE_" + std::to_string(j);
+			}
+
+			DenseMatrix result(std::move(row_names), std::move(col_names));
+
+			std::mt19937_64 twister(seed);
+			std::normal_distribution<double> base(8.0, 2.0);
+			std::uniform_real_distribution<double> noise_level(0.2, 1.5);
+			std::uniform_real_distribution<double> uniform;
+			std::normal_distribution<double> normal;
+
+			for(size_t i = 0; i < rows; ++i) {
+				const double mean = base(twister);
+				const double sd = noise_level(twister);
+
+				double shift = 0.0;
+				if(uniform(twister) < differential) {
+					shift = (uniform(twister) < 0.5 ? -1.0 : 1.0) *
+					        (0.5 + 2.0 * uniform(twister));
+				}
+
+				for(size_t j = 0; j < cols; ++j) {
+					result(i, j) = mean + sd * normal(twister) +
+					               (2 * j >= cols ? shift : 0.0);
+				}
+			}
+
+			return result;
+		}
+
+		std::vector<size_t> categorySizes(size_t num_categories,
+		                                  size_t min_size, size_t max_size,
+		                                  uint64_t seed)
+		{
+			std::mt19937_64 twister(seed);
+			std::uniform_real_distribution<double> dist(
+			    std::log(static_cast<double>(min_size)),
+			    std::log(static_cast<double>(max_size) + 1.0));
+
+			std::vector<size_t> result(num_categories);
+			for(auto& size : result) {
+				size = std::min(
+				    max_size, static_cast<size_t>(std::exp(dist(twister))));
+			}
+
+			return result;
+		}
+
+		std::vector<std::shared_ptr<Category>>
+		categories(EntityDatabase* db, size_t num_categories, size_t num_genes,
+		           uint64_t seed, size_t min_size, size_t max_size)
+		{
+			auto members = categoryMembers(num_categories, num_genes, seed,
+			                               min_size, max_size);
+
+			std::vector<std::shared_ptr<Category>> result;
+			result.reserve(num_categories);
+			for(size_t c = 0; c < members.size(); ++c) {
+				auto category = std::make_shared<Category>(db);
+				category->setName("CATEGORY_" + std::to_string(c));
+				for(size_t g : members[c]) {
+					category->insert(geneName(g));
+				}
+				result.push_back(category);
+			}
+
+			return result;
+		}
+
+		void writeGMT(std::ostream& out, size_t num_categories, size_t num_genes,
+		              uint64_t seed, size_t min_size, size_t max_size)
+		{
+			auto members = categoryMembers(num_categories, num_genes, seed,
+			                               min_size, max_size);
+
+			for(size_t c = 0; c < members.size(); ++c) {
+				out << "CATEGORY_" << c << "\thttp://localhost/" << c;
+				for(size_t g : members[c]) {
+					out << '\t' << geneName(g);
+				}
+				out << '\n';
+			}
+		}
+
+		Scores scores(const std::shared_ptr<EntityDatabase>& db,
+		              size_t num_genes, uint64_t seed)
+		{
+			std::mt19937_64 twister(seed);
+			std::normal_distribution<double> normal;
+
+			Scores result(db);
+			for(size_t i = 0; i < num_genes; ++i) {
+				result.emplace_back(geneName(i), normal(twister));
+			}
+
+			return result;
+		}
+
+		std::vector<std::pair<std::string, double>>
+		pvalues(size_t num_tests, uint64_t seed, double alternative)
+		{
+			std::mt19937_64 twister(seed);
+			std::uniform_real_distribution<double> uniform;
+
+			std::vector<std::pair<std::string, double>> result(num_tests);
+			for(size_t i = 0; i < num_tests; ++i) {
+				double p = uniform(twister);
+				if(uniform(twister) < alternative) {
+					// Beta(0.1, 1) distributed, i.e. concentrated near zero
+					p = std::pow(p, 10.0);
+				}
+				result[i] = std::make_pair("TEST_" + std::to_string(i), p);
+			}
+
+			return result;
+		}
+
+		RegulationFile<double> regulationNetwork(size_t num_genes,
+		                                         size_t num_regulators,
+		                                         size_t regulators_per_target,
+		                                         uint64_t seed)
+		{
+			RegulationFile<double> result(
+			    num_genes, std::numeric_limits<Matrix::index_type>::max());
+
+			for(const auto& e : regulations(num_genes, num_regulators,
+			                                regulators_per_target, seed)) {
+				result.addRegulation(e.first, e.second, 0.0);
+				result.increaseNumberOfTargets(e.first);
+			}
+
+			return result;
+		}
+
+		void writeRegulationNetwork(std::ostream& out, size_t num_genes,
+		                            size_t num_regulators,
+		                            size_t regulators_per_target,
+		                            uint64_t seed)
+		{
+			for(const auto& e : regulations(num_genes, num_regulators,
+			                                regulators_per_target, seed)) {
+				out << geneName(e.first) << '\t' << geneName(e.second) << '\n';
+			}
+		}
+	}
+}
@@ -0,0 +1,130 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_BENCHMARK_SYNTHETIC_DATA_H
+#define GT2_BENCHMARK_SYNTHETIC_DATA_H
+
+#include <genetrail2/core/Category.h>
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/EntityDatabase.h>
+#include <genetrail2/core/Scores.h>
+
+#include <genetrail2/regulation/RegulationFile.h>
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace GeneTrail
+{
+	/**
+	 * Generators for the synthetic data sets used by the benchmarks.
+	 *
+	 * All generators are deterministic for a given seed, so that timings
+	 * recorded at different points in time are comparable. Genes are named
+	 * GENE_0, GENE_1, ... in all generated files, which allows to combine
+	 * e.g. a generated matrix with a generated GMT file.
+	 */
+	namespace synthetic
+	{
+		/**
+		 * The name of the i-th synthetic gene.
+		 */
+		std::string geneName(size_t i);
+
+		/**
+		 * Creates an expression matrix with the given dimensions. Every gene
+		 * has its own base expression and noise level. For a fraction of
+		 * the genes the second half of the columns is shifted up- or
+		 * downwards, which mimics a two group experiment with
+		 * differentially expressed genes.
+		 *
+		 * @param rows         Number of genes.
+		 * @param cols         Number of samples.
+		 * @param seed         Seed of the random number generator.
+		 * @param differential Fraction of differentially expressed genes.
+		 */
+		DenseMatrix expressionMatrix(size_t rows, size_t cols, uint64_t seed,
+		                             double differential = 0.1);
+
+		/**
+		 * Draws category sizes from a log-uniform distribution. This
+		 * resembles the size distribution of curated databases, which
+		 * contain many small and only a few very large categories.
+		 */
+		std::vector<size_t> categorySizes(size_t num_categories,
+		                                  size_t min_size, size_t max_size,
+		                                  uint64_t seed);
+
+		/**
+		 * Creates categories over the genes GENE_0 ... GENE_{num_genes - 1}.
+		 * The sizes are drawn using categorySizes.
+		 */
+		std::vector<std::shared_ptr<Category>>
+		categories(EntityDatabase* db, size_t num_categories, size_t num_genes,
+		           uint64_t seed, size_t min_size = 5, size_t max_size = 500);
+
+		/**
+		 * Writes categories generated by categories() in GMT format.
+		 */
+		void writeGMT(std::ostream& out, size_t num_categories, size_t num_genes,
+		              uint64_t seed, size_t min_size = 5, size_t max_size = 500);
+
+		/**
+		 * Creates normally distributed scores for the genes
+		 * GENE_0 ... GENE_{num_genes - 1}.
+		 */
+		Scores scores(const std::shared_ptr<EntityDatabase>& db,
+		              size_t num_genes, uint64_t seed);
+
+		/**
+		 * Creates p-values for num_tests tests. A fraction of the tests is
+		 * drawn from the alternative and hence has small p-values, the
+		 * remaining ones are uniformly distributed.
+		 */
+		std::vector<std::pair<std::string, double>>
+		pvalues(size_t num_tests, uint64_t seed, double alternative = 0.1);
+
+		/**
+		 * Creates a regulatory network between the rows of an expression
+		 * matrix with num_genes rows. The first num_regulators rows act as
+		 * regulators. Every gene is regulated by regulators_per_target
+		 * regulators on average. The regulators are chosen with a bias
+		 * towards low indices, which creates hub regulators as observed in
+		 * real networks.
+		 */
+		RegulationFile<double> regulationNetwork(size_t num_genes,
+		                                         size_t num_regulators,
+		                                         size_t regulators_per_target,
+		                                         uint64_t seed);
+
+		/**
+		 * Writes a network generated by regulationNetwork() in the
+		 * "regulator target" format read by the RegulationFileParser.
+		 */
+		void writeRegulationNetwork(std::ostream& out, size_t num_genes,
+		                            size_t num_regulators,
+		                            size_t regulators_per_target,
+		                            uint64_t seed);
+	}
+}
+
+#endif // GT2_BENCHMARK_SYNTHETIC_DATA_H
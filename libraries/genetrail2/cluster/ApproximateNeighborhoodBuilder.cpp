@@ -0,0 +1,410 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ApproximateNeighborhoodBuilder.h"
+
+#include <genetrail2/core/Parallel.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+namespace GeneTrail
+{
+	typedef Eigen::Triplet<SparseMatrix::value_type> T;
+
+	static bool triple_equal(const T& a, const T& b) {
+		return (a.row() == b.row()) && (a.col() == b.col());
+	}
+
+	static bool triple_less(const T& a, const T& b) {
+		return a.row() < b.row() || ((a.row() == (b.row())) && a.col() < b.col());
+	}
+
+	static float similarity(const Eigen::MatrixXf& data, unsigned int i, unsigned int j)
+	{
+		// Rounding may lead to values slightly above one
+		return std::min(1.0f, std::fabs(data.col(i).dot(data.col(j))));
+	}
+
+	ApproximateNeighborhoodBuilder::ApproximateNeighborhoodBuilder()
+		: k_(10),
+		  num_trees_(8),
+		  leaf_size_(64),
+		  num_refinements_(1),
+		  seed_(0),
+		  num_threads_(0)
+	{
+	}
+
+	SparseMatrix ApproximateNeighborhoodBuilder::build(const DenseMatrix& mat) const
+	{
+		return buildMatrix_(findNeighbors_(mat), mat);
+	}
+
+	SparseMatrix ApproximateNeighborhoodBuilder::build(const DenseMatrix& mat, std::vector<std::vector<unsigned int>>& neighbor_lists) const
+	{
+		const unsigned int n = mat.rows();
+		const std::vector<Neighbor> neighbors = findNeighbors_(mat);
+
+		neighbor_lists.assign(n, std::vector<unsigned int>());
+		for(size_t idx = neighbors.size(); idx-- > 0;) {
+			const unsigned int j = neighbors[idx].second;
+			if(j != n) {
+				neighbor_lists[idx / k_].push_back(j);
+			}
+		}
+
+		return buildMatrix_(neighbors, mat);
+	}
+
+	std::vector<ApproximateNeighborhoodBuilder::Neighbor> ApproximateNeighborhoodBuilder::findNeighbors_(const DenseMatrix& mat) const
+	{
+		const unsigned int n = mat.rows();
+
+		if(n < 2 || k_ <= 0) {
+			return std::vector<Neighbor>();
+		}
+
+		Data data = standardize_(mat);
+
+		std::vector<std::vector<unsigned int>> orders(num_trees_);
+		std::vector<std::vector<unsigned int>> bounds(num_trees_);
+		std::vector<std::vector<unsigned int>> leaves(num_trees_);
+
+		parallel_for(0, num_trees_, [&](size_t t) {
+			buildTree_(data, seed_ + t, orders[t], bounds[t], leaves[t]);
+		}, num_threads_);
+
+		/*
+		 * The neighbors of row i are stored in [i * k_, (i + 1) * k_).
+		 * Every list is sorted in ascending order, the first entry always
+		 * is the worst neighbor found so far. Empty slots are marked with
+		 * a similarity of -1 and thus get replaced first.
+		 */
+		std::vector<Neighbor> neighbors(n * k_, Neighbor(-1.0f, n));
+
+		parallel_for(0, n, [&](size_t i) {
+			std::vector<unsigned int> candidates;
+
+			for(unsigned int t = 0; t < num_trees_; ++t) {
+				// Visit the leaf of the row and of its negation
+				for(unsigned int p : {(unsigned int)i, (unsigned int)i + n}) {
+					const unsigned int leaf = leaves[t][p];
+					for(unsigned int pos = bounds[t][leaf]; pos < bounds[t][leaf + 1]; ++pos) {
+						const unsigned int j = orders[t][pos] % n;
+						if(j != i) {
+							candidates.push_back(j);
+						}
+					}
+				}
+			}
+
+			std::sort(candidates.begin(), candidates.end());
+			auto end = std::unique(candidates.begin(), candidates.end());
+
+			auto list = neighbors.begin() + i * k_;
+			for(auto it = candidates.begin(); it != end; ++it) {
+				insert_(list, Neighbor(similarity(data, i, *it), *it));
+			}
+		}, num_threads_, 64);
+
+		// Free the trees before the refinement step
+		orders.clear();
+		bounds.clear();
+		leaves.clear();
+
+		for(unsigned int r = 0; r < num_refinements_; ++r) {
+			refine_(data, neighbors);
+		}
+
+		return neighbors;
+	}
+
+	ApproximateNeighborhoodBuilder::Data ApproximateNeighborhoodBuilder::standardize_(const DenseMatrix& mat) const
+	{
+		// We store the rows as columns, so that every variable
+		// occupies a contiguous block of memory.
+		Data data = mat.matrix().transpose().cast<float>();
+
+		parallel_for(0, data.cols(), [&data](size_t i) {
+			auto x = data.col(i);
+			x.array() -= x.mean();
+
+			const float norm = x.norm();
+			if(norm > 0.0f) {
+				x /= norm;
+			}
+		}, num_threads_, 256);
+
+		return data;
+	}
+
+	void ApproximateNeighborhoodBuilder::buildTree_(const Data& data, unsigned int seed, std::vector<unsigned int>& order, std::vector<unsigned int>& bounds, std::vector<unsigned int>& leaf) const
+	{
+		const unsigned int n = data.cols();
+
+		// Point p < n represents row p, point p >= n its negation
+		auto point = [&data, n](unsigned int p) {
+			return (p < n ? 1.0f : -1.0f) * data.col(p % n);
+		};
+
+		std::mt19937 gen(seed);
+
+		order.resize(2 * n);
+		std::iota(order.begin(), order.end(), 0u);
+
+		bounds.clear();
+		bounds.push_back(0);
+
+		std::vector<std::pair<float, unsigned int>> projections;
+		Eigen::VectorXf normal(data.rows());
+
+		// Depth first traversal. This results in leaves that are
+		// ordered by their position in the order array.
+		std::vector<std::pair<unsigned int, unsigned int>> stack;
+		stack.emplace_back(0, 2 * n);
+
+		while(!stack.empty()) {
+			const unsigned int begin = stack.back().first;
+			const unsigned int end = stack.back().second;
+			stack.pop_back();
+
+			if(end - begin <= std::max(leaf_size_, 2u)) {
+				bounds.push_back(end);
+				continue;
+			}
+
+			// The hyperplane is orthogonal to the difference of two random points
+			std::uniform_int_distribution<unsigned int> dist(begin, end - 1);
+			const unsigned int a = dist(gen);
+			unsigned int b = dist(gen);
+			while(b == a) {
+				b = dist(gen);
+			}
+
+			normal = point(order[a]) - point(order[b]);
+
+			projections.resize(end - begin);
+			for(unsigned int pos = begin; pos < end; ++pos) {
+				const unsigned int p = order[pos];
+				projections[pos - begin] = std::make_pair(point(p).dot(normal), p);
+			}
+
+			// Splitting at the median guarantees a balanced tree
+			const unsigned int half = (end - begin) / 2;
+			std::nth_element(projections.begin(), projections.begin() + half, projections.end());
+
+			for(unsigned int pos = begin; pos < end; ++pos) {
+				order[pos] = projections[pos - begin].second;
+			}
+
+			// Push the right child first, so that the left child gets processed first
+			stack.emplace_back(begin + half, end);
+			stack.emplace_back(begin, begin + half);
+		}
+
+		leaf.resize(2 * n);
+		for(unsigned int l = 0; l + 1 < bounds.size(); ++l) {
+			for(unsigned int pos = bounds[l]; pos < bounds[l + 1]; ++pos) {
+				leaf[order[pos]] = l;
+			}
+		}
+	}
+
+	void ApproximateNeighborhoodBuilder::insert_(std::vector<Neighbor>::iterator it, const Neighbor& v) const
+	{
+		// Is the new value better than the worst current value
+		if(v.first <= it->first) {
+			return;
+		}
+
+		// Is the candidate already present?
+		for(int i = 0; i < k_; ++i) {
+			if(it[i].second == v.second) {
+				return;
+			}
+		}
+
+		*it = v;
+
+		// Bubble-sort the entry to the right position
+		for(int i = 1; i < k_ && it[i - 1].first > it[i].first; ++i) {
+			std::swap(it[i - 1], it[i]);
+		}
+	}
+
+	void ApproximateNeighborhoodBuilder::refine_(const Data& data, std::vector<Neighbor>& neighbors) const
+	{
+		const unsigned int n = data.cols();
+
+		std::vector<Neighbor> result(neighbors);
+
+		parallel_for(0, n, [&](size_t i) {
+			std::vector<unsigned int> candidates;
+			candidates.reserve(k_ * k_);
+
+			for(int a = 0; a < k_; ++a) {
+				const unsigned int j = neighbors[i * k_ + a].second;
+				if(j == n) {
+					continue;
+				}
+
+				for(int b = 0; b < k_; ++b) {
+					const unsigned int l = neighbors[j * k_ + b].second;
+					if(l != n && l != i) {
+						candidates.push_back(l);
+					}
+				}
+			}
+
+			std::sort(candidates.begin(), candidates.end());
+			auto end = std::unique(candidates.begin(), candidates.end());
+
+			auto list = result.begin() + i * k_;
+			for(auto it = candidates.begin(); it != end; ++it) {
+				insert_(list, Neighbor(similarity(data, i, *it), *it));
+			}
+		}, num_threads_, 64);
+
+		neighbors.swap(result);
+	}
+
+	SparseMatrix ApproximateNeighborhoodBuilder::buildMatrix_(const std::vector<Neighbor>& neighbors, const DenseMatrix& mat) const
+	{
+		const unsigned int n = mat.rows();
+
+		// We allocate twice the (worst-case) storage needed, as we have
+		// to symmetrize the matrix afterwards.
+		std::vector<T> entries;
+		entries.reserve(2 * neighbors.size());
+
+		for(size_t idx = 0; idx < neighbors.size(); ++idx) {
+			const unsigned int i = idx / k_;
+			const unsigned int j = neighbors[idx].second;
+
+			if(j == n) {
+				continue;
+			}
+
+			entries.emplace_back(std::min(i, j), std::max(i, j), neighbors[idx].first);
+		}
+
+		// Make sure, that there are no duplicate entries
+		std::sort(entries.begin(), entries.end(), triple_less);
+		entries.erase(std::unique(entries.begin(), entries.end(), triple_equal), entries.end());
+
+		// Symmetrize the matrix
+		const size_t num_entries = entries.size();
+		for(size_t idx = 0; idx < num_entries; ++idx) {
+			entries.emplace_back(entries[idx].col(), entries[idx].row(), entries[idx].value());
+		}
+
+		SparseMatrix result(mat.rowNames(), mat.rowNames());
+
+		result.matrix().setFromTriplets(entries.begin(), entries.end());
+		result.matrix().makeCompressed();
+
+		return result;
+	}
+
+	double ApproximateNeighborhoodBuilder::estimateRecall(const DenseMatrix& mat, const std::vector<std::vector<unsigned int>>& neighbor_lists, unsigned int num_samples) const
+	{
+		const unsigned int n = mat.rows();
+
+		if(neighbor_lists.size() != n) {
+			throw std::invalid_argument("Expected one neighbor list per row of the matrix");
+		}
+
+		// There are no neighbors that could be missed
+		if(n < 2 || k_ <= 0 || num_samples == 0) {
+			return 1.0;
+		}
+
+		Data data = standardize_(mat);
+
+		std::vector<unsigned int> samples(n);
+		std::iota(samples.begin(), samples.end(), 0u);
+		std::shuffle(samples.begin(), samples.end(), std::mt19937(seed_));
+		samples.resize(std::min(num_samples, n));
+
+		const unsigned int k = std::min((unsigned int)k_, n - 1);
+
+		std::vector<unsigned int> hits(samples.size(), 0);
+
+		parallel_for(0, samples.size(), [&](size_t s) {
+			const unsigned int i = samples[s];
+
+			Eigen::VectorXf sims = (data.transpose() * data.col(i)).cwiseAbs();
+			sims[i] = -1.0f;
+
+			std::vector<unsigned int> exact(n);
+			std::iota(exact.begin(), exact.end(), 0u);
+			std::partial_sort(exact.begin(), exact.begin() + k, exact.end(),
+				[&sims](unsigned int a, unsigned int b) { return sims[a] > sims[b]; });
+
+			std::vector<unsigned int> found(neighbor_lists[i]);
+			std::sort(found.begin(), found.end());
+
+			for(unsigned int e = 0; e < k; ++e) {
+				if(std::binary_search(found.begin(), found.end(), exact[e])) {
+					++hits[s];
+				}
+			}
+		}, num_threads_);
+
+		const double total = std::accumulate(hits.begin(), hits.end(), 0.0);
+
+		return total / (k * samples.size());
+	}
+
+	void ApproximateNeighborhoodBuilder::setNumNeighbors(int k)
+	{
+		k_ = k;
+	}
+
+	void ApproximateNeighborhoodBuilder::setNumTrees(unsigned int num_trees)
+	{
+		num_trees_ = num_trees;
+	}
+
+	void ApproximateNeighborhoodBuilder::setLeafSize(unsigned int leaf_size)
+	{
+		leaf_size_ = leaf_size;
+	}
+
+	void ApproximateNeighborhoodBuilder::setNumRefinements(unsigned int num_refinements)
+	{
+		num_refinements_ = num_refinements;
+	}
+
+	void ApproximateNeighborhoodBuilder::setSeed(unsigned int seed)
+	{
+		seed_ = seed;
+	}
+
+	void ApproximateNeighborhoodBuilder::setNumThreads(unsigned int num_threads)
+	{
+		num_threads_ = num_threads;
+	}
+}
+
@@ -0,0 +1,151 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GT2_APPROXIMATE_NEIGHBORHOOD_BUILDER_H
+#define GT2_APPROXIMATE_NEIGHBORHOOD_BUILDER_H
+
+#include <genetrail2/core/macros.h>
+
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/SparseMatrix.h>
+
+#include <Eigen/Core>
+
+#include <vector>
+
+namespace GeneTrail
+{
+	/**
+	 * This class constructs an approximate sparse neighborhood graph
+	 * from a matrix of datapoints. It is a drop-in replacement for the
+	 * NeighborhoodBuilder for data sets where the exact, quadratic
+	 * all-pairs computation is too expensive.
+	 *
+	 * The rows of the matrix are centered and scaled to unit norm. For
+	 * such vectors the inner product equals the Pearson correlation.
+	 * As the NeighborhoodBuilder uses the absolute correlation as
+	 * similarity, every row is indexed twice: once with its original and
+	 * once with its negated values. A forest of random projection trees is
+	 * built over these points and all points sharing a leaf with a row (or
+	 * its negation) are considered as neighbor candidates. Afterwards, the
+	 * neighbor lists can be refined by additionally considering the
+	 * neighbors of the current neighbors.
+	 */
+	class GT2_EXPORT ApproximateNeighborhoodBuilder
+	{
+		public:
+			ApproximateNeighborhoodBuilder();
+
+			/**
+			 * Constructs the approximate neighborhood graph of the matrix rows.
+			 *
+			 * @param mat The data matrix. Currently rows are expected to hold
+			 *            the variables. The columns represent the samples.
+			 * @returns a neighborhood graph constructed in the following fashion:
+			 *          for each variable the k most similar datapoints among
+			 *          the candidates are chosen. This leads to a maximum
+			 *          number of edges of 2 * |V| * k
+			 */
+			SparseMatrix build(const DenseMatrix& mat) const;
+
+			/**
+			 * Constructs the approximate neighborhood graph of the matrix rows
+			 * and additionally returns the neighbors found for every row.
+			 *
+			 * @param mat            The data matrix.
+			 * @param neighbor_lists Receives the neighbors of every row in
+			 *                       descending order of similarity. In
+			 *                       contrast to the graph, the list of row i
+			 *                       does not contain the rows that only
+			 *                       have i as their neighbor.
+			 * @returns the same graph as build(mat)
+			 */
+			SparseMatrix build(const DenseMatrix& mat, std::vector<std::vector<unsigned int>>& neighbor_lists) const;
+
+			/**
+			 * Estimates the quality of the approximate neighbor lists by
+			 * comparing them to the exact k nearest neighbors of a random
+			 * sample of rows.
+			 *
+			 * @param mat            The data matrix the lists were built from.
+			 * @param neighbor_lists The neighbors of every row as returned
+			 *                       by build(mat, neighbor_lists).
+			 * @param num_samples    The number of rows for which the exact
+			 *                       neighbors should be computed.
+			 * @returns the fraction of exact neighbors that are present in
+			 *          the neighbor list of their row. 1 if no rows are
+			 *          sampled.
+			 */
+			double estimateRecall(const DenseMatrix& mat, const std::vector<std::vector<unsigned int>>& neighbor_lists, unsigned int num_samples) const;
+
+			/**
+			 * Set the number of neighbors to k
+			 */
+			void setNumNeighbors(int k);
+
+			/**
+			 * Set the number of random projection trees. More trees
+			 * increase the recall as well as the running time.
+			 */
+			void setNumTrees(unsigned int num_trees);
+
+			/**
+			 * Set the maximum number of points stored in a leaf of a
+			 * random projection tree.
+			 */
+			void setLeafSize(unsigned int leaf_size);
+
+			/**
+			 * Set the number of neighbor-of-neighbor refinement passes.
+			 */
+			void setNumRefinements(unsigned int num_refinements);
+
+			/**
+			 * Set the seed of the random number generator used for
+			 * building the trees.
+			 */
+			void setSeed(unsigned int seed);
+
+			/**
+			 * Set the number of threads. 0 uses all available cores.
+			 */
+			void setNumThreads(unsigned int num_threads);
+
+		private:
+			typedef Eigen::MatrixXf Data;
+			typedef std::pair<float, unsigned int> Neighbor;
+
+			int k_;
+			unsigned int num_trees_;
+			unsigned int leaf_size_;
+			unsigned int num_refinements_;
+			unsigned int seed_;
+			unsigned int num_threads_;
+
+			std::vector<Neighbor> findNeighbors_(const DenseMatrix& mat) const;
+			Data standardize_(const DenseMatrix& mat) const;
+			void buildTree_(const Data& data, unsigned int seed, std::vector<unsigned int>& order, std::vector<unsigned int>& bounds, std::vector<unsigned int>& leaf) const;
+			void insert_(std::vector<Neighbor>::iterator begin, const Neighbor& n) const;
+			void refine_(const Data& data, std::vector<Neighbor>& neighbors) const;
+			SparseMatrix buildMatrix_(const std::vector<Neighbor>& neighbors, const DenseMatrix& mat) const;
+	};
+}
+
+#endif // GT2_APPROXIMATE_NEIGHBORHOOD_BUILDER_H
+
@@ -12,6 +12,7 @@ SET(LIBNAME "CLUSTER")
 
 # We list all files separatly to be able to leave some out, if we do not want to compile them.
 
+add_to_library(ApproximateNeighborhoodBuilder)
 add_to_library(METISClusterer)
 add_to_library(NeighborhoodBuilder)
 
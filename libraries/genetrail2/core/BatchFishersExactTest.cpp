@@ -0,0 +1,228 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2018 Tim Kehl <tkehl@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "BatchFishersExactTest.h"
+
+#include "Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace GeneTrail
+{
+	// Number of tables whose point probabilities are computed in one go
+	static constexpr size_t BLOCK_SIZE = 1024;
+
+	const uint64_t BatchFishersExactTest::MAX_TABLE_SIZE;
+
+	BatchFishersExactTest::BatchFishersExactTest(uint64_t max_population)
+	    : log_factorial_(std::min(max_population + 1, MAX_TABLE_SIZE))
+	{
+		// lgamma is exact to a few ulp, summing up log(i) is not. The same
+		// function is used for numbers beyond the table.
+		for(uint64_t i = 0; i < log_factorial_.size(); ++i) {
+			log_factorial_[i] = std::lgamma(static_cast<double>(i) + 1.0);
+		}
+	}
+
+	double BatchFishersExactTest::logProbability(uint64_t m, uint64_t l,
+	                                             uint64_t n, uint64_t k) const
+	{
+		// Same order of operations as in pValues_, so that both give
+		// identical results.
+		const uint64_t t = l + k;
+		const uint64_t total = m + n;
+		return logFactorial_(n) - logFactorial_(k) - logFactorial_(n - k) +
+		       logFactorial_(m) - logFactorial_(l) - logFactorial_(m - l) -
+		       logFactorial_(total) + logFactorial_(t) +
+		       logFactorial_(total - t);
+	}
+
+	double BatchFishersExactTest::sumUpwards_(uint64_t m, uint64_t n,
+	                                          uint64_t t, uint64_t i) const
+	{
+		// Sum of P(j) / P(i) for j >= i
+		const uint64_t hi = std::min(n, t);
+		const double eps = std::numeric_limits<double>::epsilon();
+
+		double term = 1.0;
+		double sum = 1.0;
+		for(uint64_t j = i; j < hi; ++j) {
+			term *= (static_cast<double>(n - j) * static_cast<double>(t - j)) /
+			        (static_cast<double>(j + 1) *
+			         static_cast<double>(m + j + 1 - t));
+			sum += term;
+
+			if(term <= sum * eps) {
+				break;
+			}
+		}
+
+		return sum;
+	}
+
+	double BatchFishersExactTest::sumDownwards_(uint64_t m, uint64_t n,
+	                                            uint64_t t, uint64_t i) const
+	{
+		// Sum of P(j) / P(i) for j <= i
+		const uint64_t lo = t > m ? t - m : 0;
+		const double eps = std::numeric_limits<double>::epsilon();
+
+		double term = 1.0;
+		double sum = 1.0;
+		for(uint64_t j = i; j > lo; --j) {
+			term *= (static_cast<double>(j) * static_cast<double>(m + j - t)) /
+			        (static_cast<double>(n - j + 1) *
+			         static_cast<double>(t - j + 1));
+			sum += term;
+
+			if(term <= sum * eps) {
+				break;
+			}
+		}
+
+		return sum;
+	}
+
+	double BatchFishersExactTest::pValue_(uint64_t m, uint64_t l, uint64_t n,
+	                                      uint64_t k, double log_p,
+	                                      Tail tail) const
+	{
+		const uint64_t t = l + k;
+		const uint64_t lo = t > m ? t - m : 0;
+		const uint64_t hi = std::min(n, t);
+		const uint64_t mode = static_cast<uint64_t>(
+		    (static_cast<double>(n) + 1.0) * (static_cast<double>(t) + 1.0) /
+		    (static_cast<double>(m + n) + 2.0));
+
+		// Only sum the side of k that does not contain the mode. The
+		// other side is obtained as the complement.
+		double p;
+		if(tail == Tail::Upper) {
+			if(k >= mode) {
+				p = std::exp(log_p) * sumUpwards_(m, n, t, k);
+			} else if(k == lo) {
+				return 1.0;
+			} else {
+				p = 1.0 - std::exp(logProbability(m, l + 1, n, k - 1)) *
+				              sumDownwards_(m, n, t, k - 1);
+			}
+		} else {
+			if(k <= mode) {
+				p = std::exp(log_p) * sumDownwards_(m, n, t, k);
+			} else if(k == hi) {
+				return 1.0;
+			} else {
+				p = 1.0 - std::exp(logProbability(m, l - 1, n, k + 1)) *
+				              sumUpwards_(m, n, t, k + 1);
+			}
+		}
+
+		return std::min(1.0, std::max(0.0, p));
+	}
+
+	double BatchFishersExactTest::pValue(uint64_t m, uint64_t l, uint64_t n,
+	                                     uint64_t k, Tail tail) const
+	{
+		return pValue_(m, l, n, k, logProbability(m, l, n, k), tail);
+	}
+
+	double BatchFishersExactTest::lowerTailedPValue(uint64_t m, uint64_t l,
+	                                                uint64_t n,
+	                                                uint64_t k) const
+	{
+		return pValue(m, l, n, k, Tail::Lower);
+	}
+
+	double BatchFishersExactTest::upperTailedPValue(uint64_t m, uint64_t l,
+	                                                uint64_t n,
+	                                                uint64_t k) const
+	{
+		return pValue(m, l, n, k, Tail::Upper);
+	}
+
+	template <typename TailOf>
+	std::vector<double> BatchFishersExactTest::pValues_(
+	    const std::vector<uint64_t>& m, const std::vector<uint64_t>& l,
+	    const std::vector<uint64_t>& n, const std::vector<uint64_t>& k,
+	    TailOf tail_of, size_t num_threads) const
+	{
+		std::vector<double> result(m.size());
+
+		const size_t num_blocks = (m.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+		parallel_for(0, num_blocks, [&](size_t block) {
+			const size_t begin = block * BLOCK_SIZE;
+			const size_t end = std::min(m.size(), begin + BLOCK_SIZE);
+
+			// The point probabilities are computed in a separate, branch
+			// free loop, so that the compiler is free to vectorize it. Only
+			// the tail sums depend on the individual table.
+			std::array<double, BLOCK_SIZE> log_p;
+
+			// All arguments of the log-factorials are at most m + n
+			uint64_t max_total = 0;
+			for(size_t i = begin; i < end; ++i) {
+				max_total = std::max(max_total, m[i] + n[i]);
+			}
+
+			if(max_total < log_factorial_.size()) {
+				const double* lf = log_factorial_.data();
+				for(size_t i = begin; i < end; ++i) {
+					const uint64_t t = l[i] + k[i];
+					const uint64_t total = m[i] + n[i];
+					log_p[i - begin] = lf[n[i]] - lf[k[i]] - lf[n[i] - k[i]] +
+					                   lf[m[i]] - lf[l[i]] - lf[m[i] - l[i]] -
+					                   lf[total] + lf[t] + lf[total - t];
+				}
+			} else {
+				for(size_t i = begin; i < end; ++i) {
+					log_p[i - begin] = logProbability(m[i], l[i], n[i], k[i]);
+				}
+			}
+
+			for(size_t i = begin; i < end; ++i) {
+				result[i] = pValue_(m[i], l[i], n[i], k[i], log_p[i - begin],
+				                    tail_of(i));
+			}
+		}, num_threads);
+
+		return result;
+	}
+
+	std::vector<double> BatchFishersExactTest::pValues(
+	    const std::vector<uint64_t>& m, const std::vector<uint64_t>& l,
+	    const std::vector<uint64_t>& n, const std::vector<uint64_t>& k,
+	    Tail tail, size_t num_threads) const
+	{
+		return pValues_(m, l, n, k, [tail](size_t) { return tail; },
+		                num_threads);
+	}
+
+	std::vector<double> BatchFishersExactTest::pValues(
+	    const std::vector<uint64_t>& m, const std::vector<uint64_t>& l,
+	    const std::vector<uint64_t>& n, const std::vector<uint64_t>& k,
+	    const std::vector<Tail>& tails, size_t num_threads) const
+	{
+		return pValues_(m, l, n, k, [&tails](size_t i) { return tails[i]; },
+		                num_threads);
+	}
+}
@@ -0,0 +1,128 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2018 Tim Kehl <tkehl@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_CORE_BATCH_FISHERS_EXACT_TEST_H
+#define GT2_CORE_BATCH_FISHERS_EXACT_TEST_H
+
+#include "macros.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace GeneTrail
+{
+	/**
+	 * Fisher's exact test for large numbers of 2x2 tables.
+	 *
+	 * The parameters have the same meaning as in FishersExactTest. In
+	 * contrast to FishersExactTest, no binomial coefficients are evaluated.
+	 * The probability of the observed table is computed from a table of
+	 * log-factorials that is shared by all tests, and the remaining
+	 * probabilities of the tail are obtained from the ratio of consecutive
+	 * probabilities. Tails are always summed starting at the side closer to
+	 * the mode, i.e. with decreasing terms, so that the sum can stop as soon
+	 * as the terms no longer change the result.
+	 *
+	 * The table holds at most MAX_TABLE_SIZE entries. Log-factorials of
+	 * larger numbers are computed on demand, which gives identical results.
+	 *
+	 * All computations are done in double precision.
+	 */
+	class GT2_EXPORT BatchFishersExactTest
+	{
+		public:
+		/**
+		 * Which tail of the distribution is used as p-value.
+		 */
+		enum class Tail { Lower, Upper };
+
+		/// Maximum number of precomputed log-factorials (8 MiB)
+		static const uint64_t MAX_TABLE_SIZE = 1 << 20;
+
+		/**
+		 * @param max_population The largest m + n of the tables that will
+		 *                       be tested. Larger tables are supported, but
+		 *                       slower.
+		 */
+		explicit BatchFishersExactTest(uint64_t max_population);
+
+		/**
+		 * The natural logarithm of the probability of observing exactly k
+		 * successes.
+		 */
+		double logProbability(uint64_t m, uint64_t l, uint64_t n,
+		                      uint64_t k) const;
+
+		double lowerTailedPValue(uint64_t m, uint64_t l, uint64_t n,
+		                         uint64_t k) const;
+
+		double upperTailedPValue(uint64_t m, uint64_t l, uint64_t n,
+		                         uint64_t k) const;
+
+		double pValue(uint64_t m, uint64_t l, uint64_t n, uint64_t k,
+		              Tail tail) const;
+
+		/**
+		 * Computes the p-values of the tables (m[i], l[i], n[i], k[i])
+		 * using num_threads threads (0 selects the number of hardware
+		 * threads).
+		 */
+		std::vector<double> pValues(const std::vector<uint64_t>& m,
+		                            const std::vector<uint64_t>& l,
+		                            const std::vector<uint64_t>& n,
+		                            const std::vector<uint64_t>& k, Tail tail,
+		                            size_t num_threads = 0) const;
+
+		/**
+		 * As above, but with a separate tail for every table.
+		 */
+		std::vector<double> pValues(const std::vector<uint64_t>& m,
+		                            const std::vector<uint64_t>& l,
+		                            const std::vector<uint64_t>& n,
+		                            const std::vector<uint64_t>& k,
+		                            const std::vector<Tail>& tails,
+		                            size_t num_threads = 0) const;
+
+		private:
+		template <typename TailOf>
+		std::vector<double> pValues_(const std::vector<uint64_t>& m,
+		                             const std::vector<uint64_t>& l,
+		                             const std::vector<uint64_t>& n,
+		                             const std::vector<uint64_t>& k,
+		                             TailOf tail_of, size_t num_threads) const;
+
+		double logFactorial_(uint64_t i) const
+		{
+			return i < log_factorial_.size()
+			           ? log_factorial_[i]
+			           : std::lgamma(static_cast<double>(i) + 1.0);
+		}
+
+		double sumUpwards_(uint64_t m, uint64_t n, uint64_t t, uint64_t i) const;
+		double sumDownwards_(uint64_t m, uint64_t n, uint64_t t, uint64_t i) const;
+		double pValue_(uint64_t m, uint64_t l, uint64_t n, uint64_t k,
+		               double log_p, Tail tail) const;
+
+		std::vector<double> log_factorial_;
+	};
+}
+
+#endif // GT2_CORE_BATCH_FISHERS_EXACT_TEST_H
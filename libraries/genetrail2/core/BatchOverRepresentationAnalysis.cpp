@@ -0,0 +1,123 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2018 Tim Kehl <tkehl@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "BatchOverRepresentationAnalysis.h"
+
+#include "BinaryCategoryDatabase.h"
+#include "CategoryDatabase.h"
+
+#include <algorithm>
+
+namespace GeneTrail
+{
+	template <typename ForEachMember>
+	void BatchOverRepresentationAnalysis::index_(ForEachMember for_each_member,
+	                                             const Category& reference_set)
+	{
+		size_t max_id = 0;
+		for(size_t i = 0; i < size(); ++i) {
+			for_each_member(i, [&max_id](size_t id) {
+				max_id = std::max(max_id, id + 1);
+			});
+		}
+
+		// Count the categories per entity, then turn the counts into
+		// offsets and fill in the category indices.
+		offsets_.assign(max_id + 1, 0);
+		for(size_t i = 0; i < size(); ++i) {
+			for_each_member(i, [this](size_t id) { ++offsets_[id + 1]; });
+		}
+
+		for(size_t i = 1; i < offsets_.size(); ++i) {
+			offsets_[i] += offsets_[i - 1];
+		}
+
+		categories_.resize(offsets_.back());
+		std::vector<size_t> next(offsets_.begin(), offsets_.end() - 1);
+		for(size_t i = 0; i < size(); ++i) {
+			for_each_member(i, [this, &next, i](size_t id) {
+				categories_[next[id]++] = static_cast<uint32_t>(i);
+			});
+		}
+
+		forEachHit_(reference_set,
+		            [this](uint32_t c, size_t) { ++reference_hits_[c]; });
+	}
+
+	BatchOverRepresentationAnalysis::BatchOverRepresentationAnalysis(
+	    const CategoryDatabase& categories, const Category& reference_set)
+	    : reference_hits_(categories.size(), 0),
+	      reference_bits_(reference_set),
+	      reference_size_(reference_set.size())
+	{
+		index_(
+		    [&categories](size_t i, auto callback) {
+			    for(size_t id : categories[i]) {
+				    callback(id);
+			    }
+		    },
+		    reference_set);
+	}
+
+	BatchOverRepresentationAnalysis::BatchOverRepresentationAnalysis(
+	    const BinaryCategoryDatabase& categories,
+	    const std::vector<size_t>& entity_ids, const Category& reference_set)
+	    : reference_hits_(categories.size(), 0),
+	      reference_bits_(reference_set),
+	      reference_size_(reference_set.size())
+	{
+		index_(
+		    [&categories, &entity_ids](size_t i, auto callback) {
+			    for(auto it = categories.begin(i); it != categories.end(i); ++it) {
+				    callback(entity_ids[*it]);
+			    }
+		    },
+		    reference_set);
+	}
+
+	std::vector<size_t>
+	BatchOverRepresentationAnalysis::testHits(const Category& test_set) const
+	{
+		std::vector<size_t> result(size(), 0);
+		forEachHit_(test_set, [&result](uint32_t c, size_t) { ++result[c]; });
+		return result;
+	}
+
+	std::vector<std::vector<size_t>>
+	BatchOverRepresentationAnalysis::testMembers(const Category& test_set) const
+	{
+		// As the test set is traversed in increasing order, the members
+		// of every category are sorted.
+		std::vector<std::vector<size_t>> result(size());
+		forEachHit_(test_set, [&result](uint32_t c, size_t id) {
+			result[c].push_back(id);
+		});
+		return result;
+	}
+
+	OverRepresentationAnalysis
+	BatchOverRepresentationAnalysis::test(const Category& test_set) const
+	{
+		const bool is_subset =
+		    reference_bits_.intersectionSize(test_set) == test_set.size();
+
+		return OverRepresentationAnalysis(reference_size_, test_set.size(),
+		                                  is_subset);
+	}
+}
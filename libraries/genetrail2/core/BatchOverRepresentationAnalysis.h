@@ -0,0 +1,139 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2018 Tim Kehl <tkehl@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_CORE_BATCH_OVER_REPRESENTATION_ANALYSIS_H
+#define GT2_CORE_BATCH_OVER_REPRESENTATION_ANALYSIS_H
+
+#include "macros.h"
+
+#include "Category.h"
+#include "EntityBitmap.h"
+#include "OverRepresentationAnalysis.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace GeneTrail
+{
+	class BinaryCategoryDatabase;
+	class CategoryDatabase;
+
+	/**
+	 * Over-representation analysis of all categories of a CategoryDatabase
+	 * at once.
+	 *
+	 * On construction an inverted index mapping every entity to the
+	 * categories containing it is built and the number of reference set
+	 * members of every category is counted. Afterwards the hits of a test
+	 * set are obtained by walking the members of the test set only,
+	 * instead of intersecting the test set with every category.
+	 *
+	 * Categories are identified by their position in the database. The
+	 * object is immutable after construction and can be shared between
+	 * threads.
+	 */
+	class GT2_EXPORT BatchOverRepresentationAnalysis
+	{
+		public:
+		BatchOverRepresentationAnalysis(const CategoryDatabase& categories,
+		                                const Category& reference_set);
+
+		/**
+		 * Indexes a binary category database directly, without creating a
+		 * Category for each of its entries.
+		 *
+		 * @param entity_ids The id of every entity of the binary database
+		 *                   in the EntityDatabase of the reference set, as
+		 *                   returned by BinaryCategoryDatabase::entityIds.
+		 */
+		BatchOverRepresentationAnalysis(const BinaryCategoryDatabase& categories,
+		                                const std::vector<size_t>& entity_ids,
+		                                const Category& reference_set);
+
+		/**
+		 * The number of indexed categories.
+		 */
+		size_t size() const { return reference_hits_.size(); }
+
+		/**
+		 * The size of the reference set.
+		 */
+		size_t referenceSize() const { return reference_size_; }
+
+		/**
+		 * The number of members of every category contained in the
+		 * reference set.
+		 */
+		const std::vector<size_t>& referenceHits() const
+		{
+			return reference_hits_;
+		}
+
+		/**
+		 * Counts the members of every category contained in the test set.
+		 */
+		std::vector<size_t> testHits(const Category& test_set) const;
+
+		/**
+		 * Collects the members of every category contained in the test
+		 * set. The ids of every category are sorted.
+		 */
+		std::vector<std::vector<size_t>>
+		testMembers(const Category& test_set) const;
+
+		/**
+		 * Creates the test used to compute p-values for the given test set
+		 * from the number of hits. As in OverRepresentationAnalysis, the
+		 * hypergeometric test is used if the test set is a subset of the
+		 * reference set and Fisher's exact test otherwise.
+		 */
+		OverRepresentationAnalysis test(const Category& test_set) const;
+
+		private:
+		template <typename ForEachMember>
+		void index_(ForEachMember for_each_member, const Category& reference_set);
+
+		template <typename Callback>
+		void forEachHit_(const Category& set, Callback callback) const
+		{
+			const size_t max_id = offsets_.size() - 1;
+			for(size_t id : set) {
+				if(id >= max_id) {
+					// Ids are sorted, no later id is contained in a category
+					break;
+				}
+
+				for(size_t i = offsets_[id]; i < offsets_[id + 1]; ++i) {
+					callback(categories_[i], id);
+				}
+			}
+		}
+
+		// Categories containing entity i are
+		// categories_[offsets_[i]] ... categories_[offsets_[i + 1] - 1]
+		std::vector<size_t> offsets_;
+		std::vector<uint32_t> categories_;
+
+		std::vector<size_t> reference_hits_;
+		EntityBitmap reference_bits_;
+		size_t reference_size_;
+	};
+}
+
+#endif // GT2_CORE_BATCH_OVER_REPRESENTATION_ANALYSIS_H
@@ -0,0 +1,261 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "BinaryCategoryDatabase.h"
+
+#include "EntityDatabase.h"
+#include "Exception.h"
+#include "GMTFile.h"
+#include "JsonCategoryFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace GeneTrail
+{
+	namespace
+	{
+		const char MAGIC[8] = {'G', 'T', '2', 'C', 'A', 'T', 'D', 'B'};
+		const uint32_t VERSION = 1;
+
+		uint64_t align(uint64_t offset) { return (offset + 7) & ~uint64_t(7); }
+
+		template <typename T>
+		void writeSection(std::ofstream& out, uint64_t offset,
+		                  const std::vector<T>& data)
+		{
+			static const char zeros[8] = {};
+			const uint64_t pos = static_cast<uint64_t>(out.tellp());
+			out.write(zeros, offset - pos);
+			out.write(reinterpret_cast<const char*>(data.data()),
+			          data.size() * sizeof(T));
+		}
+
+		bool endsWith(const std::string& s, const std::string& suffix)
+		{
+			return s.size() >= suffix.size() &&
+			       s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+		}
+
+		bool isMonotonic(const uint64_t* offsets, uint64_t size)
+		{
+			return offsets[0] == 0 &&
+			       std::is_sorted(offsets, offsets + size + 1);
+		}
+	}
+
+	BinaryCategoryDatabase::BinaryCategoryDatabase(const std::string& path)
+	{
+		try {
+			file_.open(path);
+		} catch(const std::exception&) {
+			throw IOError("File (" + path + ") is not open for reading");
+		}
+
+		if(file_.size() < sizeof(Header)) {
+			throw IOError("File (" + path + ") is not a binary category database");
+		}
+
+		header_ = reinterpret_cast<const Header*>(file_.data());
+		if(std::memcmp(header_->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+		   header_->version != VERSION) {
+			throw IOError("File (" + path + ") is not a binary category database");
+		}
+
+		const uint64_t expected_strings =
+		    header_->number_of_entities + 2 * header_->number_of_categories +
+		    NUMBER_OF_ATTRIBUTES;
+		if(header_->number_of_strings != expected_strings) {
+			throw IOError("Binary category database (" + path + ") is corrupt");
+		}
+
+		string_offsets_ = section_<uint64_t>(header_->string_offsets, header_->number_of_strings + 1);
+		string_data_ = section_<char>(header_->string_data, string_offsets_[header_->number_of_strings]);
+		member_offsets_ = section_<uint64_t>(header_->member_offsets, header_->number_of_categories + 1);
+		members_ = section_<uint32_t>(header_->members, member_offsets_[header_->number_of_categories]);
+
+		// The members are used as indices into the entity names.
+		const uint64_t number_of_entities = header_->number_of_entities;
+		if(!isMonotonic(string_offsets_, header_->number_of_strings) ||
+		   !isMonotonic(member_offsets_, header_->number_of_categories) ||
+		   !std::all_of(members_, members_ + member_offsets_[header_->number_of_categories],
+		                [number_of_entities](uint32_t e) { return e < number_of_entities; })) {
+			throw IOError("Binary category database (" + path + ") is corrupt");
+		}
+	}
+
+	template <typename T>
+	const T* BinaryCategoryDatabase::section_(uint64_t offset, uint64_t count) const
+	{
+		if(offset % alignof(T) != 0 || offset > file_.size() ||
+		   count > (file_.size() - offset) / sizeof(T)) {
+			throw IOError("Binary category database is corrupt");
+		}
+
+		return reinterpret_cast<const T*>(file_.data() + offset);
+	}
+
+	bool BinaryCategoryDatabase::isBinaryCategoryDatabase(const std::string& path)
+	{
+		std::ifstream input(path, std::ios::binary);
+		char magic[sizeof(MAGIC)];
+		return input.read(magic, sizeof(magic)) &&
+		       std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+	}
+
+	void BinaryCategoryDatabase::write(const CategoryDatabase& db,
+	                                   const std::string& path)
+	{
+		// Only the entities that are part of a category are stored. They
+		// are renumbered in the order of their ids, so that the members of
+		// every category stay sorted.
+		std::vector<size_t> entities;
+		for(const auto& c : db) {
+			entities.insert(entities.end(), c.begin(), c.end());
+		}
+		std::sort(entities.begin(), entities.end());
+		entities.erase(std::unique(entities.begin(), entities.end()), entities.end());
+
+		if(entities.size() > std::numeric_limits<uint32_t>::max()) {
+			throw IOError("Too many entities for a binary category database");
+		}
+
+		std::vector<std::string> strings;
+		strings.reserve(entities.size() + 2 * db.size() + NUMBER_OF_ATTRIBUTES);
+		for(size_t e : entities) {
+			strings.push_back(db.entityDatabase()->name(e));
+		}
+
+		std::vector<uint64_t> member_offsets(1, 0);
+		std::vector<uint32_t> members;
+		for(const auto& c : db) {
+			strings.push_back(c.name());
+			strings.push_back(c.reference());
+			for(size_t e : c) {
+				members.push_back(static_cast<uint32_t>(
+				    std::lower_bound(entities.begin(), entities.end(), e) -
+				    entities.begin()));
+			}
+			member_offsets.push_back(members.size());
+		}
+
+		strings.push_back(db.name());
+		strings.push_back(db.editor().name);
+		strings.push_back(db.editor().email);
+		strings.push_back(db.creationDate());
+		strings.push_back(db.sourceUrl());
+		strings.push_back(db.identifier());
+
+		std::vector<uint64_t> string_offsets(1, 0);
+		std::vector<char> string_data;
+		for(const auto& s : strings) {
+			string_data.insert(string_data.end(), s.begin(), s.end());
+			string_offsets.push_back(string_data.size());
+		}
+
+		Header header;
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+		header.version = VERSION;
+		header.number_of_entities = entities.size();
+		header.number_of_categories = db.size();
+		header.number_of_strings = strings.size();
+		header.string_offsets = align(sizeof(Header));
+		header.string_data = align(header.string_offsets + string_offsets.size() * sizeof(uint64_t));
+		header.member_offsets = align(header.string_data + string_data.size());
+		header.members = align(header.member_offsets + member_offsets.size() * sizeof(uint64_t));
+
+		std::ofstream out(path, std::ios::binary);
+		if(!out) {
+			throw IOError("File (" + path + ") is not open for writing");
+		}
+
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		writeSection(out, header.string_offsets, string_offsets);
+		writeSection(out, header.string_data, string_data);
+		writeSection(out, header.member_offsets, member_offsets);
+		writeSection(out, header.members, members);
+
+		if(!out) {
+			throw IOError("Could not write binary category database (" + path + ")");
+		}
+	}
+
+	std::vector<size_t> BinaryCategoryDatabase::entityIds(EntityDatabase& db) const
+	{
+		std::vector<size_t> ids(numberOfEntities());
+		for(size_t i = 0; i < ids.size(); ++i) {
+			ids[i] = db.index(entityName(i));
+		}
+		return ids;
+	}
+
+	CategoryDatabase BinaryCategoryDatabase::toCategoryDatabase(
+	    const std::shared_ptr<EntityDatabase>& db) const
+	{
+		const auto ids = entityIds(*db);
+
+		CategoryDatabase result(db);
+		result.setName(databaseName());
+		result.editor().name = editorName();
+		result.editor().email = editorEmail();
+		result.setCreationDate(creationDate());
+		result.setSourceUrl(sourceUrl());
+		result.setIdentifier(identifier());
+
+		result.reserve(size());
+		std::vector<size_t> members;
+		for(size_t i = 0; i < size(); ++i) {
+			members.clear();
+			for(auto it = begin(i); it != end(i); ++it) {
+				members.push_back(ids[*it]);
+			}
+
+			auto& c = result.addCategory(members.begin(), members.end());
+			c.setName(name(i));
+			c.setReference(reference(i));
+		}
+
+		return result;
+	}
+
+	CategoryDatabase readCategoryDatabase(const std::shared_ptr<EntityDatabase>& db,
+	                                      const std::string& path)
+	{
+		if(BinaryCategoryDatabase::isBinaryCategoryDatabase(path)) {
+			return BinaryCategoryDatabase(path).toCategoryDatabase(db);
+		}
+
+		if(endsWith(path, ".json")) {
+			JsonCategoryFile input(db, path);
+			if(!input) {
+				throw IOError("File (" + path + ") is not open for reading");
+			}
+			return input.read();
+		}
+
+		GMTFile input(db, path);
+		if(!input) {
+			throw IOError("File (" + path + ") is not open for reading");
+		}
+		return input.read();
+	}
+}
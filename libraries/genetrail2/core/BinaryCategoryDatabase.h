@@ -0,0 +1,186 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_CORE_BINARY_CATEGORY_DATABASE_H
+#define GT2_CORE_BINARY_CATEGORY_DATABASE_H
+
+#include "CategoryDatabase.h"
+
+#include "macros.h"
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace GeneTrail
+{
+	class EntityDatabase;
+
+	/**
+	 * A read-only view of a category database stored in a precompiled
+	 * binary format.
+	 *
+	 * The file is memory mapped. It contains a string table with all entity
+	 * and category names and, for every category, a sorted array of entity
+	 * ids. Opening a database thus requires no parsing, and the members of
+	 * a category can be accessed without allocating a string per gene.
+	 *
+	 * Layout (all integers in host byte order, all sections 8 byte aligned):
+	 *  - Header (magic, version, counts and section offsets)
+	 *  - String offsets (uint64, number_of_strings + 1) and characters.
+	 *    The first number_of_entities strings are the entity names, followed
+	 *    by the name and the reference of every category and the database
+	 *    attributes.
+	 *  - Member offsets (uint64, number_of_categories + 1) and members
+	 *    (uint32, sorted per category)
+	 *
+	 * Entities are numbered in the order of their ids in the EntityDatabase
+	 * of the written CategoryDatabase.
+	 */
+	class GT2_EXPORT BinaryCategoryDatabase
+	{
+	  public:
+		using const_iterator = const uint32_t*;
+
+		/**
+		 * Memory maps the given file.
+		 *
+		 * @throws IOError if the file cannot be opened or is not a valid
+		 *         binary category database.
+		 */
+		explicit BinaryCategoryDatabase(const std::string& path);
+
+		/**
+		 * Checks whether the file starts with the magic number of the binary
+		 * category database format.
+		 */
+		static bool isBinaryCategoryDatabase(const std::string& path);
+
+		/**
+		 * Writes the given database in the binary format.
+		 *
+		 * @throws IOError if the file cannot be written.
+		 */
+		static void write(const CategoryDatabase& db, const std::string& path);
+
+		/// The number of categories
+		size_t size() const { return header_->number_of_categories; }
+
+		/// The number of distinct entities in all categories
+		size_t numberOfEntities() const { return header_->number_of_entities; }
+
+		std::string entityName(size_t i) const { return string_(i); }
+
+		std::string name(size_t i) const
+		{
+			return string_(numberOfEntities() + 2 * i);
+		}
+
+		std::string reference(size_t i) const
+		{
+			return string_(numberOfEntities() + 2 * i + 1);
+		}
+
+		/// The sorted entity ids of the i-th category
+		const_iterator begin(size_t i) const { return members_ + member_offsets_[i]; }
+		const_iterator end(size_t i) const { return members_ + member_offsets_[i + 1]; }
+
+		std::string databaseName() const { return attribute_(NAME); }
+		std::string editorName() const { return attribute_(EDITOR_NAME); }
+		std::string editorEmail() const { return attribute_(EDITOR_EMAIL); }
+		std::string creationDate() const { return attribute_(CREATION_DATE); }
+		std::string sourceUrl() const { return attribute_(SOURCE_URL); }
+		std::string identifier() const { return attribute_(IDENTIFIER); }
+
+		/**
+		 * Registers all entities with the given EntityDatabase.
+		 *
+		 * @returns The id in db for every entity of this database.
+		 */
+		std::vector<size_t> entityIds(EntityDatabase& db) const;
+
+		/**
+		 * Creates a CategoryDatabase containing all categories. Every entity
+		 * name is looked up only once.
+		 */
+		CategoryDatabase toCategoryDatabase(const std::shared_ptr<EntityDatabase>& db) const;
+
+		struct Header
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t reserved;
+			uint64_t number_of_entities;
+			uint64_t number_of_categories;
+			uint64_t number_of_strings;
+			uint64_t string_offsets;
+			uint64_t string_data;
+			uint64_t member_offsets;
+			uint64_t members;
+		};
+
+	  private:
+		enum Attribute
+		{
+			NAME,
+			EDITOR_NAME,
+			EDITOR_EMAIL,
+			CREATION_DATE,
+			SOURCE_URL,
+			IDENTIFIER,
+			NUMBER_OF_ATTRIBUTES
+		};
+
+		std::string string_(size_t i) const
+		{
+			return std::string(string_data_ + string_offsets_[i],
+			                   string_offsets_[i + 1] - string_offsets_[i]);
+		}
+
+		std::string attribute_(Attribute a) const
+		{
+			return string_(numberOfEntities() + 2 * size() + a);
+		}
+
+		template <typename T> const T* section_(uint64_t offset, uint64_t count) const;
+
+		boost::iostreams::mapped_file_source file_;
+		const Header* header_;
+		const uint64_t* string_offsets_;
+		const char* string_data_;
+		const uint64_t* member_offsets_;
+		const uint32_t* members_;
+	};
+
+	/**
+	 * Reads a category database from a binary, JSON or GMT file. The format
+	 * is determined by the magic number of binary files and by the ".json"
+	 * extension of JSON files. All other files are read as GMT files.
+	 *
+	 * @throws IOError if the file cannot be read.
+	 */
+	GT2_EXPORT CategoryDatabase
+	readCategoryDatabase(const std::shared_ptr<EntityDatabase>& db,
+	                     const std::string& path);
+}
+
+#endif // GT2_CORE_BINARY_CATEGORY_DATABASE_H
@@ -0,0 +1,189 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2018 Tim Kehl <tkehl@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "BinaryEnrichmentResults.h"
+
+#include "Exception.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace GeneTrail
+{
+	namespace
+	{
+		const char MAGIC[8] = {'G', 'T', '2', 'E', 'N', 'R', 'E', 'S'};
+		const uint32_t VERSION = 1;
+
+		uint64_t align(uint64_t offset) { return (offset + 7) & ~uint64_t(7); }
+
+		template <typename T>
+		void writeSection(std::ofstream& out, uint64_t offset,
+		                  const std::vector<T>& data)
+		{
+			static const char zeros[8] = {};
+			const uint64_t pos = static_cast<uint64_t>(out.tellp());
+			out.write(zeros, offset - pos);
+			out.write(reinterpret_cast<const char*>(data.data()),
+			          data.size() * sizeof(T));
+		}
+
+		template <typename T>
+		void readSection(const std::vector<char>& buffer, uint64_t offset,
+		                 uint64_t count, std::vector<T>& data,
+		                 const std::string& path)
+		{
+			if(offset > buffer.size() ||
+			   count > (buffer.size() - offset) / sizeof(T)) {
+				throw IOError("Binary enrichment result file (" + path + ") is corrupt");
+			}
+
+			data.resize(count);
+			std::memcpy(data.data(), buffer.data() + offset, count * sizeof(T));
+		}
+	}
+
+	bool BinaryEnrichmentResults::isBinaryEnrichmentResults(const std::string& path)
+	{
+		std::ifstream input(path, std::ios::binary);
+		char magic[sizeof(MAGIC)];
+		return input.read(magic, sizeof(magic)) &&
+		       std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+	}
+
+	void BinaryEnrichmentResults::write(const EnrichmentResultColumns& results,
+	                                    const std::string& path)
+	{
+		const size_t n = results.size();
+		if(results.references.size() != n || results.hits.size() != n ||
+		   results.scores.size() != n || results.expected_scores.size() != n ||
+		   results.pvalues.size() != n || results.enriched.size() != n ||
+		   (!results.members.empty() && results.members.size() != n)) {
+			throw std::invalid_argument("All result columns must have the same size.");
+		}
+
+		std::vector<uint64_t> string_offsets(1, 0);
+		std::vector<char> string_data;
+		auto addStrings = [&](const std::vector<std::string>& strings) {
+			for(const auto& s : strings) {
+				string_data.insert(string_data.end(), s.begin(), s.end());
+				string_offsets.push_back(string_data.size());
+			}
+		};
+		addStrings(results.names);
+		addStrings(results.references);
+		addStrings(results.members);
+
+		Header header;
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+		header.version = VERSION;
+		header.has_members = results.members.empty() ? 0 : 1;
+		header.number_of_categories = n;
+		header.number_of_strings = string_offsets.size() - 1;
+		header.string_offsets = align(sizeof(Header));
+		header.string_data = align(header.string_offsets + string_offsets.size() * sizeof(uint64_t));
+		header.hits = align(header.string_data + string_data.size());
+		header.scores = align(header.hits + n * sizeof(uint32_t));
+		header.expected_scores = align(header.scores + n * sizeof(double));
+		header.pvalues = align(header.expected_scores + n * sizeof(double));
+		header.enriched = align(header.pvalues + n * sizeof(double));
+		header.size = header.enriched + n * sizeof(uint8_t);
+
+		std::ofstream out(path, std::ios::binary);
+		if(!out) {
+			throw IOError("File (" + path + ") is not open for writing");
+		}
+
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		writeSection(out, header.string_offsets, string_offsets);
+		writeSection(out, header.string_data, string_data);
+		writeSection(out, header.hits, results.hits);
+		writeSection(out, header.scores, results.scores);
+		writeSection(out, header.expected_scores, results.expected_scores);
+		writeSection(out, header.pvalues, results.pvalues);
+		writeSection(out, header.enriched, results.enriched);
+
+		if(!out) {
+			throw IOError("Could not write binary enrichment results (" + path + ")");
+		}
+	}
+
+	EnrichmentResultColumns BinaryEnrichmentResults::read(const std::string& path)
+	{
+		std::ifstream input(path, std::ios::binary | std::ios::ate);
+		if(!input) {
+			throw IOError("File (" + path + ") is not open for reading");
+		}
+
+		std::vector<char> buffer(static_cast<size_t>(input.tellg()));
+		input.seekg(0);
+		if(!input.read(buffer.data(), buffer.size())) {
+			throw IOError("Could not read binary enrichment results (" + path + ")");
+		}
+
+		Header header;
+		if(buffer.size() < sizeof(Header)) {
+			throw IOError("File (" + path + ") is not a binary enrichment result file");
+		}
+		std::memcpy(&header, buffer.data(), sizeof(Header));
+
+		if(std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+		   header.version != VERSION) {
+			throw IOError("File (" + path + ") is not a binary enrichment result file");
+		}
+
+		const uint64_t n = header.number_of_categories;
+		if(header.number_of_strings != (header.has_members ? 3 : 2) * n) {
+			throw IOError("Binary enrichment result file (" + path + ") is corrupt");
+		}
+
+		std::vector<uint64_t> string_offsets;
+		std::vector<char> string_data;
+		readSection(buffer, header.string_offsets, header.number_of_strings + 1, string_offsets, path);
+		readSection(buffer, header.string_data, string_offsets.back(), string_data, path);
+
+		EnrichmentResultColumns results;
+		auto getStrings = [&](size_t first, std::vector<std::string>& strings) {
+			strings.reserve(n);
+			for(size_t i = first; i < first + n; ++i) {
+				if(string_offsets[i] > string_offsets[i + 1] ||
+				   string_offsets[i + 1] > string_data.size()) {
+					throw IOError("Binary enrichment result file (" + path + ") is corrupt");
+				}
+				strings.emplace_back(string_data.data() + string_offsets[i],
+				                     string_offsets[i + 1] - string_offsets[i]);
+			}
+		};
+		getStrings(0, results.names);
+		getStrings(n, results.references);
+		if(header.has_members) {
+			getStrings(2 * n, results.members);
+		}
+
+		readSection(buffer, header.hits, n, results.hits, path);
+		readSection(buffer, header.scores, n, results.scores, path);
+		readSection(buffer, header.expected_scores, n, results.expected_scores, path);
+		readSection(buffer, header.pvalues, n, results.pvalues, path);
+		readSection(buffer, header.enriched, n, results.enriched, path);
+
+		return results;
+	}
+}
@@ -0,0 +1,107 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2018 Tim Kehl <tkehl@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_CORE_BINARY_ENRICHMENT_RESULTS_H
+#define GT2_CORE_BINARY_ENRICHMENT_RESULTS_H
+
+#include "macros.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace GeneTrail
+{
+	/**
+	 * The enrichment results of one category database, stored column-wise.
+	 * Entry i of every column belongs to category i.
+	 */
+	struct GT2_EXPORT EnrichmentResultColumns
+	{
+		std::vector<std::string> names;
+		std::vector<std::string> references;
+		std::vector<uint32_t> hits;
+		std::vector<double> scores;
+		std::vector<double> expected_scores;
+		std::vector<double> pvalues;
+		std::vector<uint8_t> enriched;
+		/// Comma separated members of every category. Optional, either
+		/// empty or of the same size as the other columns.
+		std::vector<std::string> members;
+
+		size_t size() const { return names.size(); }
+	};
+
+	/**
+	 * Reads and writes enrichment results in a binary, columnar format.
+	 *
+	 * In contrast to the text files written by the enrichment tools, no
+	 * numbers need to be formatted or parsed and a single column can be
+	 * used without looking at the others.
+	 *
+	 * Layout (all integers in host byte order, all sections 8 byte aligned):
+	 *  - Header (magic, version, counts and section offsets)
+	 *  - String offsets (uint64, number_of_strings + 1) and characters.
+	 *    The names of all categories, followed by their references and,
+	 *    if stored, their members.
+	 *  - Hits (uint32), scores, expected scores and p-values (double) and
+	 *    the enriched flags (uint8) of all categories
+	 */
+	class GT2_EXPORT BinaryEnrichmentResults
+	{
+	  public:
+		/**
+		 * Checks whether the file starts with the magic number of the
+		 * binary enrichment result format.
+		 */
+		static bool isBinaryEnrichmentResults(const std::string& path);
+
+		/**
+		 * @throws IOError if the file cannot be written.
+		 * @throws std::invalid_argument if the columns differ in size.
+		 */
+		static void write(const EnrichmentResultColumns& results,
+		                  const std::string& path);
+
+		/**
+		 * @throws IOError if the file cannot be read or is not a valid
+		 *         binary enrichment result file.
+		 */
+		static EnrichmentResultColumns read(const std::string& path);
+
+		struct Header
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t has_members;
+			uint64_t number_of_categories;
+			uint64_t number_of_strings;
+			uint64_t string_offsets;
+			uint64_t string_data;
+			uint64_t hits;
+			uint64_t scores;
+			uint64_t expected_scores;
+			uint64_t pvalues;
+			uint64_t enriched;
+			uint64_t size;
+		};
+	};
+}
+
+#endif // GT2_CORE_BINARY_ENRICHMENT_RESULTS_H
@@ -21,21 +21,99 @@
 
 #include "CombineReducedEnrichments.h"
 
+#include "BinaryEnrichmentResults.h"
+#include "DenseMatrixWriter.h"
+#include "Exception.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
 #include <vector>
-#include <fstream>
 
 #include <boost/algorithm/string/split.hpp>
-#include <boost/algorithm/string/trim.hpp>
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/classification.hpp>
-#include <boost/algorithm/string/predicate.hpp>
-#include <boost/lexical_cast.hpp>
-
-#include "Exception.h"
-#include <iostream>
 
 namespace GeneTrail
 {
+	namespace
+	{
+		/**
+		 * Calls f(category, value) for every entry of a reduced enrichment
+		 * file. The category is passed as a mutable string that is only
+		 * valid during the call, which avoids allocating a new string for
+		 * every line. Values that cannot be parsed are reported as NaN.
+		 */
+		template <typename Function>
+		void readEntries(const std::string& file, Function&& f)
+		{
+			std::ifstream reader(file);
+			if(!reader) throw IOError("Could not open input file " + file);
+
+			for(std::string line; std::getline(reader, line);){
+				if(line.empty() || line[0] == '#') continue;
+
+				// Consecutive tabs are treated as a single separator
+				const auto tab = line.find('\t');
+				if(tab == 0 || tab == std::string::npos) continue;
+				const auto begin = line.find_first_not_of('\t', tab);
+				if(begin == std::string::npos) continue;
+
+				const char* value = line.c_str() + begin;
+				char* end;
+				double v = std::strtod(value, &end);
+				if(end == value) {
+					v = std::numeric_limits<double>::quiet_NaN();
+				}
+
+				line.resize(tab);
+				f(line, v);
+			}
+		}
+
+		/**
+		 * Same as above, but for a binary enrichment result file. Either
+		 * the scores or the p-values are reported as values.
+		 */
+		template <typename Function>
+		void readBinaryEntries(const std::string& file, bool pvalues, Function&& f)
+		{
+			const auto results = BinaryEnrichmentResults::read(file);
+			const auto& values = pvalues ? results.pvalues : results.scores;
+			for(size_t i = 0; i < results.size(); ++i) {
+				f(results.names[i], values[i]);
+			}
+		}
+
+		/**
+		 * Writes the shortest representation of v that can be parsed back
+		 * to the same value. For values that were written with the default
+		 * stream precision this reproduces the input.
+		 */
+		void writeValue(std::ostream& out, double v)
+		{
+			if(std::isnan(v)) {
+				out << "NA";
+				return;
+			}
+
+			char buffer[32];
+			for(int precision = 6; precision <= std::numeric_limits<double>::max_digits10; ++precision) {
+				std::snprintf(buffer, sizeof(buffer), "%.*g", precision, v);
+				if(std::strtod(buffer, nullptr) == v) break;
+			}
+			out << buffer;
+		}
+	}
+
 	void CombineReducedEnrichments::writeFiles(const std::string& sampleOutDirs, const std::string& matrixOutFiles){
 		parseMatrixOutFiles(matrixOutFiles);
 		parseSampleOutDirs(sampleOutDirs);
@@ -43,6 +121,14 @@ namespace GeneTrail
 			write(idx);
 		}
 	}
+
+	void CombineReducedEnrichments::setSamples(std::vector<std::string> samples, std::vector<std::string> dirs){
+		if(samples.size() != dirs.size()) {
+			throw std::invalid_argument("The number of samples and directories differ.");
+		}
+		this->samples = std::move(samples);
+		this->dirs = std::move(dirs);
+	}
 	
 	void CombineReducedEnrichments::parseMatrixOutFiles(const std::string& matrixOutFiles){
 		categoryDBs.clear();
@@ -56,7 +142,7 @@ namespace GeneTrail
 			boost::split(fields, line, boost::is_any_of(split_string), boost::token_compress_on);
 			if(fields.size() < 2) continue;
 			categoryDBs.emplace_back(fields[0]);
-			allWriters.emplace_back(fields[1]);
+			allWriters.emplace_back(fields[1], binary_ ? std::ios::out | std::ios::binary : std::ios::out);
 			if(!allWriters.back().is_open()){
 				throw IOError("Could not open output file: " + fields[1]);
 			}
@@ -81,74 +167,121 @@ namespace GeneTrail
 	}
 	
 	void CombineReducedEnrichments::write(size_t idx){
-		const auto& category = categoryDBs[idx];
-		auto& writer = allWriters[idx];
-		std::map<std::string, std::vector<std::string>> result;
-		
-		for(size_t idx_sample=0; idx_sample < samples.size(); idx_sample++){
-			std::cout << "Processing category " << (idx+1) << "/";
-			std::cout << categoryDBs.size() << " - sample " << (idx_sample+1);
-			std::cout << "/" << samples.size() << std::endl;
-			readSample(result, idx_sample, category);
-		}
-		
+		std::cout << "Processing category " << (idx+1) << "/";
+		std::cout << categoryDBs.size() << " - " << samples.size() << " samples" << std::endl;
+
+		DenseMatrix matrix = combine(categoryDBs[idx]);
+
 		std::cout << "Writing matrix for category " << (idx+1) << "/" << categoryDBs.size() << std::endl;
-		writeMatrix(result, writer);
+		if(binary_) {
+			DenseMatrixWriter writer;
+			writer.writeBinary(allWriters[idx], matrix);
+		} else {
+			writeMatrix(matrix, allWriters[idx]);
+		}
+		allWriters[idx].close();
 	}
-	
-	void CombineReducedEnrichments::readSample(std::map<std::string, std::vector<std::string>>& result, size_t idx_sample, const std::string& categoryDB){
-		const std::string file = dirs[idx_sample] + "/" + categoryDB + ".txt";
-		
-		const std::string split_string = "\t";
-		std::vector<std::string> fields;
-		std::string category;
-		std::ifstream reader(file);
-		if(!reader) throw IOError("Could not open input file " + file);
-		
-		for(std::string line; std::getline(reader, line);){
-			if(boost::starts_with(line, "#")) continue;
-			boost::split(fields, line, boost::is_any_of(split_string), boost::token_compress_on);
-			if(fields.size() < 2) continue;
-			category = fields[0];
-			auto search = result.find(category);
-			if(search == result.end()){
-				result.emplace(category, std::vector<std::string>(samples.size()));
-				search = result.find(category);
+
+	DenseMatrix CombineReducedEnrichments::combine(const std::string& categoryDB) const{
+		const bool text = input_format_ == InputFormat::Text;
+		auto entries = [&](size_t idx_sample, auto&& f) {
+			const std::string file = dirs[idx_sample] + "/" + categoryDB + (text ? ".txt" : ".bin");
+			if(text) {
+				readEntries(file, f);
+			} else {
+				readBinaryEntries(file, input_format_ == InputFormat::BinaryPValues, f);
 			}
-			search->second[idx_sample] = fields[1];
+		};
+
+		std::unordered_map<std::string, size_t> index;
+		std::vector<std::string> categories;
+
+		auto intern = [&index, &categories](const std::string& category) {
+			auto res = index.emplace(category, categories.size());
+			if(res.second) {
+				categories.push_back(category);
+			}
+			return res.first->second;
+		};
+
+		// Usually all samples share the same categories, so the first
+		// file is sufficient to size the matrix.
+		if(!samples.empty()) {
+			entries(0, [&intern](const std::string& category, double) {
+				intern(category);
+			});
 		}
-	}
-	
-	void CombineReducedEnrichments::writeHeader(unsigned int idx){
-		auto& writer = allWriters[idx];
-		bool first = true;
-		for(const auto& sample: samples){
-			writer << (first ? "" : "\t") << sample;
-			first = false;
+
+		DenseMatrix::DMatrix values = DenseMatrix::DMatrix::Constant(
+		    categories.size(), samples.size(), std::numeric_limits<double>::quiet_NaN());
+
+		// Categories that are not part of the first file cannot be added
+		// concurrently. They are collected and inserted afterwards.
+		std::vector<std::vector<std::pair<std::string, double>>> unknown(samples.size());
+
+		parallel_for(0, samples.size(), [&](size_t idx_sample) {
+			entries(idx_sample, [&](const std::string& category, double value) {
+				auto search = index.find(category);
+				if(search == index.end()) {
+					unknown[idx_sample].emplace_back(category, value);
+				} else {
+					values(search->second, idx_sample) = value;
+				}
+			});
+		}, num_threads_);
+
+		const size_t known = categories.size();
+		for(const auto& entries : unknown) {
+			for(const auto& entry : entries) {
+				intern(entry.first);
+			}
 		}
-		writer << "\n";
+
+		if(categories.size() > known) {
+			values.conservativeResize(categories.size(), Eigen::NoChange);
+			values.bottomRows(categories.size() - known).setConstant(std::numeric_limits<double>::quiet_NaN());
+
+			for(size_t idx_sample = 0; idx_sample < unknown.size(); ++idx_sample) {
+				for(const auto& entry : unknown[idx_sample]) {
+					values(index[entry.first], idx_sample) = entry.second;
+				}
+			}
+		}
+
+		std::vector<DenseMatrix::index_type> order(categories.size());
+		std::iota(order.begin(), order.end(), 0u);
+		std::sort(order.begin(), order.end(), [&categories](size_t a, size_t b) {
+			return categories[a] < categories[b];
+		});
+
+		for(auto& category : categories) {
+			boost::replace_all(category, "_", " ");
+		}
+
+		// The matrix is not initialised by this constructor, so no memory is
+		// touched before swapping in the values.
+		DenseMatrix result(std::move(categories), samples);
+		result.matrix().swap(values);
+		result.shuffleRows(order);
+
+		return result;
 	}
 	
-	void CombineReducedEnrichments::writeMatrix(std::map<std::string, std::vector<std::string>>& result, std::ofstream& writer){
+	void CombineReducedEnrichments::writeMatrix(const DenseMatrix& matrix, std::ofstream& writer){
 		bool first = true;
-		for(const auto& sample: samples){
+		for(const auto& sample: matrix.colNames()){
 			writer << (first ? "" : "\t") << sample;
 			first = false;
 		}
-		writer << std::endl;
+		writer << '\n';
 		
-		for(auto& categoryResults: result){
-			std::string category = categoryResults.first;
-			boost::replace_all(category, "_", " ");
-			writer << category;
-			for(const auto& res: categoryResults.second){
-				writer << "\t" << res;
+		for(DenseMatrix::index_type i = 0; i < matrix.rows(); ++i){
+			writer << matrix.rowName(i);
+			for(DenseMatrix::index_type j = 0; j < matrix.cols(); ++j){
+				writer << '\t';
+				writeValue(writer, matrix(i, j));
 			}
-			writer << std::endl;
+			writer << '\n';
 		}
 	}
 }
-
-
-
-
@@ -19,24 +19,70 @@
  *
  */
 
-#ifndef GT2_DENSE_MATRIX_READER_H
-#define GT2_DENSE_MATRIX_READER_H
+#ifndef GT2_CORE_COMBINE_REDUCED_ENRICHMENTS_H
+#define GT2_CORE_COMBINE_REDUCED_ENRICHMENTS_H
 
 #include "macros.h"
 
-#include <istream>
+#include "DenseMatrix.h"
+
+#include <fstream>
+#include <string>
 #include <vector>
-#include <map>
-#include <set>
-#include <initializer_list>
 
 namespace GeneTrail{
+	/**
+	 * Merges the reduced enrichment results (one file per sample and
+	 * category database, containing category names and values) into one
+	 * category x sample matrix per category database.
+	 *
+	 * Category names are interned once per database and the values are
+	 * parsed into a preallocated matrix of doubles. The sample files are
+	 * read in parallel. Missing or unparsable values are stored as NaN.
+	 */
 	class GT2_EXPORT CombineReducedEnrichments{
 	public:
+		/**
+		 * Format of the sample files. Text files (<db>.txt) contain the
+		 * category names and one value per line. Binary files (<db>.bin)
+		 * are written by BinaryEnrichmentResults and contain all result
+		 * columns, of which either the scores or the p-values are used.
+		 */
+		enum class InputFormat { Text, BinaryScores, BinaryPValues };
+
 		CombineReducedEnrichments() = default;
-		
+
 		void writeFiles(const std::string& sampleOutDirs, const std::string& matrixOutFiles);
 
+		/**
+		 * Set the samples and the directories containing their results.
+		 */
+		void setSamples(std::vector<std::string> samples, std::vector<std::string> dirs);
+
+		/**
+		 * Combines the results of all samples for the given category
+		 * database. The rows are sorted by category name, underscores in
+		 * the names are replaced by spaces.
+		 */
+		DenseMatrix combine(const std::string& categoryDB) const;
+
+		/**
+		 * Write the matrices in the binary DenseMatrixWriter format
+		 * instead of the text format.
+		 */
+		void setBinaryOutput(bool binary) { binary_ = binary; }
+
+		/**
+		 * Set the format of the sample files. Default is InputFormat::Text.
+		 */
+		void setInputFormat(InputFormat format) { input_format_ = format; }
+
+		/**
+		 * Set the number of threads used for reading the sample
+		 * files. 0 uses all available cores.
+		 */
+		void setNumberOfThreads(size_t num_threads) { num_threads_ = num_threads; }
+
 	private:
 		using WriterPerCategoryDB = std::vector<std::ofstream>;
 		using CategoryDBs = std::vector<std::string>;
@@ -44,17 +90,17 @@ namespace GeneTrail{
 		
 		WriterPerCategoryDB allWriters;
 		CategoryDBs categoryDBs;
-		std::vector<std::string> samples;
+		Samples samples;
 		std::vector<std::string> dirs;
+		bool binary_ = false;
+		InputFormat input_format_ = InputFormat::Text;
+		size_t num_threads_ = 0;
 		
 		void parseMatrixOutFiles(const std::string& matrixOutFiles);
 		void parseSampleOutDirs(const std::string& sampleOutDirs);
 		void write(size_t idx);
-		void readSample(std::map<std::string, std::vector<std::string>>& result, size_t idx_sample, const std::string& category);
-		void writeMatrix(std::map<std::string, std::vector<std::string>>& result, std::ofstream& writer);
-		void writeHeader(unsigned int idx);
+		void writeMatrix(const DenseMatrix& matrix, std::ofstream& writer);
 	};
 }
 
-#endif //GT2_DENSE_MATRIX_READER_H
-
+#endif //GT2_CORE_COMBINE_REDUCED_ENRICHMENTS_H
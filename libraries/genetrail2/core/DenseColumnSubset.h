@@ -22,6 +22,7 @@
 #define GT2_DENSE_COLUMN_SUBSET_H
 
 #include "DenseMatrix.h"
+#include "DenseMatrixView.h"
 #include <iostream>
 #include "macros.h"
 
@@ -89,6 +90,14 @@ namespace GeneTrail
 				return static_cast<const DenseMatrix*>(mat_)->matrix().col(col_subset_[j]);
 			}
 
+			/**
+			 * A non-virtual view on the same columns. Use it in loops that
+			 * access many elements.
+			 */
+			DenseColumnSubsetView view() const {
+				return columnSubsetView(*mat_, col_subset_.begin(), col_subset_.end());
+			}
+
 			const std::string& colName(index_type j) const override;
 			const std::string& rowName(index_type i) const override;
 
@@ -0,0 +1,235 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2018 Tim Kehl <tkehl@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_CORE_DENSE_MATRIX_VIEW_H
+#define GT2_CORE_DENSE_MATRIX_VIEW_H
+
+#include "DenseMatrix.h"
+
+#include "macros.h"
+
+#include <cassert>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace GeneTrail
+{
+	/**
+	 * Selects all rows or columns of a matrix without storing indices.
+	 */
+	class AllIndices
+	{
+		public:
+		explicit AllIndices(size_t n = 0) : n_(n) {}
+
+		size_t operator[](size_t i) const { return i; }
+		size_t size() const { return n_; }
+
+		private:
+		size_t n_;
+	};
+
+	/**
+	 * Selects rows or columns of a matrix by index. Indices may occur
+	 * more than once, e.g. for bootstrap samples.
+	 */
+	using IndexSubset = std::vector<size_t>;
+
+	/**
+	 * A read-only view on selected rows and columns of a DenseMatrix.
+	 *
+	 * In contrast to DenseColumnSubset and DenseRowSubset, a view does not
+	 * derive from Matrix. Element access is not virtual and directly reads
+	 * the storage of the underlying matrix, so that it can be inlined into
+	 * the loops of MatrixIterator and MatrixHTest.
+	 *
+	 * The view stores a pointer to the data of the matrix. It becomes
+	 * invalid if the matrix is resized or destroyed.
+	 */
+	template <typename RowIndices, typename ColIndices>
+	class DenseMatrixView
+	{
+		public:
+		using value_type = DenseMatrix::value_type;
+		using index_type = DenseMatrix::index_type;
+
+		DenseMatrixView(const DenseMatrix& mat, RowIndices rows, ColIndices cols)
+		    : mat_(&mat),
+		      data_(mat.matrix().data()),
+		      stride_(mat.matrix().outerStride()),
+		      rows_(std::move(rows)),
+		      cols_(std::move(cols))
+		{
+		}
+
+		value_type operator()(index_type i, index_type j) const
+		{
+			return data_[cols_[j] * stride_ + rows_[i]];
+		}
+
+		index_type rows() const { return rows_.size(); }
+		index_type cols() const { return cols_.size(); }
+
+		/**
+		 * Contiguous storage of column j. Only available if the view
+		 * contains all rows of the matrix.
+		 */
+		const value_type* colData(index_type j) const
+		{
+			static_assert(std::is_same<RowIndices, AllIndices>::value,
+			              "The columns of a row subset are not contiguous.");
+			return data_ + cols_[j] * stride_;
+		}
+
+		/**
+		 * Copies row i of the view to out, which must provide space for
+		 * cols() values. Loops that read the same row repeatedly should
+		 * work on such a copy, as the rows of a DenseMatrix are strided.
+		 */
+		void gatherRow(index_type i, value_type* out) const
+		{
+			const value_type* row = data_ + rows_[i];
+			for(size_t j = 0; j < cols_.size(); ++j) {
+				out[j] = row[cols_[j] * stride_];
+			}
+		}
+
+		/**
+		 * Copies the view into a contiguous matrix. This pays off if
+		 * the selected elements are read many times, e.g. in the inner
+		 * loop of a permutation test.
+		 */
+		DenseMatrix::DMatrix gather() const
+		{
+			DenseMatrix::DMatrix result(rows(), cols());
+			for(size_t j = 0; j < cols_.size(); ++j) {
+				const value_type* col = data_ + cols_[j] * stride_;
+				for(size_t i = 0; i < rows_.size(); ++i) {
+					result(i, j) = col[rows_[i]];
+				}
+			}
+			return result;
+		}
+
+		/**
+		 * Replaces the selected columns, e.g. by a new bootstrap sample.
+		 */
+		template <typename InputIterator>
+		void assignCols(InputIterator first, InputIterator last)
+		{
+			static_assert(std::is_same<ColIndices, IndexSubset>::value,
+			              "Only explicit column subsets can be reassigned.");
+			cols_.assign(first, last);
+		}
+
+		const RowIndices& rowIndices() const { return rows_; }
+		const ColIndices& colIndices() const { return cols_; }
+
+		const std::string& rowName(index_type i) const
+		{
+			return mat_->rowName(rows_[i]);
+		}
+
+		const std::string& colName(index_type j) const
+		{
+			return mat_->colName(cols_[j]);
+		}
+
+		const std::vector<std::string>& rowNames() const
+		{
+			return names_(rows_, mat_->rowNames(), row_names_cache_);
+		}
+
+		const std::vector<std::string>& colNames() const
+		{
+			return names_(cols_, mat_->colNames(), col_names_cache_);
+		}
+
+		private:
+		static const std::vector<std::string>&
+		names_(const AllIndices&, const std::vector<std::string>& names,
+		       std::vector<std::string>&)
+		{
+			return names;
+		}
+
+		static const std::vector<std::string>&
+		names_(const IndexSubset& subset, const std::vector<std::string>& names,
+		       std::vector<std::string>& cache)
+		{
+			cache.resize(subset.size());
+			for(size_t i = 0; i < subset.size(); ++i) {
+				cache[i] = names[subset[i]];
+			}
+			return cache;
+		}
+
+		const DenseMatrix* mat_;
+		const value_type* data_;
+		size_t stride_;
+		RowIndices rows_;
+		ColIndices cols_;
+
+		mutable std::vector<std::string> row_names_cache_;
+		mutable std::vector<std::string> col_names_cache_;
+	};
+
+	/// A view on a subset of the columns of a DenseMatrix
+	using DenseColumnSubsetView = DenseMatrixView<AllIndices, IndexSubset>;
+
+	/// A view on a subset of the rows of a DenseMatrix
+	using DenseRowSubsetView = DenseMatrixView<IndexSubset, AllIndices>;
+
+	template <typename Iterator>
+	DenseColumnSubsetView columnSubsetView(const DenseMatrix& mat,
+	                                       Iterator first, Iterator last)
+	{
+		return DenseColumnSubsetView(mat, AllIndices(mat.rows()),
+		                             IndexSubset(first, last));
+	}
+
+	/**
+	 * A bootstrap sample given by the multiplicity of every column of mat.
+	 * Column j of mat occurs weights[j] times in the resulting view.
+	 */
+	inline DenseColumnSubsetView
+	bootstrapView(const DenseMatrix& mat, const std::vector<size_t>& weights)
+	{
+		assert(weights.size() == mat.cols());
+
+		IndexSubset cols;
+		for(size_t j = 0; j < weights.size(); ++j) {
+			cols.insert(cols.end(), weights[j], j);
+		}
+
+		return DenseColumnSubsetView(mat, AllIndices(mat.rows()),
+		                             std::move(cols));
+	}
+
+	template <typename Iterator>
+	DenseRowSubsetView rowSubsetView(const DenseMatrix& mat, Iterator first,
+	                                 Iterator last)
+	{
+		return DenseRowSubsetView(mat, IndexSubset(first, last),
+		                          AllIndices(mat.cols()));
+	}
+}
+
+#endif // GT2_CORE_DENSE_MATRIX_VIEW_H
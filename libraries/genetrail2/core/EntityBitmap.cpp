@@ -0,0 +1,204 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "EntityBitmap.h"
+
+#include "Category.h"
+
+#include <algorithm>
+
+namespace GeneTrail
+{
+	namespace
+	{
+		inline size_t popcount(uint64_t x)
+		{
+			return static_cast<size_t>(__builtin_popcountll(x));
+		}
+
+		/**
+		 * Intersection of two sorted arrays. If one of the arrays is much
+		 * smaller than the other, the small array is searched in the large
+		 * one using exponential search.
+		 */
+		size_t intersectArrays(const std::vector<uint16_t>& a,
+		                       const std::vector<uint16_t>& b)
+		{
+			const std::vector<uint16_t>& small = a.size() <= b.size() ? a : b;
+			const std::vector<uint16_t>& large = a.size() <= b.size() ? b : a;
+
+			size_t result = 0;
+
+			if(small.size() * 32 < large.size()) {
+				auto it = large.begin();
+				for(uint16_t x : small) {
+					size_t step = 1;
+					auto hi = it;
+					while(hi != large.end() && *hi < x) {
+						it = hi;
+						hi = static_cast<size_t>(large.end() - hi) > step
+						         ? hi + step
+						         : large.end();
+						step *= 2;
+					}
+
+					it = std::lower_bound(it, hi, x);
+					if(it == large.end()) {
+						break;
+					}
+
+					if(*it == x) {
+						++result;
+					}
+				}
+
+				return result;
+			}
+
+			auto it = small.begin();
+			auto jt = large.begin();
+			while(it != small.end() && jt != large.end()) {
+				if(*it < *jt) {
+					++it;
+				} else if(*jt < *it) {
+					++jt;
+				} else {
+					++result;
+					++it;
+					++jt;
+				}
+			}
+
+			return result;
+		}
+	}
+
+	EntityBitmap::EntityBitmap() : size_(0) {}
+
+	EntityBitmap::EntityBitmap(const Category& category) : size_(0)
+	{
+		build_(std::vector<size_t>(category.begin(), category.end()));
+	}
+
+	void EntityBitmap::build_(std::vector<size_t> ids)
+	{
+		std::sort(ids.begin(), ids.end());
+		ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+		size_ = ids.size();
+
+		auto it = ids.begin();
+		while(it != ids.end()) {
+			const size_t key = *it >> CHUNK_BITS;
+			auto chunk_end =
+			    std::find_if(it, ids.end(), [key](size_t id) {
+				    return (id >> CHUNK_BITS) != key;
+			    });
+
+			Container container;
+			container.key = key;
+			container.cardinality = chunk_end - it;
+
+			if(container.cardinality > MAX_ARRAY_SIZE) {
+				container.bits.assign(BITMAP_WORDS, 0);
+				for(; it != chunk_end; ++it) {
+					const uint16_t low = static_cast<uint16_t>(*it);
+					container.bits[low >> 6] |= uint64_t(1) << (low & 63);
+				}
+			} else {
+				container.array.reserve(container.cardinality);
+				for(; it != chunk_end; ++it) {
+					container.array.push_back(static_cast<uint16_t>(*it));
+				}
+			}
+
+			containers_.push_back(std::move(container));
+		}
+	}
+
+	const EntityBitmap::Container* EntityBitmap::findContainer_(size_t key) const
+	{
+		auto it = std::lower_bound(
+		    containers_.begin(), containers_.end(), key,
+		    [](const Container& c, size_t k) { return c.key < k; });
+
+		if(it != containers_.end() && it->key == key) {
+			return &*it;
+		}
+
+		return nullptr;
+	}
+
+	bool EntityBitmap::contains(size_t id) const
+	{
+		const Container* container = findContainer_(id >> CHUNK_BITS);
+		return container != nullptr &&
+		       container->contains(static_cast<uint16_t>(id));
+	}
+
+	size_t EntityBitmap::intersectionSize(const EntityBitmap& other) const
+	{
+		size_t result = 0;
+
+		auto it = containers_.begin();
+		auto jt = other.containers_.begin();
+		while(it != containers_.end() && jt != other.containers_.end()) {
+			if(it->key < jt->key) {
+				++it;
+			} else if(jt->key < it->key) {
+				++jt;
+			} else {
+				result += it->intersectionSize(*jt);
+				++it;
+				++jt;
+			}
+		}
+
+		return result;
+	}
+
+	size_t EntityBitmap::intersectionSize(const Category& category) const
+	{
+		return intersectionSize(category.begin(), category.end());
+	}
+
+	size_t EntityBitmap::Container::intersectionSize(const Container& other) const
+	{
+		if(!bits.empty() && !other.bits.empty()) {
+			size_t result = 0;
+			for(size_t i = 0; i < BITMAP_WORDS; ++i) {
+				result += popcount(bits[i] & other.bits[i]);
+			}
+			return result;
+		}
+
+		if(!bits.empty() || !other.bits.empty()) {
+			const Container& bitmap = bits.empty() ? other : *this;
+			const Container& array = bits.empty() ? *this : other;
+
+			size_t result = 0;
+			for(uint16_t low : array.array) {
+				result += (bitmap.bits[low >> 6] >> (low & 63)) & 1;
+			}
+			return result;
+		}
+
+		return intersectArrays(array, other.array);
+	}
+}
@@ -0,0 +1,157 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_CORE_ENTITY_BITMAP_H
+#define GT2_CORE_ENTITY_BITMAP_H
+
+#include "macros.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace GeneTrail
+{
+	class Category;
+
+	/**
+	 * A compressed set of EntityDatabase ids that is optimized for
+	 * membership tests and intersection sizes.
+	 *
+	 * The id space is partitioned into chunks of 2^16 ids. For every
+	 * non-empty chunk a container stores the lower 16 bits of the contained
+	 * ids. Sparse chunks are stored as sorted arrays, chunks with more than
+	 * 4096 entries as a bitmap of 2^16 bits. This is the layout used by
+	 * "roaring" bitmaps: no container is larger than 8 KiB and the size of
+	 * the intersection of two bitmaps can be computed using popcounts.
+	 *
+	 * EntityBitmaps are immutable. They are meant to be built once for the
+	 * reference and test sets of an enrichment and then be intersected with
+	 * every category.
+	 */
+	class GT2_EXPORT EntityBitmap
+	{
+		public:
+		EntityBitmap();
+
+		/**
+		 * Creates a bitmap containing the ids in [begin, end). The ids
+		 * need not be sorted or unique.
+		 */
+		template <typename InputIterator>
+		EntityBitmap(InputIterator begin, InputIterator end)
+		    : size_(0)
+		{
+			build_(std::vector<size_t>(begin, end));
+		}
+
+		/**
+		 * Creates a bitmap containing the members of the category.
+		 */
+		explicit EntityBitmap(const Category& category);
+
+		/**
+		 * The number of ids in the bitmap.
+		 */
+		size_t size() const { return size_; }
+
+		bool empty() const { return size_ == 0; }
+
+		/**
+		 * Checks whether the given id is part of the bitmap.
+		 */
+		bool contains(size_t id) const;
+
+		/**
+		 * Computes the number of ids contained in both bitmaps.
+		 */
+		size_t intersectionSize(const EntityBitmap& other) const;
+
+		/**
+		 * Computes the number of members of the category contained in
+		 * the bitmap.
+		 */
+		size_t intersectionSize(const Category& category) const;
+
+		/**
+		 * Counts the ids in [begin, end) that are contained in the bitmap.
+		 * Duplicate ids are counted multiple times. The range may be in
+		 * arbitrary order, however sorted ranges are processed faster, as
+		 * the container lookup is only performed when the chunk changes.
+		 */
+		template <typename Iterator>
+		size_t intersectionSize(Iterator begin, const Iterator& end) const
+		{
+			size_t result = 0;
+			size_t key = NO_KEY;
+			const Container* container = nullptr;
+
+			for(; begin != end; ++begin) {
+				const size_t id = *begin;
+
+				if((id >> CHUNK_BITS) != key) {
+					key = id >> CHUNK_BITS;
+					container = findContainer_(key);
+				}
+
+				if(container != nullptr &&
+				   container->contains(static_cast<uint16_t>(id))) {
+					++result;
+				}
+			}
+
+			return result;
+		}
+
+		private:
+		static const size_t CHUNK_BITS = 16;
+		static const size_t MAX_ARRAY_SIZE = 4096;
+		static const size_t BITMAP_WORDS = (1 << CHUNK_BITS) / 64;
+		static const size_t NO_KEY = ~size_t(0);
+
+		struct Container
+		{
+			size_t key;
+			size_t cardinality;
+			// Exactly one of these is non-empty
+			std::vector<uint16_t> array;
+			std::vector<uint64_t> bits;
+
+			bool contains(uint16_t low) const
+			{
+				if(!bits.empty()) {
+					return (bits[low >> 6] >> (low & 63)) & 1;
+				}
+
+				return std::binary_search(array.begin(), array.end(), low);
+			}
+
+			size_t intersectionSize(const Container& other) const;
+		};
+
+		void build_(std::vector<size_t> ids);
+		const Container* findContainer_(size_t key) const;
+
+		std::vector<Container> containers_;
+		size_t size_;
+	};
+}
+
+#endif // GT2_CORE_ENTITY_BITMAP_H
@@ -55,6 +55,11 @@ namespace GeneTrail
 		 */
 		void clear();
 
+		/**
+		 * The number of registered entities. Valid ids are in [0, size()).
+		 */
+		size_t size() const { return db_.size(); }
+
 		/**
 		 * Return the name of instance i
 		 *
@@ -83,6 +88,17 @@ namespace GeneTrail
 		 */
 		size_t index(const std::string& name) const;
 
+		/**
+		 * Checks whether an entity is registered with the database.
+		 *
+		 * @param name The name of an entity.
+		 * @return True if the entity has an id.
+		 */
+		bool contains(const std::string& name) const
+		{
+			return name_to_index_.find(name) != name_to_index_.end();
+		}
+
 		/**
 		 * Overload for index(const std::string&)
 		 */
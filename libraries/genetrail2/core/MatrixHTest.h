@@ -21,6 +21,8 @@
 #ifndef GT2_CORE_MATRIX_HTEST_H
 #define GT2_CORE_MATRIX_HTEST_H
 
+#include "DenseColumnSubset.h"
+#include "DenseMatrixView.h"
 #include "HTest.h"
 #include "FTest.h"
 #include "IndependentTTest.h"
@@ -560,6 +562,21 @@ namespace GeneTrail
 			return test_(factory.getDescriptor(method), ref, sam, mode);
 		}
 
+		/**
+		 * Column subsets are tested through their non-virtual views.
+		 */
+		Scores test(const std::string& method, const DenseColumnSubset& ref,
+		            const DenseColumnSubset& sam, NanMode mode = NanMode::Ignore)
+		{
+			return test(method, ref.view(), sam.view(), mode);
+		}
+
+		Scores test(MatrixHTests method, const DenseColumnSubset& ref,
+		            const DenseColumnSubset& sam, NanMode mode = NanMode::Ignore)
+		{
+			return test(method, ref.view(), sam.view(), mode);
+		}
+
 		private:
 		MatrixHTestFactory factory;
 		std::vector<size_t> row_db_indices_;
@@ -757,17 +774,24 @@ namespace GeneTrail
 			auto db = std::make_shared<EntityDatabase>();
 			Scores scores(ref.rows(), db);
 
-			RowMajorMatrixIterator<Matrix> ref_it(&ref, 0), sam_it(&sam, 0);
+			// Every row is copied to contiguous memory once, so that
+			// the test does not access the matrix element by element.
+			using value_type = typename Matrix::value_type;
+			std::vector<value_type> ref_row(ref.cols()), sam_row(sam.cols());
 
-			using Iterator1 = decltype(ref_it->begin());
-			using Iterator2 = decltype(sam_it->begin());
+			using Iterator = typename std::vector<value_type>::const_iterator;
 
-			auto method = factory.create<Iterator1, Iterator2>(descriptor.id,
-			                                                   Dep(), Scalar());
+			auto method = factory.create<Iterator, Iterator>(descriptor.id,
+			                                                 Dep(), Scalar());
 
-			for(size_t r = 0; r < ref.rows(); ++r, ++ref_it, ++sam_it) {
-				auto score = method->test(ref_it->begin(), ref_it->end(),
-				                          sam_it->begin(), sam_it->end());
+			for(size_t r = 0; r < ref.rows(); ++r) {
+				gatherRow_(ref, r, ref_row);
+				gatherRow_(sam, r, sam_row);
+
+				const auto& cref_row = ref_row;
+				const auto& csam_row = sam_row;
+				auto score = method->test(cref_row.begin(), cref_row.end(),
+				                          csam_row.begin(), csam_row.end());
 				if(row_db_indices_.empty()) {
 					scores.emplace_back(ref.rowName(r), score);
 				} else {
@@ -803,6 +827,22 @@ namespace GeneTrail
 			return scores;
 		}
 
+		template <typename Matrix>
+		static void gatherRow_(const Matrix& m, size_t r,
+		                       std::vector<typename Matrix::value_type>& out)
+		{
+			for(size_t j = 0; j < out.size(); ++j) {
+				out[j] = m(r, j);
+			}
+		}
+
+		template <typename RowIndices, typename ColIndices>
+		static void gatherRow_(const DenseMatrixView<RowIndices, ColIndices>& m,
+		                       size_t r, std::vector<double>& out)
+		{
+			m.gatherRow(r, out.data());
+		}
+
 		template<typename Matrix>
 		void assignScores_(Scores& scores, const std::vector<typename Matrix::value_type>& v, const Matrix& ref) const {
 			if(row_db_indices_.empty()) {
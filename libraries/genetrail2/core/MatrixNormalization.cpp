@@ -0,0 +1,262 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2017 Lea Eckhart <leckhart@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "MatrixNormalization.h"
+
+#include <unsupported/Eigen/FFT>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+
+namespace GeneTrail
+{
+	namespace
+	{
+		bool isCount(double x, double max)
+		{
+			return x >= 0.0 && x < max && x == std::floor(x);
+		}
+	}
+
+	void GaussEstimator::kernelSums(const std::vector<double>& values, std::vector<double>& sums)
+	{
+		const size_t n = values.size();
+		if(n == 0) {
+			sums.clear();
+			return;
+		}
+
+		const auto range = std::minmax_element(values.begin(), values.end());
+		const double nodes = (*range.second - *range.first) / GRID_SPACING + 2.0;
+		const double fft_size = nodes + 2.0 * KERNEL_CUTOFF / GRID_SPACING;
+
+		// Compare the number of pairs of the sweep to the cost of the FFTs
+		if(0.5 * n * (n - 1) > fft_size * std::log2(fft_size)) {
+			gridKernelSums_(values, sums);
+		} else {
+			sweepKernelSums_(values, sums);
+		}
+	}
+
+	void GaussEstimator::sweepKernelSums_(const std::vector<double>& values, std::vector<double>& sums)
+	{
+		const size_t n = values.size();
+
+		std::vector<size_t> order(n);
+		std::iota(order.begin(), order.end(), size_t(0));
+		std::sort(order.begin(), order.end(), [&values](size_t i, size_t j) {
+			return values[i] < values[j];
+		});
+
+		std::vector<double> sorted(n);
+		for(size_t i = 0; i < n; ++i) {
+			sorted[i] = values[order[i]];
+		}
+
+		// The kernel of a value with itself is cdf(0) = 0.5.
+		// above[j] counts the values that are more than KERNEL_CUTOFF
+		// bandwidths below sorted[j] (stored as a difference array).
+		std::vector<double> sorted_sums(n, 0.5);
+		std::vector<double> above(n + 1, 0.0);
+
+		size_t window_end = 0;
+		for(size_t i = 0; i < n; ++i) {
+			window_end = std::max(window_end, i + 1);
+			while(window_end < n && sorted[window_end] - sorted[i] < KERNEL_CUTOFF) {
+				++window_end;
+			}
+
+			double sum = 0.0;
+			for(size_t j = i + 1; j < window_end; ++j) {
+				const double p = detail::normalCDF(sorted[i] - sorted[j]);
+				sum += p;
+				sorted_sums[j] += 1.0 - p;
+			}
+			sorted_sums[i] += sum;
+
+			above[window_end] += 1.0;
+		}
+
+		sums.resize(n);
+		double count = 0.0;
+		for(size_t i = 0; i < n; ++i) {
+			count += above[i];
+			sums[order[i]] = sorted_sums[i] + count;
+		}
+	}
+
+	void GaussEstimator::gridKernelSums_(const std::vector<double>& values, std::vector<double>& sums)
+	{
+		// table[d] = cdf(d * GRID_SPACING) - 1 for d > 0. The remaining
+		// grid distances follow from cdf(-x) = 1 - cdf(x).
+		static const std::vector<double> table = [] {
+			const size_t size = std::ceil(KERNEL_CUTOFF / GRID_SPACING) + 1;
+			boost::math::normal normal;
+			std::vector<double> result(size, 0.0);
+			for(size_t d = 1; d < size; ++d) {
+				result[d] = boost::math::cdf(normal, d * GRID_SPACING) - 1.0;
+			}
+			return result;
+		}();
+
+		const size_t n = values.size();
+		const size_t width = table.size() - 1;
+
+		const auto range = std::minmax_element(values.begin(), values.end());
+		const double lowest = *range.first;
+		const size_t num_nodes = static_cast<size_t>((*range.second - lowest) / GRID_SPACING) + 2;
+
+		size_t fft_size = 1;
+		while(fft_size < num_nodes + 2 * width) {
+			fft_size *= 2;
+		}
+
+		// Distribute every value onto its two closest grid nodes
+		std::vector<size_t> node(n);
+		std::vector<double> fraction(n);
+		std::vector<double> counts(fft_size, 0.0);
+		for(size_t j = 0; j < n; ++j) {
+			const double pos = (values[j] - lowest) / GRID_SPACING;
+			node[j] = std::min(static_cast<size_t>(pos), num_nodes - 2);
+			fraction[j] = pos - node[j];
+			counts[node[j]] += 1.0 - fraction[j];
+			counts[node[j] + 1] += fraction[j];
+		}
+
+		// The kernel minus a unit step at zero vanishes beyond
+		// KERNEL_CUTOFF. Entry width + d holds the kernel at distance d.
+		std::vector<double> kernel(fft_size, 0.0);
+		for(size_t d = 1; d <= width; ++d) {
+			kernel[width + d] = table[d];
+			kernel[width - d] = -table[d];
+		}
+
+		Eigen::FFT<double> fft;
+		std::vector<std::complex<double>> counts_spectrum, kernel_spectrum;
+		fft.fwd(counts_spectrum, counts);
+		fft.fwd(kernel_spectrum, kernel);
+		for(size_t i = 0; i < fft_size; ++i) {
+			counts_spectrum[i] *= kernel_spectrum[i];
+		}
+
+		std::vector<double> convolution;
+		fft.inv(convolution, counts_spectrum);
+
+		// Add the unit step, i.e. the counts of the nodes below, to obtain
+		// the kernel sums of the grid nodes
+		std::vector<double> node_sums(num_nodes);
+		double below = 0.0;
+		for(size_t m = 0; m < num_nodes; ++m) {
+			node_sums[m] = convolution[m + width] + below + 0.5 * counts[m];
+			below += counts[m];
+		}
+
+		sums.resize(n);
+		for(size_t j = 0; j < n; ++j) {
+			sums[j] = (1.0 - fraction[j]) * node_sums[node[j]] +
+			          fraction[j] * node_sums[node[j] + 1];
+		}
+	}
+
+	double PoissonEstimator::kernelCDF(double value, double center)
+	{
+		// Tabulating the CDF for small counts avoids most calls to the
+		// (expensive) incomplete gamma function for count data.
+		static const std::vector<double> table = [] {
+			std::vector<double> result(TABLE_SIZE * TABLE_SIZE);
+			for(size_t c = 0; c < TABLE_SIZE; ++c) {
+				boost::math::poisson poisson(c + 0.5);
+				for(size_t v = 0; v < TABLE_SIZE; ++v) {
+					result[c * TABLE_SIZE + v] = boost::math::cdf(poisson, v);
+				}
+			}
+			return result;
+		}();
+
+		if(isCount(value, TABLE_SIZE) && isCount(center, TABLE_SIZE)) {
+			return table[static_cast<size_t>(center) * TABLE_SIZE +
+			             static_cast<size_t>(value)];
+		}
+
+		boost::math::poisson poisson(center + 0.5);
+		return boost::math::cdf(poisson, value);
+	}
+
+	void PoissonEstimator::kernelCDFs(double center,
+	                                  const std::vector<double>& values,
+	                                  std::vector<double>& result)
+	{
+		const double max_count = std::numeric_limits<int>::max();
+
+		if(!isCount(center, max_count)) {
+			for(size_t i = 0; i < values.size(); ++i) {
+				result[i] = kernelCDF(values[i], center);
+			}
+			return;
+		}
+
+		const double mean = center + 0.5;
+		boost::math::poisson poisson(mean);
+
+		// State of the recurrence: cdf and pmf at the count k
+		double k = -1.0;
+		double cdf = 0.0;
+		double pmf = 0.0;
+
+		for(size_t i = 0; i < values.size(); ++i) {
+			const double v = values[i];
+
+			if(!isCount(v, max_count) || (v < TABLE_SIZE && center < TABLE_SIZE)) {
+				result[i] = kernelCDF(v, center);
+				continue;
+			}
+
+			// Far in the left tail, the Chernoff bound
+			// P(X <= v) <= exp(-mean) (e * mean / v)^v is below 1e-300.
+			if(v < mean && v * (1.0 + std::log(mean / std::max(v, 1.0))) - mean < -690.0) {
+				result[i] = 0.0;
+				continue;
+			}
+
+			// Far in the right tail the cdf does not change anymore.
+			if(k > mean && pmf <= 1e-250) {
+				k = v;
+				result[i] = cdf;
+				continue;
+			}
+
+			// Denormal pmfs would spoil the accuracy of the recurrence.
+			if(k >= 0.0 && v - k <= MAX_STEPS && pmf > 1e-250) {
+				for(double j = k + 1.0; j <= v; j += 1.0) {
+					pmf *= mean / j;
+					cdf += pmf;
+				}
+				cdf = std::min(cdf, 1.0);
+			} else {
+				cdf = boost::math::cdf(poisson, v);
+				pmf = boost::math::pdf(poisson, v);
+			}
+
+			k = v;
+			result[i] = cdf;
+		}
+	}
+}
@@ -25,12 +25,51 @@
 #include "Matrix.h"
 #include "Statistic.h"
 #include "MatrixIterator.h"
+#include "Parallel.h"
 #include <boost/math/distributions/poisson.hpp>
 #include <boost/math/distributions/normal.hpp>
-#include <genetrail2/core/DenseMatrix.h>
+#include "DenseMatrix.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+#include <vector>
 
 namespace GeneTrail
 {
+	namespace detail
+	{
+		/**
+		 * Approximation of the standard normal CDF based on the Chebyshev
+		 * fit of erfc given in Numerical Recipes (Press et al., 6.2). The
+		 * relative error of erfc is below 1.2e-7 on the whole real line,
+		 * hence the absolute error of the CDF is below 1.2e-7, too.
+		 *
+		 * In contrast to boost::math::cdf this is a branch-poor
+		 * polynomial with a single call to exp, which makes it suitable
+		 * for the inner loop of the kernel estimation.
+		 */
+		inline double normalCDF(double x)
+		{
+			const double z = std::fabs(x) * 0.70710678118654752440;
+			const double t = 1.0 / (1.0 + 0.5 * z);
+			const double r =
+			    t * std::exp(-z * z - 1.26551223 +
+			                 t * (1.00002368 +
+			                 t * (0.37409196 +
+			                 t * (0.09678418 +
+			                 t * (-0.18628806 +
+			                 t * (0.27886807 +
+			                 t * (-1.13520398 +
+			                 t * (1.48851587 +
+			                 t * (-0.82215223 +
+			                 t * 0.17087277)))))))));
+			// r = erfc(|x| / sqrt(2)) = 2 * cdf(-|x|)
+			return x >= 0.0 ? 1.0 - 0.5 * r : 0.5 * r;
+		}
+	}
+
   	/**
 	 * A class that performs gaussian kernel estimation 
 	 * of the cumulative density function
@@ -72,6 +111,79 @@ namespace GeneTrail
 		    
 		    return normalizedValue/std::distance(begin,end);
 		  }
+
+		/**
+		 * Normalizes all values of a row at once. This computes the same
+		 * values as calling normalizeValue for every entry of the row, up
+		 * to an absolute error below 1e-6. The standard deviation is
+		 * computed only once and the kernel sums are computed by
+		 * kernelSums.
+		 *
+		 * @param begin InputIterator corresponding to the begin of the row.
+		 * @param end   InputIterator corresponding to the end of the row.
+		 * @param out   OutputIterator receiving the normalized values in
+		 *              the order of the input. May be equal to begin.
+		 */
+		template <typename InputIterator, typename OutputIterator>
+		void normalizeRow(InputIterator begin, InputIterator end, OutputIterator out) const
+		{
+			const double stddeviation = statistic::sd<double>(begin, end);
+
+			if(stddeviation == 0) {
+				std::fill_n(out, std::distance(begin, end), 0.5);
+				return;
+			}
+
+			// The values in units of the bandwidth
+			const double inv_bandwidth = 4.0 / stddeviation;
+			std::vector<double> scaled;
+			scaled.reserve(std::distance(begin, end));
+			for(InputIterator it = begin; it != end; ++it) {
+				scaled.push_back(*it * inv_bandwidth);
+			}
+
+			std::vector<double> sums;
+			kernelSums(scaled, sums);
+
+			const double n = scaled.size();
+			for(const double sum : sums) {
+				*out = sum / n;
+				++out;
+			}
+		}
+
+		/**
+		 * Computes sums[i] = sum_j cdf(values[i] - values[j]) for the
+		 * standard normal distribution. Depending on the number of values
+		 * and their range, one of two methods is used:
+		 *
+		 * - A sweep over the sorted values. Every pair of values is
+		 *   evaluated only once, as cdf(x) + cdf(-x) = 1. Pairs further
+		 *   apart than KERNEL_CUTOFF contribute exactly 0 or 1 (up to
+		 *   1e-17) and are only counted. The CDF is evaluated using
+		 *   detail::normalCDF, which has an absolute error below 1.2e-7.
+		 * - A grid with a spacing of GRID_SPACING. The values are
+		 *   distributed onto the two closest grid points by linear
+		 *   interpolation, the sums on the grid are computed by an FFT
+		 *   based convolution with a precomputed table of the CDF, and
+		 *   the sums of the values are interpolated linearly. As |pdf'|
+		 *   is at most pdf(1), each interpolation contributes at most
+		 *   GRID_SPACING^2 * pdf(1) / 8 per pair. Hence, the error of
+		 *   sums[i] is below 1e-6 * n.
+		 *
+		 * @param values The values in units of the kernel bandwidth.
+		 * @param sums   Receives the kernel sums of all values.
+		 */
+		static void kernelSums(const std::vector<double>& values, std::vector<double>& sums);
+
+		private:
+		static void sweepKernelSums_(const std::vector<double>& values, std::vector<double>& sums);
+		static void gridKernelSums_(const std::vector<double>& values, std::vector<double>& sums);
+
+		// cdf(-8.5) < 1e-17
+		static constexpr double KERNEL_CUTOFF = 8.5;
+		// Spacing of the grid used by gridKernelSums_ in bandwidths
+		static constexpr double GRID_SPACING = 1.0 / 256.0;
 	};
 	
 	 /**
@@ -108,6 +220,86 @@ namespace GeneTrail
 	
 		    return normalizedValue/std::distance(begin,end);
 		 }
+
+		/**
+		 * Normalizes all values of a row at once. This computes the same
+		 * values as calling normalizeValue for every entry of the row.
+		 *
+		 * The kernel sum only depends on the distinct values of the row,
+		 * which are few for count data. Hence the sums are computed once
+		 * per distinct value, weighted by the multiplicity of the kernel
+		 * centers. For small integer counts the CDF values are read from
+		 * a table that is shared by all rows.
+		 *
+		 * @param begin InputIterator corresponding to the begin of the row.
+		 * @param end   InputIterator corresponding to the end of the row.
+		 * @param out   OutputIterator receiving the normalized values in
+		 *              the order of the input.
+		 */
+		template <typename InputIterator, typename OutputIterator>
+		void normalizeRow(InputIterator begin, InputIterator end, OutputIterator out) const
+		{
+			const std::vector<double> values(begin, end);
+			const size_t n = values.size();
+
+			std::vector<double> distinct(values);
+			std::sort(distinct.begin(), distinct.end());
+
+			std::vector<double> multiplicity;
+			multiplicity.reserve(n);
+			size_t m = 0;
+			for(size_t i = 0; i < n; ++i) {
+				if(i == 0 || distinct[i] != distinct[m - 1]) {
+					distinct[m++] = distinct[i];
+					multiplicity.push_back(1.0);
+				} else {
+					multiplicity.back() += 1.0;
+				}
+			}
+			distinct.resize(m);
+
+			std::vector<double> sums(m, 0.0);
+			std::vector<double> cdfs(m);
+			for(size_t j = 0; j < m; ++j) {
+				kernelCDFs(distinct[j], distinct, cdfs);
+				for(size_t i = 0; i < m; ++i) {
+					sums[i] += multiplicity[j] * cdfs[i];
+				}
+			}
+
+			for(const double v : values) {
+				const size_t i = std::lower_bound(distinct.begin(), distinct.end(), v) - distinct.begin();
+				*out = sums[i] / n;
+				++out;
+			}
+		}
+
+		/**
+		 * The CDF of a poisson distribution with mean (center + 0.5)
+		 * evaluated at value.
+		 */
+		static double kernelCDF(double value, double center);
+
+		/**
+		 * Evaluates kernelCDF(values[i], center) for all values.
+		 *
+		 * For integer counts the CDF is advanced from one value to the
+		 * next using the recurrence pmf(k) = pmf(k - 1) * mean / k, so
+		 * that the incomplete gamma function only needs to be evaluated
+		 * if two consecutive values are far apart.
+		 *
+		 * @param center The center of the kernel.
+		 * @param values Values sorted in ascending order.
+		 * @param result Vector receiving the CDF values. Must have the
+		 *               same size as values.
+		 */
+		static void kernelCDFs(double center, const std::vector<double>& values, std::vector<double>& result);
+
+		private:
+		// Size of the table of precomputed CDF values for integer counts
+		static const size_t TABLE_SIZE = 256;
+		// Maximum number of recurrence steps between two values
+		static const size_t MAX_STEPS = 64;
 	};
 	
 	/**
@@ -156,6 +348,101 @@ namespace GeneTrail
 		  return (sd == 0) ? 0 : (normalizedValue - mean)/sd;
 		}
 
+		/**
+		 * Normalizes all values of a row at once in linear time. The
+		 * statistics excluding a value are derived from the sum of squared
+		 * deviations of the whole row. If a value dominates this sum, the
+		 * derived sum of squares of the other values suffers from
+		 * cancellation. It is then computed exactly from the other values.
+		 *
+		 * @param begin InputIterator corresponding to the begin of the row.
+		 * @param end   InputIterator corresponding to the end of the row.
+		 * @param out   OutputIterator receiving the normalized values in
+		 *              the order of the input. May be equal to begin.
+		 */
+		template <typename InputIterator, typename OutputIterator>
+		void normalizeRow(InputIterator begin, InputIterator end, OutputIterator out) const
+		{
+			const double n = std::distance(begin, end);
+
+			const double mean = statistic::mean<double>(begin, end);
+
+			double ss = 0.0;
+			for(InputIterator it = begin; it != end; ++it) {
+				ss += (*it - mean) * (*it - mean);
+			}
+
+			// All exclusive standard deviations of a constant row are zero
+			if(ss == 0.0) {
+				std::fill_n(out, size_t(n), 0.0);
+				return;
+			}
+
+			// The exact scores are computed before any output is written,
+			// as out may overwrite the row.
+			std::vector<std::pair<size_t, double>> exact;
+			size_t i = 0;
+			for(InputIterator it = begin; it != end; ++it, ++i) {
+				const double d = *it - mean;
+				if(!(ss - d * d * n / (n - 1) > ss * CANCELLATION_BOUND)) {
+					exact.emplace_back(i, exactValue_(it, begin, end));
+				}
+			}
+
+			auto next_exact = exact.begin();
+			i = 0;
+			for(InputIterator it = begin; it != end; ++it, ++i) {
+				if(next_exact != exact.end() && next_exact->first == i) {
+					*out = next_exact->second;
+					++next_exact;
+					++out;
+					continue;
+				}
+
+				const double v = *it;
+				const double d = v - mean;
+				// Mean and sum of squares of all values but v
+				const double exclusive_mean = mean - d / (n - 1);
+				const double exclusive_ss = ss - d * d * n / (n - 1);
+
+				const double sd = std::sqrt(exclusive_ss / (n - 2));
+				*out = (v - exclusive_mean) / sd;
+				++out;
+			}
+		}
+
+		private:
+		/**
+		 * Computes the exclusive Z-Score of 'value' in two passes over the
+		 * other values of the row.
+		 */
+		template <typename InputIterator>
+		double exactValue_(InputIterator value, InputIterator begin, InputIterator end) const
+		{
+			const double n = std::distance(begin, end);
+
+			double mean = 0.0;
+			for(InputIterator it = begin; it != end; ++it) {
+				if(it != value) {
+					mean += *it;
+				}
+			}
+			mean /= (n - 1);
+
+			double ss = 0.0;
+			for(InputIterator it = begin; it != end; ++it) {
+				if(it != value) {
+					ss += (*it - mean) * (*it - mean);
+				}
+			}
+
+			const double sd = std::sqrt(ss / (n - 2));
+			return (sd == 0) ? 0 : (*value - mean) / sd;
+		}
+
+		// Below this fraction of the row's sum of squares the derived
+		// exclusive sum of squares is computed exactly
+		static constexpr double CANCELLATION_BOUND = 1e-8;
 	};
 	
 	/**
@@ -188,13 +475,11 @@ namespace GeneTrail
 		 template<typename InputIterator, typename Matrix, typename Normalization> 
 		 void normalizeRange(InputIterator in_begin, InputIterator in_end, Matrix& matrix, int row_index,  Normalization& norm) {
 		   
-		   int col_index = 0;
-		   
-		   // Iterate over one row (samples of one gene)
-		   for(InputIterator iter = in_begin ;iter != in_end; ++iter) {
-		     
-		     matrix.set(row_index, col_index,norm.normalizeValue(iter, in_begin, in_end));
-		     ++col_index;
+		   std::vector<double> normalized(std::distance(in_begin, in_end));
+		   norm.normalizeRow(in_begin, in_end, normalized.begin());
+
+		   for(size_t col_index = 0; col_index < normalized.size(); ++col_index) {
+		     matrix.set(row_index, col_index, normalized[col_index]);
 		   }
 		 }
 		 
@@ -207,31 +492,51 @@ namespace GeneTrail
 		 * GSVA: gene set variation analysis for microarray and RNA-Seq data
 		 * by Hänzelmann et al. (DOI: 10.1186/1471-2105-14-7)
 		 *
+		 * The rows are normalized in parallel.
+		 *
 		 * @param matrix	The matrix to be normalized.
 		 * @param norm		The distribution (gaussian, poisson) used for kernel density estimation,
 		 * 			or the exclusive Z-Score
+		 * @param num_threads	The number of threads. 0 uses all available cores.
 		 *
 		 * @return normalized matrix
 		 */
 		 template<typename Normalization, typename Matrix> 
-		 DenseMatrix normalizeMatrix( const Matrix& matrix,  Normalization& norm) {
+		 DenseMatrix normalizeMatrix( const Matrix& matrix,  Normalization& norm, size_t num_threads = 0) {
 		   
 		  DenseMatrix normalizedMatrix(matrix.rowNames(), matrix.colNames());
-		   
-		  RowMajorMatrixIterator<Matrix> row_it(&matrix, 0);
-		  RowMajorMatrixIterator<Matrix> row_end(&matrix, matrix.rows());
-		   
-		   int row_index = 0;
-		   
-		  // Iterate over each row (each gene)
-		  for(; row_it != row_end; ++row_it) {
-		     // compute normalization for each sample of the gene
-		     normalizeRange(row_it->begin(), row_it->end(), normalizedMatrix, row_index, norm);
-		     ++row_index;
-		   }
+		  DenseMatrix::DMatrix& result = normalizedMatrix.matrix();
+		  const Normalization& n = norm;
+
+		  // Rows are processed in blocks that share one row buffer
+		  const size_t rows = matrix.rows();
+		  const size_t num_blocks = (rows + ROW_BLOCK_SIZE - 1) / ROW_BLOCK_SIZE;
+
+		  parallel_for(0, num_blocks, [&](size_t b) {
+		    std::vector<double> row(matrix.cols());
+		    const size_t last = std::min(rows, (b + 1) * ROW_BLOCK_SIZE);
+
+		    // Iterate over each row (each gene)
+		    for(size_t i = b * ROW_BLOCK_SIZE; i < last; ++i) {
+		      for(size_t j = 0; j < row.size(); ++j) {
+		        row[j] = matrix(i, j);
+		      }
+
+		      // compute normalization for each sample of the gene
+		      n.normalizeRow(row.begin(), row.end(), row.begin());
+
+		      for(size_t j = 0; j < row.size(); ++j) {
+		        result(i, j) = row[j];
+		      }
+		    }
+		  }, num_threads);
 		   
 		   return normalizedMatrix;
 		 }
+
+		private:
+		// Number of rows normalized by one task of normalizeMatrix
+		static constexpr size_t ROW_BLOCK_SIZE = 64;
 	};
   
 }
@@ -22,13 +22,17 @@
 #ifndef GT2_MATRIX_TRANSFORMATION_H
 #define GT2_MATRIX_TRANSFORMATION_H
 
+#include <algorithm>
 #include <numeric> 
 #include <cmath>
+#include <vector>
 
 #include "macros.h"
+#include "DenseMatrix.h"
 #include "Matrix.h"
 #include "Statistic.h"
 #include "MatrixIterator.h"
+#include "Parallel.h"
 
 namespace GeneTrail
 {	
@@ -54,6 +58,34 @@ namespace GeneTrail
 	     }
 	     return;
 	  }
+
+	/**
+	 * Specialization of valuesToRanks for dense matrices. The columns are
+	 * accessed directly in the underlying Eigen matrix and ranked in
+	 * parallel. Ties are ranked in the order of their rows.
+	 *
+	 * @param matrix      The Matrix whose values should be transformed into ranks.
+	 * @param num_threads The number of threads. 0 uses all available cores.
+	 */
+	  inline void valuesToRanks(DenseMatrix& in_matrix, size_t num_threads = 0) {
+	    DenseMatrix::DMatrix& m = in_matrix.matrix();
+	    const size_t rows = m.rows();
+
+	    parallel_for(0, m.cols(), [&](size_t c) {
+	      const double* column = m.col(c).data();
+
+	      std::vector<size_t> rankVec(rows);
+	      std::iota(rankVec.begin(), rankVec.end(), 0);
+	      std::sort(rankVec.begin(), rankVec.end(), [column](size_t a, size_t b) {
+	        return column[a] > column[b] || (column[a] == column[b] && a < b);
+	      });
+
+	      double* out = m.col(c).data();
+	      for(size_t v = 0; v < rows; ++v) {
+	        out[rankVec[v]] = v + 1;
+	      }
+	    }, num_threads);
+	  }
 	  
 	/**
 	 * This function applies a function to each value of the Matrix
@@ -71,6 +103,32 @@ namespace GeneTrail
 		}
 	      }
 	  }
+
+	/**
+	 * Specialization of transformMatrix for dense matrices. The function is
+	 * applied to the contiguous columns of the underlying Eigen matrix.
+	 * Large matrices are processed in parallel.
+	 *
+	 * @param matrix      The Matrix to which the function should be applied.
+	 * @param f           The function that should be applied. It must be
+	 *                    safe to call it concurrently.
+	 * @param num_threads The number of threads. 0 uses all available cores.
+	 */
+	  template <typename Func>
+	  void transformMatrix(DenseMatrix& matrix, Func f, size_t num_threads = 0){
+	    DenseMatrix::DMatrix& m = matrix.matrix();
+	    const size_t rows = m.rows();
+
+	    // Only use additional threads for large matrices.
+	    const size_t grain_size = std::max(size_t(1), size_t(1 << 16) / std::max(rows, size_t(1)));
+
+	    parallel_for(0, m.cols(), [&](size_t c) {
+	      double* column = m.col(c).data();
+	      for(size_t i = 0; i < rows; ++i) {
+	        column[i] = f(column[i]);
+	      }
+	    }, num_threads, grain_size);
+	  }
 	  
  
 	/**
@@ -23,7 +23,10 @@ using namespace GeneTrail;
 
 OverRepresentationAnalysis::OverRepresentationAnalysis(
     const Category& reference_set, const Category& test_set)
-    : reference_set_(reference_set), test_set_(test_set)
+    : reference_set_(reference_set),
+      reference_bits_(reference_set),
+      test_set_(test_set),
+      test_bits_(test_set)
 {
 	m_ = reference_set_.size();
 	n_ = test_set_.size();
@@ -33,12 +36,26 @@ OverRepresentationAnalysis::OverRepresentationAnalysis(
 
 OverRepresentationAnalysis::OverRepresentationAnalysis(
     const Category& reference_set, const Category& test_set, bool useHypergeometricTest)
-    : reference_set_(reference_set), test_set_(test_set), useHypergeometricTest_(useHypergeometricTest)
+    : reference_set_(reference_set),
+      reference_bits_(reference_set),
+      test_set_(test_set),
+      test_bits_(test_set),
+      useHypergeometricTest_(useHypergeometricTest)
 {
 	m_ = reference_set_.size();
 	n_ = test_set_.size();
 }
 
+OverRepresentationAnalysis::OverRepresentationAnalysis(
+    size_t reference_size, size_t test_size, bool useHypergeometricTest)
+    : reference_set_(nullptr),
+      m_(reference_size),
+      test_set_(nullptr),
+      n_(test_size),
+      useHypergeometricTest_(useHypergeometricTest)
+{
+}
+
 bool
 OverRepresentationAnalysis::categoryContainsAllGenes(const Category& reference,
                                                      const Category& testSet)
@@ -53,11 +70,14 @@ OverRepresentationAnalysis::categoryContainsAllGenes(const Category& reference,
 }
 
 double OverRepresentationAnalysis::numberOfHits(const Category& category) const {
-	return static_cast<double>(Category::intersect("null", category, test_set_).size());
+	return static_cast<double>(test_bits_.intersectionSize(category));
 }
 
 double OverRepresentationAnalysis::expectedNumberOfHits(const Category& category) const {
-	auto l = Category::intersect("null", category, reference_set_).size();
+	return expectedNumberOfHits(reference_bits_.intersectionSize(category));
+}
+
+double OverRepresentationAnalysis::expectedNumberOfHits(size_t l) const {
 	return (l * n_) / static_cast<double>(m_);
 }
 
@@ -87,9 +107,14 @@ double OverRepresentationAnalysis::computePValue(const Category& category) const
 	// GeneTrail 1
 	// size_t l = category.size();
 
-	size_t k = Category::intersect("null", category, test_set_).size();
-	size_t l = Category::intersect("null", category, reference_set_).size();
+	size_t k = test_bits_.intersectionSize(category);
+	size_t l = reference_bits_.intersectionSize(category);
 
+	return computePValue(l, k);
+}
+
+double OverRepresentationAnalysis::computePValue(size_t l, size_t k) const
+{
 	auto expected_k = ((double)l * n_) / ((double)m_);
 	bool enriched = expected_k < k;
 
@@ -102,9 +127,14 @@ double OverRepresentationAnalysis::computeUpperTailedPValue(const Category& cate
 	// GeneTrail 1
 	// size_t l = category.size();
 
-	size_t k = Category::intersect("null", category, test_set_).size();
-	size_t l = Category::intersect("null", category, reference_set_).size();
+	size_t k = test_bits_.intersectionSize(category);
+	size_t l = reference_bits_.intersectionSize(category);
+
+	return computeUpperTailedPValue(l, k);
+}
 
+double OverRepresentationAnalysis::computeUpperTailedPValue(size_t l, size_t k) const
+{
 	return computePValue_(l, k, true);
 }
 
@@ -114,9 +144,14 @@ double OverRepresentationAnalysis::computeLowerTailedPValue(const Category& cate
 	// GeneTrail 1
 	// size_t l = category.size();
 
-	size_t k = Category::intersect("null", category, test_set_).size();
-	size_t l = Category::intersect("null", category, reference_set_).size();
+	size_t k = test_bits_.intersectionSize(category);
+	size_t l = reference_bits_.intersectionSize(category);
+
+	return computeLowerTailedPValue(l, k);
+}
 
+double OverRepresentationAnalysis::computeLowerTailedPValue(size_t l, size_t k) const
+{
 	return computePValue_(l, k, false);
 }
 
@@ -125,8 +160,8 @@ double OverRepresentationAnalysis::computeScore(const Category& category) const
 	// GeneTrail 1
 	// size_t l = category.size();
 
-	size_t k = Category::intersect("null", category, test_set_).size();
-	size_t l = Category::intersect("null", category, reference_set_).size();
+	size_t k = test_bits_.intersectionSize(category);
+	size_t l = reference_bits_.intersectionSize(category);
 
 	if(useHypergeometricTest_) {
 		return hyperTest_.compute(m_, l, n_, k).convert_to<double>();
@@ -134,3 +169,13 @@ double OverRepresentationAnalysis::computeScore(const Category& category) const
 		return fisherTest_.compute(m_, l, n_, k).convert_to<double>();
 	}
 }
+
+size_t OverRepresentationAnalysis::referenceHits(const Category& category) const
+{
+	return reference_bits_.intersectionSize(category);
+}
+
+size_t OverRepresentationAnalysis::testHits(const Category& category) const
+{
+	return test_bits_.intersectionSize(category);
+}
@@ -23,6 +23,7 @@
 #include "macros.h"
 
 #include "Category.h"
+#include "EntityBitmap.h"
 #include "FishersExactTest.h"
 #include "HypergeometricTest.h"
 #include "multiprecision.h"
@@ -58,6 +59,13 @@ namespace GeneTrail {
 			
 			OverRepresentationAnalysis(const Category& reference_set, const Category& test_set, bool);
 
+			/**
+			 * Creates an ORA that only knows the sizes of the reference
+			 * and test set. Only the methods taking the number of hits
+			 * can be used.
+			 */
+			OverRepresentationAnalysis(size_t reference_size, size_t test_size, bool useHypergeometricTest);
+
 			/**
 			 * This method computes a one-sided p-value.
 			 *
@@ -76,15 +84,51 @@ namespace GeneTrail {
 			double numberOfHits(const Category& category) const;
 
 			double expectedNumberOfHits(const Category& category) const;
+
+			/**
+			 * The p-values and the expected number of hits for a category
+			 * with l members in the reference set and k members in the
+			 * test set.
+			 */
+			double computePValue(size_t l, size_t k) const;
+
+			double computeUpperTailedPValue(size_t l, size_t k) const;
+
+			double computeLowerTailedPValue(size_t l, size_t k) const;
+
+			double expectedNumberOfHits(size_t l) const;
+
+			/**
+			 * The parameters the count based methods depend on.
+			 */
+			size_t referenceSize() const { return m_; }
+
+			size_t testSize() const { return n_; }
+
+			bool usesHypergeometricTest() const { return useHypergeometricTest_; }
+
+			/**
+			 * The number of members of the category contained in the
+			 * reference set.
+			 */
+			size_t referenceHits(const Category& category) const;
+
+			/**
+			 * The number of members of the category contained in the
+			 * test set.
+			 */
+			size_t testHits(const Category& category) const;
 		private:
 
 			double computePValue_(size_t l, size_t k, bool enriched) const;
 
 			Category reference_set_;
+			EntityBitmap reference_bits_;
 			//Size of reference set
 			size_t m_;
 
 			Category test_set_;
+			EntityBitmap test_bits_;
 			//Size of test set
 			size_t n_;
 
@@ -19,11 +19,487 @@
  */
 #include "PValue.h"
 
+#include "Parallel.h"
+
+#include <boost/filesystem.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <queue>
+
 namespace GeneTrail
 {
 namespace pvalue
 {
 
+namespace
+{
+// Number of consecutive elements processed by a thread at once
+const size_t GRAIN_SIZE = 1 << 16;
+
+struct IndexedValue
+{
+	double value;
+	uint64_t index;
+};
+
+/**
+ * The order based methods compute f(p, n, i) * factor for the i-th smallest
+ * p-value and then take the cumulative minimum starting from the largest
+ * p-value (step-up) or the cumulative maximum starting from the smallest
+ * p-value (step-down). Ranks and sizes are passed as double to avoid
+ * integer overflows for huge inputs.
+ */
+struct OrderAdjustment
+{
+	double (*f)(double p, double n, double i);
+	double factor;
+	bool step_up;
+};
+
+double holm_f(double p, double n, double i) { return p * (n - i + 1); }
+
+double holm_sidak_f(double p, double n, double i)
+{
+	return 1.0 - std::pow(1.0 - p, n - i + 1);
+}
+
+double finner_f(double p, double n, double i)
+{
+	return 1.0 - std::pow(1.0 - p, n / i);
+}
+
+double fdr_f(double p, double n, double i) { return (n * p) / i; }
+
+bool isOrderBased(MultipleTestingCorrection method)
+{
+	switch(method) {
+		case MultipleTestingCorrection::Bonferroni:
+		case MultipleTestingCorrection::Sidak:
+		case MultipleTestingCorrection::GSEA:
+			return false;
+		default:
+			return true;
+	}
+}
+
+OrderAdjustment orderAdjustment(MultipleTestingCorrection method, size_t n)
+{
+	switch(method) {
+		case MultipleTestingCorrection::Holm:
+			return {holm_f, 1.0, false};
+		case MultipleTestingCorrection::HolmSidak:
+			return {holm_sidak_f, 1.0, false};
+		case MultipleTestingCorrection::Finner:
+			return {finner_f, 1.0, false};
+		case MultipleTestingCorrection::BenjaminiHochberg:
+		case MultipleTestingCorrection::Simes:
+			return {fdr_f, 1.0, true};
+		case MultipleTestingCorrection::BenjaminiYekutieli: {
+			double q = 0.0;
+			for(size_t i = 0; i < n; ++i) {
+				q += 1 / (i + 1.0);
+			}
+			return {fdr_f, q, true};
+		}
+		case MultipleTestingCorrection::Hochberg:
+			return {holm_f, 1.0, true};
+		default:
+			throw NotImplemented(__FILE__, __LINE__, "The requested correction "
+			                                         "method has not yet been "
+			                                         "implemented.");
+	}
+}
+
+/**
+ * Applies Bonferroni, Sidak or GSEA (no-op) correction to count p-values
+ * out of a total of n p-values.
+ */
+void adjustBySizeInPlace(double* pvalues, size_t count, size_t n,
+                         MultipleTestingCorrection method, size_t num_threads)
+{
+	switch(method) {
+		case MultipleTestingCorrection::Bonferroni:
+			parallel_for(0, count, [pvalues, n](size_t i) {
+				pvalues[i] = std::min(bonferroni_func(pvalues[i], n), 1.0);
+			}, num_threads, GRAIN_SIZE);
+			return;
+		case MultipleTestingCorrection::Sidak:
+			parallel_for(0, count, [pvalues, n](size_t i) {
+				pvalues[i] = std::min(sidak_func(pvalues[i], n), 1.0);
+			}, num_threads, GRAIN_SIZE);
+			return;
+		default:
+			return;
+	}
+}
+
+/**
+ * Computes the step-up/step-down minima/maxima of the adjusted p-values,
+ * which are given in ascending order of the original p-values, and writes
+ * them back to their original position.
+ *
+ * Every block first computes its own running minimum/maximum. The block
+ * results are then combined sequentially and applied to all elements in
+ * a second parallel pass.
+ */
+void cumulateAndScatter(std::vector<double>& adjusted,
+                        const std::vector<size_t>& order, bool step_up,
+                        double* pvalues, size_t num_threads)
+{
+	const size_t n = adjusted.size();
+	if(n == 0) {
+		return;
+	}
+
+	if(num_threads == 0) {
+		num_threads = defaultNumberOfThreads();
+	}
+
+	const size_t num_blocks = std::max(size_t(1), std::min(num_threads, n / GRAIN_SIZE));
+	std::vector<size_t> bounds(num_blocks + 1);
+	for(size_t b = 0; b <= num_blocks; ++b) {
+		bounds[b] = b * n / num_blocks;
+	}
+
+	parallel_for(0, num_blocks, [&](size_t b) {
+		if(step_up) {
+			for(size_t i = bounds[b + 1] - 1; i > bounds[b]; --i) {
+				adjusted[i - 1] = std::min(adjusted[i - 1], adjusted[i]);
+			}
+		} else {
+			for(size_t i = bounds[b] + 1; i < bounds[b + 1]; ++i) {
+				adjusted[i] = std::max(adjusted[i - 1], adjusted[i]);
+			}
+		}
+	}, num_threads);
+
+	// carry[b] is the minimum of all following / maximum of all preceding blocks
+	std::vector<double> carry(num_blocks);
+	if(step_up) {
+		carry[num_blocks - 1] = std::numeric_limits<double>::infinity();
+		for(size_t b = num_blocks - 1; b > 0; --b) {
+			carry[b - 1] = std::min(carry[b], adjusted[bounds[b]]);
+		}
+	} else {
+		carry[0] = -std::numeric_limits<double>::infinity();
+		for(size_t b = 1; b < num_blocks; ++b) {
+			carry[b] = std::max(carry[b - 1], adjusted[bounds[b] - 1]);
+		}
+	}
+
+	parallel_for(0, num_blocks, [&](size_t b) {
+		for(size_t i = bounds[b]; i < bounds[b + 1]; ++i) {
+			const double p = step_up ? std::min(adjusted[i], carry[b])
+			                         : std::max(adjusted[i], carry[b]);
+			pvalues[order[i]] = std::min(p, 1.0);
+		}
+	}, num_threads);
+}
+
+/**
+ * Removes a temporary directory and all its content on destruction.
+ */
+struct TemporaryDirectory
+{
+	TemporaryDirectory()
+	    : path(boost::filesystem::temp_directory_path() /
+	           boost::filesystem::unique_path("gt2-pvalues-%%%%-%%%%-%%%%-%%%%"))
+	{
+		boost::filesystem::create_directories(path);
+	}
+
+	~TemporaryDirectory()
+	{
+		boost::system::error_code ec;
+		boost::filesystem::remove_all(path, ec);
+	}
+
+	std::string file(const std::string& prefix, size_t i) const
+	{
+		return (path / (prefix + std::to_string(i))).native();
+	}
+
+	boost::filesystem::path path;
+};
+
+template <typename T>
+void readValues(std::ifstream& in, T* data, size_t count, const std::string& file)
+{
+	if(!in.read(reinterpret_cast<char*>(data), count * sizeof(T))) {
+		throw IOError("Could not read from file (" + file + ")");
+	}
+}
+
+template <typename T>
+void writeValues(std::ofstream& out, const T* data, size_t count, const std::string& file)
+{
+	if(!out.write(reinterpret_cast<const char*>(data), count * sizeof(T))) {
+		throw IOError("Could not write to file (" + file + ")");
+	}
+}
+
+std::ifstream openInput(const std::string& file)
+{
+	std::ifstream in(file, std::ios::binary);
+	if(!in) {
+		throw IOError("File (" + file + ") is not open for reading");
+	}
+	return in;
+}
+
+std::ofstream openOutput(const std::string& file)
+{
+	std::ofstream out(file, std::ios::binary);
+	if(!out) {
+		throw IOError("File (" + file + ") is not open for writing");
+	}
+	return out;
+}
+
+// Maximum number of runs that are merged at once, which bounds the number
+// of open files independent of the input size.
+const size_t MAX_MERGE_FAN_IN = 64;
+
+/**
+ * Merges the sorted runs stored in files[begin, end) and passes the
+ * elements to emit in the order given by before.
+ */
+template <typename Before, typename Emit>
+void mergeRuns(const std::vector<std::string>& files, size_t begin,
+               size_t end, const Before& before, Emit emit)
+{
+	std::vector<std::ifstream> runs;
+	runs.reserve(end - begin);
+	for(size_t r = begin; r < end; ++r) {
+		runs.emplace_back(openInput(files[r]));
+	}
+
+	using Head = std::pair<IndexedValue, size_t>;
+	auto after = [&before](const Head& a, const Head& b) {
+		return before(b.first, a.first);
+	};
+	std::priority_queue<Head, std::vector<Head>, decltype(after)> heads(after);
+
+	auto next = [&](size_t r) {
+		IndexedValue v;
+		if(runs[r].read(reinterpret_cast<char*>(&v), sizeof(v))) {
+			heads.emplace(v, r);
+		}
+	};
+
+	for(size_t r = 0; r < runs.size(); ++r) {
+		next(r);
+	}
+
+	while(!heads.empty()) {
+		const Head head = heads.top();
+		heads.pop();
+		next(head.second);
+		emit(head.first);
+	}
+}
+
+/**
+ * Merges the sorted runs stored in files and passes the elements to emit
+ * in the order given by before. At most MAX_MERGE_FAN_IN runs are opened
+ * at once; if there are more, groups of runs are first merged into longer
+ * runs in the temporary directory.
+ */
+template <typename Before, typename Emit>
+void mergeAllRuns(const TemporaryDirectory& tmp, std::vector<std::string> files,
+                  const Before& before, Emit emit)
+{
+	size_t pass = 0;
+	while(files.size() > MAX_MERGE_FAN_IN) {
+		std::vector<std::string> merged;
+		for(size_t begin = 0; begin < files.size(); begin += MAX_MERGE_FAN_IN) {
+			const size_t end = std::min(begin + MAX_MERGE_FAN_IN, files.size());
+			merged.push_back(tmp.file("pass" + std::to_string(pass) + "_", merged.size()));
+			auto out = openOutput(merged.back());
+			mergeRuns(files, begin, end, before, [&](const IndexedValue& v) {
+				writeValues(out, &v, 1, merged.back());
+			});
+			for(size_t r = begin; r < end; ++r) {
+				boost::filesystem::remove(files[r]);
+			}
+		}
+		files = std::move(merged);
+		++pass;
+	}
+
+	mergeRuns(files, 0, files.size(), before, emit);
+}
+} // namespace
+
+std::vector<size_t> sortPermutation(const double* pvalues, size_t n,
+                                    size_t num_threads)
+{
+	std::vector<IndexedValue> indexed(n);
+	parallel_for(0, n, [&](size_t i) {
+		indexed[i] = IndexedValue{pvalues[i], i};
+	}, num_threads, GRAIN_SIZE);
+
+	parallel_sort(indexed.begin(), indexed.end(),
+	              [](const IndexedValue& a, const IndexedValue& b) {
+		              return a.value < b.value;
+		          },
+	              num_threads);
+
+	std::vector<size_t> order(n);
+	parallel_for(0, n, [&](size_t i) {
+		order[i] = indexed[i].index;
+	}, num_threads, GRAIN_SIZE);
+
+	return order;
+}
+
+void adjustPValuesInPlace(double* pvalues, size_t n,
+                          MultipleTestingCorrection method, size_t num_threads)
+{
+	if(!isOrderBased(method)) {
+		adjustBySizeInPlace(pvalues, n, n, method, num_threads);
+		return;
+	}
+
+	adjustPValuesInPlace(pvalues, sortPermutation(pvalues, n, num_threads),
+	                     method, num_threads);
+}
+
+void adjustPValuesInPlace(double* pvalues, const std::vector<size_t>& order,
+                          MultipleTestingCorrection method, size_t num_threads)
+{
+	const size_t n = order.size();
+
+	if(!isOrderBased(method)) {
+		adjustBySizeInPlace(pvalues, n, n, method, num_threads);
+		return;
+	}
+
+	const OrderAdjustment adj = orderAdjustment(method, n);
+
+	std::vector<double> adjusted(n);
+	parallel_for(0, n, [&](size_t i) {
+		adjusted[i] = adj.f(pvalues[order[i]], n, i + 1.0) * adj.factor;
+	}, num_threads, GRAIN_SIZE);
+
+	cumulateAndScatter(adjusted, order, adj.step_up, pvalues, num_threads);
+}
+
+void adjustPValuesFile(const std::string& input, const std::string& output,
+                       MultipleTestingCorrection method,
+                       size_t max_values_in_memory, size_t num_threads)
+{
+	const size_t chunk_size = std::max(max_values_in_memory, size_t(1));
+
+	boost::system::error_code ec;
+	const uintmax_t file_size = boost::filesystem::file_size(input, ec);
+	if(ec || file_size % sizeof(double) != 0) {
+		throw IOError("File (" + input + ") is not a binary file of p-values");
+	}
+	const size_t n = file_size / sizeof(double);
+
+	auto in = openInput(input);
+	auto out = openOutput(output);
+
+	std::vector<double> chunk;
+
+	if(n <= chunk_size) {
+		chunk.resize(n);
+		readValues(in, chunk.data(), n, input);
+		adjustPValuesInPlace(chunk.data(), n, method, num_threads);
+		writeValues(out, chunk.data(), n, output);
+		return;
+	}
+
+	if(!isOrderBased(method)) {
+		chunk.resize(chunk_size);
+		for(size_t begin = 0; begin < n; begin += chunk_size) {
+			const size_t count = std::min(chunk_size, n - begin);
+			readValues(in, chunk.data(), count, input);
+			adjustBySizeInPlace(chunk.data(), count, n, method, num_threads);
+			writeValues(out, chunk.data(), count, output);
+		}
+		return;
+	}
+
+	const OrderAdjustment adj = orderAdjustment(method, n);
+	const size_t num_chunks = (n + chunk_size - 1) / chunk_size;
+
+	// Step-up methods are computed starting with the largest p-value
+	auto before = [&adj](const IndexedValue& a, const IndexedValue& b) {
+		return adj.step_up ? a.value > b.value : a.value < b.value;
+	};
+
+	TemporaryDirectory tmp;
+
+	// Sorts run and writes it to a new temporary file
+	auto writeRun = [&](std::vector<IndexedValue>& run, const std::string& prefix,
+	                    std::vector<std::string>& files, const auto& order) {
+		parallel_sort(run.begin(), run.end(), order, num_threads);
+		files.push_back(tmp.file(prefix, files.size()));
+		auto run_out = openOutput(files.back());
+		writeValues(run_out, run.data(), run.size(), files.back());
+	};
+
+	// 1. Write runs of at most chunk_size p-values sorted by value
+	std::vector<std::string> sorted_runs;
+	std::vector<IndexedValue> run;
+	chunk.resize(chunk_size);
+	for(size_t r = 0; r < num_chunks; ++r) {
+		const size_t begin = r * chunk_size;
+		const size_t count = std::min(chunk_size, n - begin);
+		readValues(in, chunk.data(), count, input);
+
+		run.resize(count);
+		for(size_t i = 0; i < count; ++i) {
+			run[i] = IndexedValue{chunk[i], begin + i};
+		}
+		writeRun(run, "run", sorted_runs, before);
+	}
+	chunk = std::vector<double>();
+
+	// 2. Merge the runs and compute the adjusted p-values in rank order.
+	//    Every chunk_size adjusted p-values are written as a run sorted by
+	//    their original position.
+	auto by_index = [](const IndexedValue& a, const IndexedValue& b) {
+		return a.index < b.index;
+	};
+
+	std::vector<std::string> adjusted_runs;
+	run.clear();
+	size_t k = 0;
+	double current = adj.step_up ? std::numeric_limits<double>::infinity()
+	                             : -std::numeric_limits<double>::infinity();
+	mergeAllRuns(tmp, std::move(sorted_runs), before, [&](const IndexedValue& v) {
+		const double rank = adj.step_up ? double(n - k) : double(k + 1);
+		const double p = adj.f(v.value, n, rank) * adj.factor;
+		current = adj.step_up ? std::min(current, p) : std::max(current, p);
+		++k;
+
+		run.push_back(IndexedValue{std::min(current, 1.0), v.index});
+		if(run.size() == chunk_size) {
+			writeRun(run, "adjusted", adjusted_runs, by_index);
+			run.clear();
+		}
+	});
+
+	if(k != n) {
+		throw IOError("Temporary file in " + tmp.path.native() + " is truncated");
+	}
+	if(!run.empty()) {
+		writeRun(run, "adjusted", adjusted_runs, by_index);
+	}
+	run = std::vector<IndexedValue>();
+
+	// 3. Restore the original order by merging the runs by position
+	mergeAllRuns(tmp, std::move(adjusted_runs), by_index, [&](const IndexedValue& v) {
+		writeValues(out, &v.value, 1, output);
+	});
+}
+
 boost::optional<MultipleTestingCorrection>
 getCorrectionMethod(const std::string& method)
 {
@@ -26,9 +26,11 @@
 
 #include <algorithm>
 #include <cmath>
+#include <string>
 #include <utility>
 #include <tuple>
 #include <type_traits>
+#include <vector>
 
 #include <boost/math/distributions/chi_squared.hpp>
 #include <boost/math/distributions/normal.hpp>
@@ -488,6 +490,68 @@ rcref<PValues> adjustPValues(PValues&& pvalues, Access&& access,
 	}
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Flat array adjustments
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Computes the permutation that sorts the given p-values ascendingly,
+ * i.e. pvalues[order[0]] <= pvalues[order[1]] <= ...
+ *
+ * The permutation can be passed to adjustPValuesInPlace to correct the
+ * same p-values with several methods without sorting them again.
+ *
+ * @param pvalues     Pointer to n p-values. NaNs are not allowed.
+ * @param n           The number of p-values.
+ * @param num_threads Number of threads. 0 uses all available cores.
+ */
+GT2_EXPORT std::vector<size_t> sortPermutation(const double* pvalues, size_t n,
+                                               size_t num_threads = 0);
+
+/**
+ * Adjusts an array of p-values in place. In contrast to adjustPValues the
+ * p-values keep their position, so that no container of (name, p-value)
+ * pairs needs to be built and sorted. Sorting, the step-up/step-down
+ * passes and the final scatter run in parallel. The results are identical
+ * to adjustPValues.
+ *
+ * @param pvalues     Pointer to n p-values. NaNs are not allowed.
+ * @param n           The number of p-values.
+ * @param method      The method for multiple testing correction.
+ * @param num_threads Number of threads. 0 uses all available cores.
+ */
+GT2_EXPORT void adjustPValuesInPlace(double* pvalues, size_t n,
+                                     MultipleTestingCorrection method,
+                                     size_t num_threads = 0);
+
+/**
+ * Overload of adjustPValuesInPlace that uses a precomputed sortPermutation
+ * of the p-values.
+ */
+GT2_EXPORT void adjustPValuesInPlace(double* pvalues,
+                                     const std::vector<size_t>& order,
+                                     MultipleTestingCorrection method,
+                                     size_t num_threads = 0);
+
+/**
+ * Adjusts p-values that are stored in a binary file of doubles (host byte
+ * order) and writes the adjusted p-values in the same order to output.
+ *
+ * At most max_values_in_memory p-values are held in memory at any time.
+ * Larger inputs are sorted externally: sorted runs are written to
+ * temporary files and merged to compute the ranks and the step-up/step-down
+ * minima/maxima. The results are written as runs sorted by position, which
+ * are merged again to restore the original order. At most 64 runs are
+ * merged at once, longer inputs need additional merge passes.
+ *
+ * @throws IOError if a file cannot be read or written.
+ */
+GT2_EXPORT void adjustPValuesFile(const std::string& input,
+                                  const std::string& output,
+                                  MultipleTestingCorrection method,
+                                  size_t max_values_in_memory,
+                                  size_t num_threads = 0);
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // P-value aggregation
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,175 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_CORE_PARALLEL_H
+#define GT2_CORE_PARALLEL_H
+
+#include "macros.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GeneTrail
+{
+	/**
+	 * Returns the number of threads that should be used by default for
+	 * parallel loops. This is the number of hardware threads, but at least one.
+	 */
+	inline size_t defaultNumberOfThreads()
+	{
+		return std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	/**
+	 * Calls f(i) for every i in [begin, end) using num_threads worker
+	 * threads. Indices are handed out dynamically in blocks of grain_size
+	 * elements, which keeps the threads busy even if the cost per index
+	 * varies strongly.
+	 *
+	 * The first exception thrown by f is rethrown in the calling thread
+	 * after all workers have finished.
+	 *
+	 * @param begin       First index of the range.
+	 * @param end         End of the range (exclusive).
+	 * @param f           The loop body. Must be safe to call concurrently.
+	 * @param num_threads Number of threads. 0 selects defaultNumberOfThreads().
+	 * @param grain_size  Number of consecutive indices processed per block.
+	 */
+	template <typename Function>
+	void parallel_for(size_t begin, size_t end, Function&& f,
+	                  size_t num_threads = 0, size_t grain_size = 1)
+	{
+		if(begin >= end) {
+			return;
+		}
+
+		if(num_threads == 0) {
+			num_threads = defaultNumberOfThreads();
+		}
+
+		grain_size = std::max(grain_size, size_t(1));
+		const size_t num_blocks = (end - begin + grain_size - 1) / grain_size;
+		num_threads = std::min(num_threads, num_blocks);
+
+		if(num_threads <= 1) {
+			for(size_t i = begin; i < end; ++i) {
+				f(i);
+			}
+			return;
+		}
+
+		std::atomic<size_t> next(begin);
+		std::exception_ptr error;
+		std::mutex error_mutex;
+
+		auto worker = [&]() {
+			try {
+				for(size_t b = next.fetch_add(grain_size); b < end;
+				    b = next.fetch_add(grain_size)) {
+					const size_t e = std::min(end, b + grain_size);
+					for(size_t i = b; i < e; ++i) {
+						f(i);
+					}
+				}
+			} catch(...) {
+				std::lock_guard<std::mutex> lock(error_mutex);
+				if(!error) {
+					error = std::current_exception();
+				}
+				// Make the remaining workers stop early
+				next = end;
+			}
+		};
+
+		std::vector<std::thread> threads;
+		threads.reserve(num_threads - 1);
+		for(size_t t = 1; t < num_threads; ++t) {
+			threads.emplace_back(worker);
+		}
+
+		worker();
+
+		for(auto& t : threads) {
+			t.join();
+		}
+
+		if(error) {
+			std::rethrow_exception(error);
+		}
+	}
+
+	/**
+	 * Sorts the range [begin, end) using num_threads threads. The range is
+	 * split into one block per thread, the blocks are sorted concurrently
+	 * and then merged pairwise. Like std::sort, the sort is not stable.
+	 *
+	 * @param begin       Random access iterator to the first element.
+	 * @param end         Random access iterator past the last element.
+	 * @param comp        A strict weak ordering.
+	 * @param num_threads Number of threads. 0 selects defaultNumberOfThreads().
+	 */
+	template <typename RandomIt, typename Compare>
+	void parallel_sort(RandomIt begin, RandomIt end, Compare comp,
+	                   size_t num_threads = 0)
+	{
+		// Below this size threading does not pay off
+		static const size_t MIN_BLOCK_SIZE = 1 << 14;
+
+		const size_t n = static_cast<size_t>(end - begin);
+
+		if(num_threads == 0) {
+			num_threads = defaultNumberOfThreads();
+		}
+		num_threads = std::min(num_threads, std::max(n / MIN_BLOCK_SIZE, size_t(1)));
+
+		if(num_threads <= 1) {
+			std::sort(begin, end, comp);
+			return;
+		}
+
+		std::vector<size_t> bounds(num_threads + 1);
+		for(size_t i = 0; i <= num_threads; ++i) {
+			bounds[i] = i * n / num_threads;
+		}
+
+		parallel_for(0, num_threads, [&](size_t i) {
+			std::sort(begin + bounds[i], begin + bounds[i + 1], comp);
+		}, num_threads);
+
+		for(size_t width = 1; width < num_threads; width *= 2) {
+			const size_t merges = (num_threads + 2 * width - 1) / (2 * width);
+			parallel_for(0, merges, [&](size_t m) {
+				const size_t first = 2 * width * m;
+				const size_t middle = std::min(first + width, num_threads);
+				const size_t last = std::min(first + 2 * width, num_threads);
+				if(middle < last) {
+					std::inplace_merge(begin + bounds[first],
+					                   begin + bounds[middle],
+					                   begin + bounds[last], comp);
+				}
+			}, num_threads);
+		}
+	}
+}
+
+#endif // GT2_CORE_PARALLEL_H
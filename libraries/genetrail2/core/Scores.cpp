@@ -20,71 +20,46 @@
 #include "Scores.h"
 #include "Category.h"
 #include "GeneSet.h"
+#include "misc_algorithms.h"
 
 #include <algorithm>
+#include <numeric>
+#include <utility>
 
 namespace GeneTrail
 {
-	Scores::IndexProxy::IndexProxy(const std::vector<Score>* data) : data_(data)
-	{
-	}
-
-	Scores::ConstScoresProxy::ConstScoresProxy(const std::vector<Score>* data)
-	    : data_(data)
-	{
-	}
-
-	Scores::ScoresProxy::ScoresProxy(std::vector<Score>* data)
-	    : data_(data)
-	{
-	}
-
-	Scores::NamesProxy::NamesProxy(const std::vector<Score>* data,
+	Scores::NamesProxy::NamesProxy(const size_t* begin, const size_t* end,
 	                               const EntityDatabase* db)
-	    : data_(data), db_(db)
-	{
-	}
-
-	bool Scores::LessScore::operator()(const Score& a, const Score& b) const
-	{
-		if(a.score() == b.score()) {
-			return a.index() < b.index();
-		}
-
-		return a.score() < b.score();
-	}
-
-	bool Scores::GreaterScore::operator()(const Score& a, const Score& b) const
-	{
-		if(a.score() == b.score()) {
-			return a.index() > b.index();
-		}
-
-		return a.score() > b.score();
-	}
-
-	bool Scores::LessIndex::operator()(const Score& a, const Score& b) const
+	    : begin_(begin), end_(end), db_(db)
 	{
-		return a.index() < b.index();
 	}
 
 	Scores::Scores(const std::vector<Score>& data,
 	               const std::shared_ptr<EntityDatabase>& db)
-	    : data_(data), isSortedByIndex_(false), db_(db)
+	    : isSortedByIndex_(false), db_(db)
 	{
+		indices_.reserve(data.size());
+		scores_.reserve(data.size());
+
+		for(const auto& entry : data) {
+			indices_.push_back(entry.index());
+			scores_.push_back(entry.score());
+		}
 	}
 
 	Scores::Scores(std::vector<Score>&& data,
 	               const std::shared_ptr<EntityDatabase>& db)
-	    : data_(std::move(data)), isSortedByIndex_(false), db_(db)
+	    : Scores(static_cast<const std::vector<Score>&>(data), db)
 	{
+		data.clear();
 	}
 
 	Scores::Scores(const GeneTrail::GeneSet& gene_set,
 	               const std::shared_ptr<EntityDatabase>& db)
 	    : isSortedByIndex_(true), db_(db)
 	{
-		data_.reserve(gene_set.size());
+		indices_.reserve(gene_set.size());
+		scores_.reserve(gene_set.size());
 
 		// Insert the entries of the gene set. emplace_back
 		// ensures, that isSortedByName_ is updated properly.
@@ -97,7 +72,8 @@ namespace GeneTrail
 	               const std::shared_ptr<EntityDatabase>& db)
 	    : isSortedByIndex_(true), db_(db)
 	{
-		data_.reserve(gene_set.size());
+		indices_.reserve(gene_set.size());
+		scores_.reserve(gene_set.size());
 
 		// Insert the entries of the gene set. emplace_back
 		// ensures, that isSortedByName_ is updated properly.
@@ -113,7 +89,8 @@ namespace GeneTrail
 	Scores::Scores(size_t size, const std::shared_ptr<EntityDatabase>& db)
 	    : isSortedByIndex_(true), db_(db)
 	{
-		data_.reserve(size);
+		indices_.reserve(size);
+		scores_.reserve(size);
 	}
 
 	Scores Scores::subset(const Category& c) const
@@ -130,11 +107,17 @@ namespace GeneTrail
 		auto n = size();
 		Scores result(std::min(n, c.size()), db_);
 
-		auto scoresIt = begin();
+		auto first = indices_.begin();
+		auto last = indices_.end();
+		auto scoresIt = first;
 		auto categoryIt = c.begin();
 
-		while(scoresIt != end() && categoryIt != c.end()) {
-			auto search_end = end();
+		auto add = [&](std::vector<size_t>::const_iterator it) {
+			result.push_back_(*it, scores_[it - first]);
+		};
+
+		while(scoresIt != last && categoryIt != c.end()) {
+			auto search_end = last;
 
 			// This is a heuristic that tries to guess the position
 			// of the current category element in the scores vector
@@ -145,15 +128,15 @@ namespace GeneTrail
 			if(*categoryIt < n) {
 				// Look up the score index that can be found at the
 				// current index in the category.
-				auto cat_lookup = begin() + *categoryIt;
-				auto scores_index = cat_lookup->index();
+				auto cat_lookup = first + *categoryIt;
+				auto scores_index = *cat_lookup;
 
 				if(scores_index == *categoryIt) {
 					// If we hit what we were looking for, we
 					// are done and can continue.
 					scoresIt = cat_lookup + 1;
 					++categoryIt;
-					result.emplace_back(*cat_lookup);
+					add(cat_lookup);
 					continue;
 				} else if(scores_index > *categoryIt) {
 					// If the found index is larger than what we were looking
@@ -166,14 +149,11 @@ namespace GeneTrail
 				}
 			}
 
-			// TODO: Temporary can be optimized away using C++14 heterogenous
-			//      lookup.
-			Score dummy(*categoryIt, 0.0);
-			scoresIt = std::lower_bound(scoresIt, search_end, dummy, LessIndex());
+			scoresIt = std::lower_bound(scoresIt, search_end, *categoryIt);
 
 			// Check that we found the index we searched for
-			if(scoresIt != search_end) {
-				result.emplace_back(*scoresIt);
+			if(scoresIt != search_end && *scoresIt == *categoryIt) {
+				add(scoresIt);
 				++scoresIt;
 			}
 			++categoryIt;
@@ -188,9 +168,9 @@ namespace GeneTrail
 
 		Scores result(std::min(size(), c.size()), db_);
 
-		for(const auto& entry : *this) {
-			if(c.contains(entry.index())) {
-				result.emplace_back(entry);
+		for(size_t i = 0; i < size(); ++i) {
+			if(c.contains(indices_[i])) {
+				result.push_back_(indices_[i], scores_[i]);
 			}
 		}
 
@@ -203,7 +183,7 @@ namespace GeneTrail
 		result.reserve(std::min(size(), c.size()));
 
 		for(size_t i = 0; i < size(); ++i) {
-			if(c.contains(data_[i].index())) {
+			if(c.contains(indices_[i])) {
 				result.emplace_back(i);
 			}
 		}
@@ -211,6 +191,20 @@ namespace GeneTrail
 		return result;
 	}
 
+	void Scores::permute_(const std::vector<size_t>& order)
+	{
+		std::vector<size_t> indices(order.size());
+		std::vector<double> scores(order.size());
+
+		for(size_t i = 0; i < order.size(); ++i) {
+			indices[i] = indices_[order[i]];
+			scores[i] = scores_[order[i]];
+		}
+
+		indices_.swap(indices);
+		scores_.swap(scores);
+	}
+
 	void Scores::sortByIndex()
 	{
 		// Nothing to do here
@@ -220,17 +214,58 @@ namespace GeneTrail
 
 		isSortedByIndex_ = true;
 
-		std::sort(data_.begin(), data_.end(), LessIndex());
+		std::vector<size_t> order(size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+			return indices_[a] < indices_[b];
+		});
+
+		permute_(order);
 	}
 
 	void Scores::sortByName()
 	{
 		isSortedByIndex_ = size() <= 1;
 
-		std::sort(data_.begin(), data_.end(),
-		          [this](const Score& a, const Score& b) {
-			return a.name(*db_) < b.name(*db_);
+		std::vector<size_t> order(size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+			return (*db_)(indices_[a]) < (*db_)(indices_[b]);
 		});
+
+		permute_(order);
+	}
+
+	std::vector<size_t> Scores::orderByScore_(Order order) const
+	{
+		// Ties are broken by the identifier. As the radix sort is stable,
+		// it suffices to sort the scores after ordering them by identifier.
+		std::vector<size_t> by_index;
+		std::vector<size_t> by_score;
+		if(isSortedByIndex_) {
+			radix_sort_permutation(by_score, scores_.data(),
+			                       scores_.data() + size());
+		} else {
+			radix_sort_permutation(by_index, indices_.data(),
+			                       indices_.data() + size());
+
+			std::vector<double> keys(size());
+			for(size_t i = 0; i < size(); ++i) {
+				keys[i] = scores_[by_index[i]];
+			}
+
+			radix_sort_permutation(by_score, keys.data(), keys.data() + size());
+
+			for(auto& i : by_score) {
+				i = by_index[i];
+			}
+		}
+
+		if(order == Order::Decreasing) {
+			std::reverse(by_score.begin(), by_score.end());
+		}
+
+		return by_score;
 	}
 
 	void Scores::sortByScore(Order order)
@@ -238,34 +273,34 @@ namespace GeneTrail
 		// The data is only sorted by name if there is at most one item present.
 		isSortedByIndex_ = size() <= 1;
 
-		switch(order) {
-			case Order::Increasing:
-				std::sort(data_.begin(), data_.end(), LessScore());
-				break;
-			case Order::Decreasing:
-				std::sort(data_.begin(), data_.end(), GreaterScore());
-				break;
+		permute_(orderByScore_(order));
+	}
+
+	std::vector<size_t> Scores::indicesSortedByScore(Order order) const
+	{
+		auto result = orderByScore_(order);
+		for(auto& i : result) {
+			i = indices_[i];
 		}
+		return result;
 	}
 
 	bool Scores::contains(const std::string& name) const
 	{
-		// TODO: This might be replaced with heterogenous lookup from
-		//      C++14
-		return contains(Score(*db_, name, 0.0));
+		if(!db_->contains(name)) {
+			return false;
+		}
+
+		return contains(Score(db_->index(name), 0.0));
 	}
 
 	bool Scores::contains(const Score& score) const
 	{
 		if(isSortedByIndex_) {
-			return std::binary_search(data_.begin(), data_.end(), score, LessIndex());
+			return std::binary_search(indices_.begin(), indices_.end(), score.index());
 		} else {
-			auto pred = [&score](const Score& a) {
-				return a.index() == score.index();
-			};
-
-			return std::find_if(data_.begin(), data_.end(), pred) !=
-		           data_.end();
+			return std::find(indices_.begin(), indices_.end(), score.index()) !=
+		           indices_.end();
 		}
 	}
 	EntityDatabase Scores::getEntityDatabase()
@@ -23,8 +23,10 @@
 #include "macros.h"
 #include "EntityDatabase.h"
 
+#include <boost/iterator/iterator_facade.hpp>
 #include <boost/iterator/transform_iterator.hpp>
 
+#include <cstddef>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -43,7 +45,7 @@ namespace GeneTrail
 	class GT2_EXPORT Score
 	{
 		public:
-		Score(EntityDatabase& db, const std::string& n, double s) : entity_(db(n)), score_(s), db_(db) {}
+		Score(EntityDatabase& db, const std::string& n, double s) : entity_(db(n)), score_(s) {}
 		Score(size_t i, double s) : entity_(i), score_(s) {}
 
 		const std::string& name(const EntityDatabase& db) const { return db(entity_); }
@@ -55,145 +57,111 @@ namespace GeneTrail
 		private:
 		size_t entity_;
 		double score_;
-		EntityDatabase db_;
 	};
 
-	class GT2_EXPORT Scores
+	/**
+	 * A contiguous range of elements, e.g. one of the columns of Scores.
+	 */
+	template <typename T> class Span
 	{
 		public:
-		using iterator = std::vector<Score>::iterator;
-		using const_iterator = std::vector<Score>::const_iterator;
+		using iterator = T*;
+		using const_iterator = T*;
 
-		class IndexProxy
-		{
-			private:
-			struct ExtractIndex
-			{
-				size_t operator()(const Score& s) const
-				{
-					return s.index();
-				}
-			};
+		Span(T* begin, T* end) : begin_(begin), end_(end) {}
+
+		T* begin() const { return begin_; }
+		T* end() const { return end_; }
+		T* data() const { return begin_; }
+
+		size_t size() const { return end_ - begin_; }
+		bool empty() const { return begin_ == end_; }
+
+		T& operator[](size_t i) const { return begin_[i]; }
 
-			const std::vector<Score>* data_;
+		private:
+		T* begin_;
+		T* end_;
+	};
 
+	/**
+	 * A list of scores for entities.
+	 *
+	 * The identifiers and the scores are stored in two separate arrays, so
+	 * that statistics over the scores or the identifiers work on
+	 * contiguous memory. Iterating over Scores yields Score objects by
+	 * value.
+	 */
+	class GT2_EXPORT Scores
+	{
+		public:
+		class const_iterator
+		    : public boost::iterator_facade<const_iterator, Score,
+		                                    boost::random_access_traversal_tag,
+		                                    Score>
+		{
 			public:
-			using const_iterator = boost::transform_iterator<ExtractIndex, Scores::const_iterator>;
-			IndexProxy(const std::vector<Score>* data);
+			const_iterator() : scores_(nullptr), i_(0) {}
+			const_iterator(const Scores* scores, size_t i) : scores_(scores), i_(i) {}
 
-			const_iterator begin() const {
-				return boost::make_transform_iterator(data_->begin(), ExtractIndex());
+			private:
+			friend class boost::iterator_core_access;
+
+			Score dereference() const { return (*scores_)[i_]; }
+			bool equal(const const_iterator& o) const { return i_ == o.i_; }
+			void increment() { ++i_; }
+			void decrement() { --i_; }
+			void advance(std::ptrdiff_t n) { i_ += n; }
+			std::ptrdiff_t distance_to(const const_iterator& o) const
+			{
+				return static_cast<std::ptrdiff_t>(o.i_) - static_cast<std::ptrdiff_t>(i_);
 			}
 
-			const_iterator end() const {
-				return boost::make_transform_iterator(data_->end(), ExtractIndex());
-			}
+			const Scores* scores_;
+			size_t i_;
 		};
 
+		using iterator = const_iterator;
+
 		class NamesProxy
 		{
 			private:
 			struct ExtractName
 			{
 				ExtractName(const EntityDatabase* db) : db_(db) {}
-				const std::string& operator()(const Score& s) const
+				const std::string& operator()(size_t i) const
 				{
-					return s.name(*db_);
+					return (*db_)(i);
 				};
 			private:
 			const EntityDatabase* db_;
 			};
-			const std::vector<Score>* data_;
+			const size_t* begin_;
+			const size_t* end_;
 			const EntityDatabase* db_;
 
 			public:
 			using const_iterator =
-			    boost::transform_iterator<ExtractName, Scores::const_iterator>;
+			    boost::transform_iterator<ExtractName, const size_t*>;
 
-			NamesProxy(const std::vector<Score>* data, const EntityDatabase* db_);
+			NamesProxy(const size_t* begin, const size_t* end, const EntityDatabase* db_);
 
 			const_iterator begin() const
 			{
-				return boost::make_transform_iterator(data_->begin(),
-				                                      ExtractName(db_));
+				return boost::make_transform_iterator(begin_, ExtractName(db_));
 			}
 			const_iterator end() const
 			{
-				return boost::make_transform_iterator(data_->end(),
-				                                      ExtractName(db_));
+				return boost::make_transform_iterator(end_, ExtractName(db_));
 			}
 		};
 
-		class ConstScoresProxy
-		{
-			private:
-			struct ExtractScore
-			{
-				double operator()(const Score& s) const { return s.score(); }
-			};
-			const std::vector<Score>* data_;
-
-			public:
-			using const_iterator =
-			    boost::transform_iterator<ExtractScore, Scores::const_iterator>;
-
-			ConstScoresProxy(const std::vector<Score>* data);
-
-			const_iterator begin() const
-			{
-				return boost::make_transform_iterator(data_->begin(),
-				                                      ExtractScore());
-			}
-
-			const_iterator end() const
-			{
-				return boost::make_transform_iterator(data_->end(),
-				                                      ExtractScore());
-			}
-		};
+		using IndexProxy = Span<const size_t>;
+		using ConstScoresProxy = Span<const double>;
+		using ScoresProxy = Span<double>;
 
-		class ScoresProxy
-		{
-			private:
-			struct ExtractScore
-			{
-				double& operator()(Score& s) const { return s.score(); }
-			};
-			std::vector<Score>* data_;
-
-			public:
-			using iterator =
-			    boost::transform_iterator<ExtractScore, Scores::iterator>;
-
-			ScoresProxy(std::vector<Score>* data);
-
-			iterator begin()
-			{
-				return boost::make_transform_iterator(data_->begin(),
-				                                      ExtractScore());
-			}
-
-			iterator end()
-			{
-				return boost::make_transform_iterator(data_->end(),
-				                                      ExtractScore());
-			}
-		};
-
-		struct LessScore {
-			bool operator()(const Score& a, const Score& b) const;
-		};
-
-		struct GreaterScore {
-			bool operator()(const Score& a, const Score& b) const;
-		};
-
-		struct LessIndex {
-			bool operator()(const Score& a, const Score& b) const;
-		};
-
-		using ScoreIterator = ScoresProxy::iterator;
-		using ConstScoreIterator = ConstScoresProxy::const_iterator;
+		using ScoreIterator = double*;
+		using ConstScoreIterator = const double*;
 		using ConstNameIterator = NamesProxy::const_iterator;
 
 		explicit Scores(const std::shared_ptr<EntityDatabase>& db);
@@ -212,53 +180,48 @@ namespace GeneTrail
 
 		template <typename... Ts> void emplace_back(const char* str, Ts&&... ts)
 		{
-			data_.emplace_back(db_->index(str), std::forward<Ts>(ts)...);
-			updateIsSorted_();
+			push_back_(db_->index(str), std::forward<Ts>(ts)...);
 		}
 
 		template <typename... Ts> void emplace_back(const std::string& str, Ts&&... ts)
 		{
-			data_.emplace_back(db_->index(str), std::forward<Ts>(ts)...);
-			updateIsSorted_();
+			push_back_(db_->index(str), std::forward<Ts>(ts)...);
 		}
 
 		template <typename... Ts> void emplace_back(std::string&& str, Ts&&... ts)
 		{
-			data_.emplace_back(db_->index(str), std::forward<Ts>(ts)...);
-			updateIsSorted_();
+			push_back_(db_->index(str), std::forward<Ts>(ts)...);
 		}
 
 		template <typename... Ts> void emplace_back(Ts&&... ts)
 		{
-			data_.emplace_back(std::forward<Ts>(ts)...);
-			updateIsSorted_();
+			const Score s(std::forward<Ts>(ts)...);
+			push_back_(s.index(), s.score());
 		}
 
-		iterator begin() { return data_.begin(); }
-		iterator end() { return data_.end(); }
+		const_iterator begin() const { return const_iterator(this, 0); }
+		const_iterator end() const { return const_iterator(this, size()); }
 
-		const_iterator begin() const { return data_.begin(); }
-		const_iterator end() const { return data_.end(); }
-
-		IndexProxy indices() const { return IndexProxy(&data_); };
-		NamesProxy names() const { return NamesProxy(&data_, db_.get()); };
-		ConstScoresProxy scores() const { return ConstScoresProxy(&data_); };
-		ScoresProxy scores() { return ScoresProxy(&data_); };
+		IndexProxy indices() const { return IndexProxy(indices_.data(), indices_.data() + indices_.size()); };
+		NamesProxy names() const { return NamesProxy(indices_.data(), indices_.data() + indices_.size(), db_.get()); };
+		ConstScoresProxy scores() const { return ConstScoresProxy(scores_.data(), scores_.data() + scores_.size()); };
+		ScoresProxy scores() { return ScoresProxy(scores_.data(), scores_.data() + scores_.size()); };
 
 		const std::shared_ptr<EntityDatabase>& db() const { return db_; }
 
-		size_t size() const { return data_.size(); }
+		size_t size() const { return indices_.size(); }
 
 		Scores subset(const Category& c) const;
 		std::vector<size_t> subsetIndices(const Category& c) const;
 
-		const Score& set(size_t i, const Score& s) {
+		Score set(size_t i, const Score& s) {
 			isSortedByIndex_ = false;
-			data_[i] = s;
-			return data_[i];
+			indices_[i] = s.index();
+			scores_[i] = s.score();
+			return s;
 		}
 
-		const Score& operator[](size_t i) const { return data_[i]; }
+		Score operator[](size_t i) const { return Score(indices_[i], scores_[i]); }
 
 		EntityDatabase getEntityDatabase();
 
@@ -266,6 +229,21 @@ namespace GeneTrail
 		void sortByIndex();
 		void sortByScore(Order order = Order::Increasing);
 
+		/**
+		 * The identifiers in the order sortByScore(order) would produce,
+		 * without sorting the scores themselves.
+		 */
+		std::vector<size_t> indicesSortedByScore(Order order = Order::Increasing) const;
+
+		/**
+		 * The positions of the entries in the order sortByScore(order)
+		 * would produce, without sorting the scores themselves.
+		 */
+		std::vector<size_t> positionsSortedByScore(Order order = Order::Increasing) const
+		{
+			return orderByScore_(order);
+		}
+
 		bool isSortedByIndex() { return isSortedByIndex_; }
 		bool contains(const std::string& name) const;
 		bool contains(const Score& score) const;
@@ -274,11 +252,31 @@ namespace GeneTrail
 		Scores subsetMerge_(const Category& c) const;
 		Scores subsetFind_(const Category& c) const;
 
+		/**
+		 * Computes the positions of the entries sorted by score. Ties are
+		 * broken by the identifiers, NaNs are larger than any other score.
+		 */
+		std::vector<size_t> orderByScore_(Order order) const;
+
+		/**
+		 * Reorders both columns such that entry i is the former entry
+		 * order[i].
+		 */
+		void permute_(const std::vector<size_t>& order);
+
+		void push_back_(size_t index, double score)
+		{
+			indices_.push_back(index);
+			scores_.push_back(score);
+			updateIsSorted_();
+		}
+
 		void updateIsSorted_() {
-			isSortedByIndex_ = size() <= 1 || (isSortedByIndex_ && data_[size() - 1].index() >= data_[size() - 2].index());
+			isSortedByIndex_ = size() <= 1 || (isSortedByIndex_ && indices_[size() - 1] >= indices_[size() - 2]);
 		}
 
-		std::vector<Score> data_;
+		std::vector<size_t> indices_;
+		std::vector<double> scores_;
 		bool isSortedByIndex_;
 		std::shared_ptr<EntityDatabase> db_;
 	};
@@ -143,7 +143,9 @@ namespace GeneTrail
 	void SparseMatrixReader::readInnerData_(std::istream& input, SparseMatrix& result, uint64_t chunk_size) const
 	{
 		uint64_t bytes_read = 0;
-		result.matrix().resizeNonZeros(chunk_size / sizeof(SparseMatrix::SMatrix::Index));
+		// The indices are stored using Eigen's storage index type, which
+		// can be smaller than SMatrix::Index.
+		result.matrix().resizeNonZeros(chunk_size / sizeof(*result.matrix().innerIndexPtr()));
 
 		// As the internal storage format of matrix is column major this is quite efficient...
 		input.read(reinterpret_cast<char*>(result.matrix().innerIndexPtr()), chunk_size);
@@ -70,13 +70,13 @@ namespace GeneTrail
 		total += n;
 
 		// Write outer indices
-		n = (matrix.matrix().outerSize() + 1) * sizeof(SparseMatrix::SMatrix::Index);
+		n = (matrix.matrix().outerSize() + 1) * sizeof(*matrix.matrix().outerIndexPtr());
 		total += writeChunkHeader_(output, 0x3, n);
 		output.write(reinterpret_cast<const char*>(matrix.matrix().outerIndexPtr()), n);
 		total += n;
 
 		// Write inner indices
-		n = matrix.matrix().nonZeros() * sizeof(SparseMatrix::SMatrix::Index);
+		n = matrix.matrix().nonZeros() * sizeof(*matrix.matrix().innerIndexPtr());
 		writeChunkHeader_(output, 0x4, n);
 		output.write(reinterpret_cast<const char*>(matrix.matrix().innerIndexPtr()), n);
 		total += n;
@@ -45,23 +45,100 @@ namespace GeneTrail
 
 		using Indices = std::vector<size_t>;
 
+		constexpr static size_t NO_POSITION = static_cast<size_t>(-1);
+
 		private:
-		Scores scores_;
+		// Position of every entity id in the sorted score list
+		std::vector<size_t> positions_;
+		// Absolute score at every position of the sorted score list
+		std::vector<float_type> weights_;
+
+		/**
+		 * Clears the id -> position index for the ids of the scores. The
+		 * memory of the index is reused.
+		 */
+		void resetIndex_(const Scores& scores)
+		{
+			size_t max_id = 0;
+			for(const auto& id : scores.indices()) {
+				max_id = std::max(max_id, static_cast<size_t>(id) + 1);
+			}
+
+			positions_.assign(max_id, NO_POSITION);
+			weights_.resize(scores.size());
+		}
+
+		/**
+		 * Builds the id -> position index and the weights for the
+		 * current order of the scores.
+		 */
+		void index_(const Scores& scores)
+		{
+			resetIndex_(scores);
+
+			size_t i = 0;
+			for(const auto& id : scores.indices()) {
+				positions_[id] = i;
+				weights_[i] = std::abs(scores[i].score());
+				++i;
+			}
+		}
 
 		public:
 		/**
 		 * Constructor
 		 */
 		WeightedGeneSetEnrichmentAnalysis(const Scores& scores, Order order, bool keepOrder)
-			: scores_(scores)
 		{
-			if(!keepOrder){
-				scores_.sortByScore(order);
+			if(keepOrder){
+				index_(scores);
+			} else {
+				setScores(scores, order);
 			}
 		}
 
-		void setScores(Scores&& scores) {
-			scores_ = std::move(scores);
+		/**
+		 * Replaces the scores by the given scores in the specified order.
+		 * Only the order of the identifiers is computed, the scores are
+		 * neither copied nor sorted and the buffers of the index are
+		 * reused. This makes it cheap to replace the scores repeatedly,
+		 * e.g. for every permutation of the samples.
+		 */
+		void setScores(const Scores& scores, Order order) {
+			const auto order_by_score = scores.positionsSortedByScore(order);
+
+			resetIndex_(scores);
+
+			// Every weight is written, even if an identifier occurs twice.
+			// As for index_, such an identifier is found at its last position.
+			for(size_t i = 0; i < order_by_score.size(); ++i) {
+				const auto score = scores[order_by_score[i]];
+				positions_[score.index()] = i;
+				weights_[i] = std::abs(score.score());
+			}
+		}
+
+		/**
+		 * This method computes the sorted positions of the members of a
+		 * category in the score list. In contrast to intersection, only the
+		 * members of the category are visited.
+		 *
+		 * @param category Category
+		 */
+		Indices positions(const Category& category) const
+		{
+			Indices result;
+			result.reserve(std::min(category.size(), weights_.size()));
+
+			for(size_t id : category) {
+				if(id < positions_.size() && positions_[id] != NO_POSITION) {
+					result.emplace_back(positions_[id]);
+				}
+			}
+
+			std::sort(result.begin(), result.end());
+
+			return result;
 		}
 
 		/**
@@ -97,7 +174,7 @@ namespace GeneTrail
 			using namespace std;
 			float_type result = 0.0;
 			for(; it != end; ++it) {
-				result += std::abs(scores_[*it].score());
+				result += weights_[*it];
 			}
 			return result;
 		}
@@ -125,7 +202,7 @@ namespace GeneTrail
 		 */
 		std::tuple<float_type, float_type> computeRunningSum(const Category& category) const
 		{
-			Indices S = intersection(category, scores_);
+			Indices S = positions(category);
 			return computeRunningSum(S.begin(), S.end());
 		}
 
@@ -151,19 +228,19 @@ namespace GeneTrail
 			}
 
 			const float_type NR_inv = 1.0 / sum(begin, end);
-			const float_type missv = 1.0 / (scores_.size() - category_size);
+			const float_type missv = 1.0 / (weights_.size() - category_size);
 
 			float_type maxRS = 0.0;
 			
 			float_type RS = -(*begin * missv);
 			float_type minRS = RS;
-			RS += NR_inv * std::abs(scores_[*begin].score());
+			RS += NR_inv * weights_[*begin];
 			maxRS = (maxRS > RS) ? maxRS : RS;
 			size_t lastIndex = *begin;
 			for(auto it = begin + 1; it != end; ++it) {
 				RS -= (*it - lastIndex - 1) * missv;
 				minRS = (minRS < RS) ? minRS : RS;
-				RS += NR_inv * std::abs(scores_[*it].score());
+				RS += NR_inv * weights_[*it];
 				maxRS = (maxRS > RS) ? maxRS : RS;
 
 				lastIndex = *it;
@@ -175,7 +252,88 @@ namespace GeneTrail
 			
 			return std::make_tuple(RSc, kuiper);
 		}
+
+		/**
+		 * This method computes the running sum statistic for the union of
+		 * two sorted lists of indices, e.g. a random sample and a sorted
+		 * batch of indices by which the sample is extended. The union is
+		 * written to out while the running sum is computed, so neither a
+		 * separate merge nor a separate pass over the merged list is
+		 * necessary.
+		 *
+		 * @param weight The sum of the weights of [begin, end). It is
+		 *               updated to the sum of the weights of the union,
+		 *               which avoids summing up the whole sample again when
+		 *               it is extended further.
+		 * @return The same as computeRunningSum(out, out + size), up to
+		 *         rounding differences in the sum of the weights.
+		 */
+		template <typename OutputIterator>
+		std::tuple<float_type, float_type>
+		computeRunningSum(Indices::const_iterator begin, Indices::const_iterator end,
+		                  Indices::const_iterator batch_begin,
+		                  Indices::const_iterator batch_end, OutputIterator out,
+		                  float_type& weight) const
+		{
+			weight += sum(batch_begin, batch_end);
+
+			const auto category_size = std::distance(begin, end) +
+			                           std::distance(batch_begin, batch_end);
+
+			if(category_size == 0) {
+				return std::make_tuple(float_type(),float_type());
+			}
+
+			const float_type NR_inv = 1.0 / weight;
+			const float_type missv = 1.0 / (weights_.size() - category_size);
+
+			float_type maxRS = 0.0;
+			float_type minRS = 0.0;
+			float_type RS = 0.0;
+			size_t lastIndex = 0;
+			bool first = true;
+
+			auto visit = [&](size_t index) {
+				if(first) {
+					RS = -(index * missv);
+					minRS = RS;
+					first = false;
+				} else {
+					RS -= (index - lastIndex - 1) * missv;
+					minRS = (minRS < RS) ? minRS : RS;
+				}
+				RS += NR_inv * weights_[index];
+				maxRS = (maxRS > RS) ? maxRS : RS;
+
+				lastIndex = index;
+				*out = index;
+				++out;
+			};
+
+			while(begin != end && batch_begin != batch_end) {
+				if(*batch_begin < *begin) {
+					visit(*batch_begin++);
+				} else {
+					visit(*begin++);
+				}
+			}
+			for(; begin != end; ++begin) {
+				visit(*begin);
+			}
+			for(; batch_begin != batch_end; ++batch_begin) {
+				visit(*batch_begin);
+			}
+
+			float_type RSc =  (maxRS > -minRS) ? maxRS : minRS;
+
+			float_type kuiper = std::max(maxRS,0.0) - std::abs(std::min(0.0,minRS));
+
+			return std::make_tuple(RSc, kuiper);
+		}
 	};
+
+	template <typename float_type>
+	constexpr size_t WeightedGeneSetEnrichmentAnalysis<float_type>::NO_POSITION;
 }
 
 #endif // GT2_CORE_WEIGHTED_GENE_SET_ENRICHMENT_ANALYSIS_H
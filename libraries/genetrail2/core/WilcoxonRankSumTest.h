@@ -29,7 +29,10 @@
 #include <boost/math/distributions/normal.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <numeric>
+#include <vector>
 
 namespace GeneTrail
 {
@@ -265,6 +268,102 @@ template <typename ValueType> class GT2_EXPORT WilcoxonRankSumTest
 		return score_ = computeZScore_(rank_sum1, size1, size2);
 	}
 
+	/**
+	 * Ranks all entries of a scores object once, so that the Z-score of
+	 * arbitrary subsets can be computed by test_ranked() without sorting.
+	 * Tied scores receive their mean rank and the variance of the rank sum
+	 * is corrected for ties.
+	 *
+	 * @param scores The scores of all entities of the analysed list.
+	 */
+	void rank(const Scores& scores)
+	{
+		std::vector<size_t> order(scores.size());
+		std::iota(order.begin(), order.end(), static_cast<size_t>(0));
+		std::sort(order.begin(), order.end(), [&scores](size_t i, size_t j) {
+			return scores[i].score() < scores[j].score();
+		});
+
+		resetRanks_(scores.indices().begin(), scores.indices().end());
+
+		size_t i = 0;
+		while(i < order.size()) {
+			size_t j = i + 1;
+			while(j < order.size() &&
+			      scores[order[j]].score() == scores[order[i]].score()) {
+				++j;
+			}
+
+			const value_type rank = (value_type)(i + 1 + j) / (value_type)2.0;
+			for(size_t k = i; k < j; ++k) {
+				ranks_[scores[order[k]].index()] = rank;
+			}
+
+			const value_type t = j - i;
+			tie_correction_ += t * t * t - t;
+			i = j;
+		}
+	}
+
+	/**
+	 * Ranks a list of entity indices that is sorted decreasingly. The last
+	 * entry receives rank 1. This is the ranking used by
+	 * computeZScore(category, begin, end).
+	 *
+	 * @param begin Iterator (begin) of entries (ids of EntityDatabase) of list L
+	 * @param end Iterator (end) of entries (ids of EntityDatabase) of list L
+	 */
+	template <typename Iterator>
+	void rank(const Iterator& begin, const Iterator& end)
+	{
+		resetRanks_(begin, end);
+
+		value_type rank = num_ranked_;
+		for(auto it = begin; it != end; ++it, --rank) {
+			ranks_[*it] = rank;
+		}
+	}
+
+	/**
+	 * Computes the Z-score of the entities in [begin, end) using the ranks
+	 * computed by rank(). Entities without a rank are ignored. The cost is
+	 * linear in the size of the range.
+	 *
+	 * @param begin Iterator (begin) of ids of EntityDatabase
+	 * @param end Iterator (end) of ids of EntityDatabase
+	 * @return The Z-score of the given entities.
+	 */
+	template <typename Iterator>
+	value_type test_ranked(Iterator begin, const Iterator& end)
+	{
+		value_type rank_sum = 0;
+		size_t size1 = 0;
+		for(; begin != end; ++begin) {
+			if(*begin < ranks_.size() && ranks_[*begin] > 0) {
+				rank_sum += ranks_[*begin];
+				++size1;
+			}
+		}
+
+		const value_type n1 = size1;
+		const value_type n2 = num_ranked_ - size1;
+		const value_type n = num_ranked_;
+
+		value_type mu = n1 * (n + 1) / boost::numeric_cast<value_type>(2.0);
+		value_type var = n1 * n2 / boost::numeric_cast<value_type>(12.0) *
+		                 ((n + 1) - tie_correction_ / (n * (n - 1)));
+
+		// If all scores are tied (or a group is empty) the rank sum does
+		// not vary and there is no evidence for an enrichment
+		if(!(var > 0)) {
+			enriched_ = false;
+			return score_ = 0;
+		}
+
+		enriched_ = rank_sum > mu;
+		return score_ = (rank_sum - mu) / sqrt(var);
+	}
+
 	boost::math::normal distribution()
 	{
 		boost::math::normal dist(0, 1);
@@ -282,9 +381,28 @@ template <typename ValueType> class GT2_EXPORT WilcoxonRankSumTest
 	bool enriched() { return enriched_; }
 
   protected:
+	template <typename Iterator>
+	void resetRanks_(const Iterator& begin, const Iterator& end)
+	{
+		size_t max_index = 0;
+		num_ranked_ = 0;
+		for(auto it = begin; it != end; ++it, ++num_ranked_) {
+			max_index = std::max(max_index, static_cast<size_t>(*it));
+		}
+
+		// Entities that are not part of the list keep rank zero
+		ranks_.assign(num_ranked_ == 0 ? 0 : max_index + 1, value_type(0));
+		tie_correction_ = 0;
+	}
+
 	value_type tolerance_;
 	value_type score_;
 	bool enriched_;
+
+	// Rank of every entity (by entity index) in the ranked list
+	std::vector<value_type> ranks_;
+	size_t num_ranked_ = 0;
+	value_type tie_correction_ = 0;
 };
 }
 
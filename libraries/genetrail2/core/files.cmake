@@ -17,6 +17,7 @@ add_header_to_library(BoostGraph.h)
 add_header_to_library(BoostGraphParser.h)
 add_header_to_library(CategoryDatabaseFile.h)
 add_header_to_library(DenseMatrixIterator.h)
+add_header_to_library(DenseMatrixView.h)
 add_header_to_library(GeneSetEnrichmentAnalysis.h)
 add_header_to_library(Matrix.h)
 add_header_to_library(DependentTTest.h)
@@ -35,7 +36,6 @@ add_header_to_library(WeightedGeneSetEnrichmentAnalysis.h)
 add_header_to_library(ConfidenceInterval.h)
 add_header_to_library(BinomialTest.h)
 add_header_to_library(NameDatabases.h)
-add_header_to_library(MatrixNormalization.h)
 add_header_to_library(MatrixTransformation.h)
 add_header_to_library(Entropy.h)
 add_header_to_library(MetadataReader.h)
@@ -43,10 +43,16 @@ add_header_to_library(ORAGroupPreference.h)
 add_header_to_library(GroupedScores.h)
 add_header_to_library(MatrixTools.h)
 add_header_to_library(CombineReducedEnrichments.h)
+add_header_to_library(BinaryEnrichmentResults.h)
 add_header_to_library(SCMatrixFilter.h)
+add_header_to_library(Parallel.h)
 
 # Sources
 add_to_library(AbstractMatrix)
+add_to_library(BatchFishersExactTest)
+add_to_library(BatchOverRepresentationAnalysis)
+add_to_library(BinaryCategoryDatabase)
+add_to_library(BinaryEnrichmentResults)
 add_to_library(BoostGraphProcessor)
 add_to_library(Category)
 add_to_library(CategoryDatabase)
@@ -55,6 +61,7 @@ add_to_library(DenseMatrix)
 add_to_library(DenseMatrixReader)
 add_to_library(DenseMatrixWriter)
 add_to_library(DenseRowSubset)
+add_to_library(EntityBitmap)
 add_to_library(EntityDatabase)
 add_to_library(Exception)
 add_to_library(File)
@@ -70,6 +77,7 @@ add_to_library(GEOGSEParser)
 add_to_library(GMTFile)
 add_to_library(JsonCategoryFile)
 add_to_library(MatrixHTest)
+add_to_library(MatrixNormalization)
 add_to_library(MatrixWriter)
 add_to_library(Metadata)
 add_to_library(misc_algorithms)
@@ -19,39 +19,214 @@
  */
 #include "misc_algorithms.h"
 
+#include "Parallel.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
 namespace GeneTrail
 {
 	namespace internal
 	{
-		void invert_cycle(size_t start, const std::vector<size_t>& perm,
-		                  std::vector<size_t>& inv_perm)
+		// The keys are sorted in six passes of eleven bits each.
+		static constexpr size_t RADIX_BITS = 11;
+		static constexpr size_t RADIX_SIZE = size_t(1) << RADIX_BITS;
+		static constexpr size_t RADIX_MASK = RADIX_SIZE - 1;
+		static constexpr size_t RADIX_PASSES = (64 + RADIX_BITS - 1) / RADIX_BITS;
+
+		// Below this size a comparison sort is faster, above it the passes
+		// are distributed over several threads.
+		static constexpr size_t RADIX_MIN_SIZE = 256;
+		static constexpr size_t RADIX_PARALLEL_SIZE = size_t(1) << 18;
+
+		struct RadixEntry
+		{
+			uint64_t key;
+			size_t index;
+		};
+
+		inline size_t radix_digit(uint64_t key, size_t pass)
+		{
+			return (key >> (pass * RADIX_BITS)) & RADIX_MASK;
+		}
+
+		// Maps a double to an unsigned integer with the same order. Positive
+		// numbers only need their sign bit flipped, negative numbers are
+		// stored in sign-magnitude form and thus need all bits flipped.
+		inline uint64_t radix_key(double value)
+		{
+			if(std::isnan(value)) {
+				return ~uint64_t(0);
+			}
+
+			// Adding 0.0 turns -0.0 into 0.0
+			value += 0.0;
+
+			uint64_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+
+			const uint64_t sign = uint64_t(1) << 63;
+			return (bits & sign) ? ~bits : (bits | sign);
+		}
+
+		inline uint64_t radix_key(size_t value) { return value; }
+
+		void radix_sort_sequential(std::vector<RadixEntry>& data,
+		                           std::vector<RadixEntry>& buffer)
+		{
+			// The number of occurrences of every digit does not change
+			// while sorting, so all histograms are computed at once.
+			std::vector<size_t> histograms(RADIX_PASSES * RADIX_SIZE, 0);
+			for(const auto& entry : data) {
+				for(size_t pass = 0; pass < RADIX_PASSES; ++pass) {
+					++histograms[pass * RADIX_SIZE + radix_digit(entry.key, pass)];
+				}
+			}
+
+			for(size_t pass = 0; pass < RADIX_PASSES; ++pass) {
+				size_t* offsets = histograms.data() + pass * RADIX_SIZE;
+
+				// Skip the pass if all keys share the digit.
+				if(offsets[radix_digit(data[0].key, pass)] == data.size()) {
+					continue;
+				}
+
+				size_t sum = 0;
+				for(size_t d = 0; d < RADIX_SIZE; ++d) {
+					const size_t count = offsets[d];
+					offsets[d] = sum;
+					sum += count;
+				}
+
+				for(const auto& entry : data) {
+					buffer[offsets[radix_digit(entry.key, pass)]++] = entry;
+				}
+
+				data.swap(buffer);
+			}
+		}
+
+		void radix_sort_parallel(std::vector<RadixEntry>& data,
+		                         std::vector<RadixEntry>& buffer,
+		                         size_t num_threads)
 		{
-			auto prev_pos = start;
-			auto current_pos = perm[start];
+			// Every chunk is counted and scattered by one thread. Within
+			// a digit, the chunks are placed in order, which keeps the
+			// sort stable.
+			const size_t num_chunks = num_threads;
+			const size_t chunk_size = (data.size() + num_chunks - 1) / num_chunks;
+			std::vector<size_t> offsets(num_chunks * RADIX_SIZE);
+
+			for(size_t pass = 0; pass < RADIX_PASSES; ++pass) {
+				std::fill(offsets.begin(), offsets.end(), 0);
+
+				parallel_for(0, num_chunks, [&](size_t chunk) {
+					const size_t begin = std::min(data.size(), chunk * chunk_size);
+					const size_t end = std::min(data.size(), begin + chunk_size);
+					size_t* counts = offsets.data() + chunk * RADIX_SIZE;
+					for(size_t i = begin; i < end; ++i) {
+						++counts[radix_digit(data[i].key, pass)];
+					}
+				}, num_threads);
+
+				size_t sum = 0;
+				for(size_t d = 0; d < RADIX_SIZE; ++d) {
+					for(size_t chunk = 0; chunk < num_chunks; ++chunk) {
+						const size_t count = offsets[chunk * RADIX_SIZE + d];
+						offsets[chunk * RADIX_SIZE + d] = sum;
+						sum += count;
+					}
+				}
+
+				// Skip the pass if all keys share the digit.
+				const size_t first = radix_digit(data[0].key, pass);
+				if(offsets[first] == 0 &&
+				   (first + 1 == RADIX_SIZE || offsets[first + 1] == data.size())) {
+					continue;
+				}
+
+				parallel_for(0, num_chunks, [&](size_t chunk) {
+					const size_t begin = std::min(data.size(), chunk * chunk_size);
+					const size_t end = std::min(data.size(), begin + chunk_size);
+					size_t* chunk_offsets = offsets.data() + chunk * RADIX_SIZE;
+					for(size_t i = begin; i < end; ++i) {
+						buffer[chunk_offsets[radix_digit(data[i].key, pass)]++] = data[i];
+					}
+				}, num_threads);
+
+				data.swap(buffer);
+			}
+		}
+
+		template <typename T>
+		void radix_sort_permutation(std::vector<size_t>& p, const T* begin,
+		                            const T* end, bool descending,
+		                            size_t num_threads)
+		{
+			const size_t n = end - begin;
+			p.resize(n);
+
+			// Sorting the complemented keys in increasing order sorts the
+			// values in decreasing order and keeps the sort stable.
+			const uint64_t flip = descending ? ~uint64_t(0) : uint64_t(0);
 
-			for(; current_pos != start;
-			    prev_pos = current_pos, current_pos = perm[current_pos]) {
-				inv_perm[current_pos] = prev_pos;
+			std::vector<RadixEntry> data(n);
+			for(size_t i = 0; i < n; ++i) {
+				data[i].key = radix_key(begin[i]) ^ flip;
+				data[i].index = i;
 			}
 
-			inv_perm[current_pos] = prev_pos;
+			if(num_threads == 0) {
+				num_threads = defaultNumberOfThreads();
+			}
+
+			if(n < RADIX_MIN_SIZE) {
+				std::stable_sort(data.begin(), data.end(),
+				                 [](const RadixEntry& a, const RadixEntry& b) {
+					return a.key < b.key;
+				});
+			} else {
+				std::vector<RadixEntry> buffer(n);
+				if(n >= RADIX_PARALLEL_SIZE && num_threads > 1) {
+					radix_sort_parallel(data, buffer, num_threads);
+				} else {
+					radix_sort_sequential(data, buffer);
+				}
+			}
+
+			for(size_t i = 0; i < n; ++i) {
+				p[i] = data[i].index;
+			}
 		}
 	}
 
 	void invert_permutation(const std::vector<size_t>& perm,
 	                        std::vector<size_t>& inv_perm)
 	{
-		// Fill the inverse permutation with a place holder and allocate
-		// enough space.
-		inv_perm.assign(perm.size(), perm.size());
+		// A single scatter is cheaper than following the cycles of the
+		// permutation, as no placeholders need to be written and checked.
+		inv_perm.resize(perm.size());
 
 		for(size_t i = 0; i < perm.size(); ++i) {
-			if(inv_perm[i] == perm.size()) {
-				internal::invert_cycle(i, perm, inv_perm);
-			}
+			inv_perm[perm[i]] = i;
 		}
 	}
 
+	void radix_sort_permutation(std::vector<size_t>& p, const double* begin,
+	                            const double* end, bool descending,
+	                            size_t num_threads)
+	{
+		internal::radix_sort_permutation(p, begin, end, descending, num_threads);
+	}
+
+	void radix_sort_permutation(std::vector<size_t>& p, const size_t* begin,
+	                            const size_t* end, bool descending,
+	                            size_t num_threads)
+	{
+		internal::radix_sort_permutation(p, begin, end, descending, num_threads);
+	}
+
 	std::vector<size_t> invert_permutation(const std::vector<size_t>& perm)
 	{
 		std::vector<size_t> result;
@@ -47,6 +47,7 @@ namespace GeneTrail {
 			("maximum,x",      value(&p.maximum)->default_value(1000), "Maximum number of genes allowed in categories.")
 			("just_scores",    value(&p.justScores)->default_value(false)->zero_tokens(), "If provided, only print the category name and the scores. Default: false")
 			("just_pvalues",    value(&p.justPvalues)->default_value(false)->zero_tokens(), "If provided, only print the category name and the pvalues. Default: false")
+			("binary_output",  value(&p.binaryOutput)->default_value(false)->zero_tokens(), "If provided, the results are written to binary, column-wise files (<database>.bin) instead of text files. just_scores and just_pvalues are ignored. Default: false")
 			("include_all,i",    value(&p.includeAll)->default_value(false)->zero_tokens(), "If provided, all categories from the desired category database are included in the output. If not provided, categories that are filtered due to their size are ignored in the output. Default: false")
 			("output,o",       value(&p.out_)->required(), "Output prefix for text files.")
 			("adjustment,a",   value(&p.adjustment)->default_value(boost::none, "none"), "P-value adjustment method for multiple testing.")
@@ -24,20 +24,12 @@
 #include <genetrail2/core/macros.h>
 #include <genetrail2/core/Exception.h>
 
-#include <boost/filesystem.hpp>
-#include <boost/lexical_cast.hpp>
-#include <boost/algorithm/string.hpp>
-#include <boost/numeric/conversion/cast.hpp>
-
-#include <algorithm>
-#include <fstream>
-#include <iostream>
+#include <cerrno>
 #include <cstdlib>
-#include <cmath>
+#include <fstream>
 #include <limits>
+#include <string>
 #include <vector>
-#include <functional>
-#include <tuple>
 
 namespace GeneTrail
 {
@@ -45,8 +37,21 @@ template <typename IntType> class GT2_EXPORT ContingencyMatrixParser
 {
   public:
 	using int_type = IntType;
-	using contingency_table = std::tuple<std::string, int_type, int_type, int_type, int_type>;
-	using contingency_tables = std::vector<contingency_table>;
+
+	/**
+	 * The parsed tables, stored column-wise. Table i consists of
+	 * ab[i], not_ab[i], a_not_b[i] and not_a_not_b[i].
+	 */
+	struct contingency_tables
+	{
+		std::vector<std::string> names;
+		std::vector<int_type> ab;
+		std::vector<int_type> not_ab;
+		std::vector<int_type> a_not_b;
+		std::vector<int_type> not_a_not_b;
+
+		size_t size() const { return names.size(); }
+	};
 
 	ContingencyMatrixParser(const std::string& file_name)
 	:ctables_()
@@ -59,7 +64,30 @@ template <typename IntType> class GT2_EXPORT ContingencyMatrixParser
 	}
 
   private:
-	
+
+	static bool isSpace_(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+	// Parses the next whitespace delimited count starting at pos.
+	static bool parseCount_(const std::string& line, size_t& pos, int_type& result)
+	{
+		while(pos < line.size() && isSpace_(line[pos])) {
+			++pos;
+		}
+
+		const char* begin = line.c_str() + pos;
+		char* end = nullptr;
+		errno = 0;
+		unsigned long long value = std::strtoull(begin, &end, 10);
+		if(end == begin || errno == ERANGE || *begin == '-' ||
+		   value > static_cast<unsigned long long>(std::numeric_limits<int_type>::max())) {
+			return false;
+		}
+
+		pos += end - begin;
+		result = static_cast<int_type>(value);
+		return pos == line.size() || isSpace_(line[pos]);
+	}
+
 	void read_(const std::string& file_name)
 	{
 		std::ifstream input(file_name);
@@ -67,23 +95,37 @@ template <typename IntType> class GT2_EXPORT ContingencyMatrixParser
 			throw GeneTrail::IOError("File (" + file_name + ") is not open for reading");
 		}
 
-		std::vector<std::string> sline;
+		int_type counts[4];
 		for(std::string line; getline(input, line);) {
-			boost::trim_if(line, boost::is_any_of("\t "));
-			boost::split(sline, line, boost::is_any_of(" \t"), boost::token_compress_on);
-			if(sline.size() == 5) {
-				ctables_.emplace_back(
-					std::make_tuple(
-						sline[0],
-						boost::numeric_cast<int_type>(boost::lexical_cast<int>(sline[1])),
-						boost::numeric_cast<int_type>(boost::lexical_cast<int>(sline[2])),
-						boost::numeric_cast<int_type>(boost::lexical_cast<int>(sline[3])),
-						boost::numeric_cast<int_type>(boost::lexical_cast<int>(sline[4]))
-					)
-				);
-			} else {
+			size_t pos = 0;
+			while(pos < line.size() && isSpace_(line[pos])) {
+				++pos;
+			}
+
+			const size_t name_begin = pos;
+			while(pos < line.size() && !isSpace_(line[pos])) {
+				++pos;
+			}
+			const size_t name_end = pos;
+
+			bool valid = name_end > name_begin;
+			for(size_t i = 0; valid && i < 4; ++i) {
+				valid = parseCount_(line, pos, counts[i]);
+			}
+
+			while(pos < line.size() && isSpace_(line[pos])) {
+				++pos;
+			}
+
+			if(!valid || pos != line.size()) {
 				throw GeneTrail::IOError("Wrong file format.");
 			}
+
+			ctables_.names.emplace_back(line, name_begin, name_end - name_begin);
+			ctables_.ab.push_back(counts[0]);
+			ctables_.not_ab.push_back(counts[1]);
+			ctables_.a_not_b.push_back(counts[2]);
+			ctables_.not_a_not_b.push_back(counts[3]);
 		}
 	}
 
@@ -22,72 +22,73 @@
 #define GT2_CONTINGENCY_ORA_H
 
 #include <genetrail2/core/macros.h>
-#include <genetrail2/core/Exception.h>
-#include <genetrail2/core/OverRepresentationAnalysis.h>
-#include <genetrail2/core/FishersExactTest.h>
-#include <genetrail2/core/multiprecision.h>
+#include <genetrail2/core/BatchFishersExactTest.h>
 
 #include "ContingencyEnrichmentResult.h"
-
-#include <boost/filesystem.hpp>
-#include <boost/lexical_cast.hpp>
-#include <boost/algorithm/string.hpp>
+#include "ContingencyMatrixParser.h"
 
 #include <algorithm>
-#include <fstream>
-#include <iostream>
-#include <cstdlib>
-#include <cmath>
-#include <limits>
+#include <cstdint>
 #include <vector>
-#include <functional>
-#include <tuple>
 
 namespace GeneTrail
 {
-template <typename IntType, typename FloatType> class GT2_EXPORT ContingencyORA
+/**
+ * Fisher's exact test for every table read by a ContingencyMatrixParser.
+ *
+ * All tables are handed to a BatchFishersExactTest at once, which shares
+ * one log-factorial table between all of them and distributes the tables
+ * over num_threads threads.
+ */
+template <typename IntType> class GT2_EXPORT ContingencyORA
 {
   public:
 	using int_type = IntType;
-	using float_type = FloatType;
-	using contingency_table = std::tuple<std::string, int_type, int_type, int_type, int_type>;
-	using contingency_tables = std::vector<contingency_table>;
+	using contingency_tables = typename ContingencyMatrixParser<int_type>::contingency_tables;
 
 	ContingencyORA(const contingency_tables& ctables)
 	:ctables_(ctables)
 	{}
 
-	std::vector<ContingencyEnrichmentResult> run(bool upperTailed = true){
-		std::vector<ContingencyEnrichmentResult> results;
-		results.reserve(ctables_.size());
-		for(auto& ctable : ctables_){
-			ContingencyEnrichmentResult result;
-			std::string name;
-			int_type a, b, c, d;
-			std::tie(name, a, c, b ,d) = ctable;
-			
+	std::vector<ContingencyEnrichmentResult> run(bool upperTailed = true, size_t num_threads = 0){
+		const size_t size = ctables_.size();
+
+		// Notation of FishersExactTest: m = AnotB + notAnotB, l = AnotB,
+		// n = AB + notAB and k = AB
+		std::vector<uint64_t> m(size), l(size), n(size), k(size);
+		std::vector<BatchFishersExactTest::Tail> tails(size);
+		std::vector<double> expected(size);
+		uint64_t max_population = 0;
+		for(size_t i = 0; i < size; ++i) {
+			m[i] = static_cast<uint64_t>(ctables_.a_not_b[i]) + ctables_.not_a_not_b[i];
+			l[i] = ctables_.a_not_b[i];
+			n[i] = static_cast<uint64_t>(ctables_.ab[i]) + ctables_.not_ab[i];
+			k[i] = ctables_.ab[i];
+			max_population = std::max(max_population, m[i] + n[i]);
+
 			// Check if upper-tailed or lower-tailed p-value should be calculated
-			auto k_ = (((double)(a+c)*b)/((double)(b+d)));
-			float_type p;
-			if(upperTailed || (k_ < a)) {
-				p = test_.upperTailedPValue(b+d, b, a+c, a);
-			} else {
-				p = test_.lowerTailedPValue(b+d, b, a+c, a);
-			}
+			expected[i] = ((double)n[i] * l[i]) / ((double)m[i]);
+			tails[i] = (upperTailed || expected[i] < k[i])
+			               ? BatchFishersExactTest::Tail::Upper
+			               : BatchFishersExactTest::Tail::Lower;
+		}
+
+		BatchFishersExactTest test(max_population);
+		const auto p_values = test.pValues(m, l, n, k, tails, num_threads);
 
-			result.name = name;
-			result.hits = a;
-			result.expected_hits = k_;
-			result.p_value = p;
-			results.emplace_back(result);
+		std::vector<ContingencyEnrichmentResult> results(size);
+		for(size_t i = 0; i < size; ++i) {
+			results[i].name = ctables_.names[i];
+			results[i].hits = k[i];
+			results[i].expected_hits = expected[i];
+			results[i].p_value = p_values[i];
 		}
-		return std::move(results);
+		return results;
 	}
 
   private:
 	const contingency_tables& ctables_;
-	FishersExactTest<int_type, float_type> test_;
 };
 }
 
-#endif // GT2_CONTINGENCY_ORA_H
\ No newline at end of file
+#endif // GT2_CONTINGENCY_ORA_H
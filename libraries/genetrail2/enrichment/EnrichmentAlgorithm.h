@@ -57,6 +57,20 @@ namespace GeneTrail
 		virtual std::tuple<double, double>
 		computeEnrichmentScore(IndexIterator begin, IndexIterator end) = 0;
 
+		/**
+		 * Computes the score for the union of the sorted indices
+		 * [begin, end) and [batch_begin, batch_end), which is written to
+		 * out. This is used by permutation tests that extend a sorted
+		 * random sample batch by batch.
+		 *
+		 * @param weight Running sum statistics keep the total weight of
+		 *               the sample here. Must be 0 for an empty sample.
+		 */
+		virtual std::tuple<double, double>
+		computeEnrichmentScore(IndexIterator begin, IndexIterator end,
+		                       IndexIterator batch_begin, IndexIterator batch_end,
+		                       Indices::iterator out, double& weight) = 0;
+
 		private:
 		PValueMode mode_;
 	};
@@ -100,6 +114,18 @@ namespace GeneTrail
 				    typename Statistics::SupportsIndices(), begin, end);
 			}
 
+			std::tuple<double, double>
+			computeEnrichmentScore(IndexIterator begin, IndexIterator end,
+			                       IndexIterator batch_begin,
+			                       IndexIterator batch_end,
+			                       Indices::iterator out,
+			                       double& weight) override
+			{
+				return computeEnrichmentScoreDispatch_(
+				    typename Statistics::SupportsIndices(), begin, end,
+				    batch_begin, batch_end, out, weight);
+			}
+
 			std::unique_ptr<EnrichmentResult>
 			computeEnrichment(const std::shared_ptr<Category>& c) override
 			{
@@ -203,6 +229,31 @@ namespace GeneTrail
 				                     "indices.");
 			}
 
+			std::tuple<double, double>
+			computeEnrichmentScoreDispatch_(StatTags::SupportsIndices,
+			                                IndexIterator begin,
+			                                IndexIterator end,
+			                                IndexIterator batch_begin,
+			                                IndexIterator batch_end,
+			                                Indices::iterator out,
+			                                double& weight)
+			{
+				return statistics_.computeScore(begin, end, batch_begin,
+				                                batch_end, out, weight);
+			}
+
+			std::tuple<double, double>
+			    computeEnrichmentScoreDispatch_(StatTags::DoesNotSupportIndices,
+			                                    IndexIterator, IndexIterator,
+			                                    IndexIterator, IndexIterator,
+			                                    Indices::iterator, double&)
+			{
+				throw NotImplemented(__FILE__, __LINE__,
+				                     "This type does not implement the "
+				                     "computation of enrichment scores using "
+				                     "indices.");
+			}
+
 			Statistics statistics_;
 		};
 	}
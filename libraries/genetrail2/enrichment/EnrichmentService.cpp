@@ -0,0 +1,404 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2018 Tim Kehl <tkehl@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "EnrichmentService.h"
+
+#include "common.h"
+#include "EnrichmentAlgorithm.h"
+#include "EnrichmentResult.h"
+#include "Parameters.h"
+
+#include <genetrail2/core/BinaryCategoryDatabase.h>
+#include <genetrail2/core/EntityDatabase.h>
+#include <genetrail2/core/GeneSet.h>
+#include <genetrail2/core/Scores.h>
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace GeneTrail
+{
+	namespace
+	{
+		using Value = rapidjson::Value;
+
+		const Value* member(const Value& request, const char* name)
+		{
+			auto it = request.FindMember(name);
+			return it == request.MemberEnd() ? nullptr : &it->value;
+		}
+
+		std::invalid_argument invalid(const char* name, const char* type)
+		{
+			return std::invalid_argument(std::string("Member '") + name +
+			                             "' must be " + type + ".");
+		}
+
+		std::string getString(const Value& request, const char* name,
+		                      const std::string& default_value)
+		{
+			const Value* v = member(request, name);
+			if(v == nullptr) {
+				return default_value;
+			}
+			if(!v->IsString()) {
+				throw invalid(name, "a string");
+			}
+			return v->GetString();
+		}
+
+		bool getBool(const Value& request, const char* name, bool default_value)
+		{
+			const Value* v = member(request, name);
+			if(v == nullptr) {
+				return default_value;
+			}
+			if(!v->IsBool()) {
+				throw invalid(name, "a boolean");
+			}
+			return v->GetBool();
+		}
+
+		size_t getSize(const Value& request, const char* name, size_t default_value)
+		{
+			const Value* v = member(request, name);
+			if(v == nullptr) {
+				return default_value;
+			}
+			if(!v->IsUint64()) {
+				throw invalid(name, "a non-negative integer");
+			}
+			return v->GetUint64();
+		}
+
+		/**
+		 * Reads a gene set from an inline array. Identifier lists get the
+		 * score 0.
+		 */
+		bool readGeneSet(GeneSet& result, const Value& request,
+		                 const char* name, bool with_scores)
+		{
+			const Value* v = member(request, name);
+			if(v == nullptr) {
+				return false;
+			}
+
+			if(!v->IsArray()) {
+				throw invalid(name, "an array");
+			}
+
+			for(const auto& entry : v->GetArray()) {
+				if(with_scores) {
+					if(!entry.IsArray() || entry.Size() != 2 ||
+					   !entry[0].IsString() || !entry[1].IsNumber()) {
+						throw invalid(name, "an array of [identifier, score] pairs");
+					}
+					result.insert(entry[0].GetString(), entry[1].GetDouble());
+				} else {
+					if(!entry.IsString()) {
+						throw invalid(name, "an array of identifiers");
+					}
+					result.insert(entry.GetString(), 0.0);
+				}
+			}
+
+			return true;
+		}
+
+		NullHypothesis getHypothesis(const std::string& hypothesis)
+		{
+			if(hypothesis == "two-sided") {
+				return NullHypothesis::TWO_SIDED;
+			} else if(hypothesis == "upper-tailed") {
+				return NullHypothesis::UPPER_TAILED;
+			} else if(hypothesis == "lower-tailed") {
+				return NullHypothesis::LOWER_TAILED;
+			}
+			throw std::invalid_argument("Unknown hypothesis '" + hypothesis + "'.");
+		}
+
+		void readParams(Params& p, const Value& request)
+		{
+			p.verbose = false;
+			p.minimum = getSize(request, "minimum", 0);
+			p.maximum = getSize(request, "maximum", 1000);
+			p.numPermutations = getSize(request, "permutations", 1000000);
+			p.randomSeed = getSize(request, "seed", p.randomSeed);
+			p.adjustSeparately = getBool(request, "adjust_separately", false);
+			p.includeAll = getBool(request, "include_all", false);
+			p.justScores = getBool(request, "just_scores", false);
+			p.justPvalues = getBool(request, "just_pvalues", false);
+
+			const std::string adjustment = getString(request, "adjustment", "none");
+			if(adjustment != "none") {
+				p.adjustment = pvalue::getCorrectionMethod(adjustment);
+				if(!p.adjustment) {
+					throw std::invalid_argument("Unknown adjustment method '" +
+					                            adjustment + "'.");
+				}
+			}
+
+			if(p.justScores && p.justPvalues) {
+				throw std::invalid_argument(
+				    "just_scores and just_pvalues can not be applied together.");
+			}
+		}
+
+		/**
+		 * Looks up the databases listed in the request. All databases are
+		 * used if the request does not list any.
+		 */
+		CategoryDBPtrList selectDatabases(const EnrichmentService::Databases& databases,
+		                                  const Value* names)
+		{
+			if(names == nullptr) {
+				return CategoryDBPtrList(databases.begin(), databases.end());
+			}
+
+			if(!names->IsArray()) {
+				throw invalid("categories", "an array of database names");
+			}
+
+			CategoryDBPtrList result;
+			for(const auto& name : names->GetArray()) {
+				if(!name.IsString()) {
+					throw invalid("categories", "an array of database names");
+				}
+				auto it = databases.find(name.GetString());
+				if(it == databases.end()) {
+					throw std::invalid_argument(
+					    std::string("Unknown category database '") +
+					    name.GetString() + "'.");
+				}
+				result.emplace_back(it->first, it->second);
+			}
+			return result;
+		}
+
+		/**
+		 * Maps the identifiers of a request to entity ids without modifying
+		 * the shared entity database. Identifiers that are not contained in
+		 * any category database get ids beyond the database that are local
+		 * to the request. They never match a category member.
+		 */
+		class RequestEntities
+		{
+		  public:
+			explicit RequestEntities(const EntityDatabase& db)
+			    : db_(db), next_(db.size())
+			{
+			}
+
+			size_t index(const std::string& name)
+			{
+				if(db_.contains(name)) {
+					return db_.index(name);
+				}
+
+				auto it = unknown_.emplace(name, next_);
+				if(it.second) {
+					++next_;
+				}
+				return it.first->second;
+			}
+
+			Category toCategory(const GeneSet& genes, EntityDatabase* db,
+			                    const std::string& name)
+			{
+				Category result(db);
+				result.setName(name);
+				for(const auto& g : genes) {
+					result.insert(index(g.first));
+				}
+				return result;
+			}
+
+		  private:
+			const EntityDatabase& db_;
+			std::unordered_map<std::string, size_t> unknown_;
+			size_t next_;
+		};
+
+		std::string errorResponse(const std::string& message)
+		{
+			rapidjson::StringBuffer sb;
+			rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+			writer.StartObject();
+			writer.String("status");
+			writer.String("error");
+			writer.String("message");
+			writer.String(message.c_str());
+			writer.EndObject();
+			return sb.GetString();
+		}
+	}
+
+	EnrichmentService::EnrichmentService()
+	    : entities_(std::make_shared<EntityDatabase>())
+	{
+	}
+
+	EnrichmentService::~EnrichmentService() = default;
+
+	void EnrichmentService::preload(const std::string& name,
+	                                const std::string& path)
+	{
+		std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+		if(databases_.find(name) != databases_.end()) {
+			throw std::invalid_argument("The category database '" + name +
+			                            "' is already loaded.");
+		}
+
+		auto db = std::make_shared<CategoryDatabase>(
+		    readCategoryDatabase(entities_, path));
+		db->setName(name);
+		databases_.emplace(name, std::move(db));
+	}
+
+	size_t EnrichmentService::numberOfDatabases() const
+	{
+		std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+		return databases_.size();
+	}
+
+	std::string EnrichmentService::handle(const std::string& request)
+	{
+		try {
+			return respond_(request);
+		} catch(const std::exception& e) {
+			return errorResponse(e.what());
+		} catch(const std::string& e) {
+			return errorResponse(e);
+		}
+	}
+
+	std::string EnrichmentService::respond_(const std::string& request_string)
+	{
+		rapidjson::StringBuffer sb;
+		rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+
+		rapidjson::Document request;
+		request.Parse(request_string.c_str());
+		if(request.HasParseError() || !request.IsObject()) {
+			throw std::invalid_argument("The request is not a JSON object.");
+		}
+
+		Params p;
+		readParams(p, request);
+
+		const std::string method = getString(request, "method", "");
+		const bool increasing = getBool(request, "increasing", false);
+		const bool absolute = getBool(request, "absolute", false);
+		const NullHypothesis hypothesis =
+		    getHypothesis(getString(request, "hypothesis", "two-sided"));
+
+		GeneSet test_set;
+		const bool has_scores = readGeneSet(test_set, request, "scores", true);
+		if(has_scores && member(request, "identifiers") != nullptr) {
+			throw std::invalid_argument(
+			    "Only one of scores and identifiers may be given.");
+		}
+		if(!has_scores && !readGeneSet(test_set, request, "identifiers", false)) {
+			throw std::invalid_argument("No test set specified.");
+		}
+
+		GeneSet reference_set;
+		if(method == "ora" &&
+		   !readGeneSet(reference_set, request, "reference", false)) {
+			throw std::invalid_argument("No reference set specified.");
+		}
+
+		std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+
+		const CategoryDBPtrList databases =
+		    selectDatabases(databases_, member(request, "categories"));
+
+		// The request only reads shared data, the entity database only
+		// contains the identifiers of the preloaded databases.
+		RequestEntities ids(*entities_);
+
+		std::vector<Score> data;
+		data.reserve(test_set.size());
+		for(const auto& g : test_set) {
+			data.emplace_back(ids.index(g.first), g.second);
+		}
+		auto scores = std::make_unique<Scores>(std::move(data), entities_);
+
+		const Order order = increasing ? Order::Increasing : Order::Decreasing;
+		if(has_scores && (method == "gsea" || method == "wilcoxon")) {
+			if(absolute) {
+				for(auto& s : scores->scores()) {
+					s = std::abs(s);
+				}
+			}
+			scores->sortByScore(order);
+		}
+
+		EnrichmentAlgorithmPtr algorithm;
+		if(method == "ora") {
+			algorithm = createEnrichmentAlgorithm<Ora>(
+			    p.pValueMode,
+			    ids.toCategory(reference_set, entities_.get(), "reference"),
+			    ids.toCategory(test_set, entities_.get(), "test"), hypothesis);
+		} else if(method == "gsea") {
+			algorithm = createEnrichmentAlgorithm<KolmogorovSmirnov>(
+			    p.pValueMode, scores->indices().begin(),
+			    scores->indices().end(), order);
+		} else if(method == "wilcoxon") {
+			algorithm = createEnrichmentAlgorithm<WilcoxonRSTest>(
+			    p.pValueMode, scores->indices().begin(),
+			    scores->indices().end(), order);
+		} else if(method == "mean") {
+			algorithm = createEnrichmentAlgorithm<MeanEnrichment>(p.pValueMode, *scores);
+		} else if(method == "median") {
+			algorithm = createEnrichmentAlgorithm<MedianEnrichment>(p.pValueMode, *scores);
+		} else if(method == "sum") {
+			algorithm = createEnrichmentAlgorithm<SumEnrichment>(p.pValueMode, *scores);
+		} else if(method == "max-mean") {
+			algorithm = createEnrichmentAlgorithm<MaxMeanEnrichment>(p.pValueMode, *scores);
+		} else {
+			throw std::invalid_argument("Unknown method '" + method + "'.");
+		}
+
+		const AllResults results =
+		    computeEnrichments(*scores, databases, algorithm, p, true);
+
+		writer.StartObject();
+		writer.String("status");
+		writer.String("ok");
+		writer.String("results");
+		writer.StartObject();
+		for(const auto& database : results) {
+			std::ostringstream table;
+			writeResults(table, database.second, p.justScores, p.justPvalues);
+			writer.String(database.first.c_str());
+			writer.String(table.str().c_str());
+		}
+		writer.EndObject();
+		writer.EndObject();
+
+		return sb.GetString();
+	}
+}
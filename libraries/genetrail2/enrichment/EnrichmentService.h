@@ -0,0 +1,111 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2018 Tim Kehl <tkehl@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_ENRICHMENT_ENRICHMENT_SERVICE_H
+#define GT2_ENRICHMENT_ENRICHMENT_SERVICE_H
+
+#include <genetrail2/core/macros.h>
+
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+
+namespace GeneTrail
+{
+	class CategoryDatabase;
+	class EntityDatabase;
+
+	/**
+	 * Answers enrichment requests encoded as JSON objects.
+	 *
+	 * In contrast to the command line tools, category databases and the
+	 * identifiers of all entities stay in memory between requests. The
+	 * category databases are read via preload() and shared by all
+	 * requests. Requests can only use these databases and never access
+	 * files.
+	 *
+	 * A request has the following members:
+	 *  - "method": One of "ora", "gsea", "wilcoxon", "mean", "median",
+	 *    "sum" or "max-mean"
+	 *  - Either "scores" (an array of [identifier, score] pairs) or
+	 *    "identifiers" (an array of identifiers)
+	 *  - For "ora": "reference" (an array of identifiers), and optionally
+	 *    "hypothesis" ("two-sided", "upper-tailed" or "lower-tailed")
+	 *  - Optional: "categories", an array of the names of the preloaded
+	 *    databases to be tested. All databases are tested by default.
+	 *  - Optional: "minimum", "maximum", "permutations", "seed",
+	 *    "adjustment", "adjust_separately", "include_all", "just_scores",
+	 *    "just_pvalues", "increasing" and "absolute"
+	 *
+	 * The options have the same meaning as for the command line tools.
+	 *
+	 * The response contains "status" ("ok" or "error"). A successful
+	 * response maps every database name in "results" to the tab separated
+	 * table that the command line tools write. A failed response contains
+	 * a "message".
+	 *
+	 * All methods are thread-safe. Requests are evaluated concurrently and
+	 * only read shared data. Identifiers that do not occur in the category
+	 * databases are not registered with the shared entity database, so its
+	 * size is bounded by the preloaded databases.
+	 */
+	class GT2_EXPORT EnrichmentService
+	{
+	  public:
+		using Databases =
+		    std::map<std::string, std::shared_ptr<const CategoryDatabase>>;
+
+		EnrichmentService();
+		~EnrichmentService();
+
+		/**
+		 * Reads the category database stored in path and makes it
+		 * available to requests under the given name.
+		 *
+		 * @throws IOError if the file cannot be read.
+		 * @throws std::invalid_argument if a database with this name is
+		 *         already loaded.
+		 */
+		void preload(const std::string& name, const std::string& path);
+
+		/**
+		 * Computes the enrichments for the request.
+		 *
+		 * @param request A JSON object as described above.
+		 * @return The JSON encoded response. Errors are reported in the
+		 *         response and never thrown.
+		 */
+		std::string handle(const std::string& request);
+
+		/// The number of category databases held in memory
+		size_t numberOfDatabases() const;
+
+	  private:
+		std::string respond_(const std::string& request);
+
+		std::shared_ptr<EntityDatabase> entities_;
+		Databases databases_;
+
+		// Held exclusively while a database is preloaded
+		mutable std::shared_timed_mutex mutex_;
+	};
+}
+
+#endif // GT2_ENRICHMENT_ENRICHMENT_SERVICE_H
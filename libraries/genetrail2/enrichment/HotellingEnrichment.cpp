@@ -0,0 +1,238 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2018 Tim Kehl <tkehl@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "HotellingEnrichment.h"
+
+#include <genetrail2/core/CategoryDatabase.h>
+#include <genetrail2/core/Parallel.h>
+
+#include <Eigen/Cholesky>
+#include <Eigen/Eigenvalues>
+
+#include <boost/math/distributions/fisher_f.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace GeneTrail
+{
+	const size_t HotellingEnrichment::MAX_CACHED_COLUMNS;
+
+	HotellingEnrichment::HotellingEnrichment(const DenseMatrix& control,
+	                                         const DenseMatrix& sample,
+	                                         double shrinkage)
+	    : control_(&control),
+	      data_(control.rows() + sample.rows(), control.cols()),
+	      n_control_(control.rows()),
+	      n_sample_(sample.rows()),
+	      shrinkage_(shrinkage),
+	      cached_columns_(0)
+	{
+		if(control.colNames() != sample.colNames()) {
+			throw std::invalid_argument(
+			    "Control and sample group must contain the same genes.");
+		}
+
+		if(shrinkage < 0.0 || shrinkage > 1.0) {
+			throw std::invalid_argument("Shrinkage must be in [0, 1].");
+		}
+
+		// Remark: Do not use auto with Eigen expressions, as they may not be
+		// fully evaluated.
+		Eigen::RowVectorXd cm = control.matrix().colwise().mean();
+		Eigen::RowVectorXd sm = sample.matrix().colwise().mean();
+		diff_ = (cm - sm).transpose();
+
+		const double scale = 1.0 / std::sqrt(static_cast<double>(
+		                               n_control_ + n_sample_ - 2));
+
+		data_.topRows(n_control_) =
+		    (control.matrix().rowwise() - cm) * scale;
+		data_.bottomRows(n_sample_) = (sample.matrix().rowwise() - sm) * scale;
+	}
+
+	std::vector<size_t> HotellingEnrichment::columns_(const Category& c) const
+	{
+		std::vector<size_t> columns;
+		columns.reserve(c.size());
+
+		for(const auto& name : c.names()) {
+			auto i = control_->colIndex(name);
+
+			if(i != std::numeric_limits<decltype(i)>::max()) {
+				columns.push_back(i);
+			}
+		}
+
+		// The order of the columns does not change T^2. Sorting them
+		// allows to recognize identical member sets.
+		std::sort(columns.begin(), columns.end());
+
+		return columns;
+	}
+
+	double HotellingEnrichment::t2_(const std::vector<size_t>& columns) const
+	{
+		{
+			std::lock_guard<std::mutex> lock(cache_mutex_);
+			auto it = cache_.find(columns);
+			if(it != cache_.end()) {
+				return it->second;
+			}
+		}
+
+		const auto p = columns.size();
+
+		DenseMatrix::DMatrix gathered(data_.rows(), p);
+		Eigen::VectorXd diff(p);
+		for(size_t i = 0; i < p; ++i) {
+			gathered.col(i) = data_.col(columns[i]);
+			diff[i] = diff_[columns[i]];
+		}
+
+		DenseMatrix::DMatrix cov = DenseMatrix::DMatrix::Zero(p, p);
+		cov.selfadjointView<Eigen::Lower>().rankUpdate(gathered.transpose());
+
+		double result = shrinkage_ == 0.0 ? pseudoInverseT2_(cov, diff)
+		                                  : shrunkenT2_(cov, diff);
+		result *= static_cast<double>(n_control_ * n_sample_) /
+		          (n_control_ + n_sample_);
+
+		if(!std::isfinite(result) || result < 0.0) {
+			result = std::numeric_limits<double>::quiet_NaN();
+		}
+
+		std::lock_guard<std::mutex> lock(cache_mutex_);
+		auto res = cache_.emplace(columns, result);
+		if(res.second) {
+			cache_order_.push_back(res.first);
+			cached_columns_ += p;
+			while(cached_columns_ > MAX_CACHED_COLUMNS) {
+				cached_columns_ -= cache_order_.front()->first.size();
+				cache_.erase(cache_order_.front());
+				cache_order_.pop_front();
+			}
+		}
+
+		return result;
+	}
+
+	double HotellingEnrichment::shrunkenT2_(DenseMatrix::DMatrix& cov,
+	                                        const Eigen::VectorXd& diff) const
+	{
+		// Only the lower triangle is used by the decomposition
+		cov.triangularView<Eigen::StrictlyLower>() *= (1.0 - shrinkage_);
+
+		Eigen::LDLT<DenseMatrix::DMatrix, Eigen::Lower> ldlt(cov);
+		if(ldlt.info() != Eigen::Success || !ldlt.isPositive()) {
+			return std::numeric_limits<double>::quiet_NaN();
+		}
+
+		return diff.dot(ldlt.solve(diff));
+	}
+
+	double
+	HotellingEnrichment::pseudoInverseT2_(const DenseMatrix::DMatrix& cov,
+	                                      const Eigen::VectorXd& diff) const
+	{
+		// Only the lower triangle is used by the solver
+		Eigen::SelfAdjointEigenSolver<DenseMatrix::DMatrix> solver(cov);
+		if(solver.info() != Eigen::Success) {
+			return std::numeric_limits<double>::quiet_NaN();
+		}
+
+		const Eigen::VectorXd projected =
+		    solver.eigenvectors().transpose() * diff;
+		const Eigen::VectorXd& values = solver.eigenvalues();
+
+		double result = 0.0;
+		for(int i = 0; i < values.rows(); ++i) {
+			if(std::abs(values[i]) >= 0.01) {
+				result += projected[i] * projected[i] / values[i];
+			}
+		}
+
+		return result;
+	}
+
+	double HotellingEnrichment::pValue_(double t2, size_t p) const
+	{
+		const double n = n_control_ + n_sample_;
+		const double df = n - p - 1;
+
+		if(std::isnan(t2) || df <= 0) {
+			return std::numeric_limits<double>::quiet_NaN();
+		}
+
+		t2 *= df / ((n - 2) * p);
+
+		boost::math::fisher_f F(p, df);
+		return boost::math::cdf(boost::math::complement(F, t2));
+	}
+
+	HotellingEnrichment::Result
+	HotellingEnrichment::compute(const Category& c) const
+	{
+		const auto columns = columns_(c);
+		const auto p = columns.size();
+
+		if(p == 0 || n_control_ + n_sample_ <= p + 1) {
+			const double nan = std::numeric_limits<double>::quiet_NaN();
+			return Result{nan, nan, p};
+		}
+
+		const double t2 = t2_(columns);
+
+		return Result{t2, pValue_(t2, p), p};
+	}
+
+	std::vector<HotellingEnrichment::Result>
+	HotellingEnrichment::compute(const CategoryDatabase& categories,
+	                             size_t num_threads) const
+	{
+		std::vector<Result> results(categories.size());
+
+		parallel_for(0, categories.size(),
+		             [&](size_t i) { results[i] = compute(categories[i]); },
+		             num_threads);
+
+		return results;
+	}
+
+	bool HotellingEnrichment::canUseCategory(const Category& c, size_t) const
+	{
+		const auto p = columns_(c).size();
+		return p > 0 && n_control_ + n_sample_ > p + 1;
+	}
+
+	std::tuple<double, double>
+	HotellingEnrichment::computeScore(const Category& c) const
+	{
+		return std::make_tuple(compute(c).t2, 0.0);
+	}
+
+	double
+	HotellingEnrichment::computeRowWisePValue(EnrichmentResult* result) const
+	{
+		// The score of the result is T^2, only the F-test remains
+		return pValue_(result->score, columns_(*result->category).size());
+	}
+}
@@ -0,0 +1,146 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2018 Tim Kehl <tkehl@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_ENRICHMENT_HOTELLING_ENRICHMENT_H
+#define GT2_ENRICHMENT_HOTELLING_ENRICHMENT_H
+
+#include "SetLevelStatistics.h"
+
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/macros.h>
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace GeneTrail
+{
+	class CategoryDatabase;
+
+	/**
+	 * Hotelling's T^2 test for the difference of the mean expression of
+	 * the members of a category between a control and a sample group.
+	 *
+	 * Both groups are centered once on construction. For every category
+	 * the pooled covariance matrix S of its members is computed from the
+	 * gathered columns of the centered data.
+	 *
+	 * By default, T^2 is computed using the pseudo-inverse of S, ignoring
+	 * eigenvalues with an absolute value below 0.01. If a shrinkage weight
+	 * is given, S is instead shrunken towards its diagonal
+	 *
+	 *   S* = (1 - shrinkage) * S + shrinkage * diag(S)
+	 *
+	 * and T^2 is obtained from an LDLT decomposition of S*, which is
+	 * considerably faster for large categories. Shrinkage keeps S*
+	 * invertible if a category has more members than there are samples,
+	 * but changes the resulting p-values.
+	 *
+	 * T^2 only depends on the set of matrix columns used for a category, so
+	 * results are memoized for categories with identical members, e.g. in
+	 * different databases. The memo holds at most MAX_CACHED_COLUMNS
+	 * column indices and evicts the oldest entries first. All methods are
+	 * safe to call concurrently.
+	 */
+	class GT2_EXPORT HotellingEnrichment
+	    : public SetLevelStatistics<StatTags::Direct,
+	                                StatTags::DoesNotSupportIndices,
+	                                StatTags::Identifiers>
+	{
+		public:
+		struct Result
+		{
+			/// The T^2 statistic, NaN if it could not be computed
+			double t2;
+			/// The p-value of the corresponding F-test
+			double pvalue;
+			/// The number of category members contained in the matrices
+			size_t genes;
+		};
+
+		/**
+		 * @param control   The control group. One row per sample, one
+		 *                  column per gene.
+		 * @param sample    The sample group. Must have the same columns
+		 *                  as the control group.
+		 * @param shrinkage Weight of the diagonal target, in [0, 1]. 0 uses
+		 *                  the pseudo-inverse of the covariance matrix.
+		 */
+		HotellingEnrichment(const DenseMatrix& control,
+		                    const DenseMatrix& sample, double shrinkage = 0.0);
+
+		HotellingEnrichment(const HotellingEnrichment&) = delete;
+		HotellingEnrichment& operator=(const HotellingEnrichment&) = delete;
+
+		/**
+		 * Computes the test for a single category.
+		 */
+		Result compute(const Category& c) const;
+
+		/**
+		 * Computes the test for all categories of the database using
+		 * num_threads threads (0 selects the number of hardware threads).
+		 */
+		std::vector<Result> compute(const CategoryDatabase& categories,
+		                            size_t num_threads = 0) const;
+
+		bool canUseCategory(const Category& c, size_t) const;
+
+		std::tuple<double, double> computeScore(const Category& c) const;
+
+		/**
+		 * Returns the p-value of the category of result. Its score must be
+		 * the T^2 computed by computeScore.
+		 */
+		double computeRowWisePValue(EnrichmentResult* result) const;
+
+		/// Maximum number of column indices held by the memo
+		static const size_t MAX_CACHED_COLUMNS = 1 << 22;
+
+		private:
+		std::vector<size_t> columns_(const Category& c) const;
+		double t2_(const std::vector<size_t>& columns) const;
+		double shrunkenT2_(DenseMatrix::DMatrix& cov, const Eigen::VectorXd& diff) const;
+		double pseudoInverseT2_(const DenseMatrix::DMatrix& cov, const Eigen::VectorXd& diff) const;
+		double pValue_(double t2, size_t p) const;
+
+		const DenseMatrix* control_;
+
+		// Both groups centered and stacked. Scaled such that the pooled
+		// covariance of two genes is the dot product of their columns.
+		DenseMatrix::DMatrix data_;
+		// Difference of the group means
+		Eigen::VectorXd diff_;
+
+		size_t n_control_;
+		size_t n_sample_;
+		double shrinkage_;
+
+		using Cache = std::map<std::vector<size_t>, double>;
+		mutable std::mutex cache_mutex_;
+		mutable Cache cache_;
+		// Cache entries in the order of their insertion
+		mutable std::deque<Cache::iterator> cache_order_;
+		mutable size_t cached_columns_;
+	};
+}
+
+#endif // GT2_ENRICHMENT_HOTELLING_ENRICHMENT_H
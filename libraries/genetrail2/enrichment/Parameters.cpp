@@ -32,6 +32,7 @@ Params::Params()
 	includeAll(false),
 	justScores(false),
 	justPvalues(false),
+	binaryOutput(false),
 	verbose(true),
 	pValueMode(PValueMode::RowWise)
 	{
@@ -107,6 +107,7 @@ namespace GeneTrail {
 		bool includeAll;
 		bool justScores;
 		bool justPvalues;
+		bool binaryOutput;
 		bool verbose;
 
 		boost::optional<MultipleTestingCorrection> adjustment;
@@ -25,7 +25,7 @@
 
 #include <genetrail2/core/macros.h>
 #include <genetrail2/core/misc_algorithms.h>
-#include <genetrail2/core/DenseColumnSubset.h>
+#include <genetrail2/core/DenseMatrixView.h>
 #include <genetrail2/core/DenseMatrix.h>
 #include <genetrail2/core/MatrixHTest.h>
 
@@ -145,23 +145,41 @@ class GT2_EXPORT RowPermutationTest
 	      permutations_(permutations),
 	      twister_(randomSeed),
 	      indices_(begin, end),
-	      tmp_indices_(std::distance(begin, end))
+	      sorted_indices_(indices_.size()),
+	      tmp_indices_(indices_.size())
 	{
 	}
 
+	/**
+	 * Extends the sorted sample from a to b indices and computes its
+	 * score. Index based algorithms do this in a single pass over the
+	 * sample, all others need the merged sample as category.
+	 */
 	std::tuple<double, double>
 	computeEnrichmentScore_(const EnrichmentAlgorithmPtr& algorithm,
-	                        size_t currentSampleSize)
+	                        size_t a, size_t b, double& weight)
 	{
-		auto start = indices_.begin();
-		auto stop = indices_.begin() + currentSampleSize;
+		std::sort(indices_.begin() + a, indices_.begin() + b);
 
 		if(algorithm->supportsIndices()) {
-			return algorithm->computeEnrichmentScore(start, stop);
-		} else {
-			category_.replaceAll(start, stop);
-			return algorithm->computeEnrichmentScore(category_);
+			auto score = algorithm->computeEnrichmentScore(
+			    sorted_indices_.begin(), sorted_indices_.begin() + a,
+			    indices_.begin() + a, indices_.begin() + b,
+			    tmp_indices_.begin(), weight);
+			sorted_indices_.swap(tmp_indices_);
+			return score;
 		}
+
+		// Merge into a temporary vector, as inplace_merge would
+		// allocate a new buffer every time it is called.
+		std::merge(sorted_indices_.begin(), sorted_indices_.begin() + a,
+		           indices_.begin() + a, indices_.begin() + b,
+		           tmp_indices_.begin());
+		sorted_indices_.swap(tmp_indices_);
+
+		category_.replaceAll(sorted_indices_.begin(),
+		                     sorted_indices_.begin() + b);
+		return algorithm->computeEnrichmentScore(category_);
 	}
 
 	void performSinglePermutation_(const EnrichmentAlgorithmPtr& algorithm,
@@ -170,6 +188,7 @@ class GT2_EXPORT RowPermutationTest
 	{
 		size_t currentSampleSize = 0;
 		value_type currentScore = 0.0;
+		double weight = 0.0;
 
 		// Shuffle the indices. The tests are sorted
 		// by the number of hits for every category, so we only
@@ -179,17 +198,22 @@ class GT2_EXPORT RowPermutationTest
 		for(size_t i = 0; i < tests.size(); ++i) {
 			// Check if the sampleSize has changed. As the tests_ vector is
 			// sorted we can use one running sum value for all categories of
-			// the same size.
+			// the same size. The sorted sample of the previous size is
+			// reused.
 			if(tests[i]->hits != currentSampleSize) {
-				presort_(currentSampleSize, tests[i]->hits);
+				currentScore = std::get<0>(computeEnrichmentScore_(
+				    algorithm, currentSampleSize, tests[i]->hits, weight));
 				currentSampleSize = tests[i]->hits;
-
-				currentScore = std::get<0>(
-				    computeEnrichmentScore_(algorithm, currentSampleSize));
 			}
 
 			this->updateCounter_(tests[i], counter[i], currentScore);
 		}
+
+		// Leave the sample sorted in place, as the next shuffle starts
+		// from the current order of the indices.
+		std::copy(sorted_indices_.begin(),
+		          sorted_indices_.begin() + currentSampleSize,
+		          indices_.begin());
 	}
 
 	void shuffle_(size_t n)
@@ -200,31 +224,12 @@ class GT2_EXPORT RowPermutationTest
 		}
 	}
 
-	/**
-	 * This sorts the indices vector until position b.
-	 * It is assumed, that the vector is sorted up to position a.
-	 */
-	void presort_(size_t a, size_t b)
-	{
-		// Sort [a, b)
-		std::sort(indices_.begin() + a, indices_.begin() + b);
-
-		// Merge [0, a) and [a, b) into a temporary vector.
-		// Note that inplace_merge would reallocate a new vector
-		// every time it is called.
-		std::merge(indices_.begin(), indices_.begin() + a, indices_.begin() + a,
-		           indices_.begin() + b, tmp_indices_.begin());
-
-		// Copy the sorted range [0, b) from the temporary vector
-		// to the names_ vector
-		std::copy(tmp_indices_.begin(), tmp_indices_.begin() + b,
-		          indices_.begin());
-	}
-
 	Category category_;
 	size_t permutations_;
 	std::mt19937_64 twister_;
 	std::vector<size_t> indices_;
+	// The sample drawn so far, sorted
+	std::vector<size_t> sorted_indices_;
 	std::vector<size_t> tmp_indices_;
 };
 
@@ -281,8 +286,8 @@ class ColumnPermutationBase : public internal::PermutationBase<value_type>
 
 		auto mid = begin + reference_size_;
 
-		auto ref = DenseColumnSubset(&data_, begin, mid);
-		auto sam = DenseColumnSubset(&data_, mid, end);
+		auto ref = columnSubsetView(data_, begin, mid);
+		auto sam = columnSubsetView(data_, mid, end);
 
 		return Scores(scoring.test(method_, ref, sam));
 	}
@@ -315,10 +320,12 @@ class ColumnPermutationBase : public internal::PermutationBase<value_type>
 		switch(order) {
 			case Order::Decreasing:
 				sort_permutation(permutation_, scores.scores().begin(),
-				                 scores.scores().end(), std::less<double>());
+				                 scores.scores().end(), std::greater<double>());
+				break;
 			case Order::Increasing:
 				sort_permutation(permutation_, scores.scores().begin(),
-				                 scores.scores().end(), std::greater<double>());
+				                 scores.scores().end(), std::less<double>());
+				break;
 		}
 
 		// After that we invert the permutation so that we
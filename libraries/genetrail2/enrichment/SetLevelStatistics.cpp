@@ -20,6 +20,8 @@
 
 #include "SetLevelStatistics.h"
 
+#include <boost/functional/hash.hpp>
+
 namespace GeneTrail
 {
 	StatisticsEnrichment::StatisticsEnrichment(const Statistics& test,
@@ -69,4 +71,90 @@ namespace GeneTrail
 		return statistic::mean<double>(scores_.scores().begin(),
 		                               scores_.scores().end());
 	}
+
+	const size_t OraPValueCache::MAX_ENTRIES;
+	const size_t OraPValueCache::NUMBER_OF_SHARDS;
+
+	OraPValueCache::OraPValueCache(size_t max_entries)
+	    : max_shard_entries_(
+	          std::max<size_t>(1, max_entries / NUMBER_OF_SHARDS))
+	{
+	}
+
+	OraPValueCache::OraPValueCache(const DenseMatrix& precomputed,
+	                               size_t max_entries)
+	    : precomputed_(precomputed.matrix()),
+	      max_shard_entries_(
+	          std::max<size_t>(1, max_entries / NUMBER_OF_SHARDS))
+	{
+	}
+
+	size_t OraPValueCache::KeyHash::operator()(const Key& key) const
+	{
+		size_t seed = 0;
+		boost::hash_combine(seed, key.reference_size);
+		boost::hash_combine(seed, key.test_size);
+		boost::hash_combine(seed, key.hypergeometric);
+		boost::hash_combine(seed, static_cast<int>(key.hypothesis));
+		boost::hash_combine(seed, key.l);
+		boost::hash_combine(seed, key.k);
+		return seed;
+	}
+
+	double OraPValueCache::pValue(const OverRepresentationAnalysis& test,
+	                              NullHypothesis hypothesis, size_t l,
+	                              size_t k) const
+	{
+		if(l < static_cast<size_t>(precomputed_.rows()) &&
+		   k < static_cast<size_t>(precomputed_.cols())) {
+			return precomputed_(l, k);
+		}
+
+		const Key key{test.referenceSize(), test.testSize(),
+		              test.usesHypergeometricTest(), hypothesis, l, k};
+		Shard& shard = shards_[KeyHash()(key) % NUMBER_OF_SHARDS];
+		{
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			auto it = shard.entries.find(key);
+			if(it != shard.entries.end()) {
+				return it->second;
+			}
+		}
+
+		// Computed without holding the lock. If another thread computes
+		// the same entry concurrently, both obtain the same value.
+		double p;
+		switch(hypothesis) {
+			case UPPER_TAILED:
+				p = test.computeUpperTailedPValue(l, k);
+				break;
+			case LOWER_TAILED:
+				p = test.computeLowerTailedPValue(l, k);
+				break;
+			case TWO_SIDED:
+			default:
+				p = test.computePValue(l, k);
+		}
+
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		if(shard.entries.emplace(key, p).second) {
+			shard.order.push_back(key);
+			if(shard.order.size() > max_shard_entries_) {
+				shard.entries.erase(shard.order.front());
+				shard.order.pop_front();
+			}
+		}
+
+		return p;
+	}
+
+	size_t OraPValueCache::size() const
+	{
+		size_t result = 0;
+		for(auto& shard : shards_) {
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			result += shard.entries.size();
+		}
+		return result;
+	}
 }
@@ -25,6 +25,7 @@
 
 #include <genetrail2/core/DenseMatrix.h>
 #include <genetrail2/core/HTest.h>
+#include <genetrail2/core/EntityBitmap.h>
 #include <genetrail2/core/Scores.h>
 #include <genetrail2/core/GeneSetEnrichmentAnalysis.h>
 #include <genetrail2/core/WilcoxonRankSumTest.h>
@@ -38,6 +39,12 @@
 #include <boost/iterator/filter_iterator.hpp>
 #include <boost/iterator/transform_iterator.hpp>
 
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
 namespace GeneTrail
 {
 	class Category;
@@ -233,74 +240,49 @@ namespace GeneTrail
 		Test test_;
 	};
 
-    template <typename T>
-    class HTestEnrichment<WilcoxonRankSumTest<T>>
-        : public HTestEnrichmentBase<WilcoxonRankSumTest<T>>
-    {
+	/**
+	 * The scores are ranked once. The rank sum of a category is then
+	 * gathered from the ranks of its members, which avoids sorting the
+	 * scores for every category.
+	 */
+	template <typename T>
+	class HTestEnrichment<WilcoxonRankSumTest<T>>
+	    : public HTestEnrichmentBase<WilcoxonRankSumTest<T>>
+	{
 	  public:
 		using Base = HTestEnrichmentBase<WilcoxonRankSumTest<T>>;
 
-		HTestEnrichment(const Scores& scores)
-			: Base(scores),
-			  sorted_scores_(scores)
+		HTestEnrichment(const Scores& scores) : Base(scores)
 		{
-			updateSortedScores_();
+			test_.rank(this->scores_);
 		}
 
-	    void setInputScores(const Scores& scores)
-	    {
-		    this->scores_ = scores;
-		    this->scores_.sortByIndex();
-		    this->sorted_scores_ = scores;
-
-			updateSortedScores_();
-	    }
-
-	    bool canUseCategory(const Category&, size_t hits) const
-	    {
-		    return hits > 1;
-	    }
-
-	    double computeRowWisePValue(EnrichmentResult* result)
-	    {
-		    return Base::computeRowWisePValue(test_, result);
-	    }
-
-	    std::tuple<double, double> computeScore(const Category& c)
-	    {
-		    using namespace boost;
-
-		    auto which = this->scores_.subset(c);
-			which.sortByScore(Order::Increasing);
-
-		    auto score = test_.test_sorted(sorted_scores_, which.begin(), which.end());
-
-		    return std::make_tuple(score, 0.0);
-	    }
-
-	  private:
-		void updateSortedScores_()
+		void setInputScores(const Scores& scores)
 		{
-		    score_permutation_.resize(this->scores_.size());
-		    std::iota(score_permutation_.begin(), score_permutation_.end(),
-		              static_cast<size_t>(0));
+			this->scores_ = scores;
+			this->scores_.sortByIndex();
+			test_.rank(this->scores_);
+		}
 
-		    auto comp = [this](size_t i, size_t j) {
-				return Scores::LessScore()(this->scores_[i], this->scores_[j]);
-			};
+		bool canUseCategory(const Category&, size_t hits) const
+		{
+			return hits > 1;
+		}
 
-		    score_permutation_ = sort_permutation(
-		        score_permutation_.begin(), score_permutation_.end(), comp);
+		double computeRowWisePValue(EnrichmentResult* result)
+		{
+			return Base::computeRowWisePValue(test_, result);
+		}
 
-		    for(size_t i = 0; i < sorted_scores_.size(); ++i) {
-			    sorted_scores_.set(i, this->scores_[score_permutation_[i]]);
-		    }
+		std::tuple<double, double> computeScore(const Category& c)
+		{
+			auto score = test_.test_ranked(c.begin(), c.end());
+			return std::make_tuple(score, 0.0);
 		}
 
-	    WilcoxonRankSumTest<T> test_;
-	    Scores sorted_scores_;
-	    std::vector<size_t> score_permutation_;
-    };
+	  private:
+		WilcoxonRankSumTest<T> test_;
+	};
 
 	template <typename T>
 	class HTestEnrichment<OneSampleTTest<T>>
@@ -393,23 +375,109 @@ namespace GeneTrail
 	};
 
 #include <iostream>
+	/**
+	 * Lazily filled cache of ORA p-values.
+	 *
+	 * For a fixed reference and test set size, the p-value of a category
+	 * only depends on the number l of its members in the reference set and
+	 * the number k of its members in the test set. Every (l, k) pair is
+	 * computed once, on first use, and only the pairs that actually occur
+	 * are stored. Thus categories of arbitrary size are supported.
+	 *
+	 * Optionally, a matrix of precomputed p-values indexed by (l, k) can be
+	 * supplied. Its entries are used instead of computing the p-value,
+	 * regardless of the test and hypothesis that are requested.
+	 *
+	 * The cache can be shared between threads. Its entries are distributed
+	 * over independently locked shards, so that threads rarely wait for
+	 * each other.
+	 *
+	 * As the entries also depend on the reference and test set size, a
+	 * cache shared by many test sets would grow without limit. Thus, every
+	 * shard holds at most max_entries / NUMBER_OF_SHARDS entries and
+	 * evicts the oldest entries first.
+	 */
+	class GT2_EXPORT OraPValueCache
+	{
+		public:
+		/// Default maximum number of cached p-values
+		static const size_t MAX_ENTRIES = 1 << 18;
+
+		explicit OraPValueCache(size_t max_entries = MAX_ENTRIES);
+
+		explicit OraPValueCache(const DenseMatrix& precomputed,
+		                        size_t max_entries = MAX_ENTRIES);
+
+		OraPValueCache(const OraPValueCache&) = delete;
+		OraPValueCache& operator=(const OraPValueCache&) = delete;
+
+		/**
+		 * The p-value of a category with l members in the reference set
+		 * and k members in the test set.
+		 */
+		double pValue(const OverRepresentationAnalysis& test,
+		              NullHypothesis hypothesis, size_t l, size_t k) const;
+
+		/**
+		 * The number of cached p-values.
+		 */
+		size_t size() const;
+
+		private:
+		struct Key
+		{
+			size_t reference_size;
+			size_t test_size;
+			bool hypergeometric;
+			NullHypothesis hypothesis;
+			size_t l;
+			size_t k;
+
+			bool operator==(const Key& o) const
+			{
+				return reference_size == o.reference_size &&
+				       test_size == o.test_size &&
+				       hypergeometric == o.hypergeometric &&
+				       hypothesis == o.hypothesis && l == o.l && k == o.k;
+			}
+		};
+
+		struct KeyHash
+		{
+			size_t operator()(const Key& key) const;
+		};
+
+		struct Shard
+		{
+			std::mutex mutex;
+			std::unordered_map<Key, double, KeyHash> entries;
+			// Keys of the entries in the order of their insertion
+			std::deque<Key> order;
+		};
+
+		static const size_t NUMBER_OF_SHARDS = 64;
+
+		DenseMatrix::DMatrix precomputed_;
+		size_t max_shard_entries_;
+
+		mutable std::array<Shard, NUMBER_OF_SHARDS> shards_;
+	};
+
 	class PreprocessedORA : public SetLevelStatistics<StatTags::Direct,
 	                                      StatTags::DoesNotSupportIndices,
 	                                      StatTags::Identifiers>
 	{
 		public:
-		PreprocessedORA(const Category& reference_set, const Category& test_set, NullHypothesis hypothesis, const DenseMatrix& p_values, const bool justScores, const bool justPvalues)
-		: reference_set_(reference_set), 
-		  test_set_(test_set),
-		  hypothesis_(hypothesis), 
+		PreprocessedORA(const Category& reference_set, const Category& test_set, NullHypothesis hypothesis, const OraPValueCache& p_values, const bool justScores, const bool justPvalues)
+		: hypothesis_(hypothesis),
 		  test_(reference_set, test_set),
 		  p_values_(p_values),
 		  just_scores_(justScores),
 		  just_pvalues_(justPvalues)
 		{};
 
-		bool canUseCategory(const Category& c, size_t) const {
-			return c.size() <= 1000;
+		bool canUseCategory(const Category&, size_t) const {
+			return true;
 		}
 
 		std::tuple<double, double> computeScore(const Category& c) const
@@ -428,18 +496,16 @@ namespace GeneTrail
 
 		double computeRowWisePValue(EnrichmentResult* result) const
 		{
-			size_t csize = Category::intersect("null", *result->category, reference_set_).size();
-            size_t hits = Category::intersect("null", *result->category, test_set_).size();
-			return p_values_(csize, hits);
+			size_t l = test_.referenceHits(*result->category);
+			size_t k = test_.testHits(*result->category);
+			return p_values_.pValue(test_, hypothesis_, l, k);
 		}
 
 		private:
 
-		Category reference_set_;
-		Category test_set_;
 		NullHypothesis hypothesis_;
 		OverRepresentationAnalysis test_;
-		const GeneTrail::DenseMatrix& p_values_;
+		const OraPValueCache& p_values_;
 		const bool just_scores_;
 		const bool just_pvalues_;
 	};
@@ -492,24 +558,33 @@ namespace GeneTrail
 		public:
 		template <typename Iterator>
 		WilcoxonRSTest(const Iterator& beginIds, const Iterator& endIds, Order order)
-		    : order_(order), ids_(beginIds, endIds), hypothesis_(NullHypothesis::TWO_SIDED)
+		    : order_(order),
+		      ids_(beginIds, endIds),
+		      id_bits_(ids_.begin(), ids_.end()),
+		      hypothesis_(NullHypothesis::TWO_SIDED)
 		{
+			test_.rank(ids_.begin(), ids_.end());
 		}
 		
 		template <typename Iterator>
 		WilcoxonRSTest(const Iterator& beginIds, const Iterator& endIds, Order order, NullHypothesis hypothesis)
-		    : order_(order), ids_(beginIds, endIds), hypothesis_(hypothesis)
+		    : order_(order),
+		      ids_(beginIds, endIds),
+		      id_bits_(ids_.begin(), ids_.end()),
+		      hypothesis_(hypothesis)
 		{
+			test_.rank(ids_.begin(), ids_.end());
 		}
 
 		Order getOrder() const {
 			return order_;
 		}
 
-		void setInputScores(Scores scores)
+		void setInputScores(const Scores& scores)
 		{
-			scores.sortByScore(order_);
-			ids_.assign(scores.indices().begin(), scores.indices().end());
+			ids_ = scores.indicesSortedByScore(order_);
+			id_bits_ = EntityBitmap(ids_.begin(), ids_.end());
+			test_.rank(ids_.begin(), ids_.end());
 		}
 
 		bool canUseCategory(const Category&, size_t hits) const { 
@@ -518,13 +593,13 @@ namespace GeneTrail
 
 		std::tuple<double, double> computeScore(const Category& category)
 		{
-			auto score = test_.computeZScore(category, ids_.begin(), ids_.end());
+			auto score = test_.test_ranked(category.begin(), category.end());
 			return std::make_tuple(score, 0.0);
 		}
 
 		double computeRowWisePValue(EnrichmentResult* result)
 		{
-			result->hits = test_.intersectionSize(*result->category, ids_.begin(), ids_.end());
+			result->hits = id_bits_.intersectionSize(*result->category);
 
 			double p_value = 1.0;	
 
@@ -551,6 +626,7 @@ namespace GeneTrail
 		private:
 		Order order_;
 		std::vector<size_t> ids_;
+		EntityBitmap id_bits_;
 		WilcoxonRankSumTest<double> test_;
 		NullHypothesis hypothesis_;
 	};
@@ -560,7 +636,9 @@ namespace GeneTrail
 		public:
 		template <typename Iterator>
 		KolmogorovSmirnov(const Iterator& beginIds, const Iterator& endIds, Order order)
-		    : order_(order), ids_(beginIds, endIds)
+		    : order_(order),
+		      ids_(beginIds, endIds),
+		      id_bits_(ids_.begin(), ids_.end())
 		{
 		}
 
@@ -568,10 +646,10 @@ namespace GeneTrail
 			return order_;
 		}
 
-		void setInputScores(Scores scores)
+		void setInputScores(const Scores& scores)
 		{
-			scores.sortByScore(order_);
-			ids_.assign(scores.indices().begin(), scores.indices().end());
+			ids_ = scores.indicesSortedByScore(order_);
+			id_bits_ = EntityBitmap(ids_.begin(), ids_.end());
 		}
 
 		bool canUseCategory(const Category&, size_t) const { return true; }
@@ -590,10 +668,18 @@ namespace GeneTrail
 			return std::make_tuple(score, 0.0);
 		}
 
+		std::tuple<double, double> computeScore(IndexIterator begin, IndexIterator end,
+		                                        IndexIterator batch_begin,
+		                                        IndexIterator batch_end,
+		                                        Indices::iterator out, double&)
+		{
+			auto out_end = std::merge(begin, end, batch_begin, batch_end, out);
+			return computeScore(out, out_end);
+		}
+
 		double computeRowWisePValue(EnrichmentResult* result)
 		{
-			auto intersection_size = test_.intersectionSize(
-			    *result->category, ids_.begin(), ids_.end());
+			auto intersection_size = id_bits_.intersectionSize(*result->category);
 
 			double p_value = 1.0;	
 
@@ -613,6 +699,7 @@ namespace GeneTrail
 		private:
 		Order order_;
 		std::vector<size_t> ids_;
+		EntityBitmap id_bits_;
 		GeneSetEnrichmentAnalysis<big_float, int64_t> test_;
 	};
 
@@ -630,10 +717,9 @@ namespace GeneTrail
 			return order_;
 		}
 
-		void setInputScores(Scores scores)
+		void setInputScores(const Scores& scores)
 		{
-			scores.sortByScore(order_);
-			test_.setScores(std::move(scores));
+			test_.setScores(scores, order_);
 		}
 
 		bool canUseCategory(const Category&, size_t) const { return true; }
@@ -651,6 +737,18 @@ namespace GeneTrail
 			return std::make_tuple(std::get<0>(score), 0.0);
 		}
 
+		std::tuple<double, double> computeScore(IndexIterator begin,
+		                                        IndexIterator end,
+		                                        IndexIterator batch_begin,
+		                                        IndexIterator batch_end,
+		                                        Indices::iterator out,
+		                                        double& weight)
+		{
+			auto score = test_.computeRunningSum(begin, end, batch_begin,
+			                                     batch_end, out, weight);
+			return std::make_tuple(std::get<0>(score), 0.0);
+		}
+
 		private:
 		Order order_;
 		WeightedGeneSetEnrichmentAnalysis<double> test_;
@@ -669,10 +767,9 @@ namespace GeneTrail
 			return order_;
 		}
 
-		void setInputScores(Scores scores)
+		void setInputScores(const Scores& scores)
 		{
-			scores.sortByScore(order_);
-			test_.setScores(std::move(scores));
+			test_.setScores(scores, order_);
 		}
 
 		bool canUseCategory(const Category&, size_t) const { return true; }
@@ -690,6 +787,18 @@ namespace GeneTrail
 			return std::make_tuple(std::get<1>(score), 0.0);
 		}
 
+		std::tuple<double, double> computeScore(IndexIterator begin,
+		                                        IndexIterator end,
+		                                        IndexIterator batch_begin,
+		                                        IndexIterator batch_end,
+		                                        Indices::iterator out,
+		                                        double& weight)
+		{
+			auto score = test_.computeRunningSum(begin, end, batch_begin,
+			                                     batch_end, out, weight);
+			return std::make_tuple(std::get<1>(score), 0.0);
+		}
+
 		private:
 		Order order_;
 		WeightedGeneSetEnrichmentAnalysis<double> test_;
@@ -25,17 +25,22 @@
 #include "Parameters.h"
 #include "PermutationTest.h"
 
+#include <genetrail2/core/BinaryCategoryDatabase.h>
+#include <genetrail2/core/BinaryEnrichmentResults.h>
 #include <genetrail2/core/DenseMatrixReader.h>
 #include <genetrail2/core/GeneSet.h>
 #include <genetrail2/core/GeneSetReader.h>
-#include <genetrail2/core/GMTFile.h>
+#include <genetrail2/core/Parallel.h>
 #include <genetrail2/core/PValue.h>
 #include <genetrail2/core/TextFile.h>
 
+#include <boost/algorithm/string/join.hpp>
 #include <boost/filesystem.hpp>
 
 #include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <limits>
 
 static CategoryList getCategoryList(const std::string& catfile_list)
 {
@@ -119,15 +124,49 @@ processCategory(const Category& c, const Scores& test_set, const Params& p)
 	return std::make_tuple(p.minimum <= subset.size() && subset.size() <= p.maximum, subset.size(), std::move(entries));
 }
 
-static void writeFiles(const std::string& output_dir, const AllResults& all_results, const bool justScores, const bool justPvalues)
+static void writeBinaryResults(const std::string& path, const Results& results)
 {
+	EnrichmentResultColumns columns;
+	columns.names.reserve(results.size());
+	columns.references.reserve(results.size());
+	columns.hits.reserve(results.size());
+	columns.scores.reserve(results.size());
+	columns.expected_scores.reserve(results.size());
+	columns.pvalues.reserve(results.size());
+	columns.enriched.reserve(results.size());
+
+	bool has_members = false;
+	for(const auto& ele : results) {
+		const auto& result = *ele.second;
+		columns.names.push_back(result.category->name());
+		columns.references.push_back(result.category->reference());
+		columns.hits.push_back(result.hits);
+		columns.scores.push_back(result.score);
+		columns.expected_scores.push_back(result.expected_score);
+		// P-values below the smallest double are flushed to zero
+		columns.pvalues.push_back(result.pvalue.convert_to<double>());
+		columns.enriched.push_back(result.enriched ? 1 : 0);
+		has_members = has_members || !result.info.empty();
+	}
 
-	size_t size = 0;
-	for(auto& results_it : all_results) {
-		size += results_it.second.size();
+	if(has_members) {
+		columns.members.reserve(results.size());
+		for(const auto& ele : results) {
+			columns.members.push_back(ele.second->info);
+		}
 	}
 
+	BinaryEnrichmentResults::write(columns, path);
+}
+
+static void writeFiles(const std::string& output_dir, const AllResults& all_results, const bool justScores, const bool justPvalues, const bool binary)
+{
 	for(const auto& database : all_results) {
+		if(binary) {
+			writeBinaryResults(output_dir + "/" + database.first + ".bin", database.second);
+			continue;
+		}
+
 		std::ofstream output(output_dir + "/" + database.first + ".txt");
 		if(database.second.begin() == database.second.end()) {
 			output.close();
@@ -136,15 +175,24 @@ static void writeFiles(const std::string& output_dir, const AllResults& all_resu
 		if(!output) {
 			throw GeneTrail::IOError("No input file specified.");
 		}
-		output << database.second.begin()->second->header(justScores, justPvalues) << std::endl;
-		for(const auto& ele : database.second) {
-			ele.second->serialize(output, justScores, justPvalues);
-			output << std::endl;
-		}
+		writeResults(output, database.second, justScores, justPvalues);
 		output.close();
 	}
 }
 
+void writeResults(std::ostream& output, const Results& results, const bool justScores, const bool justPvalues)
+{
+	if(results.empty()) {
+		return;
+	}
+
+	output << results.begin()->second->header(justScores, justPvalues) << '\n';
+	for(const auto& ele : results) {
+		ele.second->serialize(output, justScores, justPvalues);
+		output << '\n';
+	}
+}
+
 int initTestSet(GeneSet& test_set, const Params& p){
 	try {
 		readTestSet(test_set, p);
@@ -195,12 +243,12 @@ static void updatePValues(AllResults& results, const PValueList& pvalues)
 }
 
 static void computeOne(AllResults& name_to_cat_results, Scores& test_set,
-					   const CategoryDatabase& category_db,
+					   const CategoryDatabase& category_db, const std::string& name,
 					   EnrichmentAlgorithmPtr& algorithm, const Params& p)
 {
 	Results name_to_result;
 	for(const auto& c : category_db) {
-		if(p.verbose) std::cout << "INFO: Processing - " << category_db.name() << " - " << c.name() << std::endl;
+		if(p.verbose) std::cout << "INFO: Processing - " << name << " - " << c.name() << std::endl;
 		auto processed = processCategory(c, test_set, p);
 
 		std::shared_ptr<EnrichmentResult> result;
@@ -222,8 +270,8 @@ static void computeOne(AllResults& name_to_cat_results, Scores& test_set,
 
 		name_to_result.emplace(c.name(), std::move(result));
 	}
-	//std::cerr << "[" << category_db.name() << "]";
-	name_to_cat_results.emplace(category_db.name(), std::move(name_to_result));
+	//std::cerr << "[" << name << "]";
+	name_to_cat_results.emplace(name, std::move(name_to_result));
 }
 
 static AllResults compute(Scores& test_set, const CategoryList& cat_list,
@@ -232,17 +280,9 @@ static AllResults compute(Scores& test_set, const CategoryList& cat_list,
 	AllResults name_to_cat_results;
 	for(const auto& cat : cat_list) {
 		try {
-			GMTFile input(test_set.db(), cat.second);
-			if(!input) {
-				std::cerr << "WARNING: Could not open database " + cat.first +
-									" for reading! Skipping database."
-							<< std::endl;
-				continue;
-			}
-
-			auto category_db = input.read();
+			auto category_db = readCategoryDatabase(test_set.db(), cat.second);
 			category_db.setName(cat.first);
-			computeOne(name_to_cat_results, test_set, category_db, algorithm, p);
+			computeOne(name_to_cat_results, test_set, category_db, cat.first, algorithm, p);
 		} catch(IOError& exn) {
 			std::cerr << "WARNING: Could not process category file "
 				<< cat.first << "! " << exn.what() << std::endl;
@@ -257,12 +297,23 @@ static AllResults compute(Scores& test_set, const CategoryDBList& category_db,
 {
 	AllResults name_to_cat_results;
 	for(const auto& db : category_db) {
-		computeOne(name_to_cat_results, test_set, db, algorithm, p);
+		computeOne(name_to_cat_results, test_set, db, db.name(), algorithm, p);
 	}
 	
 	return name_to_cat_results;
 }
 
+static AllResults compute(Scores& test_set, const CategoryDBPtrList& category_db,
+						  EnrichmentAlgorithmPtr& algorithm, const Params& p)
+{
+	AllResults name_to_cat_results;
+	for(const auto& db : category_db) {
+		computeOne(name_to_cat_results, test_set, *db.second, db.first, algorithm, p);
+	}
+
+	return name_to_cat_results;
+}
+
 static void adjustCombined(AllResults& all_results, MultipleTestingCorrection correction)
 {
 	auto results = resultVector(all_results);
@@ -412,17 +463,8 @@ static void computePValues(EnrichmentAlgorithmPtr& algorithm,
         }
 }
 
-template <typename Categories>
-void run(Scores& test_set, const Categories& cat_list,
-         EnrichmentAlgorithmPtr& algorithm, const Params& p, bool computePValue)
+static void adjustPValues(AllResults& name_to_cat_results, const Params& p)
 {
-        test_set.sortByIndex();
-
-        AllResults name_to_cat_results(compute(test_set, cat_list, algorithm, p));
-        if(computePValue && !algorithm->pValuesComputed()) {
-                computePValues(algorithm, name_to_cat_results, test_set, p);
-        }
-
         if(p.adjustment && boost::get(p.adjustment) != MultipleTestingCorrection::GSEA) {
                 // Checks how they should be adjusted
                 if(p.adjustSeparately) {
@@ -431,8 +473,196 @@ void run(Scores& test_set, const Categories& cat_list,
                         adjustCombined(name_to_cat_results, p.adjustment.get());
                 }
         }
+}
 
-        writeFiles(p.out(), name_to_cat_results, p.justScores, p.justPvalues);
+template <typename Categories>
+AllResults computeEnrichments(Scores& test_set, const Categories& cat_list,
+                              EnrichmentAlgorithmPtr& algorithm, const Params& p,
+                              bool computePValue)
+{
+        test_set.sortByIndex();
+
+        AllResults name_to_cat_results(compute(test_set, cat_list, algorithm, p));
+        if(computePValue && !algorithm->pValuesComputed()) {
+                computePValues(algorithm, name_to_cat_results, test_set, p);
+        }
+
+        adjustPValues(name_to_cat_results, p);
+
+        return name_to_cat_results;
+}
+
+static double oraPValue(const OverRepresentationAnalysis& test, size_t l,
+                        size_t k, NullHypothesis hypothesis,
+                        const OraPValueCache* p_values)
+{
+	if(p_values != nullptr) {
+		return p_values->pValue(test, hypothesis, l, k);
+	}
+
+	switch(hypothesis) {
+		case UPPER_TAILED:
+			return test.computeUpperTailedPValue(l, k);
+		case LOWER_TAILED:
+			return test.computeLowerTailedPValue(l, k);
+		case TWO_SIDED:
+		default:
+			return test.computePValue(l, k);
+	}
+}
+
+static std::string joinNames(const std::vector<size_t>& ids,
+                             const EntityDatabase& db)
+{
+	std::vector<std::string> names;
+	names.reserve(ids.size());
+	for(size_t id : ids) {
+		names.push_back(db.name(id));
+	}
+
+	std::sort(names.begin(), names.end());
+
+	return boost::join(names, ",");
+}
+
+std::shared_ptr<Category> IndexedCategoryDatabase::category(size_t i) const
+{
+	if(!binary) {
+		return std::make_shared<Category>(categories[i]);
+	}
+
+	std::vector<size_t> members;
+	members.reserve(binary->end(i) - binary->begin(i));
+	for(auto it = binary->begin(i); it != binary->end(i); ++it) {
+		members.push_back(entity_ids[*it]);
+	}
+
+	auto c = std::make_shared<Category>(categories.entityDatabase().get(),
+	                                    members.begin(), members.end());
+	c->setName(binary->name(i));
+	c->setReference(binary->reference(i));
+	return c;
+}
+
+AllResults computeOraEnrichments(const Category& test_set,
+                                 const IndexedCategoryDBList& databases,
+                                 NullHypothesis hypothesis, const Params& p,
+                                 const OraPValueCache* p_values)
+{
+	AllResults name_to_cat_results;
+	for(const auto& db : databases) {
+		const auto& l = db.ora.referenceHits();
+		const auto members = db.ora.testMembers(test_set);
+		const auto test = db.ora.test(test_set);
+
+		Results name_to_result;
+		for(size_t i = 0; i < db.size(); ++i) {
+			const size_t k = members[i].size();
+			const bool isValid = p.minimum <= k && k <= p.maximum;
+
+			if(!isValid && !p.includeAll) {
+				continue;
+			}
+
+			auto c = db.category(i);
+			auto result = std::make_shared<EnrichmentResult>(c);
+			if(isValid) {
+				result->score = k;
+				result->expected_score = test.expectedNumberOfHits(l[i]);
+				result->enriched = result->score > result->expected_score;
+				result->pvalue = oraPValue(test, l[i], k, hypothesis, p_values);
+			}
+
+			result->hits = k;
+			result->info = joinNames(members[i], *c->entityDatabase());
+
+			name_to_result.emplace(c->name(), std::move(result));
+		}
+		name_to_cat_results.emplace(db.name, std::move(name_to_result));
+	}
+
+	adjustPValues(name_to_cat_results, p);
+
+	return name_to_cat_results;
+}
+
+void runOra(const Category& test_set, const IndexedCategoryDBList& databases,
+            NullHypothesis hypothesis, const Params& p,
+            const OraPValueCache* p_values)
+{
+	writeFiles(p.out(),
+	           computeOraEnrichments(test_set, databases, hypothesis, p,
+	                                 p_values),
+	           p.justScores, p.justPvalues, p.binaryOutput);
+}
+
+std::map<std::string, SampleEnrichments>
+computeSampleEnrichments(const DenseMatrix& samples,
+                         const CategoryDBPtrList& databases,
+                         const std::shared_ptr<EntityDatabase>& db,
+                         const EnrichmentAlgorithmFactory& factory,
+                         const Params& p, size_t num_threads)
+{
+	// Registering identifiers modifies the entity database, so this must
+	// not happen while the samples are processed.
+	std::vector<size_t> ids(samples.rows());
+	for(size_t i = 0; i < ids.size(); ++i) {
+		ids[i] = db->index(samples.rowName(i));
+	}
+
+	std::map<std::string, SampleEnrichments> result;
+	for(const auto& database : databases) {
+		std::vector<std::string> names;
+		names.reserve(database.second->size());
+		for(const auto& c : *database.second) {
+			names.push_back(c.name());
+		}
+
+		SampleEnrichments enrichments{DenseMatrix(names, samples.colNames()),
+		                              DenseMatrix(names, samples.colNames())};
+		enrichments.scores.matrix().setConstant(
+		    std::numeric_limits<double>::quiet_NaN());
+		enrichments.pvalues.matrix().setConstant(
+		    std::numeric_limits<double>::quiet_NaN());
+
+		result.emplace(database.first, std::move(enrichments));
+	}
+
+	parallel_for(0, samples.cols(), [&](size_t j) {
+		std::vector<Score> data;
+		data.reserve(ids.size());
+		for(size_t i = 0; i < ids.size(); ++i) {
+			const double value = samples(i, j);
+			if(!std::isnan(value)) {
+				data.emplace_back(ids[i], value);
+			}
+		}
+
+		Scores scores(std::move(data), db);
+		auto algorithm = factory(scores);
+		const AllResults all_results =
+		    computeEnrichments(scores, databases, algorithm, p, true);
+
+		// Every thread writes its own column only
+		for(const auto& database : all_results) {
+			auto& enrichments = result.find(database.first)->second;
+			for(const auto& entry : database.second) {
+				const auto i = enrichments.scores.rowIndex(entry.first);
+				enrichments.scores(i, j) = entry.second->score;
+				enrichments.pvalues(i, j) =
+				    entry.second->pvalue.convert_to<double>();
+			}
+		}
+	}, num_threads);
+
+	return result;
+}
+
+template <typename Categories>
+void run(Scores& test_set, const Categories& cat_list,
+         EnrichmentAlgorithmPtr& algorithm, const Params& p, bool computePValue)
+{
+        writeFiles(p.out(), computeEnrichments(test_set, cat_list, algorithm, p, computePValue), p.justScores, p.justPvalues, p.binaryOutput);
 }
 
 template
@@ -442,3 +672,15 @@ void run(Scores& test_set, const CategoryList& cat_list,
 template
 void run(Scores& test_set, const CategoryDBList& cat_list,
          EnrichmentAlgorithmPtr& algorithm, const Params& p, bool computePValue);
+
+template
+AllResults computeEnrichments(Scores& test_set, const CategoryList& cat_list,
+                              EnrichmentAlgorithmPtr& algorithm, const Params& p, bool computePValue);
+
+template
+AllResults computeEnrichments(Scores& test_set, const CategoryDBList& cat_list,
+                              EnrichmentAlgorithmPtr& algorithm, const Params& p, bool computePValue);
+
+template
+AllResults computeEnrichments(Scores& test_set, const CategoryDBPtrList& cat_list,
+                              EnrichmentAlgorithmPtr& algorithm, const Params& p, bool computePValue);
@@ -24,14 +24,19 @@
 #include "CommandLineInterface.h"
 #include "EnrichmentAlgorithm.h"
 
+#include <genetrail2/core/BatchOverRepresentationAnalysis.h>
+#include <genetrail2/core/BinaryCategoryDatabase.h>
 #include <genetrail2/core/MatrixHTest.h>
 #include <genetrail2/core/CategoryDatabase.h>
+#include <genetrail2/core/DenseMatrix.h>
 #include <genetrail2/core/macros.h>
 #include <genetrail2/core/PValue.h>
 
 #include <boost/program_options.hpp>
 
+#include <functional>
 #include <list>
+#include <map>
 #include <utility>
 #include <string>
 #include <memory>
@@ -59,6 +64,53 @@ typedef std::vector<std::pair<std::string, double>> PValueList;
 
 using CategoryList = std::list<std::pair<std::string, std::string>>;
 using CategoryDBList = std::vector<CategoryDatabase>;
+using NamedCategoryDatabase = std::pair<std::string, std::shared_ptr<const CategoryDatabase>>;
+using CategoryDBPtrList = std::vector<NamedCategoryDatabase>;
+
+/**
+ * A category database prepared for running many ORAs against the same
+ * reference set.
+ */
+struct GT2_EXPORT IndexedCategoryDatabase
+{
+	IndexedCategoryDatabase(std::string name, CategoryDatabase db,
+	                        const Category& reference_set)
+	    : name(std::move(name)),
+	      categories(std::move(db)),
+	      ora(categories, reference_set)
+	{
+	}
+
+	/**
+	 * Indexes a binary category database without converting it into a
+	 * CategoryDatabase. Categories are only created for the results.
+	 */
+	IndexedCategoryDatabase(std::string name,
+	                        std::shared_ptr<const BinaryCategoryDatabase> db,
+	                        const std::shared_ptr<EntityDatabase>& entities,
+	                        const Category& reference_set)
+	    : name(std::move(name)),
+	      categories(entities),
+	      binary(std::move(db)),
+	      entity_ids(binary->entityIds(*entities)),
+	      ora(*binary, entity_ids, reference_set)
+	{
+	}
+
+	size_t size() const { return ora.size(); }
+
+	/// Creates the i-th category
+	std::shared_ptr<Category> category(size_t i) const;
+
+	std::string name;
+	// Empty if the categories are read from binary
+	CategoryDatabase categories;
+	std::shared_ptr<const BinaryCategoryDatabase> binary;
+	std::vector<size_t> entity_ids;
+	BatchOverRepresentationAnalysis ora;
+};
+
+using IndexedCategoryDBList = std::vector<IndexedCategoryDatabase>;
 
 /**
  * This function initializes the needed attributes.
@@ -84,4 +136,80 @@ GT2_EXPORT int initCategories(CategoryList& cat_list, const Params& p);
 template <typename Categories>
 GT2_EXPORT void run(Scores& test_set, const Categories& cat_list, EnrichmentAlgorithmPtr& algorithm, const Params& p, bool computePValues);
 
+/**
+ * This function runs the pipeline without writing the results.
+ *
+ * @param test_set Test set for which the computation should be started
+ * @param cat_list List of categories for the computation
+ * @param p
+ * @return The (adjusted) results for every category database
+ */
+template <typename Categories>
+GT2_EXPORT AllResults computeEnrichments(Scores& test_set, const Categories& cat_list, EnrichmentAlgorithmPtr& algorithm, const Params& p, bool computePValues);
+
+/**
+ * Computes an ORA for the test set with the categories of every database.
+ * The results are the same as for computeEnrichments with an Ora algorithm,
+ * but the hits of all categories are obtained in a single pass over the
+ * test set.
+ *
+ * @param test_set Test set for which the computation should be started
+ * @param databases Category databases indexed for the reference set
+ * @param hypothesis Null hypothesis used for the p-values
+ * @param p
+ * @param p_values If not null, p-values are looked up in this cache
+ * @return The (adjusted) results for every category database
+ */
+GT2_EXPORT AllResults computeOraEnrichments(const Category& test_set, const IndexedCategoryDBList& databases, NullHypothesis hypothesis, const Params& p, const OraPValueCache* p_values = nullptr);
+
+/**
+ * Runs computeOraEnrichments and writes the results.
+ */
+GT2_EXPORT void runOra(const Category& test_set, const IndexedCategoryDBList& databases, NullHypothesis hypothesis, const Params& p, const OraPValueCache* p_values = nullptr);
+
+/**
+ * Scores and p-values of every category of a database for every sample.
+ * Rows correspond to categories, columns to samples. Categories that were
+ * not tested for a sample are NaN.
+ */
+struct GT2_EXPORT SampleEnrichments
+{
+	DenseMatrix scores;
+	DenseMatrix pvalues;
+};
+
+/**
+ * Creates the enrichment algorithm for the scores of a single sample. The
+ * scores may be modified, e.g. sorted, before they are used.
+ */
+using EnrichmentAlgorithmFactory = std::function<EnrichmentAlgorithmPtr(Scores&)>;
+
+/**
+ * Computes an enrichment for every column of a gene x sample matrix.
+ *
+ * The identifiers of the genes are registered in db once, before any
+ * sample is processed, and the category databases are shared by all
+ * samples. The samples are processed in parallel. Every sample is
+ * evaluated as by computeEnrichments, with the scores of its column
+ * (missing values are skipped) and an algorithm created by the factory.
+ * The algorithm, and with it any index over the sorted scores such as
+ * the gene positions of weighted GSEA, is built per sample, as the order
+ * of the genes differs between the columns.
+ *
+ * @param samples Gene x sample matrix of scores
+ * @param databases Category databases to be tested
+ * @param db The entity database used by the category databases
+ * @param factory Creates the algorithm for a single sample
+ * @param p
+ * @param num_threads The number of threads, 0 selects the number of
+ *                    hardware threads
+ * @return The results for every category database
+ */
+GT2_EXPORT std::map<std::string, SampleEnrichments> computeSampleEnrichments(const DenseMatrix& samples, const CategoryDBPtrList& databases, const std::shared_ptr<EntityDatabase>& db, const EnrichmentAlgorithmFactory& factory, const Params& p, size_t num_threads = 0);
+
+/**
+ * Writes the results for one category database as tab separated table.
+ */
+GT2_EXPORT void writeResults(std::ostream& output, const Results& results, const bool justScores, const bool justPvalues);
+
 #endif // GT2_APPLICATIONS_ENRICHMENT_COMMON_H
@@ -0,0 +1,252 @@
+#include "BinaryRegulationNetwork.h"
+
+#include <genetrail2/core/Exception.h>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace GeneTrail
+{
+	namespace
+	{
+		const char MAGIC[8] = {'G', 'T', '2', 'R', 'N', 'E', 'T', '\0'};
+		const uint32_t VERSION = 2;
+
+		uint64_t align(uint64_t offset) { return (offset + 7) & ~uint64_t(7); }
+
+		template <typename T>
+		void writeSection(std::ofstream& out, uint64_t offset,
+		                  const std::vector<T>& data)
+		{
+			static const char zeros[8] = {};
+			const uint64_t pos = static_cast<uint64_t>(out.tellp());
+			out.write(zeros, offset - pos);
+			out.write(reinterpret_cast<const char*>(data.data()),
+			          data.size() * sizeof(T));
+		}
+
+		/**
+		 * Computes the CSR offsets for the given keys and the position of
+		 * every element in the CSR arrays. The order of elements with the
+		 * same key is preserved.
+		 */
+		void countingSort(const std::vector<uint32_t>& keys, size_t number_of_keys,
+		                  std::vector<uint64_t>& offsets,
+		                  std::vector<uint32_t>& positions)
+		{
+			offsets.assign(number_of_keys + 1, 0);
+			for(uint32_t k : keys) {
+				++offsets[k + 1];
+			}
+
+			for(size_t i = 0; i < number_of_keys; ++i) {
+				offsets[i + 1] += offsets[i];
+			}
+
+			std::vector<uint64_t> next(offsets.begin(), offsets.end() - 1);
+			positions.resize(keys.size());
+			for(size_t i = 0; i < keys.size(); ++i) {
+				positions[i] = static_cast<uint32_t>(next[keys[i]]++);
+			}
+		}
+
+		bool isMonotonic(const uint64_t* offsets, uint64_t size)
+		{
+			return offsets[0] == 0 &&
+			       std::is_sorted(offsets, offsets + size + 1);
+		}
+
+		bool isBounded(const uint32_t* data, uint64_t size, uint64_t bound)
+		{
+			return std::all_of(data, data + size,
+			                   [bound](uint32_t x) { return x < bound; });
+		}
+	}
+
+	BinaryRegulationNetwork::BinaryRegulationNetwork(const std::string& file)
+	{
+		try {
+			file_.open(file);
+		} catch(const std::exception&) {
+			throw IOError("File (" + file + ") is not open for reading");
+		}
+
+		if(file_.size() < sizeof(Header)) {
+			throw IOError("File (" + file + ") is not a binary regulation network");
+		}
+
+		header_ = reinterpret_cast<const Header*>(file_.data());
+		if(std::memcmp(header_->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+		   header_->version != VERSION) {
+			throw IOError("File (" + file + ") is not a binary regulation network");
+		}
+
+		const uint64_t n = header_->number_of_names;
+		const uint64_t m = header_->number_of_edges;
+
+		name_offsets_ = section_<uint64_t>(header_->name_offsets, n + 1);
+		name_data_ = section_<char>(header_->name_data, name_offsets_[n]);
+		regulator_offsets_ = section_<uint64_t>(header_->regulator_offsets, n + 1);
+		targets_ = section_<uint32_t>(header_->targets, m);
+		values_ = section_<double>(header_->values, m);
+		target_offsets_ = section_<uint64_t>(header_->target_offsets, n + 1);
+		regulators_ = section_<uint32_t>(header_->regulators, m);
+		edges_ = section_<uint32_t>(header_->edges, m);
+		lines_ = section_<uint32_t>(header_->lines, m);
+
+		// The sections are used as indices, so check them once here instead
+		// of on every access.
+		if(regulator_offsets_[n] != m || target_offsets_[n] != m ||
+		   !isMonotonic(name_offsets_, n) ||
+		   !isMonotonic(regulator_offsets_, n) ||
+		   !isMonotonic(target_offsets_, n) || !isBounded(targets_, m, n) ||
+		   !isBounded(regulators_, m, n) || !isBounded(edges_, m, m) ||
+		   !isBounded(lines_, m, m)) {
+			throw IOError("Binary regulation network (" + file + ") is corrupt");
+		}
+	}
+
+	template <typename T>
+	const T* BinaryRegulationNetwork::section_(uint64_t offset, uint64_t count) const
+	{
+		if(offset % alignof(T) != 0 || offset > file_.size() ||
+		   count > (file_.size() - offset) / sizeof(T)) {
+			throw IOError("Binary regulation network is corrupt");
+		}
+
+		return reinterpret_cast<const T*>(file_.data() + offset);
+	}
+
+	bool BinaryRegulationNetwork::isBinaryNetwork(const std::string& file)
+	{
+		std::ifstream input(file, std::ios::binary);
+		char magic[sizeof(MAGIC)];
+		return input.read(magic, sizeof(magic)) &&
+		       std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+	}
+
+	void BinaryRegulationNetwork::convert(const std::string& text_file,
+	                                      const std::string& binary_file)
+	{
+		std::ifstream input(text_file);
+		if(!input) {
+			throw IOError("File (" + text_file + ") is not open for reading");
+		}
+
+		std::unordered_map<std::string, uint32_t> name_to_id;
+		std::vector<std::string> names;
+		auto intern = [&](const std::string& name) {
+			auto res = name_to_id.emplace(name, static_cast<uint32_t>(names.size()));
+			if(res.second) {
+				if(names.size() == std::numeric_limits<uint32_t>::max()) {
+					throw IOError("Too many names for a binary regulation network");
+				}
+				names.push_back(name);
+			}
+			return res.first->second;
+		};
+
+		std::vector<uint32_t> regulators, targets;
+		std::vector<double> values;
+
+		std::vector<std::string> sline;
+		for(std::string line; getline(input, line);) {
+			boost::trim_if(line, boost::is_any_of("\t "));
+			boost::split(sline, line, boost::is_any_of(" \t"), boost::token_compress_on);
+			if(sline.size() != 2 && sline.size() != 3) {
+				throw IOError("Wrong file format.");
+			}
+
+			if(regulators.size() == std::numeric_limits<uint32_t>::max()) {
+				throw IOError("Too many edges for a binary regulation network");
+			}
+
+			regulators.push_back(intern(sline[0]));
+			targets.push_back(intern(sline[1]));
+			values.push_back(sline.size() == 3
+			                     ? boost::lexical_cast<double>(sline[2])
+			                     : std::numeric_limits<double>::quiet_NaN());
+		}
+
+		const size_t n = names.size();
+		const size_t m = regulators.size();
+
+		Header header;
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+		header.version = VERSION;
+		header.number_of_names = n;
+		header.number_of_edges = m;
+
+		std::vector<uint64_t> name_offsets(n + 1, 0);
+		for(size_t i = 0; i < n; ++i) {
+			name_offsets[i + 1] = name_offsets[i] + names[i].size();
+		}
+		std::vector<char> name_data;
+		name_data.reserve(name_offsets[n]);
+		for(const auto& name : names) {
+			name_data.insert(name_data.end(), name.begin(), name.end());
+		}
+
+		// Edges grouped by regulator
+		std::vector<uint64_t> regulator_offsets;
+		std::vector<uint32_t> edge_of_line;
+		countingSort(regulators, n, regulator_offsets, edge_of_line);
+
+		std::vector<uint32_t> csr_targets(m), csr_lines(m);
+		std::vector<double> csr_values(m);
+		for(size_t i = 0; i < m; ++i) {
+			csr_targets[edge_of_line[i]] = targets[i];
+			csr_values[edge_of_line[i]] = values[i];
+			csr_lines[edge_of_line[i]] = static_cast<uint32_t>(i);
+		}
+
+		// Edges grouped by target, referring to the edges above
+		std::vector<uint64_t> target_offsets;
+		std::vector<uint32_t> position_of_line;
+		countingSort(targets, n, target_offsets, position_of_line);
+
+		std::vector<uint32_t> csr_regulators(m), csr_edges(m);
+		for(size_t i = 0; i < m; ++i) {
+			csr_regulators[position_of_line[i]] = regulators[i];
+			csr_edges[position_of_line[i]] = edge_of_line[i];
+		}
+
+		header.name_offsets = align(sizeof(Header));
+		header.name_data = align(header.name_offsets + name_offsets.size() * sizeof(uint64_t));
+		header.regulator_offsets = align(header.name_data + name_data.size());
+		header.targets = align(header.regulator_offsets + regulator_offsets.size() * sizeof(uint64_t));
+		header.values = align(header.targets + m * sizeof(uint32_t));
+		header.target_offsets = align(header.values + m * sizeof(double));
+		header.regulators = align(header.target_offsets + target_offsets.size() * sizeof(uint64_t));
+		header.edges = align(header.regulators + m * sizeof(uint32_t));
+		header.lines = align(header.edges + m * sizeof(uint32_t));
+
+		std::ofstream out(binary_file, std::ios::binary);
+		if(!out) {
+			throw IOError("File (" + binary_file + ") is not open for writing");
+		}
+
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		writeSection(out, header.name_offsets, name_offsets);
+		writeSection(out, header.name_data, name_data);
+		writeSection(out, header.regulator_offsets, regulator_offsets);
+		writeSection(out, header.targets, csr_targets);
+		writeSection(out, header.values, csr_values);
+		writeSection(out, header.target_offsets, target_offsets);
+		writeSection(out, header.regulators, csr_regulators);
+		writeSection(out, header.edges, csr_edges);
+		writeSection(out, header.lines, csr_lines);
+
+		if(!out) {
+			throw IOError("Could not write binary regulation network (" + binary_file + ")");
+		}
+	}
+}
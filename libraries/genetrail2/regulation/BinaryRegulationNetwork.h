@@ -0,0 +1,143 @@
+/**
+* GeneTrail2 - An efficent library for interpreting genetic data
+* Copyright (C) 2016 Tim Kehl tkehl@bioinf.uni-sb.de>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the Lesser GNU General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* Lesser GNU General Public License for more details.
+*
+* You should have received a copy of the Lesser GNU General Public
+* License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef GT2_REGULATION_BINARY_REGULATION_NETWORK_H
+#define GT2_REGULATION_BINARY_REGULATION_NETWORK_H
+
+#include <genetrail2/core/macros.h>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+namespace GeneTrail
+{
+/**
+ * A regulatory network stored in a compact binary format.
+ *
+ * Parsing large text networks is dominated by splitting lines, converting
+ * numbers and resolving names. The binary format stores every name only
+ * once and keeps the edges in compressed sparse row (CSR) layout for both
+ * directions, so that a network can be memory mapped and traversed without
+ * any parsing. Text networks can be converted using convert().
+ *
+ * Layout (all integers in host byte order, all sections 8 byte aligned):
+ *  - Header (magic, version, flags, counts and section offsets)
+ *  - Name offsets (uint64, number_of_names + 1) and name characters
+ *  - Regulator offsets (uint64, number_of_names + 1), targets (uint32),
+ *    values (double) and line numbers (uint32) of all edges grouped by
+ *    regulator
+ *  - Target offsets (uint64, number_of_names + 1), regulators (uint32) and
+ *    edge indices (uint32) of all edges grouped by target
+ *
+ * Within a regulator or target the edges keep the order of the text file.
+ * Edges without a value store NaN.
+ */
+class GT2_EXPORT BinaryRegulationNetwork
+{
+  public:
+	/**
+	 * Memory maps the given binary network.
+	 *
+	 * @throws IOError if the file cannot be opened or is not a valid network.
+	 */
+	explicit BinaryRegulationNetwork(const std::string& file);
+
+	/**
+	 * Checks whether the file starts with the magic number of the binary
+	 * network format.
+	 */
+	static bool isBinaryNetwork(const std::string& file);
+
+	/**
+	 * Converts a whitespace separated network (regulator, target and an
+	 * optional value per line) into the binary format.
+	 *
+	 * @throws IOError if a file cannot be opened or a line is malformed.
+	 */
+	static void convert(const std::string& text_file, const std::string& binary_file);
+
+	size_t numberOfNames() const { return header_->number_of_names; }
+	size_t numberOfEdges() const { return header_->number_of_edges; }
+
+	std::string name(size_t i) const
+	{
+		return std::string(name_data_ + name_offsets_[i], name_offsets_[i + 1] - name_offsets_[i]);
+	}
+
+	/// Edges of regulator r are [regulatorBegin(r), regulatorEnd(r))
+	size_t regulatorBegin(size_t r) const { return regulator_offsets_[r]; }
+	size_t regulatorEnd(size_t r) const { return regulator_offsets_[r + 1]; }
+	size_t target(size_t edge) const { return targets_[edge]; }
+	/// Zero based line of the edge in the text file
+	size_t line(size_t edge) const { return lines_[edge]; }
+
+	/// Positions of the edges of target t are [targetBegin(t), targetEnd(t))
+	size_t targetBegin(size_t t) const { return target_offsets_[t]; }
+	size_t targetEnd(size_t t) const { return target_offsets_[t + 1]; }
+	size_t regulator(size_t pos) const { return regulators_[pos]; }
+	size_t edge(size_t pos) const { return edges_[pos]; }
+
+	double value(size_t edge, double default_value) const
+	{
+		return std::isnan(values_[edge]) ? default_value : values_[edge];
+	}
+
+	bool isRegulator(size_t i) const { return regulatorEnd(i) > regulatorBegin(i); }
+	bool isTarget(size_t i) const { return targetEnd(i) > targetBegin(i); }
+
+	struct Header
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t flags;
+		uint64_t number_of_names;
+		uint64_t number_of_edges;
+		uint64_t name_offsets;
+		uint64_t name_data;
+		uint64_t regulator_offsets;
+		uint64_t targets;
+		uint64_t values;
+		uint64_t target_offsets;
+		uint64_t regulators;
+		uint64_t edges;
+		uint64_t lines;
+	};
+
+  private:
+	template <typename T> const T* section_(uint64_t offset, uint64_t count) const;
+
+	boost::iostreams::mapped_file_source file_;
+	const Header* header_;
+	const uint64_t* name_offsets_;
+	const char* name_data_;
+	const uint64_t* regulator_offsets_;
+	const uint32_t* targets_;
+	const double* values_;
+	const uint64_t* target_offsets_;
+	const uint32_t* regulators_;
+	const uint32_t* edges_;
+	const uint32_t* lines_;
+};
+}
+
+#endif // GT2_REGULATION_BINARY_REGULATION_NETWORK_H
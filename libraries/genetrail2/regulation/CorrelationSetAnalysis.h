@@ -31,14 +31,20 @@
 #include <genetrail2/core/macros.h>
 #include <genetrail2/core/MatrixIterator.h>
 #include <genetrail2/core/NameDatabases.h>
+#include <genetrail2/core/Parallel.h>
 #include <genetrail2/core/Statistic.h>
 
 #include <genetrail2/regulation/RegulationFile.h>
+#include <genetrail2/regulation/RegulatorAssociationScore.h>
 #include <genetrail2/regulation/RegulatorEffectResult.h>
 #include <genetrail2/regulation/RegulatoryImpactFactors.h>
 
+#include <Eigen/Core>
+
 #include <algorithm>
 #include <cmath>
+#include <iostream>
+#include <numeric>
 #include <string>
 #include <vector>
 #include <tuple>
@@ -48,6 +54,19 @@
 
 namespace GeneTrail
 {
+/**
+ * Correlation set analysis (CSA)
+ *
+ * The score of a regulator is the mean correlation between all pairs of its
+ * targets. P-values are computed by comparing the score to the mean
+ * correlation of random sets of genes of the same size.
+ *
+ * Only the correlations between targets of the same regulator and between
+ * the genes of the random sets are computed. For Pearson and Spearman
+ * correlation the rows of the matrix are standardized once, so that the
+ * correlations of a set of genes are obtained by a single matrix product.
+ * Other correlation coefficients are evaluated pairwise.
+ */
 template<typename ValueType>
 class GT2_EXPORT CorrelationSetAnalysis
 {
@@ -60,34 +79,51 @@ class GT2_EXPORT CorrelationSetAnalysis
 							std::vector<size_t>& sorted_targets,
 							RegulationFile<value_type>& regulationFile)
 	    : matrix_(matrix),
-		  correlations_(matrix->rows(), matrix->rows()),
 		  name_database_(name_database),
 		  sorted_targets_(sorted_targets),
 	      regulationFile_(regulationFile),
 		  regulators_(regulationFile.regulators()),
-		  max_regulator_(*std::max_element(regulators_.begin(), regulators_.end()))
+		  max_regulator_(*std::max_element(regulators_.begin(), regulators_.end())),
+		  num_threads_(0)
 	{
 		results_.resize(max_regulator_ + 1);
 		init_();
 	}
 
+	/**
+	 * Set the number of threads. 0 uses all available cores.
+	 */
+	void setNumberOfThreads(size_t num_threads) { num_threads_ = num_threads; }
+
 	template <typename CorrelationCoefficinent> 
 	std::vector<RegulatorEffectResult> run(CorrelationCoefficinent func, size_t seed, size_t runs, bool upper_tailed, bool abs_correlation)
 	{
-		std::cout << "INFO: Calculating correlations" << std::endl;
-		create_correlations(func, abs_correlation);
+		std::cout << "INFO: Preparing expression data" << std::endl;
+		standardized_ = prepare_(func);
 
 		std::cout << "INFO: Calculating scores" << std::endl;
-		for(size_t regulator : regulators_) {
-			compute_score_(regulator);
-		}
+		parallel_for(0, regulators_.size(), [&](size_t i) {
+			compute_score_(func, regulators_[i], abs_correlation);
+		}, num_threads_);
 
 		std::cout << "INFO: Calculating p-values" << std::endl;
-		std::mt19937 twister(seed);
-		std::uniform_int_distribution<int> distribution(0, matrix_->rows()-1);
-		for(size_t i=0; i<runs; ++i){
-			std::cout << "INFO: Performing permutation " << i << std::endl;
-			perform_permutation_(twister, distribution, upper_tailed);
+		// Every permutation uses its own random number generator, so
+		// that the results do not depend on the number of threads.
+		std::vector<std::vector<double>> means(runs);
+		parallel_for(0, runs, [&](size_t i) {
+			std::mt19937 twister(seed + i);
+			means[i] = perform_permutation_(func, twister, abs_correlation);
+		}, num_threads_);
+
+		for(const auto& mean : means) {
+			for(size_t k = 0; k < number_of_targets_.size(); ++k) {
+				for(size_t regulator : number_of_targets_to_regulator_[number_of_targets_[k]]) {
+					if(upper_tailed ? mean[k] >= results_[regulator].score
+					                : mean[k] <= results_[regulator].score) {
+						results_[regulator].number_of_extremer_scores += 1;
+					}
+				}
+			}
 		}
 
 		std::vector<RegulatorEffectResult> results;
@@ -96,51 +132,152 @@ class GT2_EXPORT CorrelationSetAnalysis
 			results_[regulator].p_value = ((double)(results_[regulator].number_of_extremer_scores + 1)) / ((double)runs);
 			results.emplace_back(results_[regulator]);
 		}
-		return results_;
+		return results;
 	}
 
   private:
+	using RowMajorMatrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
 	void init_() {
 		std::set<size_t> number_of_targets;
+		targets_.resize(max_regulator_ + 1);
 		for(size_t regulator : regulators_) {
-			number_of_targets.emplace(regulationFile_.regulator2regulations(regulator).size());
+			for(const auto& regulation : regulationFile_.regulator2regulations(regulator)) {
+				targets_[regulator].push_back(std::get<1>(regulation));
+			}
+			number_of_targets.emplace(targets_[regulator].size());
 		}
 		std::copy(number_of_targets.begin(), number_of_targets.end(), std::back_inserter(number_of_targets_));
-		std::sort(number_of_targets_.begin(), number_of_targets_.end());
-		max_number_of_targets_ = *std::max_element(number_of_targets_.begin(), number_of_targets_.end());
+		max_number_of_targets_ = number_of_targets_.back();
 		number_of_targets_to_regulator_.resize(max_number_of_targets_ + 1);
 		for(size_t regulator : regulators_) {
-			number_of_targets_to_regulator_[regulationFile_.regulator2regulations(regulator).size()].emplace_back(regulator);
+			number_of_targets_to_regulator_[targets_[regulator].size()].emplace_back(regulator);
 		}
 	}
 
+	/**
+	 * Copies the expression values into a row-major matrix, so that the
+	 * values of a gene are stored contiguously. Returns true if the rows
+	 * have been standardized.
+	 */
+	template <typename CorrelationCoefficient>
+	bool prepare_(const CorrelationCoefficient&) {
+		data_ = matrix_->matrix();
+		return false;
+	}
+
+	bool prepare_(const PearsonCorrelation&) {
+		data_ = matrix_->matrix();
+		standardize_();
+		return true;
+	}
+
+	bool prepare_(const SpearmanCorrelation&) {
+		data_ = matrix_->matrix();
+		parallel_for(0, data_.rows(), [this](size_t i) {
+			auto row = data_.row(i);
+			std::vector<size_t> order(row.size());
+			std::iota(order.begin(), order.end(), size_t(0));
+			std::sort(order.begin(), order.end(), [&row](size_t a, size_t b) { return row(a) < row(b); });
+
+			// Tied values receive their average rank
+			std::vector<double> ranks(row.size());
+			for(size_t j = 0; j < order.size();) {
+				size_t k = j + 1;
+				while(k < order.size() && row(order[k]) == row(order[j])) {
+					++k;
+				}
+				for(size_t l = j; l < k; ++l) {
+					ranks[order[l]] = 0.5 * (j + k - 1);
+				}
+				j = k;
+			}
+
+			for(size_t j = 0; j < ranks.size(); ++j) {
+				row(j) = ranks[j];
+			}
+		}, num_threads_);
+		standardize_();
+		return true;
+	}
+
+	/**
+	 * Centers the rows and scales them to unit length. Afterwards the
+	 * Pearson correlation of two rows is their dot product.
+	 *
+	 * The correlation with a constant row is undefined. Such rows are set
+	 * to zero, i.e. they are uncorrelated with all other rows, instead of
+	 * turning every correlation they take part in into NaN.
+	 */
+	void standardize_() {
+		parallel_for(0, data_.rows(), [this](size_t i) {
+			auto row = data_.row(i);
+			const double mean = row.mean();
+			row.array() -= mean;
+
+			// Centering a constant row may leave rounding errors
+			const double norm = row.norm();
+			if(norm <= 1e-12 * std::abs(mean) * std::sqrt((double)row.size())) {
+				row.setZero();
+			} else {
+				row /= norm;
+			}
+		}, num_threads_);
+	}
+
+	/**
+	 * Computes the correlations between all pairs of the given rows.
+	 */
 	template <typename CorrelationCoefficient>
-	void create_correlations(CorrelationCoefficient func, bool abs_correlation){
-		for (size_t i=0; i<matrix_->rows(); ++i) {
-			correlations_.set(i, i, 1.0);
-			for (size_t j=i+1; j<matrix_->rows(); ++j) {
-				RowMajorMatrixIterator<Matrix> regulator_it(matrix_, i),
-			    							   target_it(matrix_, j);
-				auto corr = func.compute(regulator_it->begin(), regulator_it->end(),
-			                  			 target_it->begin(), target_it->end());
-				if(abs_correlation) {
-					corr = fabs(corr);
+	void correlations_(CorrelationCoefficient& func, const std::vector<size_t>& rows, Eigen::MatrixXd& result, bool abs_correlation) const {
+		const size_t n = rows.size();
+
+		if(standardized_) {
+			RowMajorMatrix subset(n, data_.cols());
+			for(size_t i = 0; i < n; ++i) {
+				subset.row(i) = data_.row(rows[i]);
+			}
+			result.noalias() = subset * subset.transpose();
+		} else {
+			result.resize(n, n);
+			const size_t m = data_.cols();
+			for(size_t i = 0; i < n; ++i) {
+				const double* row_i = data_.row(rows[i]).data();
+				for(size_t j = i + 1; j < n; ++j) {
+					const double* row_j = data_.row(rows[j]).data();
+					result(i, j) = func.compute(row_i, row_i + m, row_j, row_j + m);
+					result(j, i) = result(i, j);
+				}
+			}
+		}
+
+		if(abs_correlation) {
+			result = result.cwiseAbs();
+		}
+
+		// A gene is perfectly correlated with itself
+		for(size_t i = 0; i < n; ++i) {
+			for(size_t j = i; j < n; ++j) {
+				if(rows[i] == rows[j]) {
+					result(i, j) = 1.0;
+					result(j, i) = 1.0;
 				}
-				correlations_.set(i, j, corr);
-				correlations_.set(j, i, corr);
 			}
 		}
 	}
 
-	void compute_score_(size_t regulator){
+	template <typename CorrelationCoefficient>
+	void compute_score_(CorrelationCoefficient& func, size_t regulator, bool abs_correlation){
+		const auto& targets = targets_[regulator];
+		const size_t size = targets.size();
+
+		Eigen::MatrixXd correlations;
+		correlations_(func, targets, correlations, abs_correlation);
+
 		value_type sum = 0.0;
-		auto regulations = regulationFile_.regulator2regulations(regulator);
-		size_t size = regulations.size();
-		for (size_t i=0; i < size; ++i){
-			for (size_t j=i+1; j < size; ++j){
-				auto t1 = std::get<1>(regulations[i]);
-				auto t2 = std::get<1>(regulations[j]);
-				sum += correlations_(t1, t2);
+		for (size_t j=1; j < size; ++j){
+			for (size_t i=0; i < j; ++i){
+				sum += correlations(i, j);
 			}
 		}
 		value_type n = (value_type)size;
@@ -153,39 +290,41 @@ class GT2_EXPORT CorrelationSetAnalysis
 		}
 	}
 
-	void perform_permutation_(std::mt19937 twister,	std::uniform_int_distribution<int> distribution, bool upper_tailed){
+	/**
+	 * Draws a random set of genes and returns the mean correlation of its
+	 * first k genes for every number of targets k in number_of_targets_.
+	 */
+	template <typename CorrelationCoefficient>
+	std::vector<double> perform_permutation_(CorrelationCoefficient& func, std::mt19937& twister, bool abs_correlation) const {
+		std::uniform_int_distribution<size_t> distribution(0, matrix_->rows()-1);
+		std::vector<size_t> regs(max_number_of_targets_);
+		for (auto& reg : regs){
+			reg = distribution(twister);
+		}
+
+		Eigen::MatrixXd correlations;
+		correlations_(func, regs, correlations, abs_correlation);
+
+		std::vector<double> means;
+		means.reserve(number_of_targets_.size());
+
 		auto next = number_of_targets_.begin();
 		double sum = 0.0;
-		std::vector<size_t> regs;
-		regs.reserve(max_number_of_targets_);
-		for (size_t i=0; i <= max_number_of_targets_; ++i){
-			regs.emplace_back(distribution(twister));
-		}
-		for (size_t i=0; i <= max_number_of_targets_; ++i){
-			for (size_t j=i+1; j <= max_number_of_targets_; ++j){
-				sum += correlations_(regs[i], regs[j]);
+		for (size_t j=0; j < regs.size(); ++j){
+			for (size_t i=0; i < j; ++i){
+				sum += correlations(i, j);
 			}
-			if(i == (*next)) {
-				double n = (double)i;
-				double mean = (2.0 / (n*(n-1.0))) * sum;
-				for (size_t regulator : number_of_targets_to_regulator_[*next]){
-					if(upper_tailed) {
-						if(mean >= results_[regulator].score) {
-							results_[regulator].number_of_extremer_scores += 1;
-						} 
-					} else{ 
-						if(mean <= results_[regulator].score) {
-							results_[regulator].number_of_extremer_scores += 1;
-						}
-					} 
-				}
+			const size_t n = j + 1;
+			if(n == (*next)) {
+				means.push_back(n == 1 ? 0.0 : (2.0 / (n*(n-1.0))) * sum);
 				++next;
 			}
 		}
+
+		return means;
 	}
 
   	DenseMatrix* matrix_;
-	DenseMatrix correlations_;
 	MatrixNameDatabase& name_database_;
 	std::vector<size_t>& sorted_targets_;
 	RegulationFile<double>& regulationFile_;
@@ -193,10 +332,15 @@ class GT2_EXPORT CorrelationSetAnalysis
 	std::vector<size_t> regulators_;
 	size_t max_regulator_;
 	std::vector<RegulatorEffectResult> results_;
+	std::vector<std::vector<size_t>> targets_;
 
 	std::vector<size_t> number_of_targets_;
 	size_t max_number_of_targets_;
 	std::vector<std::vector<size_t>> number_of_targets_to_regulator_;
+
+	RowMajorMatrix data_;
+	bool standardized_;
+	size_t num_threads_;
 };
 }
 
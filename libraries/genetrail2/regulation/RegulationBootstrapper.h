@@ -21,14 +21,13 @@
 #ifndef GT2_REGULATION_REGULATION_BOOTSTRAPPER_H
 #define GT2_REGULATION_REGULATION_BOOTSTRAPPER_H
 
-#include <genetrail2/core/DenseColumnSubset.h>
 #include <genetrail2/core/DenseMatrix.h>
-#include <genetrail2/core/Matrix.h>
-#include <genetrail2/core/MatrixIterator.h>
+#include <genetrail2/core/DenseMatrixView.h>
 #include <genetrail2/core/Statistic.h>
 
 #include <iostream>
 #include <random>
+#include <stdexcept>
 #include <vector>
 #include <tuple>
 #include <cmath>
@@ -46,8 +45,9 @@ template <typename ValueType> class GT2_EXPORT RegulationBootstrapper
 
 	RegulationBootstrapper(DenseMatrix* matrix, unsigned seed)
 	    : matrix_(matrix),
-	      bootstrap_sample_(matrix_->cols()),
-	      subset_(matrix, bootstrap_sample_.begin(), bootstrap_sample_.end()),
+	      bootstrap_sample_(columns_(matrix)),
+	      subset_(columnSubsetView(*matrix, bootstrap_sample_.begin(),
+	                               bootstrap_sample_.end())),
 	      generator_(seed),
 	      distribution_(0, matrix_->cols() - 1)
 	{
@@ -85,19 +85,22 @@ template <typename ValueType> class GT2_EXPORT RegulationBootstrapper
 								   bool sort_decreasingly,
 	                               RegulatorImpactScore score)
 	{
-		subset_.assign(bootstrap_sample_.begin(), bootstrap_sample_.end());
+		subset_.assignCols(bootstrap_sample_.begin(), bootstrap_sample_.end());
+
+		// All regulations share the target. Its row is copied once, the
+		// regulator rows are copied into a reused buffer.
+		target_.resize(subset_.cols());
+		regulator_.resize(subset_.cols());
+		subset_.gatherRow(std::get<1>(regulations[0]), target_.data());
 
-		size_t target_idx = std::get<1>(regulations[0]);
 		for(Regulation& r : regulations) {
 			size_t regulator_idx = std::get<0>(r);
 
-			RowMajorMatrixIterator<Matrix> regulator_it(&subset_,
-			                                            regulator_idx),
-			    target_it(&subset_, target_idx);
+			subset_.gatherRow(regulator_idx, regulator_.data());
 
 			value_type result =
-			    score.compute(regulator_it->begin(), regulator_it->end(),
-			                  target_it->begin(), target_it->end());
+			    score.compute(regulator_.begin(), regulator_.end(),
+			                  target_.begin(), target_.end());
 
 			if(normalize_scores) {
 				size_t tmp = rfile.regulator2regulations(regulator_idx).size();
@@ -149,9 +152,24 @@ template <typename ValueType> class GT2_EXPORT RegulationBootstrapper
 		}
 	}
 
+	/**
+	 * The number of columns of the matrix. A bootstrap sample cannot be
+	 * drawn from a matrix without columns.
+	 */
+	static size_t columns_(const DenseMatrix* matrix)
+	{
+		if(matrix->cols() == 0) {
+			throw std::invalid_argument(
+			    "Cannot bootstrap a matrix without columns");
+		}
+		return matrix->cols();
+	}
+
 	DenseMatrix* matrix_;
 	std::vector<size_t> bootstrap_sample_;
-	DenseColumnSubset subset_;
+	DenseColumnSubsetView subset_;
+	std::vector<DenseMatrix::value_type> target_;
+	std::vector<DenseMatrix::value_type> regulator_;
 	size_t samples_;
 	std::mt19937 generator_;
 	dist_type distribution_;
@@ -21,14 +21,14 @@
 #ifndef GT2_REGULATION_REGULATION_BOOTSTRAPPER_MICRO_H
 #define GT2_REGULATION_REGULATION_BOOTSTRAPPER_MICRO_H
 
-#include <genetrail2/core/DenseColumnSubset.h>
 #include <genetrail2/core/DenseMatrix.h>
-#include <genetrail2/core/Matrix.h>
-#include <genetrail2/core/MatrixIterator.h>
+#include <genetrail2/core/DenseMatrixView.h>
 #include <genetrail2/core/Statistic.h>
 
+#include <algorithm>
 #include <iostream>
 #include <random>
+#include <stdexcept>
 #include <vector>
 #include <tuple>
 #include <cmath>
@@ -47,12 +47,14 @@ template <typename ValueType> class GT2_EXPORT RegulationBootstrapperMicro
 	RegulationBootstrapperMicro(DenseMatrix* matrix, DenseMatrix* matrix_micro, unsigned seed, size_t firstControl)
 	    : matrix_(matrix),
 	      matrix_micro_(matrix_micro),
-	      bootstrap_sample_matrix_(matrix_->cols()),
-	      subset_matrix_(matrix, bootstrap_sample_matrix_.begin(), bootstrap_sample_matrix_.end()),
-	      subset_micro_(matrix_micro, bootstrap_sample_matrix_.begin(), bootstrap_sample_matrix_.end()),
+	      bootstrap_sample_matrix_(columns_(matrix, firstControl)),
+	      subset_matrix_(columnSubsetView(*matrix, bootstrap_sample_matrix_.begin(), bootstrap_sample_matrix_.end())),
+	      subset_micro_(columnSubsetView(*matrix_micro, bootstrap_sample_matrix_.begin(), bootstrap_sample_matrix_.end())),
 	      generator_(seed),
-	      distribution_dis_(0, firstControl-1),
-	      distribution_con_(firstControl,matrix_->cols() - 1),
+	      // Without disease or control samples the respective distribution
+	      // is never used, but its bounds still have to be ordered
+	      distribution_dis_(0, std::max(firstControl, size_t(1)) - 1),
+	      distribution_con_(firstControl, std::max<size_t>(firstControl, matrix_->cols() - 1)),
 	      firstControl_(firstControl)
 	     
 	{
@@ -98,20 +100,23 @@ template <typename ValueType> class GT2_EXPORT RegulationBootstrapperMicro
 	                               RegulatorImpactScore score)
 	{
 		
-		subset_matrix_.assign(bootstrap_sample_matrix_.begin(), bootstrap_sample_matrix_.end());
-		subset_micro_.assign(bootstrap_sample_matrix_.begin(), bootstrap_sample_matrix_.end());
-		
-		size_t target_idx = std::get<1>(regulations[0]);
+		subset_matrix_.assignCols(bootstrap_sample_matrix_.begin(), bootstrap_sample_matrix_.end());
+		subset_micro_.assignCols(bootstrap_sample_matrix_.begin(), bootstrap_sample_matrix_.end());
+
+		// All regulations share the target. Its row is copied once, the
+		// regulator rows are copied into a reused buffer.
+		target_.resize(subset_matrix_.cols());
+		regulator_.resize(subset_micro_.cols());
+		subset_matrix_.gatherRow(std::get<1>(regulations[0]), target_.data());
+
 		for(Regulation& r : regulations) {
 
 			size_t regulator_idx = std::get<0>(r);
-			RowMajorMatrixIterator<Matrix> regulator_it(&subset_micro_,
-			                                            regulator_idx),
-			    target_it(&subset_matrix_, target_idx);
-			
+			subset_micro_.gatherRow(regulator_idx, regulator_.data());
+
 			value_type result =
-			    score.compute(regulator_it->begin(), regulator_it->end(),
-			                  target_it->begin(), target_it->end());
+			    score.compute(regulator_.begin(), regulator_.end(),
+			                  target_.begin(), target_.end());
 			    
 			if(normalize_scores) {
 				size_t tmp = rfile.regulator2regulations(regulator_idx).size();
@@ -164,11 +169,31 @@ template <typename ValueType> class GT2_EXPORT RegulationBootstrapperMicro
 		}
 	}
 
+	/**
+	 * The number of columns of the matrix. A bootstrap sample cannot be
+	 * drawn from a matrix without columns or with fewer columns than
+	 * disease samples.
+	 */
+	static size_t columns_(const DenseMatrix* matrix, size_t firstControl)
+	{
+		if(matrix->cols() == 0) {
+			throw std::invalid_argument(
+			    "Cannot bootstrap a matrix without columns");
+		}
+		if(firstControl > matrix->cols()) {
+			throw std::invalid_argument(
+			    "The first control lies behind the last column");
+		}
+		return matrix->cols();
+	}
+
 	DenseMatrix* matrix_;
 	DenseMatrix* matrix_micro_;
 	std::vector<size_t> bootstrap_sample_matrix_;
-	DenseColumnSubset subset_matrix_;
-	DenseColumnSubset subset_micro_;
+	DenseColumnSubsetView subset_matrix_;
+	DenseColumnSubsetView subset_micro_;
+	std::vector<DenseMatrix::value_type> target_;
+	std::vector<DenseMatrix::value_type> regulator_;
 	size_t samples_;
 	std::mt19937 generator_;
 	dist_type distribution_dis_;
@@ -29,6 +29,7 @@
 #include <cmath>
 #include <limits>
 #include <tuple>
+#include <unordered_set>
 
 namespace GeneTrail
 {
@@ -83,6 +84,7 @@ template <typename ValueType> class GT2_EXPORT RegulationFile
 
 		regulator2regulations_[regulator_indices_[regulator_idx]].emplace_back(reg);
 		target2regulations_[target_indices_[target_idx]].emplace_back(reg);
+		regulations_.emplace_back(reg);
 	}
 
 	std::vector<Regulation>& regulator2regulations(size_t regulator)
@@ -137,13 +139,52 @@ template <typename ValueType> class GT2_EXPORT RegulationFile
 		return total_number_of_targets_[regulator];
 	}
 
+	/**
+	 * Creates a copy that only contains the regulations of the given
+	 * targets. The total number of targets of each regulator is kept.
+	 *
+	 * The regulations are added in the order in which they were added to
+	 * this file. This yields the same file as parsing the regulations
+	 * with the given test set, which allows to parse a network only once
+	 * and to use it for several test sets.
+	 */
+	RegulationFile restrictToTargets(const std::unordered_set<size_t>& targets) const
+	{
+		std::vector<bool> keep(target_indices_.size(), false);
+		for(size_t target : targets) {
+			if(target < keep.size()) {
+				keep[target] = true;
+			}
+		}
+
+		RegulationFile result(*this, EmptyCopy());
+		for(const Regulation& reg : regulations_) {
+			if(keep[std::get<1>(reg)]) {
+				result.addRegulation(std::get<0>(reg), std::get<1>(reg), std::get<2>(reg));
+			}
+		}
+		return result;
+	}
+
   private:
+	struct EmptyCopy {};
+
+	RegulationFile(const RegulationFile& other, EmptyCopy)
+	    : max_index_(other.max_index_),
+	      regulator_indices_(other.regulator_indices_.size(), max_index_),
+	      target_indices_(other.target_indices_.size(), max_index_),
+	      total_number_of_targets_(other.total_number_of_targets_)
+	{
+	}
+
 	size_t max_index_;
 	std::vector<size_t> regulator_indices_;
 	std::vector<size_t> target_indices_;
 
 	std::vector<std::vector<Regulation>> target2regulations_;
 	std::vector<std::vector<Regulation>> regulator2regulations_;
+	// All regulations in the order they were added
+	std::vector<Regulation> regulations_;
 	std::vector<size_t> total_number_of_targets_;
 };
 }
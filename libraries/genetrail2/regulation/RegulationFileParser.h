@@ -26,6 +26,7 @@
 #include <genetrail2/core/Matrix.h>
 #include <genetrail2/core/DenseMatrix.h>
 
+#include "BinaryRegulationNetwork.h"
 #include "RegulationFile.h"
 
 #include <boost/filesystem.hpp>
@@ -78,6 +79,11 @@ template <typename NameDatabase, typename ValueType> class GT2_EXPORT Regulation
 	           const std::unordered_set<size_t>& test_set,
 	           const std::string& file, value_type default_value)
 	{
+		if(BinaryRegulationNetwork::isBinaryNetwork(file)) {
+			readBinary_(name_database, name_database, test_set, file, default_value);
+			return;
+		}
+
 		std::ifstream input(file);
 		if(!input) {
 			throw GeneTrail::IOError("File (" + file +
@@ -104,6 +110,11 @@ template <typename NameDatabase, typename ValueType> class GT2_EXPORT Regulation
 	           const std::unordered_set<size_t>& test_set,
 	           const std::string& file, value_type default_value)
 	{
+		if(BinaryRegulationNetwork::isBinaryNetwork(file)) {
+			readBinary_(name_database_micro, name_database, test_set, file, default_value);
+			return;
+		}
+
 		std::ifstream input(file);
 		if(!input) {
 			throw GeneTrail::IOError("File (" + file +
@@ -129,6 +140,87 @@ template <typename NameDatabase, typename ValueType> class GT2_EXPORT Regulation
 		}
 	}
 
+	/**
+	 * Reads a network in the format of BinaryRegulationNetwork. Every name
+	 * is only resolved once, which makes this considerably faster than
+	 * parsing the text format. The resulting RegulationFile contains the
+	 * same regulations in the same order as if the corresponding text file
+	 * had been parsed.
+	 */
+	void readBinary_(NameDatabase& regulator_database,
+	                 NameDatabase& target_database,
+	                 const std::unordered_set<size_t>& test_set,
+	                 const std::string& file, value_type default_value)
+	{
+		BinaryRegulationNetwork network(file);
+		const size_t n = network.numberOfNames();
+
+		// The names are resolved in the order in which the text parser
+		// would encounter them, so that databases assigning indices on the
+		// fly yield the same indices as for the text format.
+		std::vector<size_t> regulator_idx(n, MAX_MATRIX_INDEX);
+		std::vector<size_t> target_idx(n, MAX_MATRIX_INDEX);
+		if(&regulator_database == &target_database) {
+			// Names are stored in the order of their first occurrence
+			for(size_t i = 0; i < n; ++i) {
+				regulator_idx[i] = target_idx[i] = regulator_database(network.name(i));
+			}
+		} else {
+			// Every database only sees the names of its own column. Order
+			// them by the line of their first edge in this column.
+			std::vector<size_t> first(network.numberOfEdges(), MAX_MATRIX_INDEX);
+			for(size_t r = 0; r < n; ++r) {
+				if(network.isRegulator(r)) {
+					first[network.line(network.regulatorBegin(r))] = r;
+				}
+			}
+			for(size_t r : first) {
+				if(r != MAX_MATRIX_INDEX) {
+					regulator_idx[r] = regulator_database(network.name(r));
+				}
+			}
+
+			std::fill(first.begin(), first.end(), MAX_MATRIX_INDEX);
+			for(size_t t = 0; t < n; ++t) {
+				if(network.isTarget(t)) {
+					first[network.line(network.edge(network.targetBegin(t)))] = t;
+				}
+			}
+			for(size_t t : first) {
+				if(t != MAX_MATRIX_INDEX) {
+					target_idx[t] = target_database(network.name(t));
+				}
+			}
+		}
+
+		// Add the regulations in the order of the lines of the text file.
+		// Thus, the regulations of every regulator and target are stored
+		// in the same order as by the text parser.
+		std::vector<std::pair<size_t, size_t>> edges(network.numberOfEdges());
+		for(size_t r = 0; r < n; ++r) {
+			for(size_t e = network.regulatorBegin(r); e < network.regulatorEnd(r); ++e) {
+				edges[network.line(e)] = std::make_pair(r, e);
+			}
+		}
+
+		for(const auto& edge : edges) {
+			const size_t regulator = regulator_idx[edge.first];
+			const size_t target = target_idx[network.target(edge.second)];
+			if(regulator == MAX_MATRIX_INDEX || target == MAX_MATRIX_INDEX) {
+				continue;
+			}
+
+			regulation_file_.increaseNumberOfTargets(regulator);
+
+			if(test_set.find(target) == test_set.end()) {
+				continue;
+			}
+
+			regulation_file_.addRegulation(
+			    regulator, target, network.value(edge.second, default_value));
+		}
+	}
+
 	void addRegulation_(NameDatabase& name_database,
 	                    const std::unordered_set<size_t>& test_set,
 	                    const std::string& regulator, const std::string& target,
@@ -13,23 +13,34 @@ void RegulatorEffectResultAggregator::read_results(const std::string& fname)
 	}
 }
 
+std::vector<AggregatedRegulatorEffectResult*>
+RegulatorEffectResultAggregator::resultPointers_()
+{
+	std::vector<AggregatedRegulatorEffectResult*> results;
+	results.reserve(aggregated_results_.size());
+	for(auto& r : aggregated_results_) {
+		results.emplace_back(&r.second);
+	}
+	return results;
+}
+
 void
 RegulatorEffectResultAggregator::adjustPValues(const std::string& method)
 {
-	std::vector<std::pair<std::string, double>> p_values;
+	// The p-values are adjusted in the iteration order of the map, which
+	// avoids copying and looking up the regulator names.
+	std::vector<double> p_values;
 	p_values.reserve(aggregated_results_.size());
-	for(auto& r : aggregated_results_) {
-		p_values.emplace_back(
-		    std::make_pair(r.first, r.second.aggregated_p_value));
+	for(const auto& r : aggregated_results_) {
+		p_values.emplace_back(r.second.aggregated_p_value);
 	}
 
-	// Adjust p-values
-	p_values = pvalue::adjustPValues(p_values, pvalue::get_second(),
-	                                 pvalue::getCorrectionMethod(method).get());
+	pvalue::adjustPValuesInPlace(p_values.data(), p_values.size(),
+	                             pvalue::getCorrectionMethod(method).get());
 
-	// Update p-values
-	for(const auto& pair : p_values) {
-		aggregated_results_[pair.first].corrected_p_value = pair.second;
+	auto p = p_values.begin();
+	for(auto& r : aggregated_results_) {
+		r.second.corrected_p_value = *p++;
 	}
 }
 
@@ -106,21 +117,18 @@ void RegulatorEffectResultAggregator::parse_results(const std::string& line)
 
 void RegulatorEffectResultAggregator::write(const std::string& fname)
 {
-	std::vector<AggregatedRegulatorEffectResult> results;
-	for(auto& r : aggregated_results_) {
-		results.emplace_back(r.second);
-	}
+	auto results = resultPointers_();
 	std::sort(results.begin(), results.end(),
-	          [](const AggregatedRegulatorEffectResult& lhs,
-	             const AggregatedRegulatorEffectResult& rhs) {
-		return lhs.rank_sum < rhs.rank_sum;
+	          [](const AggregatedRegulatorEffectResult* lhs,
+	             const AggregatedRegulatorEffectResult* rhs) {
+		return lhs->rank_sum < rhs->rank_sum;
 	});
 	rapidjson::StringBuffer sb;
 	rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(sb);
 
 	writer.StartArray();
-	for(AggregatedRegulatorEffectResult& res : results) {
-		serializeJSON(writer, res);
+	for(const AggregatedRegulatorEffectResult* res : results) {
+		serializeJSON(writer, *res);
 	}
 	writer.EndArray();
 
@@ -38,6 +38,7 @@
 
 #include <genetrail2/core/Exception.h>
 #include <genetrail2/core/PValue.h>
+#include <genetrail2/core/Parallel.h>
 #include <genetrail2/core/macros.h>
 
 namespace GeneTrail
@@ -109,18 +110,22 @@ class GT2_EXPORT RegulatorEffectResultAggregator
 
 	template <typename Aggregator> void aggregatePValues(Aggregator aggregator)
 	{
-		for(auto& entry : aggregated_results_) {
-			entry.second.aggregated_p_value = aggregator(entry.second.p_values);
-		}
+		auto results = resultPointers_();
+		parallel_for(0, results.size(), [&](size_t i) {
+			Aggregator agg(aggregator);
+			results[i]->aggregated_p_value = agg(results[i]->p_values);
+		}, 0, 1024);
 	}
 
 	void aggregatePValues(const std::string& method);
 	
 	template <typename Aggregator> void aggregateRanks(Aggregator aggregator)
 	{
-		for(auto& entry : aggregated_results_) {
-			entry.second.rank_sum = aggregator(entry.second.ranks);
-		}
+		auto results = resultPointers_();
+		parallel_for(0, results.size(), [&](size_t i) {
+			Aggregator agg(aggregator);
+			results[i]->rank_sum = agg(results[i]->ranks);
+		}, 0, 1024);
 	}
 	
 	void aggregateRanks(const std::string& method);
@@ -132,7 +137,7 @@ class GT2_EXPORT RegulatorEffectResultAggregator
   protected:
 	template <typename Writer>
 	void serializeJSON(Writer& writer,
-	                   AggregatedRegulatorEffectResult result)
+	                   const AggregatedRegulatorEffectResult& result)
 	{
 		writer.StartObject();
 
@@ -202,6 +207,11 @@ class GT2_EXPORT RegulatorEffectResultAggregator
 	void parse_results(const std::string& line);
 
 	private:
+	/**
+	 * Pointers to all results, which allows to process them in parallel.
+	 */
+	std::vector<AggregatedRegulatorEffectResult*> resultPointers_();
+
 	size_t numberOfResults;
 	std::map<std::string, AggregatedRegulatorEffectResult> aggregated_results_;
 };
@@ -26,4 +26,5 @@ add_header_to_library(RTINetwork.h)
 
 # Sources
 add_to_library(RegulatorEffectResultAggregator)
-add_to_library(RegulatorCategoryFileReader)
\ No newline at end of file
+add_to_library(RegulatorCategoryFileReader)
+add_to_library(BinaryRegulationNetwork)
\ No newline at end of file
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/cluster/ApproximateNeighborhoodBuilder.h>
+#include <genetrail2/cluster/NeighborhoodBuilder.h>
+
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/SparseMatrix.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace GeneTrail;
+
+const double TOLERANCE = 0.0001;
+
+const int K = 5;
+
+/**
+ * A 60 x 12 matrix of random rows. Some rows are (anti-)correlated with
+ * the first rows, so that both signs of the correlation occur among the
+ * nearest neighbors.
+ */
+static DenseMatrix makeMatrix()
+{
+	std::mt19937 twister(42);
+	std::normal_distribution<double> normal;
+
+	DenseMatrix mat(60, 12);
+	for(DenseMatrix::index_type i = 0; i < mat.rows(); ++i) {
+		mat.setRowName(i, "G" + std::to_string(i));
+		for(DenseMatrix::index_type j = 0; j < mat.cols(); ++j) {
+			const double base = i >= 40 ? (i % 2 == 0 ? 1.0 : -1.0) * mat(i - 40, j) : 0.0;
+			mat(i, j) = base + normal(twister);
+		}
+	}
+
+	return mat;
+}
+
+static NeighborhoodBuilder exactBuilder()
+{
+	NeighborhoodBuilder builder;
+	builder.setNumNeighbors(K);
+	return builder;
+}
+
+static void expectSameGraph(const SparseMatrix& expected, const SparseMatrix& result)
+{
+	ASSERT_EQ(expected.rows(), result.rows());
+	ASSERT_EQ(expected.cols(), result.cols());
+	EXPECT_EQ(expected.matrix().nonZeros(), result.matrix().nonZeros());
+
+	for(int j = 0; j < expected.matrix().outerSize(); ++j) {
+		for(SparseMatrix::SMatrix::InnerIterator it(expected.matrix(), j); it; ++it) {
+			EXPECT_NEAR(it.value(), result.matrix().coeff(it.row(), it.col()), TOLERANCE)
+			    << it.row() << ", " << it.col();
+		}
+	}
+}
+
+TEST(ApproximateNeighborhoodBuilder, MatchesExactWithSingleLeaf)
+{
+	const auto mat = makeMatrix();
+
+	// A leaf holding all rows and their negations makes every row a
+	// candidate, the approximation becomes exact
+	ApproximateNeighborhoodBuilder builder;
+	builder.setNumNeighbors(K);
+	builder.setNumTrees(1);
+	builder.setLeafSize(2 * mat.rows());
+	builder.setNumRefinements(0);
+
+	const auto exact = exactBuilder().build(mat);
+	std::vector<std::vector<unsigned int>> lists;
+	const auto result = builder.build(mat, lists);
+
+	expectSameGraph(exact, result);
+	expectSameGraph(builder.build(mat), result);
+	EXPECT_EQ(mat.rowNames(), result.rowNames());
+	EXPECT_NEAR(1.0, builder.estimateRecall(mat, lists, mat.rows()), TOLERANCE);
+}
+
+TEST(ApproximateNeighborhoodBuilder, NeighborLists)
+{
+	const auto mat = makeMatrix();
+
+	ApproximateNeighborhoodBuilder builder;
+	builder.setNumNeighbors(K);
+	builder.setLeafSize(8);
+	builder.setNumTrees(4);
+
+	std::vector<std::vector<unsigned int>> lists;
+	const auto result = builder.build(mat, lists);
+
+	ASSERT_EQ(mat.rows(), lists.size());
+	for(DenseMatrix::index_type i = 0; i < mat.rows(); ++i) {
+		EXPECT_GE(K, lists[i].size());
+		double last = 2.0;
+		for(const unsigned int j : lists[i]) {
+			// Every list entry is an edge, sorted by descending similarity
+			const double sim = result.matrix().coeff(j, i);
+			EXPECT_NE(0.0, sim);
+			EXPECT_LE(sim, last);
+			last = sim;
+		}
+	}
+}
+
+TEST(ApproximateNeighborhoodBuilder, Recall)
+{
+	const auto mat = makeMatrix();
+	const auto exact = exactBuilder().build(mat);
+
+	ApproximateNeighborhoodBuilder builder;
+	builder.setNumNeighbors(K);
+	builder.setLeafSize(8);
+	builder.setNumTrees(4);
+	builder.setSeed(7);
+
+	// The exact k nearest neighbors of every row
+	std::vector<std::vector<unsigned int>> exact_lists(mat.rows());
+	for(DenseMatrix::index_type i = 0; i < mat.rows(); ++i) {
+		std::vector<std::pair<double, int>> neighbors;
+		for(SparseMatrix::SMatrix::InnerIterator it(exact.matrix(), i); it; ++it) {
+			neighbors.emplace_back(it.value(), it.row());
+		}
+		// The exact graph also contains the rows having i as neighbor
+		std::partial_sort(neighbors.begin(), neighbors.begin() + K, neighbors.end(),
+		                  std::greater<std::pair<double, int>>());
+		for(int k = 0; k < K; ++k) {
+			exact_lists[i].push_back(neighbors[k].second);
+		}
+	}
+
+	// The exact neighbors are found completely
+	EXPECT_NEAR(1.0, builder.estimateRecall(mat, exact_lists, mat.rows()), TOLERANCE);
+
+	// The recall is the fraction of the exact neighbors that are in the
+	// neighbor list of their row
+	std::vector<std::vector<unsigned int>> lists;
+	const auto result = builder.build(mat, lists);
+	unsigned int found = 0;
+	unsigned int found_in_graph = 0;
+	for(DenseMatrix::index_type i = 0; i < mat.rows(); ++i) {
+		for(const unsigned int j : exact_lists[i]) {
+			found += std::find(lists[i].begin(), lists[i].end(), j) != lists[i].end();
+			found_in_graph += result.matrix().coeff(j, i) != 0.0;
+		}
+	}
+
+	const double recall = builder.estimateRecall(mat, lists, mat.rows());
+	EXPECT_NEAR(found / double(K * mat.rows()), recall, TOLERANCE);
+	EXPECT_LE(found, found_in_graph);
+	EXPECT_GT(recall, 0.5);
+
+	// Rows without neighbors miss all exact neighbors
+	std::vector<std::vector<unsigned int>> empty(mat.rows());
+	EXPECT_EQ(0.0, builder.estimateRecall(mat, empty, mat.rows()));
+	EXPECT_THROW(builder.estimateRecall(mat, std::vector<std::vector<unsigned int>>(), 1), std::invalid_argument);
+}
+
+TEST(ApproximateNeighborhoodBuilder, RecallWithoutSamples)
+{
+	const auto mat = makeMatrix();
+
+	ApproximateNeighborhoodBuilder builder;
+	builder.setNumNeighbors(K);
+
+	std::vector<std::vector<unsigned int>> lists;
+	builder.build(mat, lists);
+
+	const double recall = builder.estimateRecall(mat, lists, 0);
+	EXPECT_FALSE(std::isnan(recall));
+	EXPECT_EQ(1.0, recall);
+}
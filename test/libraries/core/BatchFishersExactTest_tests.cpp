@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/BatchFishersExactTest.h>
+#include <genetrail2/core/FishersExactTest.h>
+
+#include <cmath>
+
+using namespace GeneTrail;
+
+const double TOLERANCE = 0.00001;
+
+TEST(BatchFishersExactTest, compareToR)
+{
+	BatchFishersExactTest fet(100);
+	EXPECT_NEAR(fet.lowerTailedPValue(14, 9, 10, 1),
+	            0.0005103872 + 0.01020774, TOLERANCE);
+	EXPECT_NEAR(fet.lowerTailedPValue(14, 9, 10, 3),
+	            0.08884103 + 0.01665769 + 0.001346076 + 0.000033652,
+	            TOLERANCE);
+	EXPECT_NEAR(std::exp(fet.logProbability(14, 6, 10, 6)), 0.2332077,
+	            TOLERANCE);
+}
+
+TEST(BatchFishersExactTest, compareToFishersExactTest)
+{
+	FishersExactTest<uint64_t, long double> reference;
+	BatchFishersExactTest fet(60);
+
+	for(uint64_t m = 1; m <= 30; m += 3) {
+		for(uint64_t n = 1; n <= 30; n += 4) {
+			for(uint64_t l = 0; l <= m; ++l) {
+				for(uint64_t k = 0; k <= n; ++k) {
+					const double upper =
+					    reference.upperTailedPValue(m, l, n, k);
+					const double lower =
+					    reference.lowerTailedPValue(m, l, n, k);
+					EXPECT_NEAR(fet.upperTailedPValue(m, l, n, k), upper,
+					            1e-12 + 1e-9 * upper);
+					EXPECT_NEAR(fet.lowerTailedPValue(m, l, n, k), lower,
+					            1e-12 + 1e-9 * lower);
+				}
+			}
+		}
+	}
+}
+
+TEST(BatchFishersExactTest, extremeTables)
+{
+	BatchFishersExactTest fet(200000);
+
+	// P(X >= 0) and P(X <= n) cover the whole support
+	EXPECT_DOUBLE_EQ(fet.upperTailedPValue(100000, 500, 100000, 0), 1.0);
+	EXPECT_DOUBLE_EQ(fet.lowerTailedPValue(100000, 0, 100000, 500), 1.0);
+
+	// Far in the tail, the p-value is tiny but still positive
+	const double p = fet.upperTailedPValue(100000, 10, 100000, 500);
+	EXPECT_GT(p, 0.0);
+	EXPECT_LT(p, 1e-100);
+}
+
+TEST(BatchFishersExactTest, pValues)
+{
+	BatchFishersExactTest fet(100);
+
+	std::vector<uint64_t> m, l, n, k;
+	std::vector<BatchFishersExactTest::Tail> tails;
+	for(uint64_t i = 0; i < 2500; ++i) {
+		m.push_back(20 + i % 7);
+		l.push_back(i % 11);
+		n.push_back(30 + i % 5);
+		k.push_back(i % 13);
+		tails.push_back(i % 2 == 0 ? BatchFishersExactTest::Tail::Upper
+		                           : BatchFishersExactTest::Tail::Lower);
+	}
+
+	const auto upper = fet.pValues(m, l, n, k,
+	                               BatchFishersExactTest::Tail::Upper, 3);
+	const auto mixed = fet.pValues(m, l, n, k, tails, 2);
+
+	ASSERT_EQ(m.size(), upper.size());
+	ASSERT_EQ(m.size(), mixed.size());
+	for(size_t i = 0; i < m.size(); ++i) {
+		EXPECT_DOUBLE_EQ(fet.upperTailedPValue(m[i], l[i], n[i], k[i]),
+		                 upper[i]);
+		EXPECT_DOUBLE_EQ(fet.pValue(m[i], l[i], n[i], k[i], tails[i]),
+		                 mixed[i]);
+	}
+}
+
+TEST(BatchFishersExactTest, tablesBeyondMaxPopulation)
+{
+	// The table of log-factorials only covers populations up to 20
+	BatchFishersExactTest small(20);
+	BatchFishersExactTest large(100);
+
+	std::vector<uint64_t> m, l, n, k;
+	for(uint64_t i = 0; i < 2500; ++i) {
+		m.push_back(5 + i % 47);
+		l.push_back(i % 5);
+		n.push_back(3 + i % 43);
+		k.push_back(i % 3);
+	}
+
+	const auto expected = large.pValues(m, l, n, k,
+	                                    BatchFishersExactTest::Tail::Upper, 2);
+	const auto actual = small.pValues(m, l, n, k,
+	                                  BatchFishersExactTest::Tail::Upper, 2);
+	ASSERT_EQ(expected.size(), actual.size());
+	for(size_t i = 0; i < m.size(); ++i) {
+		EXPECT_EQ(expected[i], actual[i]);
+		EXPECT_EQ(large.logProbability(m[i], l[i], n[i], k[i]),
+		          small.logProbability(m[i], l[i], n[i], k[i]));
+		EXPECT_EQ(large.lowerTailedPValue(m[i], l[i], n[i], k[i]),
+		          small.lowerTailedPValue(m[i], l[i], n[i], k[i]));
+	}
+}
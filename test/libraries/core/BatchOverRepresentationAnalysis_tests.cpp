@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <genetrail2/core/BatchOverRepresentationAnalysis.h>
+#include <genetrail2/core/BinaryCategoryDatabase.h>
+#include <genetrail2/core/CategoryDatabase.h>
+#include <genetrail2/core/EntityDatabase.h>
+#include <genetrail2/core/OverRepresentationAnalysis.h>
+
+#include <memory>
+
+using namespace GeneTrail;
+
+const double TOLERANCE = 0.00001;
+
+static void insertRange(Category& c, int begin, int end)
+{
+	for(int i = begin; i < end; ++i) {
+		c.insert(boost::lexical_cast<std::string>(i));
+	}
+}
+
+static void checkAgainstOra(const CategoryDatabase& cats, const Category& ref,
+                            const Category& test)
+{
+	BatchOverRepresentationAnalysis batch(cats, ref);
+	OverRepresentationAnalysis ora(ref, test);
+
+	auto k = batch.testHits(test);
+	auto members = batch.testMembers(test);
+	auto batch_test = batch.test(test);
+	const auto& l = batch.referenceHits();
+
+	ASSERT_EQ(cats.size(), batch.size());
+	ASSERT_EQ(cats.size(), k.size());
+	EXPECT_EQ(ref.size(), batch.referenceSize());
+
+	for(size_t i = 0; i < cats.size(); ++i) {
+		EXPECT_EQ(ora.testHits(cats[i]), k[i]);
+		EXPECT_EQ(ora.referenceHits(cats[i]), l[i]);
+		EXPECT_EQ(k[i], members[i].size());
+		EXPECT_TRUE(std::is_sorted(members[i].begin(), members[i].end()));
+
+		EXPECT_NEAR(ora.expectedNumberOfHits(cats[i]),
+		            batch_test.expectedNumberOfHits(l[i]), TOLERANCE);
+		EXPECT_NEAR(ora.computePValue(cats[i]),
+		            batch_test.computePValue(l[i], k[i]), TOLERANCE);
+		EXPECT_NEAR(ora.computeUpperTailedPValue(cats[i]),
+		            batch_test.computeUpperTailedPValue(l[i], k[i]), TOLERANCE);
+		EXPECT_NEAR(ora.computeLowerTailedPValue(cats[i]),
+		            batch_test.computeLowerTailedPValue(l[i], k[i]), TOLERANCE);
+	}
+}
+
+TEST(BatchOverRepresentationAnalysis, HypergeometricTest)
+{
+	auto db = std::make_shared<EntityDatabase>();
+	CategoryDatabase cats(db);
+	insertRange(cats.addCategory(), 0, 5);
+	insertRange(cats.addCategory(), 3, 20);
+	insertRange(cats.addCategory(), 45, 60);
+	cats.addCategory();
+
+	Category ref(db.get());
+	insertRange(ref, 0, 50);
+	Category test(db.get());
+	insertRange(test, 1, 11);
+
+	checkAgainstOra(cats, ref, test);
+}
+
+TEST(BatchOverRepresentationAnalysis, FisherTest)
+{
+	auto db = std::make_shared<EntityDatabase>();
+	CategoryDatabase cats(db);
+	insertRange(cats.addCategory(), 5, 14);
+	insertRange(cats.addCategory(), 0, 3);
+	insertRange(cats.addCategory(), 10, 16);
+
+	Category ref(db.get());
+	insertRange(ref, 0, 14);
+	Category test(db.get());
+	insertRange(test, 7, 17);
+
+	checkAgainstOra(cats, ref, test);
+}
+
+TEST(BatchOverRepresentationAnalysis, UnknownTestMembers)
+{
+	auto db = std::make_shared<EntityDatabase>();
+	CategoryDatabase cats(db);
+	insertRange(cats.addCategory(), 0, 4);
+
+	Category ref(db.get());
+	insertRange(ref, 0, 10);
+	Category test(db.get());
+	insertRange(test, 2, 30);
+
+	BatchOverRepresentationAnalysis batch(cats, ref);
+	auto members = batch.testMembers(test);
+
+	ASSERT_EQ(1u, members.size());
+	ASSERT_EQ(2u, members[0].size());
+	EXPECT_EQ("2", db->name(members[0][0]));
+	EXPECT_EQ("3", db->name(members[0][1]));
+}
+
+TEST(BatchOverRepresentationAnalysis, BinaryCategoryDatabase)
+{
+	auto db = std::make_shared<EntityDatabase>();
+	CategoryDatabase cats(db);
+	insertRange(cats.addCategory(), 0, 5);
+	insertRange(cats.addCategory(), 3, 20);
+	insertRange(cats.addCategory(), 45, 60);
+	cats.addCategory();
+
+	const std::string path = boost::filesystem::unique_path().native();
+	BinaryCategoryDatabase::write(cats, path);
+	BinaryCategoryDatabase binary(path);
+
+	// Register the genes in a different order, so that the ids of the
+	// binary database need to be translated.
+	auto other = std::make_shared<EntityDatabase>();
+	Category ref(other.get());
+	for(int i = 50; i > 0; --i) {
+		ref.insert(boost::lexical_cast<std::string>(i - 1));
+	}
+	Category test(other.get());
+	insertRange(test, 1, 11);
+	insertRange(test, 55, 70);
+
+	const auto ids = binary.entityIds(*other);
+	BatchOverRepresentationAnalysis batch(binary, ids, ref);
+	BatchOverRepresentationAnalysis expected(binary.toCategoryDatabase(other), ref);
+	boost::filesystem::remove(path);
+
+	ASSERT_EQ(expected.size(), batch.size());
+	EXPECT_EQ(expected.referenceHits(), batch.referenceHits());
+	EXPECT_EQ(expected.testHits(test), batch.testHits(test));
+	EXPECT_EQ(expected.testMembers(test), batch.testMembers(test));
+	EXPECT_EQ((std::vector<size_t>{5, 17, 5, 0}), batch.referenceHits());
+	EXPECT_EQ((std::vector<size_t>{4, 8, 5, 0}), batch.testHits(test));
+}
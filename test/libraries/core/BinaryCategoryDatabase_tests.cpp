@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/BinaryCategoryDatabase.h>
+#include <genetrail2/core/Category.h>
+#include <genetrail2/core/Exception.h>
+#include <genetrail2/core/GMTFile.h>
+
+#include <config.h>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+
+using namespace GeneTrail;
+namespace fs = boost::filesystem;
+
+class BinaryCategoryDatabaseTest : public ::testing::Test
+{
+	public:
+		BinaryCategoryDatabaseTest()
+			: path_(fs::unique_path().native())
+		{
+		}
+
+		void TearDown() override {
+			fs::remove(path_);
+		}
+
+	protected:
+		const std::string path_;
+};
+
+TEST_F(BinaryCategoryDatabaseTest, roundTrip)
+{
+	auto db = std::make_shared<EntityDatabase>();
+	// Registered first, but not part of any category
+	db->index("unused");
+
+	GMTFile f(db, TEST_DATA_PATH("categories.gmt"));
+	auto categories = f.read();
+	categories.setName("test");
+	categories.editor().name = "Editor";
+	categories.setSourceUrl("http://localhost");
+
+	BinaryCategoryDatabase::write(categories, path_);
+	ASSERT_TRUE(BinaryCategoryDatabase::isBinaryCategoryDatabase(path_));
+	EXPECT_FALSE(BinaryCategoryDatabase::isBinaryCategoryDatabase(TEST_DATA_PATH("categories.gmt")));
+
+	BinaryCategoryDatabase view(path_);
+	ASSERT_EQ(5, view.size());
+	EXPECT_EQ(5, view.numberOfEntities());
+	EXPECT_EQ("test", view.databaseName());
+	EXPECT_EQ("Editor", view.editorName());
+	EXPECT_EQ("", view.editorEmail());
+	EXPECT_EQ("http://localhost", view.sourceUrl());
+
+	for(size_t i = 0; i < view.size(); ++i) {
+		EXPECT_EQ(categories[i].name(), view.name(i));
+		EXPECT_EQ(categories[i].reference(), view.reference(i));
+		ASSERT_EQ(categories[i].size(), size_t(view.end(i) - view.begin(i)));
+		EXPECT_TRUE(std::is_sorted(view.begin(i), view.end(i)));
+
+		auto it = view.begin(i);
+		for(const auto& name : categories[i].names()) {
+			EXPECT_EQ(name, view.entityName(*it++));
+		}
+	}
+
+	// Load into a fresh entity database
+	auto db2 = std::make_shared<EntityDatabase>();
+	auto loaded = readCategoryDatabase(db2, path_);
+	ASSERT_EQ(5, loaded.size());
+	EXPECT_EQ("test", loaded.name());
+	EXPECT_EQ("Editor", loaded.editor().name);
+	for(size_t i = 0; i < loaded.size(); ++i) {
+		EXPECT_EQ(categories[i].name(), loaded[i].name());
+		EXPECT_EQ(categories[i].reference(), loaded[i].reference());
+		ASSERT_EQ(categories[i].size(), loaded[i].size());
+		for(const auto& name : categories[i].names()) {
+			EXPECT_TRUE(loaded[i].contains(name));
+		}
+	}
+}
+
+TEST_F(BinaryCategoryDatabaseTest, readCategoryDatabaseGMT)
+{
+	auto db = std::make_shared<EntityDatabase>();
+	auto categories = readCategoryDatabase(db, TEST_DATA_PATH("categories.gmt"));
+	ASSERT_EQ(5, categories.size());
+	EXPECT_EQ("CatA", categories[0].name());
+	EXPECT_TRUE(categories[0].contains("Bla Bla"));
+}
+
+TEST_F(BinaryCategoryDatabaseTest, invalidFile)
+{
+	EXPECT_THROW(BinaryCategoryDatabase view(TEST_DATA_PATH("categories.gmt")), IOError);
+	EXPECT_THROW(BinaryCategoryDatabase view(path_), IOError);
+
+	std::ofstream out(path_, std::ios::binary);
+	out << "GT2CATDB";
+	out.close();
+	EXPECT_THROW(BinaryCategoryDatabase view(path_), IOError);
+}
+
+TEST_F(BinaryCategoryDatabaseTest, corruptIndices)
+{
+	using Header = BinaryCategoryDatabase::Header;
+
+	auto db = std::make_shared<EntityDatabase>();
+	GMTFile f(db, TEST_DATA_PATH("categories.gmt"));
+	auto categories = f.read();
+
+	auto corrupt = [&](uint64_t Header::*section, size_t index, auto value) {
+		BinaryCategoryDatabase::write(categories, path_);
+		std::fstream io(path_, std::ios::binary | std::ios::in | std::ios::out);
+		Header header;
+		io.read(reinterpret_cast<char*>(&header), sizeof(header));
+		io.seekp(header.*section + index * sizeof(value));
+		io.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	};
+
+	corrupt(&Header::members, 0, uint32_t(5));
+	EXPECT_THROW(BinaryCategoryDatabase view(path_), IOError);
+
+	corrupt(&Header::member_offsets, 1, uint64_t(1000));
+	EXPECT_THROW(BinaryCategoryDatabase view(path_), IOError);
+
+	corrupt(&Header::string_offsets, 1, uint64_t(1000));
+	EXPECT_THROW(BinaryCategoryDatabase view(path_), IOError);
+
+	corrupt(&Header::members, 0, uint32_t(0));
+	EXPECT_NO_THROW(BinaryCategoryDatabase view(path_));
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/BinaryEnrichmentResults.h>
+#include <genetrail2/core/Exception.h>
+
+#include <config.h>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <stdexcept>
+
+using namespace GeneTrail;
+namespace fs = boost::filesystem;
+
+class BinaryEnrichmentResultsTest : public ::testing::Test
+{
+	public:
+		BinaryEnrichmentResultsTest()
+			: path_(fs::unique_path().native())
+		{
+			results_.names = {"cat_a", "cat_b", ""};
+			results_.references = {"http://localhost/a", "", "c"};
+			results_.hits = {3, 0, 12};
+			results_.scores = {1.5, -2.25, 0.0};
+			results_.expected_scores = {0.5, 0.0, 3.0};
+			results_.pvalues = {1e-300, 1.0, 0.05};
+			results_.enriched = {1, 0, 1};
+		}
+
+		void TearDown() override {
+			fs::remove(path_);
+		}
+
+	protected:
+		void checkResults(const EnrichmentResultColumns& results) const;
+
+		const std::string path_;
+		EnrichmentResultColumns results_;
+};
+
+void BinaryEnrichmentResultsTest::checkResults(const EnrichmentResultColumns& results) const
+{
+	ASSERT_EQ(results_.size(), results.size());
+	EXPECT_EQ(results_.names, results.names);
+	EXPECT_EQ(results_.references, results.references);
+	EXPECT_EQ(results_.hits, results.hits);
+	EXPECT_EQ(results_.scores, results.scores);
+	EXPECT_EQ(results_.expected_scores, results.expected_scores);
+	EXPECT_EQ(results_.pvalues, results.pvalues);
+	EXPECT_EQ(results_.enriched, results.enriched);
+	EXPECT_EQ(results_.members, results.members);
+}
+
+TEST_F(BinaryEnrichmentResultsTest, roundTrip)
+{
+	BinaryEnrichmentResults::write(results_, path_);
+	ASSERT_TRUE(BinaryEnrichmentResults::isBinaryEnrichmentResults(path_));
+	EXPECT_FALSE(BinaryEnrichmentResults::isBinaryEnrichmentResults(TEST_DATA_PATH("categories.gmt")));
+
+	checkResults(BinaryEnrichmentResults::read(path_));
+}
+
+TEST_F(BinaryEnrichmentResultsTest, roundTripMembers)
+{
+	results_.members = {"a,b,c", "", "d"};
+
+	BinaryEnrichmentResults::write(results_, path_);
+	checkResults(BinaryEnrichmentResults::read(path_));
+}
+
+TEST_F(BinaryEnrichmentResultsTest, empty)
+{
+	BinaryEnrichmentResults::write(EnrichmentResultColumns(), path_);
+	EXPECT_EQ(0u, BinaryEnrichmentResults::read(path_).size());
+}
+
+TEST_F(BinaryEnrichmentResultsTest, differentSizes)
+{
+	results_.members = {"a,b,c"};
+	EXPECT_THROW(BinaryEnrichmentResults::write(results_, path_), std::invalid_argument);
+
+	results_.members.clear();
+	results_.pvalues.pop_back();
+	EXPECT_THROW(BinaryEnrichmentResults::write(results_, path_), std::invalid_argument);
+}
+
+TEST_F(BinaryEnrichmentResultsTest, invalidFile)
+{
+	EXPECT_THROW(BinaryEnrichmentResults::read(TEST_DATA_PATH("categories.gmt")), IOError);
+	EXPECT_THROW(BinaryEnrichmentResults::read(path_), IOError);
+
+	std::ofstream out(path_, std::ios::binary);
+	out << "GT2ENRES";
+	out.close();
+	EXPECT_THROW(BinaryEnrichmentResults::read(path_), IOError);
+}
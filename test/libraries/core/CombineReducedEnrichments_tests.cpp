@@ -0,0 +1,186 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/BinaryEnrichmentResults.h>
+#include <genetrail2/core/CombineReducedEnrichments.h>
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/DenseMatrixReader.h>
+#include <config.h>
+
+#include <cmath>
+#include <limits>
+#include <fstream>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+
+using namespace GeneTrail;
+namespace fs = boost::filesystem;
+
+class CombineReducedEnrichmentsTest : public ::testing::Test
+{
+	public:
+		CombineReducedEnrichmentsTest()
+			: samples_({"sample_a", "sample_b"}),
+			  dirs_({TEST_DATA_PATH("combine_reduced_enrichments/sample_a"),
+			         TEST_DATA_PATH("combine_reduced_enrichments/sample_b")}),
+			  samples_file_(fs::unique_path().native()),
+			  out_files_(fs::unique_path().native()),
+			  matrix_file_(fs::unique_path().native())
+		{
+			std::ofstream samples(samples_file_);
+			for(size_t i = 0; i < samples_.size(); ++i) {
+				samples << samples_[i] << '\t' << dirs_[i] << '\n';
+			}
+
+			std::ofstream out(out_files_);
+			out << "db\t" << matrix_file_ << '\n';
+		}
+
+		void TearDown() override {
+			fs::remove(samples_file_);
+			fs::remove(out_files_);
+			fs::remove(matrix_file_);
+		}
+
+	protected:
+		void checkMatrix(const DenseMatrix& m);
+
+		const std::vector<std::string> samples_;
+		const std::vector<std::string> dirs_;
+		const std::string samples_file_;
+		const std::string out_files_;
+		const std::string matrix_file_;
+};
+
+void CombineReducedEnrichmentsTest::checkMatrix(const DenseMatrix& m)
+{
+	ASSERT_EQ(4u, m.rows());
+	ASSERT_EQ(2u, m.cols());
+
+	EXPECT_EQ("sample_a", m.colName(0));
+	EXPECT_EQ("sample_b", m.colName(1));
+
+	EXPECT_EQ("cat a", m.rowName(0));
+	EXPECT_EQ("cat b", m.rowName(1));
+	EXPECT_EQ("cat c", m.rowName(2));
+	EXPECT_EQ("cat d", m.rowName(3));
+
+	EXPECT_DOUBLE_EQ(0.01, m(0, 0));
+	EXPECT_DOUBLE_EQ(0.2, m(0, 1));
+	EXPECT_DOUBLE_EQ(0.5, m(1, 0));
+	EXPECT_TRUE(std::isnan(m(1, 1)));
+	EXPECT_DOUBLE_EQ(1e-5, m(2, 0));
+	EXPECT_TRUE(std::isnan(m(2, 1)));
+	EXPECT_TRUE(std::isnan(m(3, 0)));
+	EXPECT_DOUBLE_EQ(0.3, m(3, 1));
+}
+
+TEST_F(CombineReducedEnrichmentsTest, combine)
+{
+	CombineReducedEnrichments c;
+	c.setSamples(samples_, dirs_);
+	c.setNumberOfThreads(2);
+
+	checkMatrix(c.combine("db"));
+}
+
+TEST_F(CombineReducedEnrichmentsTest, combine_binary)
+{
+	const std::vector<std::string> dirs = {fs::unique_path().native(),
+	                                       fs::unique_path().native()};
+	for(const auto& dir : dirs) {
+		fs::create_directory(dir);
+	}
+
+	EnrichmentResultColumns a;
+	a.names = {"cat_b", "cat_a", "cat_c"};
+	a.references = {"", "", ""};
+	a.hits = {1, 2, 3};
+	a.scores = {5.0, 0.1, 1e-4};
+	a.expected_scores = {0.0, 0.0, 0.0};
+	a.pvalues = {0.5, 0.01, 1e-5};
+	a.enriched = {0, 1, 1};
+	BinaryEnrichmentResults::write(a, dirs[0] + "/db.bin");
+
+	EnrichmentResultColumns b;
+	b.names = {"cat_a", "cat_d", "cat_b"};
+	b.references = {"", "", ""};
+	b.hits = {1, 2, 3};
+	b.scores = {2.0, 3.0, 1.0};
+	b.expected_scores = {0.0, 0.0, 0.0};
+	b.pvalues = {0.2, 0.3, std::numeric_limits<double>::quiet_NaN()};
+	b.enriched = {0, 0, 0};
+	BinaryEnrichmentResults::write(b, dirs[1] + "/db.bin");
+
+	CombineReducedEnrichments c;
+	c.setSamples(samples_, dirs);
+	c.setInputFormat(CombineReducedEnrichments::InputFormat::BinaryPValues);
+	checkMatrix(c.combine("db"));
+
+	c.setInputFormat(CombineReducedEnrichments::InputFormat::BinaryScores);
+	const auto scores = c.combine("db");
+	ASSERT_EQ(4u, scores.rows());
+	EXPECT_DOUBLE_EQ(0.1, scores(0, 0));
+	EXPECT_DOUBLE_EQ(2.0, scores(0, 1));
+	EXPECT_DOUBLE_EQ(1.0, scores(1, 1));
+
+	for(const auto& dir : dirs) {
+		fs::remove_all(dir);
+	}
+}
+
+TEST_F(CombineReducedEnrichmentsTest, combine_missing_file)
+{
+	CombineReducedEnrichments c;
+	c.setSamples(samples_, dirs_);
+
+	EXPECT_THROW(c.combine("does_not_exist"), IOError);
+}
+
+TEST_F(CombineReducedEnrichmentsTest, writeFiles_text)
+{
+	CombineReducedEnrichments c;
+	c.writeFiles(samples_file_, out_files_);
+
+	std::ifstream input(matrix_file_);
+	std::stringstream content;
+	content << input.rdbuf();
+
+	EXPECT_EQ("sample_a\tsample_b\n"
+	          "cat a\t0.01\t0.2\n"
+	          "cat b\t0.5\tNA\n"
+	          "cat c\t1e-05\tNA\n"
+	          "cat d\tNA\t0.3\n",
+	          content.str());
+}
+
+TEST_F(CombineReducedEnrichmentsTest, writeFiles_binary)
+{
+	CombineReducedEnrichments c;
+	c.setBinaryOutput(true);
+	c.writeFiles(samples_file_, out_files_);
+
+	std::ifstream input(matrix_file_, std::ios::binary);
+	DenseMatrixReader reader;
+	checkMatrix(reader.read(input));
+}
@@ -0,0 +1,148 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ * Copyright (C) 2018 Tim Kehl <tkehl@bioinf.uni-sb.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/DenseColumnSubset.h>
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/DenseMatrixView.h>
+#include <genetrail2/core/MatrixHTest.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace GeneTrail;
+
+static DenseMatrix makeMatrix(size_t rows, size_t cols)
+{
+	DenseMatrix mat(rows, cols);
+
+	for(DenseMatrix::index_type i = 0; i < mat.rows(); ++i) {
+		mat.setRowName(i, "r" + std::to_string(i));
+		for(DenseMatrix::index_type j = 0; j < mat.cols(); ++j) {
+			mat(i, j) = i * mat.cols() + j;
+		}
+	}
+
+	for(DenseMatrix::index_type j = 0; j < mat.cols(); ++j) {
+		mat.setColName(j, "c" + std::to_string(j));
+	}
+
+	return mat;
+}
+
+TEST(DenseMatrixView, columnSubset)
+{
+	auto mat = makeMatrix(3, 5);
+	std::vector<size_t> cols{4, 1, 1};
+
+	auto view = columnSubsetView(mat, cols.begin(), cols.end());
+
+	EXPECT_EQ(3u, view.rows());
+	EXPECT_EQ(3u, view.cols());
+	EXPECT_EQ("c4", view.colName(0));
+	EXPECT_EQ("r2", view.rowName(2));
+	EXPECT_EQ(mat.rowNames(), view.rowNames());
+
+	for(size_t i = 0; i < view.rows(); ++i) {
+		for(size_t j = 0; j < view.cols(); ++j) {
+			EXPECT_EQ(mat(i, cols[j]), view(i, j));
+			EXPECT_EQ(mat(i, cols[j]), view.colData(j)[i]);
+		}
+	}
+
+	view.assignCols(cols.begin() + 1, cols.end());
+	EXPECT_EQ(2u, view.cols());
+	EXPECT_EQ(mat(0, 1), view(0, 0));
+}
+
+TEST(DenseMatrixView, rowSubset)
+{
+	auto mat = makeMatrix(4, 3);
+	std::vector<size_t> rows{3, 0};
+
+	auto view = rowSubsetView(mat, rows.begin(), rows.end());
+
+	EXPECT_EQ(2u, view.rows());
+	EXPECT_EQ(3u, view.cols());
+	EXPECT_EQ("r3", view.rowName(0));
+	EXPECT_EQ(mat.colNames(), view.colNames());
+
+	std::vector<double> row(view.cols());
+	view.gatherRow(0, row.data());
+	for(size_t j = 0; j < view.cols(); ++j) {
+		EXPECT_EQ(mat(3, j), row[j]);
+	}
+
+	auto copy = view.gather();
+	ASSERT_EQ(2, copy.rows());
+	ASSERT_EQ(3, copy.cols());
+	for(size_t i = 0; i < view.rows(); ++i) {
+		for(size_t j = 0; j < view.cols(); ++j) {
+			EXPECT_EQ(mat(rows[i], j), copy(i, j));
+		}
+	}
+}
+
+TEST(DenseMatrixView, bootstrap)
+{
+	auto mat = makeMatrix(2, 3);
+
+	auto view = bootstrapView(mat, {2, 0, 1});
+
+	ASSERT_EQ(3u, view.cols());
+	EXPECT_EQ(mat(1, 0), view(1, 0));
+	EXPECT_EQ(mat(1, 0), view(1, 1));
+	EXPECT_EQ(mat(1, 2), view(1, 2));
+}
+
+TEST(DenseMatrixView, matrixHTestMatchesColumnSubset)
+{
+	auto mat = makeMatrix(4, 6);
+	mat(1, 2) = std::nan("");
+	mat(2, 0) = 7.0;
+	mat(3, 4) = -2.0;
+
+	std::vector<size_t> ref_cols{0, 1, 2}, sam_cols{3, 4, 5};
+	DenseColumnSubset ref(&mat, ref_cols.begin(), ref_cols.end());
+	DenseColumnSubset sam(&mat, sam_cols.begin(), sam_cols.end());
+	auto ref_view = columnSubsetView(mat, ref_cols.begin(), ref_cols.end());
+	auto sam_view = columnSubsetView(mat, sam_cols.begin(), sam_cols.end());
+
+	MatrixHTest htest;
+	for(auto method : {"independent-t-test", "independent-shrinkage-t-test"}) {
+		for(auto mode : {NanMode::Ignore, NanMode::Remove}) {
+			auto expected = htest.test(method, static_cast<const Matrix&>(ref),
+			                           static_cast<const Matrix&>(sam), mode);
+			auto result = htest.test(method, ref_view, sam_view, mode);
+
+			ASSERT_EQ(expected.size(), result.size());
+			for(size_t i = 0; i < expected.size(); ++i) {
+				EXPECT_EQ(expected[i].name(*expected.db()),
+				          result[i].name(*result.db()));
+				if(std::isnan(expected[i].score())) {
+					EXPECT_TRUE(std::isnan(result[i].score()));
+				} else {
+					EXPECT_DOUBLE_EQ(expected[i].score(), result[i].score());
+				}
+			}
+		}
+	}
+}
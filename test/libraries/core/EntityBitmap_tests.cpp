@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/Category.h>
+#include <genetrail2/core/EntityBitmap.h>
+#include <genetrail2/core/EntityDatabase.h>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace GeneTrail;
+
+namespace
+{
+	std::vector<size_t> randomIds(std::mt19937& twister, size_t n, size_t max)
+	{
+		std::uniform_int_distribution<size_t> dist(0, max);
+		std::vector<size_t> result(n);
+		for(auto& id : result) {
+			id = dist(twister);
+		}
+		return result;
+	}
+
+	size_t naiveIntersection(const std::vector<size_t>& a,
+	                         const std::vector<size_t>& b)
+	{
+		std::set<size_t> sa(a.begin(), a.end());
+		std::set<size_t> sb(b.begin(), b.end());
+		std::vector<size_t> result;
+		std::set_intersection(sa.begin(), sa.end(), sb.begin(), sb.end(),
+		                      std::back_inserter(result));
+		return result.size();
+	}
+}
+
+TEST(EntityBitmap, empty)
+{
+	EntityBitmap bitmap;
+
+	EXPECT_TRUE(bitmap.empty());
+	EXPECT_EQ(0u, bitmap.size());
+	EXPECT_FALSE(bitmap.contains(0));
+	EXPECT_EQ(0u, bitmap.intersectionSize(bitmap));
+}
+
+TEST(EntityBitmap, contains)
+{
+	std::vector<size_t> ids{5, 3, 70000, 3, 1 << 20, 0};
+	EntityBitmap bitmap(ids.begin(), ids.end());
+
+	EXPECT_EQ(5u, bitmap.size());
+	EXPECT_TRUE(bitmap.contains(0));
+	EXPECT_TRUE(bitmap.contains(3));
+	EXPECT_TRUE(bitmap.contains(5));
+	EXPECT_TRUE(bitmap.contains(70000));
+	EXPECT_TRUE(bitmap.contains(1 << 20));
+	EXPECT_FALSE(bitmap.contains(1));
+	EXPECT_FALSE(bitmap.contains(4464));
+	EXPECT_FALSE(bitmap.contains(65536 + 5));
+}
+
+TEST(EntityBitmap, contains_dense)
+{
+	std::vector<size_t> ids;
+	for(size_t i = 0; i < 20000; i += 2) {
+		ids.push_back(i);
+	}
+
+	EntityBitmap bitmap(ids.begin(), ids.end());
+
+	EXPECT_EQ(10000u, bitmap.size());
+	for(size_t i = 0; i < 20010; ++i) {
+		EXPECT_EQ(i % 2 == 0 && i < 20000, bitmap.contains(i));
+	}
+}
+
+TEST(EntityBitmap, intersection_size)
+{
+	std::mt19937 twister(42);
+
+	// Cover all combinations of sparse and dense containers
+	std::vector<size_t> sizes{0, 10, 300, 5000, 60000};
+
+	for(size_t n : sizes) {
+		for(size_t m : sizes) {
+			auto a = randomIds(twister, n, 140000);
+			auto b = randomIds(twister, m, 140000);
+
+			EntityBitmap bitmap_a(a.begin(), a.end());
+			EntityBitmap bitmap_b(b.begin(), b.end());
+
+			const size_t expected = naiveIntersection(a, b);
+
+			EXPECT_EQ(expected, bitmap_a.intersectionSize(bitmap_b));
+			EXPECT_EQ(expected, bitmap_b.intersectionSize(bitmap_a));
+
+			std::sort(b.begin(), b.end());
+			b.erase(std::unique(b.begin(), b.end()), b.end());
+			EXPECT_EQ(expected, bitmap_a.intersectionSize(b.begin(), b.end()));
+		}
+	}
+}
+
+TEST(EntityBitmap, intersection_size_category)
+{
+	EntityDatabase db;
+	std::vector<std::string> names{"A", "B", "C", "D", "E"};
+	std::vector<std::string> other{"B", "D", "F"};
+
+	Category a(&db, names.begin(), names.end());
+	Category b(&db, other.begin(), other.end());
+
+	EntityBitmap bitmap(a);
+
+	EXPECT_EQ(5u, bitmap.size());
+	EXPECT_EQ(2u, bitmap.intersectionSize(b));
+	EXPECT_EQ(Category::intersect("", a, b).size(),
+	          bitmap.intersectionSize(EntityBitmap(b)));
+}
@@ -3,6 +3,7 @@
 #include <iterator>
 #include <vector>
 #include <iostream>
+#include <random>
 #include <genetrail2/core/MatrixNormalization.h>
 #include <genetrail2/core/DenseMatrix.h>
 #include <genetrail2/core/MatrixIterator.h>
@@ -996,4 +997,127 @@ TEST(MatrixNormalization, ZScore_double_matrix)
 	}
 
   
-}
\ No newline at end of file
+}
+
+/**
+ * normalizeRow must agree with normalizeValue for every entry of a row.
+ */
+template <typename Normalization, typename Generator>
+void checkNormalizeRow(const Normalization& norm, Generator gen, size_t n, double tolerance)
+{
+	std::mt19937 twister(7);
+	std::vector<double> values(n);
+	for(auto& v : values) {
+		v = gen(twister);
+	}
+
+	std::vector<double> normalized(n);
+	norm.normalizeRow(values.begin(), values.end(), normalized.begin());
+
+	for(size_t j = 0; j < n; ++j) {
+		EXPECT_NEAR(norm.normalizeValue(values.begin() + j, values.begin(), values.end()), normalized[j], tolerance);
+	}
+}
+
+TEST(MatrixNormalization, GaussKDE_normalizeRow)
+{
+	GaussEstimator gauss;
+
+	// Long-tailed data, so that many pairs fall outside of the kernel cutoff
+	std::lognormal_distribution<double> lognormal(0.0, 2.0);
+	checkNormalizeRow(gauss, lognormal, 500, 1e-6);
+
+	std::normal_distribution<double> normal(3.0, 1.0);
+	checkNormalizeRow(gauss, normal, 200, 1e-6);
+
+	// Many ties
+	std::poisson_distribution<int> poisson(2.0);
+	checkNormalizeRow(gauss, [&](std::mt19937& t) { return poisson(t); }, 100, 1e-6);
+}
+
+TEST(MatrixNormalization, GaussKDE_normalizeRow_grid)
+{
+	GaussEstimator gauss;
+
+	// Long rows are evaluated on the grid
+	std::normal_distribution<double> normal(3.0, 1.0);
+	checkNormalizeRow(gauss, normal, 2000, 1e-6);
+
+	std::lognormal_distribution<double> lognormal(0.0, 2.0);
+	checkNormalizeRow(gauss, lognormal, 2000, 1e-6);
+}
+
+TEST(MatrixNormalization, GaussKDE_kernelSums)
+{
+	std::mt19937 twister(3);
+	std::normal_distribution<double> normal(0.0, 4.0);
+
+	// Few values are summed directly, many on the grid
+	for(size_t n : {10, 3000}) {
+		std::vector<double> values(n);
+		for(auto& v : values) {
+			v = normal(twister);
+		}
+
+		std::vector<double> sums;
+		GaussEstimator::kernelSums(values, sums);
+		ASSERT_EQ(n, sums.size());
+
+		boost::math::normal dist;
+		for(size_t i = 0; i < n; i += 37) {
+			double expected = 0.0;
+			for(const double v : values) {
+				expected += cdf(dist, values[i] - v);
+			}
+			EXPECT_NEAR(expected, sums[i], 1e-6 * n);
+		}
+	}
+}
+
+TEST(MatrixNormalization, PoissonKDE_normalizeRow)
+{
+	PoissonEstimator poisson;
+
+	// Covers counts inside and outside of the precomputed table
+	std::negative_binomial_distribution<int> counts(1, 0.01);
+	checkNormalizeRow(poisson, [&](std::mt19937& t) { return counts(t); }, 300, 1e-12);
+}
+
+TEST(MatrixNormalization, ExclusiveZ_normalizeRow)
+{
+	ExclusiveZScore zscore;
+
+	std::normal_distribution<double> normal(100.0, 5.0);
+	checkNormalizeRow(zscore, normal, 100, 1e-9);
+}
+
+TEST(MatrixNormalization, ExclusiveZ_normalizeRow_outlier)
+{
+	ExclusiveZScore zscore;
+
+	// The outlier dominates the sum of squares of the row
+	std::mt19937 twister(11);
+	std::normal_distribution<double> normal(0.0, 1.0);
+	std::vector<double> values(20);
+	for(auto& v : values) {
+		v = normal(twister);
+	}
+	values[7] = 1e6;
+
+	// A row that is constant apart from the outlier
+	std::vector<double> constant(10, 2.0);
+	constant[3] = 1e6;
+
+	for(const auto& row : {values, constant}) {
+		std::vector<double> normalized(row);
+		// Normalize in place, as done by normalizeMatrix
+		zscore.normalizeRow(normalized.begin(), normalized.end(), normalized.begin());
+
+		for(size_t j = 0; j < row.size(); ++j) {
+			const double expected = zscore.normalizeValue(row.begin() + j, row.begin(), row.end());
+			EXPECT_NEAR(expected, normalized[j], 1e-4 * std::max(1.0, std::fabs(expected)));
+		}
+	}
+
+	EXPECT_GT(std::fabs(zscore.normalizeValue(values.begin() + 7, values.begin(), values.end())), 1e5);
+}
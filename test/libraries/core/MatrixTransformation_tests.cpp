@@ -243,6 +243,45 @@ TEST(MT, valuesToRanksInt)
 	}
 }
 
+TEST(MT, valuesToRanksLarge)
+{
+	const unsigned int num_rows = 300;
+	const unsigned int num_cols = 20;
+
+	DenseMatrix mat(num_rows, num_cols);
+	DenseMatrix expected(num_rows, num_cols);
+
+	// Values with many ties
+	for(unsigned int i = 0; i < num_rows; ++i) {
+		for(unsigned int j = 0; j < num_cols; ++j) {
+			mat(i, j) = (i * (j + 3)) % 97;
+			expected(i, j) = mat(i, j);
+		}
+	}
+
+	// Generic implementation working on the Matrix interface
+	valuesToRanks(static_cast<Matrix&>(expected));
+	valuesToRanks(mat, 4);
+
+	for(unsigned int j = 0; j < num_cols; ++j) {
+		std::vector<bool> seen(num_rows + 1, false);
+		for(unsigned int i = 0; i < num_rows; ++i) {
+			const size_t rank = mat(i, j);
+			ASSERT_GE(rank, 1u);
+			ASSERT_LE(rank, num_rows);
+			EXPECT_FALSE(seen[rank]);
+			seen[rank] = true;
+
+			// Ties may be broken differently, but the values must agree
+			for(unsigned int k = 0; k < num_rows; ++k) {
+				if(expected(k, j) == rank) {
+					EXPECT_EQ((i * (j + 3)) % 97, (k * (j + 3)) % 97);
+				}
+			}
+		}
+	}
+}
+
 TEST(MT, upweightEnds) 
 {
 	const unsigned int num_rows = 4;
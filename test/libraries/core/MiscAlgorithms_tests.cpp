@@ -2,6 +2,10 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
 #include <random>
 
 using namespace GeneTrail;
@@ -49,6 +53,64 @@ TEST_F(MiscAlgorithmsTest, testSortPermutation)
 	EXPECT_EQ(4u, permutation[5]);
 }
 
+TEST_F(MiscAlgorithmsTest, testSortPermutationDouble)
+{
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+	const double inf = std::numeric_limits<double>::infinity();
+	std::vector<double> data { 1.5, -0.0, nan, -inf, 0.0, -2.0, inf, 1.5 };
+
+	auto increasing = sort_permutation(data.data(), data.data() + data.size(), std::less<double>());
+	std::vector<size_t> expected_increasing { 3, 5, 1, 4, 0, 7, 6, 2 };
+	EXPECT_EQ(expected_increasing, increasing);
+
+	auto decreasing = sort_permutation(data.data(), data.data() + data.size(), std::greater<double>());
+	std::vector<size_t> expected_decreasing { 2, 6, 0, 7, 1, 4, 5, 3 };
+	EXPECT_EQ(expected_decreasing, decreasing);
+}
+
+TEST_F(MiscAlgorithmsTest, stressTestRadixSortPermutation)
+{
+	std::mt19937_64 rng(std::random_device{}());
+	std::normal_distribution<double> normal;
+
+	// The sizes cover the comparison sort, the sequential and the parallel
+	// radix sort.
+	for(size_t n : { 0, 1, 100, 5000, 60000, 300000 }) {
+		// Few distinct values produce many ties.
+		std::vector<double> scores(n);
+		for(auto& s : scores) {
+			s = std::round(normal(rng) * 100.0) / 10.0;
+		}
+
+		for(bool descending : { false, true }) {
+			std::vector<size_t> expected(n);
+			std::iota(expected.begin(), expected.end(), static_cast<size_t>(0));
+			std::stable_sort(expected.begin(), expected.end(), [&](size_t i, size_t j) {
+				return descending ? scores[i] > scores[j] : scores[i] < scores[j];
+			});
+
+			std::vector<size_t> perm;
+			radix_sort_permutation(perm, scores.data(), scores.data() + n, descending, 4);
+			EXPECT_EQ(expected, perm);
+		}
+
+		std::vector<size_t> indices(n);
+		for(auto& i : indices) {
+			i = rng() % 1000;
+		}
+
+		std::vector<size_t> expected(n);
+		std::iota(expected.begin(), expected.end(), static_cast<size_t>(0));
+		std::stable_sort(expected.begin(), expected.end(), [&](size_t i, size_t j) {
+			return indices[i] < indices[j];
+		});
+
+		std::vector<size_t> perm;
+		radix_sort_permutation(perm, indices.data(), indices.data() + n, false, 4);
+		EXPECT_EQ(expected, perm);
+	}
+}
+
 TEST_F(MiscAlgorithmsTest, testInvertPermutation)
 {
 	std::vector<size_t> perm { 0, 3, 4, 6, 7, 1, 8, 5, 9, 2 };
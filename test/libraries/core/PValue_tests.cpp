@@ -2,6 +2,10 @@
 
 #include <genetrail2/core/PValue.h>
 
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <random>
 #include<vector>
 
 using namespace GeneTrail;
@@ -211,3 +215,95 @@ TEST(PValue, Stouffer){
 	EXPECT_NEAR(f, 0.0, 0.0001);
 }
 
+
+std::vector<double> randomPValues(size_t n)
+{
+	// Rounding creates many ties
+	std::mt19937 gen(42);
+	std::uniform_real_distribution<double> dist(0.0, 0.01);
+	std::vector<double> result(n);
+	for(auto& p : result) {
+		p = std::round(dist(gen) * 1e4) / 1e4;
+	}
+	return result;
+}
+
+const MultipleTestingCorrection ALL_METHODS[] = {
+    MultipleTestingCorrection::Bonferroni,
+    MultipleTestingCorrection::Sidak,
+    MultipleTestingCorrection::Holm,
+    MultipleTestingCorrection::HolmSidak,
+    MultipleTestingCorrection::Finner,
+    MultipleTestingCorrection::BenjaminiHochberg,
+    MultipleTestingCorrection::BenjaminiYekutieli,
+    MultipleTestingCorrection::Hochberg,
+    MultipleTestingCorrection::Simes,
+    MultipleTestingCorrection::GSEA};
+
+TEST(PValue, AdjustPValuesInPlace){
+	const auto input = randomPValues(200000);
+
+	std::vector<std::pair<size_t, double>> indexed;
+	for(size_t i = 0; i < input.size(); ++i) {
+		indexed.emplace_back(i, input[i]);
+	}
+
+	const auto order = pvalue::sortPermutation(input.data(), input.size(), 4);
+	ASSERT_EQ(order.size(), input.size());
+	for(size_t i = 1; i < order.size(); ++i) {
+		ASSERT_LE(input[order[i - 1]], input[order[i]]);
+	}
+
+	for(auto method : ALL_METHODS) {
+		auto expected = pvalue::adjustPValues(indexed, pvalue::get_second(), method);
+
+		auto actual = input;
+		pvalue::adjustPValuesInPlace(actual.data(), actual.size(), method, 4);
+
+		auto reused = input;
+		pvalue::adjustPValuesInPlace(reused.data(), order, method, 3);
+
+		for(const auto& e : expected) {
+			ASSERT_EQ(e.second, actual[e.first]);
+			ASSERT_EQ(e.second, reused[e.first]);
+		}
+	}
+}
+
+TEST(PValue, AdjustPValuesInPlace_empty){
+	std::vector<double> empty;
+	pvalue::adjustPValuesInPlace(empty.data(), 0, MultipleTestingCorrection::BenjaminiHochberg);
+	EXPECT_TRUE(pvalue::sortPermutation(empty.data(), 0).empty());
+}
+
+TEST(PValue, AdjustPValuesFile){
+	namespace fs = boost::filesystem;
+	const std::string input_file = fs::unique_path().native();
+	const std::string output_file = fs::unique_path().native();
+
+	const auto input = randomPValues(10007);
+	{
+		std::ofstream out(input_file, std::ios::binary);
+		out.write(reinterpret_cast<const char*>(input.data()), input.size() * sizeof(double));
+	}
+
+	for(auto method : ALL_METHODS) {
+		auto expected = input;
+		pvalue::adjustPValuesInPlace(expected.data(), expected.size(), method, 1);
+
+		// Use more than one run and an incomplete last chunk. Smaller
+		// chunks need one and two additional merge passes.
+		for(size_t chunk_size : {1000, 100, 10}) {
+			pvalue::adjustPValuesFile(input_file, output_file, method, chunk_size, 2);
+
+			std::vector<double> actual(input.size());
+			std::ifstream in(output_file, std::ios::binary);
+			in.read(reinterpret_cast<char*>(actual.data()), actual.size() * sizeof(double));
+			ASSERT_TRUE(in);
+			EXPECT_EQ(expected, actual);
+		}
+	}
+
+	fs::remove(input_file);
+	fs::remove(output_file);
+}
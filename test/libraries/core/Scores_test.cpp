@@ -24,6 +24,7 @@
 #include <genetrail2/core/Scores.h>
 
 #include <memory>
+#include <vector>
 
 using namespace GeneTrail;
 
@@ -194,6 +195,29 @@ TEST_F(ScoresTest, subsetSorted)
 	EXPECT_FALSE(subset.contains("B"));
 }
 
+TEST_F(ScoresTest, subsetSortedMissingEntry)
+{
+	auto db = std::make_shared<EntityDatabase>();
+	Category c(db.get());
+
+	// X and H have a smaller index than B, but are not part of the scores
+	c.insert("A");
+	c.insert("X");
+	c.insert("H");
+
+	Scores scores(db);
+	scores.emplace_back("A", 1.1);
+	scores.emplace_back("B", 1.1);
+
+	ASSERT_TRUE(scores.isSortedByIndex());
+
+	Scores subset = scores.subset(c);
+
+	EXPECT_EQ(size_t(1), subset.size());
+	EXPECT_TRUE(subset.contains("A"));
+	EXPECT_FALSE(subset.contains("B"));
+}
+
 TEST_F(ScoresTest, subsetUnsorted)
 {
 	auto db = std::make_shared<EntityDatabase>();
@@ -222,3 +246,35 @@ TEST_F(ScoresTest, subsetUnsorted)
 	EXPECT_FALSE(subset.contains("H"));
 	EXPECT_FALSE(subset.contains("B"));
 }
+
+TEST_F(ScoresTest, sortByScore)
+{
+	auto db = std::make_shared<EntityDatabase>();
+	Scores scores(db);
+
+	scores.emplace_back("A", 1.0);
+	scores.emplace_back("B", -1.2);
+	scores.emplace_back("C", 1.0);
+	scores.emplace_back("D", 2.5);
+
+	const std::vector<size_t> increasing = {db->index("B"), db->index("A"),
+	                                        db->index("C"), db->index("D")};
+	const std::vector<size_t> decreasing(increasing.rbegin(), increasing.rend());
+
+	// Does not reorder the scores
+	EXPECT_EQ(increasing, scores.indicesSortedByScore(Order::Increasing));
+	EXPECT_EQ(decreasing, scores.indicesSortedByScore(Order::Decreasing));
+	EXPECT_TRUE(scores.isSortedByIndex());
+
+	scores.sortByScore(Order::Decreasing);
+	EXPECT_FALSE(scores.isSortedByIndex());
+	EXPECT_EQ(decreasing, std::vector<size_t>(scores.indices().begin(), scores.indices().end()));
+	EXPECT_EQ(2.5, scores[0].score());
+	EXPECT_EQ(1.0, scores[1].score());
+	EXPECT_EQ(1.0, scores[2].score());
+	EXPECT_EQ(-1.2, scores[3].score());
+
+	scores.sortByIndex();
+	EXPECT_EQ("A", scores.begin()->name(*db));
+	EXPECT_EQ(1.0, scores.begin()->score());
+}
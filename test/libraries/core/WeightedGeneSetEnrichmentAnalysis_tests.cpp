@@ -1,75 +1,275 @@
-#include <vector>
-#include <iostream>
-#include <utility>
-
 #include <gtest/gtest.h>
+
+#include <genetrail2/core/Category.h>
+#include <genetrail2/core/EntityDatabase.h>
+#include <genetrail2/core/Scores.h>
 #include <genetrail2/core/WeightedGeneSetEnrichmentAnalysis.h>
 
-#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
 
 using namespace GeneTrail;
 
 const double TOLERANCE = 0.00001;
 
-TEST(WeightedGeneSetEnrichmentAnalysis, runningSum) {
-	std::vector<std::string> names;
-	std::vector<double> values;
-	for(int i=7; i>0; --i){
-		names.emplace_back(boost::lexical_cast<std::string>(i));
-		values.emplace_back(i);
+class WeightedGeneSetEnrichmentAnalysisTest : public ::testing::Test
+{
+  public:
+	WeightedGeneSetEnrichmentAnalysisTest()
+	    : db_(std::make_shared<EntityDatabase>())
+	{
+	}
+
+	Scores scores(const std::vector<double>& values)
+	{
+		Scores result(db_);
+		for(size_t i = 0; i < values.size(); ++i) {
+			result.emplace_back("G" + std::to_string(i), values[i]);
+		}
+		return result;
+	}
+
+	/**
+	 * Random scores for the genes G0, ..., G(n-1), inserted in random
+	 * order such that the entity ids do not follow the score order.
+	 */
+	Scores randomScores(size_t n, std::mt19937& twister)
+	{
+		std::vector<size_t> genes(n);
+		for(size_t i = 0; i < n; ++i) {
+			genes[i] = i;
+		}
+		std::shuffle(genes.begin(), genes.end(), twister);
+
+		std::normal_distribution<double> normal;
+		Scores result(db_);
+		for(size_t gene : genes) {
+			result.emplace_back("G" + std::to_string(gene), normal(twister));
+		}
+		return result;
+	}
+
+  protected:
+	std::shared_ptr<EntityDatabase> db_;
+};
+
+TEST_F(WeightedGeneSetEnrichmentAnalysisTest, runningSum)
+{
+	WeightedGeneSetEnrichmentAnalysis<double> gsea(
+	    scores({7, 6, 5, 4, 3, 2, 1}), Order::Decreasing, true);
+
+	// Hits at 0, 1, 2, 6 with weights 7, 6, 5, 1 out of 19, the misses
+	// at 3, 4 and 5 subtract 1/3 each
+	std::vector<size_t> cat{0, 1, 2, 6};
+	auto result = gsea.computeRunningSum(cat.begin(), cat.end());
+	EXPECT_NEAR(18.0 / 19.0, std::get<0>(result), TOLERANCE);
+	EXPECT_NEAR(18.0 / 19.0 - 1.0 / 19.0, std::get<1>(result), TOLERANCE);
+}
+
+TEST_F(WeightedGeneSetEnrichmentAnalysisTest, runningSumNegative)
+{
+	WeightedGeneSetEnrichmentAnalysis<double> gsea(
+	    scores({5, 4, 3, 2, 1}), Order::Decreasing, true);
+
+	// Three misses before the only hit
+	std::vector<size_t> cat{3};
+	auto result = gsea.computeRunningSum(cat.begin(), cat.end());
+	EXPECT_NEAR(-0.75, std::get<0>(result), TOLERANCE);
+	EXPECT_NEAR(0.25 - 0.75, std::get<1>(result), TOLERANCE);
+}
+
+TEST_F(WeightedGeneSetEnrichmentAnalysisTest, runningSumCategory)
+{
+	WeightedGeneSetEnrichmentAnalysis<double> gsea(
+	    scores({1.0, -3.0, 2.0, 0.5, -1.0}), Order::Decreasing, false);
+
+	// Sorted: G2, G0, G3, G4, G1. G0 and G4 are at positions 1 and 3.
+	Category category(db_.get());
+	category.insert("G0");
+	category.insert("G4");
+	category.insert("Unknown");
+
+	std::vector<size_t> expected{1, 3};
+	EXPECT_EQ(expected, gsea.positions(category));
+
+	auto a = gsea.computeRunningSum(category);
+	auto b = gsea.computeRunningSum(expected.begin(), expected.end());
+	EXPECT_EQ(std::get<0>(b), std::get<0>(a));
+	EXPECT_EQ(std::get<1>(b), std::get<1>(a));
+}
+
+TEST_F(WeightedGeneSetEnrichmentAnalysisTest, positionsMatchIntersection)
+{
+	std::mt19937 twister(42);
+
+	for(Order order : {Order::Increasing, Order::Decreasing}) {
+		const Scores s = randomScores(500, twister);
+		WeightedGeneSetEnrichmentAnalysis<double> gsea(s, order, false);
+
+		Scores sorted(s);
+		sorted.sortByScore(order);
+
+		// Categories of different sizes, some members have no score
+		std::uniform_int_distribution<size_t> member(0, 599);
+		for(size_t size : {0, 1, 5, 50, 300, 1000}) {
+			Category category(db_.get());
+			for(size_t i = 0; i < size; ++i) {
+				category.insert("G" + std::to_string(member(twister)));
+			}
+
+			const auto positions = gsea.positions(category);
+			const auto expected = gsea.intersection(category, sorted);
+			EXPECT_EQ(expected, positions);
+
+			if(!expected.empty()) {
+				auto a = gsea.computeRunningSum(category);
+				auto b = gsea.computeRunningSum(expected.begin(), expected.end());
+				EXPECT_EQ(std::get<0>(b), std::get<0>(a));
+				EXPECT_EQ(std::get<1>(b), std::get<1>(a));
+			}
+		}
 	}
-	std::vector<size_t> cat;
-	cat.emplace_back(0);
-	cat.emplace_back(1);
-	cat.emplace_back(2);
-	cat.emplace_back(6);
-	WeightedGeneSetEnrichmentAnalysis<double> gsea;
-	EXPECT_NEAR(gsea.computeRunningSum(cat.begin(), cat.end()), 0.4166666666666, TOLERANCE);
 }
 
-TEST(WeightedGeneSetEnrichmentAnalysis, runningSum2) {
-	std::vector<std::string> names;
-	names.emplace_back("A");
-	names.emplace_back("B");
-	names.emplace_back("C");
-	names.emplace_back("D");
-	names.emplace_back("E");
-	std::vector<double> values{1.51210870, 0.90155071, -0.08425374, -0.42910173, -1.02161460};
-	std::vector<size_t> cat;
-	cat.emplace_back(1);
-	cat.emplace_back(2);
-	WeightedGeneSetEnrichmentAnalysis<double> gsea;
-	EXPECT_NEAR(gsea.computeRunningSum(cat.begin(), cat.end()), 0.66666666, TOLERANCE);
+TEST_F(WeightedGeneSetEnrichmentAnalysisTest, runningSumOfUnion)
+{
+	std::mt19937 twister(7);
+	const size_t n = 400;
+	WeightedGeneSetEnrichmentAnalysis<double> gsea(randomScores(n, twister),
+	                                               Order::Decreasing, false);
+
+	std::vector<size_t> all(n);
+	for(size_t i = 0; i < n; ++i) {
+		all[i] = i;
+	}
+
+	for(size_t sample_size : {0, 1, 20, 150}) {
+		for(size_t batch_size : {0, 1, 10, 100}) {
+			if(sample_size + batch_size == 0) {
+				continue;
+			}
+
+			// Disjoint sorted sample and batch
+			std::shuffle(all.begin(), all.end(), twister);
+			std::vector<size_t> sample(all.begin(), all.begin() + sample_size);
+			std::vector<size_t> batch(all.begin() + sample_size,
+			                          all.begin() + sample_size + batch_size);
+			std::sort(sample.begin(), sample.end());
+			std::sort(batch.begin(), batch.end());
+
+			double weight = gsea.sum(sample.begin(), sample.end());
+			std::vector<size_t> merged(sample_size + batch_size);
+			auto result =
+			    gsea.computeRunningSum(sample.begin(), sample.end(), batch.begin(),
+			                           batch.end(), merged.begin(), weight);
+
+			std::vector<size_t> expected;
+			std::merge(sample.begin(), sample.end(), batch.begin(), batch.end(),
+			           std::back_inserter(expected));
+			EXPECT_EQ(expected, merged);
+
+			auto reference = gsea.computeRunningSum(merged.begin(), merged.end());
+			EXPECT_NEAR(std::get<0>(reference), std::get<0>(result), 1e-12);
+			EXPECT_NEAR(std::get<1>(reference), std::get<1>(result), 1e-12);
+
+			// The carried weight is the weight of the union
+			EXPECT_NEAR(gsea.sum(merged.begin(), merged.end()), weight, 1e-12);
+		}
+	}
 }
 
-TEST(WeightedGeneSetEnrichmentAnalysis, runningSum3) {
-	std::vector<std::string> names;
-	names.emplace_back("A");
-	names.emplace_back("B");
-	names.emplace_back("C");
-	names.emplace_back("D");
-	names.emplace_back("E");
-	names.emplace_back("F");
-	names.emplace_back("G");
-	names.emplace_back("H");
-	names.emplace_back("I");
-	names.emplace_back("J");
-	std::vector<double> values;
-	values.emplace_back(1.88024972);
-	values.emplace_back(1.40113722);
-	values.emplace_back(1.29404826);
-	values.emplace_back(1.04311852);
-	values.emplace_back(0.97672805);
-	values.emplace_back(0.09449559);
-	values.emplace_back(-0.12832204);
-	values.emplace_back(-0.19743087);
-	values.emplace_back(-0.41267957);
-	values.emplace_back(-0.52441915);
-	std::vector<size_t> cat;
-	cat.emplace_back(1);
-	cat.emplace_back(2);
-	cat.emplace_back(4);
-	cat.emplace_back(7);
-	WeightedGeneSetEnrichmentAnalysis<double> gsea;
-	EXPECT_NEAR(gsea.computeRunningSum(cat.begin(), cat.end()), 0.6156423, TOLERANCE);
+TEST_F(WeightedGeneSetEnrichmentAnalysisTest, runningSumOfUnionCarriesWeight)
+{
+	WeightedGeneSetEnrichmentAnalysis<double> gsea(
+	    scores({7, 6, 5, 4, 3, 2, 1}), Order::Decreasing, true);
+
+	// Extending the sample twice yields the same as computing the running
+	// sum of the final sample from scratch
+	std::vector<size_t> sample{1};
+	std::vector<size_t> first{0, 6};
+	std::vector<size_t> second{2};
+
+	double weight = 6.0;
+	std::vector<size_t> merged(3);
+	gsea.computeRunningSum(sample.begin(), sample.end(), first.begin(),
+	                       first.end(), merged.begin(), weight);
+	EXPECT_EQ((std::vector<size_t>{0, 1, 6}), merged);
+	EXPECT_DOUBLE_EQ(14.0, weight);
+
+	std::vector<size_t> final_sample(4);
+	auto result =
+	    gsea.computeRunningSum(merged.begin(), merged.end(), second.begin(),
+	                           second.end(), final_sample.begin(), weight);
+	EXPECT_EQ((std::vector<size_t>{0, 1, 2, 6}), final_sample);
+	EXPECT_DOUBLE_EQ(19.0, weight);
+	EXPECT_NEAR(18.0 / 19.0, std::get<0>(result), TOLERANCE);
+	EXPECT_NEAR(18.0 / 19.0 - 1.0 / 19.0, std::get<1>(result), TOLERANCE);
+}
+
+TEST_F(WeightedGeneSetEnrichmentAnalysisTest, setScores)
+{
+	std::mt19937 twister(3);
+	WeightedGeneSetEnrichmentAnalysis<double> gsea(randomScores(100, twister),
+	                                               Order::Decreasing, false);
+
+	std::uniform_int_distribution<size_t> member(0, 299);
+	for(Order order : {Order::Increasing, Order::Decreasing}) {
+		// Replace the scores by scores of a different size and order
+		for(size_t n : {300, 50}) {
+			const Scores s = randomScores(n, twister);
+			gsea.setScores(s, order);
+
+			Scores sorted(s);
+			sorted.sortByScore(order);
+			WeightedGeneSetEnrichmentAnalysis<double> expected(sorted, order, true);
+
+			for(size_t size : {1, 10, 100}) {
+				Category category(db_.get());
+				for(size_t i = 0; i < size; ++i) {
+					category.insert("G" + std::to_string(member(twister)));
+				}
+
+				const auto positions = expected.positions(category);
+				EXPECT_EQ(positions, gsea.positions(category));
+				EXPECT_EQ(expected.sum(positions.begin(), positions.end()),
+				          gsea.sum(positions.begin(), positions.end()));
+
+				auto a = expected.computeRunningSum(category);
+				auto b = gsea.computeRunningSum(category);
+				EXPECT_EQ(std::get<0>(a), std::get<0>(b));
+				EXPECT_EQ(std::get<1>(a), std::get<1>(b));
+			}
+		}
+	}
+}
+
+TEST_F(WeightedGeneSetEnrichmentAnalysisTest, setScoresWithDuplicateIdentifiers)
+{
+	WeightedGeneSetEnrichmentAnalysis<double> gsea(
+	    scores({100.0, 200.0, 300.0, 400.0}), Order::Decreasing, false);
+
+	Scores s(db_);
+	s.emplace_back("G0", 1.0);
+	s.emplace_back("G1", 4.0);
+	s.emplace_back("G0", 3.0);
+	s.emplace_back("G2", 2.0);
+	gsea.setScores(s, Order::Decreasing);
+
+	Scores sorted(s);
+	sorted.sortByScore(Order::Decreasing);
+	WeightedGeneSetEnrichmentAnalysis<double> expected(sorted, Order::Decreasing, true);
+
+	const std::vector<size_t> all{0, 1, 2, 3};
+	EXPECT_DOUBLE_EQ(10.0, gsea.sum(all.begin(), all.end()));
+	EXPECT_DOUBLE_EQ(expected.sum(all.begin(), all.end()),
+	                 gsea.sum(all.begin(), all.end()));
+
+	Category category(db_.get());
+	category.insert("G0");
+	EXPECT_EQ(expected.positions(category), gsea.positions(category));
 }
@@ -1,11 +1,14 @@
 #include <gtest/gtest.h>
 
+#include <genetrail2/core/EntityDatabase.h>
 #include <genetrail2/core/WilcoxonRankSumTest.h>
 
 #include <initializer_list>
 #include <vector>
 #include <cmath>
 #include <algorithm>
+#include <numeric>
+#include <string>
 
 using namespace GeneTrail;
 
@@ -36,4 +39,66 @@ TEST(WilcoxonRankSumTest, Simple2)
 {
 	WilcoxonRankSumTest<double> test;
     EXPECT_NEAR(test.test(a2.begin(), a2.end(), b2.begin(), b2.end()), test.computeZScore_(25, 3, 7), TOLERANCE);
-}
\ No newline at end of file
+}
+
+TEST(WilcoxonRankSumTest, RankedList)
+{
+	WilcoxonRankSumTest<double> test;
+	std::vector<size_t> list(10);
+	std::iota(list.begin(), list.end(), 0);
+	test.rank(list.begin(), list.end());
+	EXPECT_NEAR(test.test_ranked(a.begin(), a.end()), test.computeZScore_(25, 3, 7), TOLERANCE);
+	EXPECT_TRUE(test.enriched());
+}
+
+TEST(WilcoxonRankSumTest, RankedScores)
+{
+	WilcoxonRankSumTest<double> test;
+	Scores scores(std::make_shared<EntityDatabase>());
+	std::vector<size_t> first;
+	for(size_t i = 0; i < a2.size(); ++i) {
+		scores.emplace_back("A" + std::to_string(i), a2[i]);
+		first.push_back(scores[i].index());
+	}
+	for(size_t i = 0; i < b2.size(); ++i) {
+		scores.emplace_back("B" + std::to_string(i), b2[i]);
+	}
+	// Unknown entities are ignored
+	first.push_back(1000);
+
+	test.rank(scores);
+	EXPECT_NEAR(test.test_ranked(first.begin(), first.end()), test.test(a2.begin(), a2.end(), b2.begin(), b2.end()), TOLERANCE);
+}
+
+TEST(WilcoxonRankSumTest, RankedScoresWithTies)
+{
+	WilcoxonRankSumTest<double> test;
+	Scores scores(std::make_shared<EntityDatabase>());
+	scores.emplace_back("A", 1.0);
+	scores.emplace_back("B", 2.0);
+	scores.emplace_back("C", 2.0);
+	scores.emplace_back("D", 3.0);
+
+	// Ranks 2.5 and 4, one tie of size two
+	std::vector<size_t> first = {scores[1].index(), scores[3].index()};
+
+	test.rank(scores);
+	EXPECT_NEAR(test.test_ranked(first.begin(), first.end()), std::sqrt(1.5), TOLERANCE);
+}
+
+TEST(WilcoxonRankSumTest, RankedScoresAllTied)
+{
+	WilcoxonRankSumTest<double> test;
+	Scores scores(std::make_shared<EntityDatabase>());
+	for(size_t i = 0; i < 5; ++i) {
+		scores.emplace_back("E" + std::to_string(i), 1.0);
+	}
+
+	std::vector<size_t> first = {scores[0].index(), scores[2].index()};
+
+	test.rank(scores);
+	const double score = test.test_ranked(first.begin(), first.end());
+	EXPECT_FALSE(std::isnan(score));
+	EXPECT_EQ(0.0, score);
+	EXPECT_FALSE(test.enriched());
+}
@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/Exception.h>
+
+#include <genetrail2/enrichment/EnrichmentService.h>
+
+#include <config.h>
+
+#include <rapidjson/document.h>
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace GeneTrail;
+
+/**
+ * The expected tables were written by the ora and gsea tools for the same
+ * fixture with "-a benjamini_hochberg". The test and reference sets
+ * contain identifiers that are not member of any category.
+ */
+class EnrichmentServiceTest : public ::testing::Test
+{
+  public:
+	EnrichmentServiceTest()
+	{
+		service_.preload("db", TEST_DATA_PATH("EnrichmentService_categories.gmt"));
+	}
+
+	static std::string read(const std::string& path)
+	{
+		std::ifstream input(path);
+		std::stringstream buffer;
+		buffer << input.rdbuf();
+		return buffer.str();
+	}
+
+	static std::vector<std::string> readLines(const std::string& path)
+	{
+		std::ifstream input(path);
+		std::vector<std::string> result;
+		for(std::string line; std::getline(input, line);) {
+			result.push_back(line);
+		}
+		return result;
+	}
+
+	static std::string identifiers(const std::string& path)
+	{
+		std::string result = "[";
+		for(const auto& line : readLines(path)) {
+			result += (result.size() > 1 ? ",\"" : "\"") + line + "\"";
+		}
+		return result + "]";
+	}
+
+	static std::string scores(const std::string& path)
+	{
+		std::string result = "[";
+		for(const auto& line : readLines(path)) {
+			const auto tab = line.find('\t');
+			result += (result.size() > 1 ? ",[\"" : "[\"") +
+			          line.substr(0, tab) + "\"," + line.substr(tab + 1) + "]";
+		}
+		return result + "]";
+	}
+
+	rapidjson::Document handle(const std::string& request)
+	{
+		rapidjson::Document response;
+		response.Parse(service_.handle(request).c_str());
+		EXPECT_FALSE(response.HasParseError());
+		EXPECT_TRUE(response.IsObject());
+		return response;
+	}
+
+	void expectError(const std::string& request, const std::string& message)
+	{
+		auto response = handle(request);
+		EXPECT_STREQ("error", response["status"].GetString()) << request;
+		EXPECT_EQ(message, response["message"].GetString()) << request;
+		EXPECT_FALSE(response.HasMember("results")) << request;
+	}
+
+  protected:
+	EnrichmentService service_;
+};
+
+TEST_F(EnrichmentServiceTest, OraMatchesCommandLine)
+{
+	auto response = handle(
+	    "{\"method\": \"ora\", \"adjustment\": \"benjamini_hochberg\", "
+	    "\"identifiers\": " +
+	    identifiers(TEST_DATA_PATH("EnrichmentService_identifiers.txt")) +
+	    ", \"reference\": " +
+	    identifiers(TEST_DATA_PATH("EnrichmentService_reference.txt")) + "}");
+
+	ASSERT_STREQ("ok", response["status"].GetString());
+	ASSERT_EQ(1u, response["results"].MemberCount());
+	EXPECT_EQ(read(TEST_DATA_PATH("EnrichmentService_ora.txt")),
+	          response["results"]["db"].GetString());
+}
+
+TEST_F(EnrichmentServiceTest, GseaMatchesCommandLine)
+{
+	const std::string request =
+	    "{\"method\": \"gsea\", \"adjustment\": \"benjamini_hochberg\", "
+	    "\"scores\": " +
+	    scores(TEST_DATA_PATH("EnrichmentService_scores.txt")) + "}";
+
+	auto response = handle(request);
+	ASSERT_STREQ("ok", response["status"].GetString());
+	EXPECT_EQ(read(TEST_DATA_PATH("EnrichmentService_gsea.txt")),
+	          response["results"]["db"].GetString());
+
+	// Identifiers of earlier requests do not change the result
+	auto again = handle(request);
+	EXPECT_STREQ(response["results"]["db"].GetString(),
+	             again["results"]["db"].GetString());
+}
+
+TEST_F(EnrichmentServiceTest, SelectsPreloadedDatabases)
+{
+	service_.preload("other", TEST_DATA_PATH("EnrichmentService_categories.gmt"));
+	EXPECT_EQ(2u, service_.numberOfDatabases());
+
+	const std::string request = "{\"method\": \"gsea\", \"scores\": " +
+	                            scores(TEST_DATA_PATH("EnrichmentService_scores.txt"));
+
+	auto all = handle(request + "}");
+	ASSERT_STREQ("ok", all["status"].GetString());
+	EXPECT_EQ(2u, all["results"].MemberCount());
+
+	auto other = handle(request + ", \"categories\": [\"other\"]}");
+	ASSERT_STREQ("ok", other["status"].GetString());
+	ASSERT_EQ(1u, other["results"].MemberCount());
+	EXPECT_STREQ(all["results"]["other"].GetString(),
+	             other["results"]["other"].GetString());
+
+	expectError(request + ", \"categories\": [\"other\", \"missing\"]}",
+	            "Unknown category database 'missing'.");
+	expectError(request + ", \"categories\": {\"db\": \"/tmp/db.gmt\"}}",
+	            "Member 'categories' must be an array of database names.");
+}
+
+TEST_F(EnrichmentServiceTest, Preload)
+{
+	EXPECT_THROW(service_.preload("db", TEST_DATA_PATH("EnrichmentService_categories.gmt")),
+	             std::invalid_argument);
+	EXPECT_THROW(service_.preload("missing", TEST_DATA_PATH("missing.gmt")),
+	             IOError);
+	EXPECT_EQ(1u, service_.numberOfDatabases());
+}
+
+TEST_F(EnrichmentServiceTest, RequestErrors)
+{
+	expectError("", "The request is not a JSON object.");
+	expectError("{\"method\": \"gsea\"", "The request is not a JSON object.");
+	expectError("[1, 2]", "The request is not a JSON object.");
+
+	expectError("{\"method\": \"gsea\"}", "No test set specified.");
+	expectError("{\"method\": \"foo\", \"identifiers\": [\"G01\"]}",
+	            "Unknown method 'foo'.");
+	expectError("{\"method\": \"ora\", \"identifiers\": [\"G01\"]}",
+	            "No reference set specified.");
+	expectError("{\"method\": \"gsea\", \"scores\": [[\"G01\", 1]], "
+	            "\"identifiers\": [\"G01\"]}",
+	            "Only one of scores and identifiers may be given.");
+
+	expectError("{\"method\": \"gsea\", \"scores\": [[\"G01\"]]}",
+	            "Member 'scores' must be an array of [identifier, score] pairs.");
+	expectError("{\"method\": \"gsea\", \"scores\": {\"G01\": 1}}",
+	            "Member 'scores' must be an array.");
+	expectError("{\"method\": \"ora\", \"identifiers\": [1]}",
+	            "Member 'identifiers' must be an array of identifiers.");
+	expectError("{\"method\": 1, \"identifiers\": [\"G01\"]}",
+	            "Member 'method' must be a string.");
+	expectError("{\"method\": \"gsea\", \"scores\": [[\"G01\", 1]], \"minimum\": -1}",
+	            "Member 'minimum' must be a non-negative integer.");
+	expectError("{\"method\": \"gsea\", \"scores\": [[\"G01\", 1]], \"absolute\": 1}",
+	            "Member 'absolute' must be a boolean.");
+	expectError("{\"method\": \"gsea\", \"scores\": [[\"G01\", 1]], "
+	            "\"adjustment\": \"foo\"}",
+	            "Unknown adjustment method 'foo'.");
+	expectError("{\"method\": \"ora\", \"identifiers\": [\"G01\"], "
+	            "\"reference\": [\"G01\"], \"hypothesis\": \"upper\"}",
+	            "Unknown hypothesis 'upper'.");
+	expectError("{\"method\": \"gsea\", \"scores\": [[\"G01\", 1]], "
+	            "\"just_scores\": true, \"just_pvalues\": true}",
+	            "just_scores and just_pvalues can not be applied together.");
+
+	// Members that named files on the server are not supported
+	expectError("{\"method\": \"gsea\", \"scores_file\": \"/etc/passwd\"}",
+	            "No test set specified.");
+}
@@ -0,0 +1,266 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/Category.h>
+#include <genetrail2/core/CategoryDatabase.h>
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/EntityDatabase.h>
+
+#include <genetrail2/enrichment/EnrichmentResult.h>
+#include <genetrail2/enrichment/HotellingEnrichment.h>
+
+#include <Eigen/Dense>
+
+#include <boost/math/distributions/fisher_f.hpp>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace GeneTrail;
+
+const double TOLERANCE = 1e-10;
+
+class HotellingEnrichmentTest : public ::testing::Test
+{
+  public:
+	HotellingEnrichmentTest()
+	    : db_(std::make_shared<EntityDatabase>()),
+	      genes_({"G1", "G2", "G3", "G4", "G5", "G6"}),
+	      control_(rowNames(8, "C"), genes_),
+	      sample_(rowNames(7, "S"), genes_)
+	{
+		std::mt19937 twister(42);
+		std::normal_distribution<double> normal;
+		fill(control_, twister, normal, 0.0);
+		fill(sample_, twister, normal, 0.5);
+	}
+
+	Category category(const std::vector<std::string>& names)
+	{
+		Category c(db_.get());
+		for(const auto& name : names) {
+			c.insert(name);
+		}
+		return c;
+	}
+
+	/**
+	 * T^2 as computed by the hotelling tool before it was moved into the
+	 * library: the pooled covariance matrix is inverted via its eigen
+	 * decomposition, ignoring eigenvalues with an absolute value < 0.01.
+	 */
+	double referenceT2(const std::vector<std::string>& names)
+	{
+		const auto n_a = control_.rows();
+		const auto n_b = sample_.rows();
+		const auto p = names.size();
+
+		Eigen::MatrixXd c = control_.matrix();
+		Eigen::MatrixXd s = sample_.matrix();
+		Eigen::RowVectorXd cm = c.colwise().mean();
+		Eigen::RowVectorXd sm = s.colwise().mean();
+		c.rowwise() -= cm;
+		s.rowwise() -= sm;
+		Eigen::RowVectorXd diff = cm - sm;
+
+		std::vector<size_t> indices;
+		for(const auto& name : names) {
+			indices.push_back(control_.colIndex(name));
+		}
+
+		Eigen::MatrixXd cov(p, p);
+		for(size_t i = 0; i < p; ++i) {
+			for(size_t j = 0; j < p; ++j) {
+				cov(i, j) = (c.col(indices[i]).dot(c.col(indices[j])) +
+				             s.col(indices[i]).dot(s.col(indices[j]))) /
+				            (n_a + n_b - 2);
+			}
+		}
+
+		Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(cov);
+		Eigen::VectorXd values = solver.eigenvalues();
+		for(int i = 0; i < values.rows(); ++i) {
+			values[i] = std::fabs(values[i]) < 0.01 ? 0.0 : (1.0 / values[i]);
+		}
+		cov = solver.eigenvectors() * values.asDiagonal() *
+		      solver.eigenvectors().transpose();
+
+		double result = 0.0;
+		for(size_t i = 0; i < p; ++i) {
+			for(size_t j = 0; j < p; ++j) {
+				result += cov(i, j) * diff[indices[i]] * diff[indices[j]];
+			}
+		}
+
+		return result * n_a * n_b / (n_a + n_b);
+	}
+
+	double referencePValue(double t2, size_t p)
+	{
+		const double n = control_.rows() + sample_.rows();
+		const double df = n - p - 1;
+		boost::math::fisher_f F(p, df);
+		return boost::math::cdf(
+		    boost::math::complement(F, t2 * df / ((n - 2) * p)));
+	}
+
+  protected:
+	static std::vector<std::string> rowNames(size_t n, const std::string& prefix)
+	{
+		std::vector<std::string> names;
+		for(size_t i = 0; i < n; ++i) {
+			names.push_back(prefix + std::to_string(i));
+		}
+		return names;
+	}
+
+	static void fill(DenseMatrix& m, std::mt19937& twister,
+	                 std::normal_distribution<double>& normal, double shift)
+	{
+		for(size_t i = 0; i < m.rows(); ++i) {
+			for(size_t j = 0; j < 5; ++j) {
+				m.set(i, j, normal(twister) + shift * j);
+			}
+			// G6 is collinear with G1, the covariance matrix of
+			// categories containing both is singular.
+			m.set(i, 5, 2.0 * m(i, 0));
+		}
+	}
+
+	std::shared_ptr<EntityDatabase> db_;
+	std::vector<std::string> genes_;
+	DenseMatrix control_;
+	DenseMatrix sample_;
+};
+
+TEST_F(HotellingEnrichmentTest, MatchesPseudoInverseByDefault)
+{
+	HotellingEnrichment hotelling(control_, sample_);
+
+	for(const auto& names :
+	    {std::vector<std::string>{"G2"}, {"G1", "G2", "G3"},
+	     {"G1", "G2", "G3", "G4", "G5"}, {"G1", "G4", "G6"}}) {
+		const auto result = hotelling.compute(category(names));
+		const double t2 = referenceT2(names);
+
+		EXPECT_EQ(names.size(), result.genes);
+		EXPECT_NEAR(t2, result.t2, TOLERANCE * t2);
+		EXPECT_NEAR(referencePValue(t2, names.size()), result.pvalue, TOLERANCE);
+	}
+}
+
+TEST_F(HotellingEnrichmentTest, SingleGene)
+{
+	HotellingEnrichment hotelling(control_, sample_);
+	const auto result = hotelling.compute(category({"G4"}));
+
+	// For a single gene, T^2 is the square of Student's t statistic
+	const auto c = control_.matrix().col(3);
+	const auto s = sample_.matrix().col(3);
+	const double n_a = c.size(), n_b = s.size();
+	const double var = ((c.array() - c.mean()).square().sum() +
+	                    (s.array() - s.mean()).square().sum()) /
+	                   (n_a + n_b - 2);
+	const double t = (c.mean() - s.mean()) / std::sqrt(var * (1 / n_a + 1 / n_b));
+
+	EXPECT_NEAR(t * t, result.t2, TOLERANCE);
+}
+
+TEST_F(HotellingEnrichmentTest, Shrinkage)
+{
+	const double shrinkage = 0.25;
+	HotellingEnrichment hotelling(control_, sample_, shrinkage);
+
+	const std::vector<std::string> names{"G1", "G3", "G6"};
+	const auto result = hotelling.compute(category(names));
+
+	Eigen::MatrixXd data(control_.rows() + sample_.rows(), names.size());
+	Eigen::VectorXd diff(names.size());
+	for(size_t i = 0; i < names.size(); ++i) {
+		const auto j = control_.colIndex(names[i]);
+		Eigen::VectorXd c = control_.matrix().col(j);
+		Eigen::VectorXd s = sample_.matrix().col(j);
+		diff[i] = c.mean() - s.mean();
+		data.col(i) << (c.array() - c.mean()).matrix(), (s.array() - s.mean()).matrix();
+	}
+
+	const double n_a = control_.rows(), n_b = sample_.rows();
+	Eigen::MatrixXd cov = data.transpose() * data / (n_a + n_b - 2);
+	Eigen::MatrixXd shrunken = (1 - shrinkage) * cov;
+	shrunken.diagonal() = cov.diagonal();
+
+	const double t2 = diff.dot(shrunken.inverse() * diff) * n_a * n_b / (n_a + n_b);
+	EXPECT_NEAR(t2, result.t2, TOLERANCE * t2);
+	EXPECT_NEAR(referencePValue(t2, names.size()), result.pvalue, TOLERANCE);
+}
+
+TEST_F(HotellingEnrichmentTest, InvalidCategories)
+{
+	HotellingEnrichment hotelling(control_, sample_);
+
+	// Unknown genes are ignored
+	auto result = hotelling.compute(category({"G2", "Unknown"}));
+	EXPECT_EQ(1u, result.genes);
+	EXPECT_FALSE(std::isnan(result.pvalue));
+
+	result = hotelling.compute(category({"Unknown"}));
+	EXPECT_EQ(0u, result.genes);
+	EXPECT_TRUE(std::isnan(result.pvalue));
+	EXPECT_FALSE(hotelling.canUseCategory(category({"Unknown"}), 0));
+	EXPECT_TRUE(hotelling.canUseCategory(category({"G1"}), 0));
+
+	EXPECT_THROW(HotellingEnrichment(control_, sample_, 1.5), std::invalid_argument);
+}
+
+TEST_F(HotellingEnrichmentTest, Database)
+{
+	HotellingEnrichment hotelling(control_, sample_);
+
+	CategoryDatabase categories(db_);
+	for(const auto& names : {std::vector<std::string>{"G1", "G2"},
+	                         {"G3", "G4", "G5"},
+	                         {"G2", "G1"},
+	                         {"Unknown"}}) {
+		auto& c = categories.addCategory();
+		for(const auto& name : names) {
+			c.insert(name);
+		}
+	}
+
+	const auto results = hotelling.compute(categories, 3);
+	ASSERT_EQ(4u, results.size());
+	for(size_t i = 0; i < 3; ++i) {
+		const auto expected = HotellingEnrichment(control_, sample_).compute(categories[i]);
+		EXPECT_EQ(expected.t2, results[i].t2);
+		EXPECT_EQ(expected.pvalue, results[i].pvalue);
+	}
+
+	// Categories with identical members share their result
+	EXPECT_EQ(results[0].t2, results[2].t2);
+	EXPECT_TRUE(std::isnan(results[3].t2));
+}
+
+TEST_F(HotellingEnrichmentTest, ScoreAndPValue)
+{
+	HotellingEnrichment hotelling(control_, sample_);
+
+	auto c = std::make_shared<Category>(category({"G1", "G2", "G5"}));
+	const auto expected = hotelling.compute(*c);
+
+	EnrichmentResult result(c);
+	result.score = std::get<0>(hotelling.computeScore(*c));
+	EXPECT_EQ(expected.t2, result.score);
+	EXPECT_EQ(expected.pvalue, hotelling.computeRowWisePValue(&result));
+
+	// The p-value only depends on the result, not on the category that
+	// was scored last
+	auto other = std::make_shared<Category>(category({"G3"}));
+	EnrichmentResult other_result(other);
+	other_result.score = std::get<0>(hotelling.computeScore(*other));
+	hotelling.computeScore(*c);
+	EXPECT_EQ(hotelling.compute(*other).pvalue,
+	          hotelling.computeRowWisePValue(&other_result));
+	EXPECT_EQ(expected.pvalue, hotelling.computeRowWisePValue(&result));
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/OverRepresentationAnalysis.h>
+
+#include <genetrail2/enrichment/SetLevelStatistics.h>
+
+#include <thread>
+#include <vector>
+
+using namespace GeneTrail;
+
+TEST(OraPValueCache, ComputesPValues)
+{
+	OraPValueCache cache;
+	OverRepresentationAnalysis test(1000, 100, true);
+
+	for(size_t l = 0; l < 30; l += 3) {
+		for(size_t k = 0; k <= l; ++k) {
+			EXPECT_EQ(test.computePValue(l, k), cache.pValue(test, TWO_SIDED, l, k));
+			EXPECT_EQ(test.computeUpperTailedPValue(l, k), cache.pValue(test, UPPER_TAILED, l, k));
+			EXPECT_EQ(test.computeLowerTailedPValue(l, k), cache.pValue(test, LOWER_TAILED, l, k));
+		}
+	}
+
+	// Entries of a different test are not reused
+	OverRepresentationAnalysis fisher(1000, 100, false);
+	EXPECT_EQ(fisher.computePValue(20, 7), cache.pValue(fisher, TWO_SIDED, 20, 7));
+}
+
+TEST(OraPValueCache, PrecomputedPValuesTakePrecedence)
+{
+	DenseMatrix precomputed(3, 4);
+	for(size_t l = 0; l < 3; ++l) {
+		for(size_t k = 0; k < 4; ++k) {
+			precomputed.set(l, k, 0.1 * l + 0.01 * k);
+		}
+	}
+
+	OraPValueCache cache(precomputed);
+	OverRepresentationAnalysis test(1000, 100, true);
+
+	// The matrix is used regardless of the requested hypothesis
+	EXPECT_DOUBLE_EQ(0.23, cache.pValue(test, TWO_SIDED, 2, 3));
+	EXPECT_DOUBLE_EQ(0.23, cache.pValue(test, UPPER_TAILED, 2, 3));
+	EXPECT_DOUBLE_EQ(0.01, cache.pValue(test, LOWER_TAILED, 0, 1));
+
+	// Pairs outside of the matrix are computed
+	EXPECT_EQ(test.computePValue(3, 1), cache.pValue(test, TWO_SIDED, 3, 1));
+	EXPECT_EQ(test.computePValue(2, 4), cache.pValue(test, TWO_SIDED, 2, 4));
+}
+
+TEST(OraPValueCache, Concurrent)
+{
+	OraPValueCache cache;
+	OverRepresentationAnalysis test(1000, 100, true);
+
+	std::vector<std::vector<double>> results(4);
+	std::vector<std::thread> threads;
+	for(size_t t = 0; t < results.size(); ++t) {
+		threads.emplace_back([&, t]() {
+			for(size_t l = 0; l < 60; ++l) {
+				results[t].push_back(cache.pValue(test, UPPER_TAILED, l, l / 4));
+			}
+		});
+	}
+	for(auto& thread : threads) {
+		thread.join();
+	}
+
+	for(size_t l = 0; l < 60; ++l) {
+		const double expected = test.computeUpperTailedPValue(l, l / 4);
+		for(const auto& result : results) {
+			EXPECT_EQ(expected, result[l]);
+		}
+	}
+}
+
+TEST(OraPValueCache, Bounded)
+{
+	// 4 entries per shard
+	OraPValueCache cache(256);
+
+	// Every test set size yields new entries
+	for(size_t n = 100; n < 112; ++n) {
+		OverRepresentationAnalysis test(1000, n, true);
+		for(size_t l = 0; l < 30; ++l) {
+			EXPECT_EQ(test.computePValue(l, l / 3), cache.pValue(test, TWO_SIDED, l, l / 3));
+		}
+		EXPECT_LE(cache.size(), 256u);
+	}
+	EXPECT_GT(cache.size(), 0u);
+
+	// Evicted entries are computed again
+	OverRepresentationAnalysis test(1000, 100, true);
+	for(size_t l = 0; l < 30; ++l) {
+		EXPECT_EQ(test.computePValue(l, l / 3), cache.pValue(test, TWO_SIDED, l, l / 3));
+	}
+	EXPECT_LE(cache.size(), 256u);
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/EntityDatabase.h>
+#include <genetrail2/core/Scores.h>
+
+#include <genetrail2/enrichment/PermutationTest.h>
+
+#include <memory>
+#include <vector>
+
+using namespace GeneTrail;
+
+/**
+ * Exposes the lookup table that maps the index of a gene to its position
+ * in the permuted score list.
+ */
+class LookupTable : public ColumnPermutationBase<double>
+{
+  public:
+	explicit LookupTable(const EntityDatabase* db)
+	    : ColumnPermutationBase<double>(DenseMatrix(0, 0), 0, 0,
+	                                    MatrixHTests::IndependentTTest, 0, db)
+	{
+	}
+
+	std::vector<size_t> positions(Scores scores, Order order)
+	{
+		this->updateLookupTables_(EnrichmentResults(), scores, order);
+		return this->inv_permutation_;
+	}
+};
+
+class PermutationTestTest : public ::testing::Test
+{
+  public:
+	PermutationTestTest() : db_(std::make_shared<EntityDatabase>()), scores_(db_)
+	{
+		scores_.emplace_back("A", 3.0);
+		scores_.emplace_back("B", 1.0);
+		scores_.emplace_back("C", 4.0);
+		scores_.emplace_back("D", 2.0);
+	}
+
+  protected:
+	std::shared_ptr<EntityDatabase> db_;
+	Scores scores_;
+};
+
+TEST_F(PermutationTestTest, LookupTableIncreasing)
+{
+	LookupTable table(db_.get());
+
+	// The smallest score is at the first position
+	EXPECT_EQ((std::vector<size_t>{2, 0, 3, 1}),
+	          table.positions(scores_, Order::Increasing));
+}
+
+TEST_F(PermutationTestTest, LookupTableDecreasing)
+{
+	LookupTable table(db_.get());
+
+	// The largest score is at the first position
+	EXPECT_EQ((std::vector<size_t>{1, 3, 0, 2}),
+	          table.positions(scores_, Order::Decreasing));
+}
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/CategoryDatabase.h>
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/EntityDatabase.h>
+#include <genetrail2/core/Scores.h>
+
+#include <genetrail2/enrichment/common.h>
+#include <genetrail2/enrichment/Parameters.h>
+#include <genetrail2/enrichment/SetLevelStatistics.h>
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace GeneTrail;
+
+/**
+ * A 200 x 4 score matrix with some missing values and two databases of
+ * random categories. The last category of every database is too small to
+ * be tested.
+ */
+class SampleEnrichmentsTest : public ::testing::Test
+{
+  public:
+	SampleEnrichmentsTest()
+	    : db_(std::make_shared<EntityDatabase>()),
+	      samples_(names(200, "G"), names(4, "S"))
+	{
+		std::mt19937 twister(42);
+		std::normal_distribution<double> normal;
+		std::uniform_int_distribution<size_t> gene(0, 199);
+
+		for(size_t i = 0; i < samples_.rows(); ++i) {
+			for(size_t j = 0; j < samples_.cols(); ++j) {
+				samples_.set(i, j, normal(twister));
+			}
+		}
+		for(size_t k = 0; k < 10; ++k) {
+			samples_.set(gene(twister), 2, std::numeric_limits<double>::quiet_NaN());
+		}
+
+		for(const char* name : {"db1", "db2"}) {
+			auto database = std::make_shared<CategoryDatabase>(db_);
+			database->setName(name);
+			for(size_t c = 0; c < 5; ++c) {
+				auto& category = database->addCategory();
+				category.setName(std::string(name) + "_C" + std::to_string(c));
+				const size_t size = c == 4 ? 1 : 10 + 10 * c;
+				for(size_t k = 0; k < size; ++k) {
+					category.insert("G" + std::to_string(gene(twister)));
+				}
+			}
+			databases_.emplace_back(name, database);
+		}
+
+		p_.verbose = false;
+		p_.randomSeed = 7;
+		p_.numPermutations = 100;
+		p_.adjustment = MultipleTestingCorrection::BenjaminiHochberg;
+	}
+
+	static EnrichmentAlgorithmPtr gsea(Scores& scores)
+	{
+		scores.sortByScore(Order::Decreasing);
+		return createEnrichmentAlgorithm<KolmogorovSmirnov>(
+		    PValueMode::RowWise, scores.indices().begin(),
+		    scores.indices().end(), Order::Decreasing);
+	}
+
+	static EnrichmentAlgorithmPtr mean(Scores& scores)
+	{
+		return createEnrichmentAlgorithm<MeanEnrichment>(PValueMode::RowWise,
+		                                                 scores);
+	}
+
+	/**
+	 * The results of computeEnrichments for a single column.
+	 */
+	AllResults column(size_t j, const EnrichmentAlgorithmFactory& factory)
+	{
+		Scores scores(db_);
+		for(size_t i = 0; i < samples_.rows(); ++i) {
+			if(!std::isnan(samples_(i, j))) {
+				scores.emplace_back(samples_.rowName(i), samples_(i, j));
+			}
+		}
+
+		auto algorithm = factory(scores);
+		return computeEnrichments(scores, databases_, algorithm, p_, true);
+	}
+
+	void expectSameAsColumns(const std::map<std::string, SampleEnrichments>& results,
+	                         const EnrichmentAlgorithmFactory& factory)
+	{
+		ASSERT_EQ(2u, results.size());
+		for(size_t j = 0; j < samples_.cols(); ++j) {
+			const auto expected = column(j, factory);
+			for(const auto& database : databases_) {
+				const auto& result = results.at(database.first);
+				ASSERT_EQ(database.second->size(), result.scores.rows());
+				ASSERT_EQ(samples_.cols(), result.scores.cols());
+
+				const auto& categories = expected.at(database.first);
+				for(const auto& c : *database.second) {
+					const auto i = result.scores.rowIndex(c.name());
+					const auto it = categories.find(c.name());
+					if(it == categories.end()) {
+						EXPECT_TRUE(std::isnan(result.scores(i, j)));
+						EXPECT_TRUE(std::isnan(result.pvalues(i, j)));
+						continue;
+					}
+
+					EXPECT_EQ(it->second->score, result.scores(i, j));
+					EXPECT_EQ(it->second->pvalue.convert_to<double>(),
+					          result.pvalues(i, j));
+				}
+			}
+		}
+	}
+
+  protected:
+	static std::vector<std::string> names(size_t n, const std::string& prefix)
+	{
+		std::vector<std::string> result;
+		for(size_t i = 0; i < n; ++i) {
+			result.push_back(prefix + std::to_string(i));
+		}
+		return result;
+	}
+
+	std::shared_ptr<EntityDatabase> db_;
+	DenseMatrix samples_;
+	CategoryDBPtrList databases_;
+	Params p_;
+};
+
+TEST_F(SampleEnrichmentsTest, MatchesSingleSample)
+{
+	const auto results =
+	    computeSampleEnrichments(samples_, databases_, db_, gsea, p_, 1);
+	expectSameAsColumns(results, gsea);
+
+	// The categories that are too small are never tested
+	const auto& scores = results.at("db1").scores;
+	const auto i = scores.rowIndex("db1_C4");
+	for(size_t j = 0; j < scores.cols(); ++j) {
+		EXPECT_TRUE(std::isnan(scores(i, j)));
+		EXPECT_FALSE(std::isnan(scores(0, j)));
+	}
+}
+
+TEST_F(SampleEnrichmentsTest, Permutations)
+{
+	// The row-wise p-values of the mean are computed by permutation, with
+	// the same seed for every sample
+	const auto results =
+	    computeSampleEnrichments(samples_, databases_, db_, mean, p_, 1);
+	expectSameAsColumns(results, mean);
+}
+
+TEST_F(SampleEnrichmentsTest, Threads)
+{
+	const auto single =
+	    computeSampleEnrichments(samples_, databases_, db_, gsea, p_, 1);
+	const auto parallel =
+	    computeSampleEnrichments(samples_, databases_, db_, gsea, p_, 4);
+
+	for(const auto& database : single) {
+		const auto& other = parallel.at(database.first);
+		const auto& a = database.second.pvalues.matrix();
+		const auto& b = other.pvalues.matrix();
+		// NaN != NaN, compare the positions of the missing values separately
+		EXPECT_TRUE((a.array().isNaN() == b.array().isNaN()).all());
+		EXPECT_TRUE((a.array() == b.array() || a.array().isNaN()).all());
+		EXPECT_TRUE(
+		    (database.second.scores.matrix().array() == other.scores.matrix().array() ||
+		     database.second.scores.matrix().array().isNaN()).all());
+	}
+}
@@ -0,0 +1,284 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/Exception.h>
+#include <genetrail2/core/NameDatabases.h>
+
+#include <genetrail2/regulation/BinaryRegulationNetwork.h>
+#include <genetrail2/regulation/RegulationFile.h>
+#include <genetrail2/regulation/RegulationFileParser.h>
+
+#include <config.h>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <unordered_set>
+
+using namespace GeneTrail;
+namespace fs = boost::filesystem;
+
+class BinaryRegulationNetworkTest : public ::testing::Test
+{
+	public:
+		BinaryRegulationNetworkTest()
+			: text_file_(fs::unique_path().native()),
+			  binary_file_(fs::unique_path().native())
+		{
+			std::ofstream out(text_file_);
+			out << "GeneA\tGeneB\t1.0\n"
+			    << "GeneA GeneC\n"
+			    << "GeneC\tGeneD\t3.0\n"
+			    << "GeneD\tGeneB\t4.0\n"
+			    << "GeneA\tGeneE\t5.0\n"
+			    << "GeneF\tGeneB\t6.0\n";
+			out.close();
+
+			BinaryRegulationNetwork::convert(text_file_, binary_file_);
+		}
+
+		void TearDown() override {
+			fs::remove(text_file_);
+			fs::remove(binary_file_);
+		}
+
+	protected:
+		const std::string text_file_;
+		const std::string binary_file_;
+};
+
+TEST_F(BinaryRegulationNetworkTest, Layout) {
+	EXPECT_TRUE(BinaryRegulationNetwork::isBinaryNetwork(binary_file_));
+	EXPECT_FALSE(BinaryRegulationNetwork::isBinaryNetwork(text_file_));
+
+	BinaryRegulationNetwork network(binary_file_);
+	ASSERT_EQ(network.numberOfNames(), 6);
+	EXPECT_EQ(network.numberOfEdges(), 6);
+
+	// Names are stored in the order of their first occurrence
+	EXPECT_EQ(network.name(0), "GeneA");
+	EXPECT_EQ(network.name(1), "GeneB");
+	EXPECT_EQ(network.name(2), "GeneC");
+	EXPECT_EQ(network.name(3), "GeneD");
+	EXPECT_EQ(network.name(4), "GeneE");
+	EXPECT_EQ(network.name(5), "GeneF");
+
+	ASSERT_EQ(network.regulatorEnd(0) - network.regulatorBegin(0), 3);
+	size_t e = network.regulatorBegin(0);
+	EXPECT_EQ(network.target(e), 1);
+	EXPECT_EQ(network.value(e, -1.0), 1.0);
+	EXPECT_EQ(network.target(e + 1), 2);
+	EXPECT_EQ(network.value(e + 1, -1.0), -1.0);
+	EXPECT_EQ(network.target(e + 2), 4);
+	EXPECT_EQ(network.value(e + 2, -1.0), 5.0);
+	EXPECT_FALSE(network.isRegulator(1));
+
+	ASSERT_EQ(network.targetEnd(1) - network.targetBegin(1), 3);
+	size_t p = network.targetBegin(1);
+	EXPECT_EQ(network.regulator(p), 0);
+	EXPECT_EQ(network.regulator(p + 1), 3);
+	EXPECT_EQ(network.regulator(p + 2), 5);
+	EXPECT_EQ(network.value(network.edge(p + 1), 0.0), 4.0);
+	EXPECT_EQ(network.value(network.edge(p + 2), 0.0), 6.0);
+	EXPECT_FALSE(network.isTarget(0));
+}
+
+TEST_F(BinaryRegulationNetworkTest, ParserYieldsSameRegulationFile) {
+	MapNameDatabase text_names(text_file_);
+	MapNameDatabase binary_names(text_file_);
+
+	// GeneF is not part of the test set
+	std::unordered_set<size_t> tset;
+	for(const char* name : {"GeneB", "GeneC", "GeneE"}) {
+		tset.emplace(text_names(name));
+	}
+
+	RegulationFileParser<MapNameDatabase, double> text_parser(text_names, tset, text_file_, 0.5);
+	RegulationFileParser<MapNameDatabase, double> binary_parser(binary_names, tset, binary_file_, 0.5);
+	RegulationFile<double>& expected = text_parser.getRegulationFile();
+	RegulationFile<double>& actual = binary_parser.getRegulationFile();
+
+	EXPECT_EQ(expected.regulators(), actual.regulators());
+	for(size_t i = 0; i < text_names.size(); ++i) {
+		EXPECT_EQ(text_names(i), binary_names(i));
+		EXPECT_EQ(expected.getTotalNumberOfTargets(i), actual.getTotalNumberOfTargets(i));
+		ASSERT_EQ(expected.checkTarget(i), actual.checkTarget(i));
+		if(expected.checkTarget(i)) {
+			EXPECT_EQ(expected.target2regulations(i), actual.target2regulations(i));
+		}
+		ASSERT_EQ(expected.checkRegulator(i), actual.checkRegulator(i));
+		if(expected.checkRegulator(i)) {
+			EXPECT_EQ(expected.regulator2regulations(i), actual.regulator2regulations(i));
+		}
+	}
+
+	auto& regulations = actual.target2regulations(binary_names("GeneC"));
+	ASSERT_EQ(regulations.size(), 1);
+	EXPECT_EQ(std::get<2>(regulations[0]), 0.5);
+}
+
+/**
+ * Records the order in which names are resolved for the first time, which
+ * determines the indices of databases assigning them on the fly.
+ */
+struct RecordingNameDatabase
+{
+	explicit RecordingNameDatabase(const std::string& file) : names(file) {}
+
+	std::string operator()(size_t index) { return names(index); }
+
+	size_t operator()(const std::string& name)
+	{
+		if(std::find(order.begin(), order.end(), name) == order.end()) {
+			order.push_back(name);
+		}
+		return names(name);
+	}
+
+	size_t size() { return names.size(); }
+
+	MapNameDatabase names;
+	std::vector<std::string> order;
+};
+
+TEST_F(BinaryRegulationNetworkTest, ParserResolvesNamesInTextOrderForSeparateDatabases) {
+	// GeneX occurs as a target before GeneY occurs as a regulator
+	std::ofstream out(text_file_, std::ios::trunc);
+	out << "GeneA\tGeneX\n"
+	    << "GeneY\tGeneB\n"
+	    << "GeneX\tGeneC\n";
+	out.close();
+	BinaryRegulationNetwork::convert(text_file_, binary_file_);
+
+	RecordingNameDatabase text_targets(text_file_), text_regulators(text_file_);
+	RecordingNameDatabase binary_targets(text_file_), binary_regulators(text_file_);
+	std::unordered_set<size_t> tset;
+	for(const char* name : {"GeneX", "GeneB", "GeneC"}) {
+		tset.emplace(text_targets.names(name));
+	}
+
+	RegulationFileParser<RecordingNameDatabase, double> text_parser(text_targets, text_regulators, tset, text_file_, 0.5);
+	RegulationFileParser<RecordingNameDatabase, double> binary_parser(binary_targets, binary_regulators, tset, binary_file_, 0.5);
+
+	EXPECT_EQ((std::vector<std::string>{"GeneA", "GeneY", "GeneX"}), text_regulators.order);
+	EXPECT_EQ(text_regulators.order, binary_regulators.order);
+	EXPECT_EQ(text_targets.order, binary_targets.order);
+
+	RegulationFile<double>& expected = text_parser.getRegulationFile();
+	RegulationFile<double>& actual = binary_parser.getRegulationFile();
+	for(size_t i = 0; i < text_targets.size(); ++i) {
+		ASSERT_EQ(expected.checkTarget(i), actual.checkTarget(i));
+		if(expected.checkTarget(i)) {
+			EXPECT_EQ(expected.target2regulations(i), actual.target2regulations(i));
+		}
+	}
+	for(size_t i = 0; i < text_regulators.size(); ++i) {
+		ASSERT_EQ(expected.checkRegulator(i), actual.checkRegulator(i));
+		if(expected.checkRegulator(i)) {
+			EXPECT_EQ(expected.regulator2regulations(i), actual.regulator2regulations(i));
+		}
+	}
+}
+
+TEST_F(BinaryRegulationNetworkTest, ParserKeepsTextOrderOfRegulations) {
+	// The targets of GeneC occur in the opposite order of their names
+	std::ofstream out(text_file_, std::ios::trunc);
+	out << "GeneA\tGeneB\t1.0\n"
+	    << "GeneC\tGeneD\t2.0\n"
+	    << "GeneC\tGeneA\t3.0\n"
+	    << "GeneD\tGeneB\t4.0\n"
+	    << "GeneC\tGeneB\t5.0\n";
+	out.close();
+	BinaryRegulationNetwork::convert(text_file_, binary_file_);
+
+	MapNameDatabase text_names(text_file_);
+	MapNameDatabase binary_names(text_file_);
+	std::unordered_set<size_t> tset;
+	for(const char* name : {"GeneA", "GeneB", "GeneD"}) {
+		tset.emplace(text_names(name));
+	}
+
+	RegulationFileParser<MapNameDatabase, double> text_parser(text_names, tset, text_file_, 0.5);
+	RegulationFileParser<MapNameDatabase, double> binary_parser(binary_names, tset, binary_file_, 0.5);
+	RegulationFile<double>& expected = text_parser.getRegulationFile();
+	RegulationFile<double>& actual = binary_parser.getRegulationFile();
+
+	const size_t c = text_names("GeneC");
+	ASSERT_TRUE(actual.checkRegulator(c));
+	auto& regulations = actual.regulator2regulations(c);
+	ASSERT_EQ(regulations.size(), 3);
+	EXPECT_EQ(std::get<1>(regulations[0]), text_names("GeneD"));
+	EXPECT_EQ(std::get<1>(regulations[1]), text_names("GeneA"));
+	EXPECT_EQ(std::get<1>(regulations[2]), text_names("GeneB"));
+
+	EXPECT_EQ(expected.regulators(), actual.regulators());
+	for(size_t i = 0; i < text_names.size(); ++i) {
+		ASSERT_EQ(expected.checkRegulator(i), actual.checkRegulator(i));
+		if(expected.checkRegulator(i)) {
+			EXPECT_EQ(expected.regulator2regulations(i), actual.regulator2regulations(i));
+		}
+		ASSERT_EQ(expected.checkTarget(i), actual.checkTarget(i));
+		if(expected.checkTarget(i)) {
+			EXPECT_EQ(expected.target2regulations(i), actual.target2regulations(i));
+		}
+	}
+}
+
+TEST_F(BinaryRegulationNetworkTest, RejectsInvalidFiles) {
+	EXPECT_THROW(BinaryRegulationNetwork network(text_file_), IOError);
+
+	std::ofstream out(binary_file_, std::ios::binary | std::ios::trunc);
+	out << "GT2RNET";
+	out.put('\0');
+	out.close();
+	EXPECT_THROW(BinaryRegulationNetwork network(binary_file_), IOError);
+}
+
+template <typename T>
+void corrupt(const std::string& file, uint64_t BinaryRegulationNetwork::Header::*section,
+             size_t index, T value)
+{
+	std::fstream io(file, std::ios::binary | std::ios::in | std::ios::out);
+	BinaryRegulationNetwork::Header header;
+	io.read(reinterpret_cast<char*>(&header), sizeof(header));
+	io.seekp(header.*section + index * sizeof(T));
+	io.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+TEST_F(BinaryRegulationNetworkTest, RejectsOutOfBoundsIndices) {
+	using Header = BinaryRegulationNetwork::Header;
+
+	corrupt<uint32_t>(binary_file_, &Header::targets, 0, 6);
+	EXPECT_THROW(BinaryRegulationNetwork network(binary_file_), IOError);
+
+	BinaryRegulationNetwork::convert(text_file_, binary_file_);
+	corrupt<uint32_t>(binary_file_, &Header::regulators, 1, 1000);
+	EXPECT_THROW(BinaryRegulationNetwork network(binary_file_), IOError);
+
+	BinaryRegulationNetwork::convert(text_file_, binary_file_);
+	corrupt<uint32_t>(binary_file_, &Header::edges, 2, 6);
+	EXPECT_THROW(BinaryRegulationNetwork network(binary_file_), IOError);
+
+	BinaryRegulationNetwork::convert(text_file_, binary_file_);
+	corrupt<uint32_t>(binary_file_, &Header::lines, 3, 6);
+	EXPECT_THROW(BinaryRegulationNetwork network(binary_file_), IOError);
+
+	BinaryRegulationNetwork::convert(text_file_, binary_file_);
+	EXPECT_NO_THROW(BinaryRegulationNetwork network(binary_file_));
+}
+
+TEST_F(BinaryRegulationNetworkTest, RejectsNonMonotonicOffsets) {
+	using Header = BinaryRegulationNetwork::Header;
+
+	corrupt<uint64_t>(binary_file_, &Header::regulator_offsets, 1, 6);
+	EXPECT_THROW(BinaryRegulationNetwork network(binary_file_), IOError);
+
+	BinaryRegulationNetwork::convert(text_file_, binary_file_);
+	corrupt<uint64_t>(binary_file_, &Header::target_offsets, 2, 6);
+	EXPECT_THROW(BinaryRegulationNetwork network(binary_file_), IOError);
+
+	BinaryRegulationNetwork::convert(text_file_, binary_file_);
+	corrupt<uint64_t>(binary_file_, &Header::name_offsets, 1, 1000);
+	EXPECT_THROW(BinaryRegulationNetwork network(binary_file_), IOError);
+}
@@ -67,4 +67,28 @@ TEST(BootstrapperMicro, perform_bootstrapping_run) {
       }
     }
 
-}
\ No newline at end of file
+}
+
+TEST(BootstrapperMicro, rejects_matrix_without_columns) {
+    DenseMatrix matrix(3, 0);
+    DenseMatrix micro(2, 0);
+    EXPECT_THROW(RegulationBootstrapperMicro<double>(&matrix, &micro, 5, 0), std::invalid_argument);
+
+    DenseMatrix matrix2(3, 2);
+    DenseMatrix micro2(2, 2);
+    EXPECT_THROW(RegulationBootstrapperMicro<double>(&matrix2, &micro2, 5, 3), std::invalid_argument);
+    EXPECT_NO_THROW(RegulationBootstrapperMicro<double>(&matrix2, &micro2, 5, 1));
+}
+
+TEST(BootstrapperMicro, bootstraps_disease_or_control_samples_only) {
+    DenseMatrix matrix(3, 4);
+    DenseMatrix micro(2, 4);
+
+    // Only disease samples
+    RegulationBootstrapperMicro<double> disease(&matrix, &micro, 5, 4);
+    disease.create_bootstrap_sample();
+
+    // Only control samples
+    RegulationBootstrapperMicro<double> control(&matrix, &micro, 5, 0);
+    control.create_bootstrap_sample();
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/NameDatabases.h>
+
+#include <genetrail2/regulation/CorrelationSetAnalysis.h>
+#include <genetrail2/regulation/RegulationFileParser.h>
+
+#include <config.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cmath>
+#include <fstream>
+#include <unordered_set>
+
+using namespace GeneTrail;
+namespace fs = boost::filesystem;
+
+/**
+ * GeneA regulates GeneB, GeneC and GeneD, GeneF regulates GeneB and the
+ * constant GeneE. The expected values were computed with R:
+ *
+ * b <- c(2, 4, 6, 8, 10, 13); c <- c(6, 5, 4, 3, 2, 1); d <- c(1, 3, 2, 5, 4, 6)
+ * mean(c(cor(b, c), cor(b, d), cor(c, d)))
+ * [1] -0.3306888
+ * mean(c(cor(b, c, method="spearman"), cor(b, d, method="spearman"), cor(c, d, method="spearman")))
+ * [1] -0.3333333
+ */
+class CorrelationSetAnalysisTest : public ::testing::Test
+{
+	public:
+		CorrelationSetAnalysisTest()
+			: matrix_({"GeneA", "GeneB", "GeneC", "GeneD", "GeneE", "GeneF"},
+			          {"S1", "S2", "S3", "S4", "S5", "S6"}),
+			  network_(fs::unique_path().native())
+		{
+			const double values[6][6] = {
+				{1, 2, 3, 4, 5, 6},
+				{2, 4, 6, 8, 10, 13},
+				{6, 5, 4, 3, 2, 1},
+				{1, 3, 2, 5, 4, 6},
+				{3, 3, 3, 3, 3, 3},
+				{5, 1, 4, 2, 6, 3}
+			};
+			for(size_t i = 0; i < 6; ++i) {
+				for(size_t j = 0; j < 6; ++j) {
+					matrix_.set(i, j, values[i][j]);
+				}
+			}
+
+			std::ofstream out(network_);
+			out << "GeneA\tGeneB\n"
+			    << "GeneA\tGeneC\n"
+			    << "GeneA\tGeneD\n"
+			    << "GeneF\tGeneB\n"
+			    << "GeneF\tGeneE\n";
+		}
+
+		void TearDown() override {
+			fs::remove(network_);
+		}
+
+		template <typename Correlation>
+		std::vector<RegulatorEffectResult> run(Correlation func, size_t runs, size_t threads = 1)
+		{
+			std::vector<size_t> targets {0, 1, 2, 3, 4, 5};
+			std::unordered_set<size_t> test_set(targets.begin(), targets.end());
+			MatrixNameDatabase name_database(&matrix_);
+			RegulationFileParser<MatrixNameDatabase, double> parser(name_database, test_set, network_, 0.0);
+
+			CorrelationSetAnalysis<double> csa(&matrix_, name_database, targets, parser.getRegulationFile());
+			csa.setNumberOfThreads(threads);
+			return csa.run(func, 42, runs, true, false);
+		}
+
+		static const RegulatorEffectResult& find(const std::vector<RegulatorEffectResult>& results, const std::string& name)
+		{
+			for(const auto& result : results) {
+				if(result.name == name) {
+					return result;
+				}
+			}
+			throw std::invalid_argument("Unknown regulator " + name);
+		}
+
+	protected:
+		DenseMatrix matrix_;
+		const std::string network_;
+};
+
+TEST_F(CorrelationSetAnalysisTest, Pearson) {
+	auto results = run(PearsonCorrelation(), 100);
+	ASSERT_EQ(2, results.size());
+
+	const auto& a = find(results, "GeneA");
+	EXPECT_EQ(3, a.hits);
+	EXPECT_NEAR(-0.33068876692044147, a.score, 1e-12);
+
+	// The correlation with a constant gene is zero instead of NaN
+	const auto& f = find(results, "GeneF");
+	EXPECT_EQ(2, f.hits);
+	EXPECT_EQ(0.0, f.score);
+}
+
+TEST_F(CorrelationSetAnalysisTest, Spearman) {
+	auto results = run(SpearmanCorrelation(), 100);
+
+	EXPECT_NEAR(-1.0 / 3.0, find(results, "GeneA").score, 1e-12);
+	EXPECT_EQ(0.0, find(results, "GeneF").score);
+}
+
+TEST_F(CorrelationSetAnalysisTest, PValues) {
+	// Every permutation draws its genes from its own generator seeded with
+	// seed + run, which makes the p-values reproducible for a fixed seed.
+	auto results = run(PearsonCorrelation(), 200);
+
+	const auto& a = find(results, "GeneA");
+	const auto& f = find(results, "GeneF");
+	EXPECT_DOUBLE_EQ((a.number_of_extremer_scores + 1) / 200.0, a.p_value);
+	EXPECT_DOUBLE_EQ((f.number_of_extremer_scores + 1) / 200.0, f.p_value);
+
+	EXPECT_LE(a.number_of_extremer_scores, 200u);
+	EXPECT_LE(f.number_of_extremer_scores, 200u);
+
+	// The p-values do not depend on the number of threads
+	auto parallel = run(PearsonCorrelation(), 200, 4);
+	EXPECT_EQ(a.p_value, find(parallel, "GeneA").p_value);
+	EXPECT_EQ(f.p_value, find(parallel, "GeneF").p_value);
+}
@@ -0,0 +1,18 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/DenseMatrix.h>
+
+#include <genetrail2/regulation/RegulationBootstrapper.h>
+
+#include <stdexcept>
+
+using namespace GeneTrail;
+
+TEST(RegulationBootstrapper, rejects_matrix_without_columns) {
+	DenseMatrix empty(3, 0);
+	EXPECT_THROW(RegulationBootstrapper<double>(&empty, 5), std::invalid_argument);
+
+	DenseMatrix matrix(3, 2);
+	RegulationBootstrapper<double> bootstrapper(&matrix, 5);
+	bootstrapper.create_bootstrap_sample();
+}
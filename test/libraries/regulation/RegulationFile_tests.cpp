@@ -8,6 +8,7 @@
 #include <genetrail2/regulation/RegulationFileParser.h>
 
 #include <config.h>
+#include <string>
 #include <unordered_set>
 #include <tuple>
 
@@ -193,6 +194,63 @@ TEST(RegulationFile, MatrixNameDatabase) {
 }
 
 
+/**
+ * Compares restricting the parsed network to parsing it with the test set.
+ */
+static RegulationFile<double> expectRestrictionMatchesParser(MapNameDatabase& name_database, const std::string& file, const std::unordered_set<size_t>& tset) {
+    std::unordered_set<size_t> all;
+    for(size_t i=0; i<name_database.size(); ++i){
+        all.emplace(i);
+    }
+
+    RegulationFileParser<MapNameDatabase, double> full_parser(name_database, all, file, 0.0);
+    RegulationFileParser<MapNameDatabase, double> parser(name_database, tset, file, 0.0);
+    RegulationFile<double>& expected = parser.getRegulationFile();
+    RegulationFile<double> restricted = full_parser.getRegulationFile().restrictToTargets(tset);
+
+    EXPECT_EQ(expected.regulators(), restricted.regulators());
+    for(size_t i=0; i<name_database.size(); ++i){
+        EXPECT_EQ(expected.getTotalNumberOfTargets(i), restricted.getTotalNumberOfTargets(i));
+        EXPECT_EQ(expected.checkTarget(i), restricted.checkTarget(i));
+        if(expected.checkTarget(i) && restricted.checkTarget(i)){
+            EXPECT_EQ(expected.target2regulations(i), restricted.target2regulations(i));
+        }
+        EXPECT_EQ(expected.checkRegulator(i), restricted.checkRegulator(i));
+        if(expected.checkRegulator(i) && restricted.checkRegulator(i)){
+            EXPECT_EQ(expected.regulator2regulations(i), restricted.regulator2regulations(i));
+        }
+    }
+
+    return restricted;
+}
+
+TEST(RegulationFile, restrictToTargets) {
+    MapNameDatabase name_database(TEST_DATA_PATH("RegulationFile.txt"));
+    std::unordered_set<size_t> tset{name_database("GeneB"), name_database("GeneE")};
+
+    RegulationFile<double> restricted = expectRestrictionMatchesParser(name_database, TEST_DATA_PATH("RegulationFile.txt"), tset);
+
+    EXPECT_FALSE(restricted.checkTarget(name_database("GeneC")));
+    EXPECT_FALSE(restricted.checkRegulator(name_database("GeneC")));
+    EXPECT_EQ(restricted.target2regulations(name_database("GeneB")).size(), 2);
+}
+
+TEST(RegulationFile, restrictToTargetsKeepsFileOrder) {
+    // The regulations of GeneC are listed in a different order than
+    // the indices of their targets
+    MapNameDatabase name_database(TEST_DATA_PATH("RegulationFile_Order.txt"));
+    std::unordered_set<size_t> tset{name_database("GeneB"), name_database("GeneD")};
+    ASSERT_LT(name_database("GeneB"), name_database("GeneD"));
+
+    RegulationFile<double> restricted = expectRestrictionMatchesParser(name_database, TEST_DATA_PATH("RegulationFile_Order.txt"), tset);
+
+    const auto& regulations = restricted.regulator2regulations(name_database("GeneC"));
+    ASSERT_EQ(2, regulations.size());
+    EXPECT_EQ(name_database("GeneD"), std::get<1>(regulations[0]));
+    EXPECT_EQ(name_database("GeneB"), std::get<1>(regulations[1]));
+    EXPECT_FALSE(restricted.checkTarget(name_database("GeneE")));
+}
+
 TEST(RegulationFile, MatrixNameDatabaseMicro) {
     unsigned int opts = DenseMatrixReader::NO_OPTIONS;
 	opts |= DenseMatrixReader::READ_ROW_NAMES;